@@ -38,9 +38,9 @@ namespace Luna
 			{
 				return m_entity.lock();
 			}
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 
 			virtual ECameraType camera_type() override
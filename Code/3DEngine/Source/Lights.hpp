@@ -34,9 +34,9 @@ namespace Luna
 			{
 				return m_entity.lock();
 			}
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 			virtual Float3 intensity() override
 			{
@@ -82,9 +82,9 @@ namespace Luna
 			{
 				return m_entity.lock();
 			}
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 			virtual Float3 intensity() override
 			{
@@ -140,9 +140,9 @@ namespace Luna
 			{
 				return m_entity.lock();
 			}
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 			virtual Float3 intensity() override
 			{
@@ -39,9 +39,9 @@ namespace Luna
 		{
 			return m_belonging_entity.lock();
 		}
-		Vector<Guid> ModelRenderer::referred_assets()
+		InlineVector<Guid, 2> ModelRenderer::referred_assets()
 		{
-			Vector<Guid> assets;
+			InlineVector<Guid, 2> assets;
 			if (!m_model.null())
 			{
 				assets.push_back(m_model.guid());
@@ -25,7 +25,7 @@ namespace Luna
 			virtual RV deserialize(const Variant& obj) override;
 			virtual Scene::IComponentType* type_object() override;
 			virtual P<Scene::IEntity> belonging_entity() override;
-			virtual Vector<Guid> referred_assets() override;
+			virtual InlineVector<Guid, 2> referred_assets() override;
 			virtual Asset::PAsset<IModel> model() override;
 			virtual void set_model(Asset::PAsset<IModel> model) override;
 		};
@@ -45,9 +45,9 @@ namespace Luna
 			{
 				return m_belonging_scene.lock();
 			}
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 			virtual P<Scene::IEntity> camera_entity() override
 			{
@@ -37,9 +37,9 @@ namespace Luna
 			virtual RV deserialize(const Variant& obj) override;
 			virtual Scene::IComponentType* type_object() override;
 			virtual P<Scene::IEntity> belonging_entity() override;
-			virtual Vector<Guid> referred_assets() override
+			virtual InlineVector<Guid, 2> referred_assets() override
 			{
-				return Vector<Guid>();
+				return InlineVector<Guid, 2>();
 			}
 			virtual P<ITransform> parent() override;
 			virtual Vector<P<ITransform>> children() override;
@@ -62,8 +62,10 @@ namespace Luna
 
 		enum class EAssetSaveFormat : u32
 		{
+			//! Saves to `.la` files, which are human readable.
 			ascii = 1,
-			// binary = 2, // [TODO] not implemented.
+			//! Saves to `.lb` files, which are smaller and faster to load.
+			binary = 2,
 		};
 
 		//! @interface IAssetMeta
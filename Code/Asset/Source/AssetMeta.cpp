@@ -46,7 +46,7 @@ namespace Luna
 			if (!path.empty())
 			{
 				lucheck_msg((path.flags() & EPathFlag::absolute) != EPathFlag::none, "IAssetMeta::set_meta_path - The data and meta path for one asset must be absolute");
-				auto iter = g_path_mapping.get().find(path);
+				auto iter = g_path_mapping.get().find(InternedPath::find(path));
 				if (iter != g_path_mapping.get().end())
 				{
 					return custom_error(BasicError::already_exists(), "The path %s is already used by another asset.", path.encode().c_str());
@@ -56,7 +56,7 @@ namespace Luna
 			// Remove old record.
 			if (!m_meta_path.empty())
 			{
-				auto eiter = g_path_mapping.get().find(m_meta_path);
+				auto eiter = g_path_mapping.get().find(InternedPath::find(m_meta_path));
 				if (eiter != g_path_mapping.get().end())
 				{
 					g_path_mapping.get().erase(eiter);
@@ -67,7 +67,7 @@ namespace Luna
 			if (!path.empty())
 			{
 				// Add new record.
-				g_path_mapping.get().insert(Pair<Path, Guid>(path, m_guid));
+				g_path_mapping.get().insert(Pair<InternedPath, Guid>(InternedPath(path), m_guid));
 			}
 
 			m_meta_path = path;
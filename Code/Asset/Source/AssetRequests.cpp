@@ -91,16 +91,22 @@ namespace Luna
 					lulet(data, mgr->on_save_data(ass, m_params));
 					auto save_path = meta->data_path();
 					
+					P<IEncoder> encoder;
 					if (m_format == EAssetSaveFormat::ascii)
 					{
 						save_path.append_extension("data.la");
+						encoder = new_text_encoder();
 					}
 					else
 					{
-						lupanic();
+						// The ascii file is loaded first if it exists, so the old ascii file is removed.
+						auto ascii_path = save_path;
+						ascii_path.append_extension("data.la");
+						delete_file(ascii_path);
+						save_path.append_extension("data.lb");
+						encoder = new_binary_encoder();
 					}
 					lulet(f, open_file(save_path, EFileOpenFlag::write | EFileOpenFlag::user_buffering, EFileCreationMode::create_always));
-					auto encoder = new_text_encoder();
 					luexp(encoder->encode(data, f));
 					f = nullptr;
 				}
@@ -147,16 +153,22 @@ namespace Luna
 					// Write to file.
 					auto save_path = meta->meta_path();
 
+					P<IEncoder> encoder;
 					if (m_format == EAssetSaveFormat::ascii)
 					{
 						save_path.append_extension("meta.la");
+						encoder = new_text_encoder();
 					}
 					else
 					{
-						lupanic();
+						// The ascii file is loaded first if it exists, so the old ascii file is removed.
+						auto ascii_path = save_path;
+						ascii_path.append_extension("meta.la");
+						delete_file(ascii_path);
+						save_path.append_extension("meta.lb");
+						encoder = new_binary_encoder();
 					}
 					lulet(f, open_file(save_path, EFileOpenFlag::write | EFileOpenFlag::user_buffering, EFileCreationMode::create_always));
-					auto encoder = new_text_encoder();
 					luexp(encoder->encode(var, f));
 					f = nullptr;
 				}
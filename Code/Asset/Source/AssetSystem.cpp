@@ -19,7 +19,7 @@ namespace Luna
 		Unconstructed<HashMap<Name, P<IAssetType>>> g_types;
 		P<IMutex> g_type_lock;
 		Unconstructed<HashMap<Guid, P<IAsset>>> g_assets;
-		Unconstructed<HashMap<Path, Guid>> g_path_mapping;
+		Unconstructed<HashMap<InternedPath, Guid>> g_path_mapping;
 		P<IMutex> g_lock;
 		P<IDispatchQueue> g_dispatch;
 		Unconstructed<HashMap<Guid, Vector<Guid>>> m_unresolved;
@@ -132,6 +132,8 @@ namespace Luna
 			{
 				auto p = path;
 				P<IFile> f;
+				// Binary files are mapped so that blobs in the file reference the mapped memory instead of being copied.
+				P<IMappedFile> mf;
 				bool is_binary = false;
 				if (load_meta)
 				{
@@ -156,12 +158,7 @@ namespace Luna
 						memcpy(filename_ext + filename_sz, ext2, 9 * sizeof(c8));
 						filename_name = Name(filename_ext);
 						p[p.size() - 1] = filename_name;
-						rf = open_file(p, EFileOpenFlag::read | EFileOpenFlag::user_buffering, EFileCreationMode::open_existing);
-						if (failed(rf))
-						{
-							return rf.errcode();
-						}
-						f = rf.get();
+						luset(mf, map_file(p, EFileMapHint::will_need));
 					}
 				}
 				else
@@ -187,24 +184,18 @@ namespace Luna
 						memcpy(filename_ext + filename_sz, ext2, 9 * sizeof(c8));
 						filename_name = Name(filename_ext);
 						p[p.size() - 1] = filename_name;
-						rf = open_file(p, EFileOpenFlag::read | EFileOpenFlag::user_buffering, EFileCreationMode::open_existing);
-						if (failed(rf))
-						{
-							return rf.errcode();
-						}
-						f = rf.get();
+						luset(mf, map_file(p, EFileMapHint::will_need));
 					}
 				}
-				P<IDecoder> decoder;
 				if (is_binary)
 				{
-					lupanic_msg("Not implemented.");
+					luset(r, decode_binary_variant(mf->data(), mf->size(), mf));
 				}
 				else
 				{
-					decoder = new_text_decoder();
+					auto decoder = new_text_decoder();
+					luset(r, decoder->decode(f));
 				}
-				luset(r, decoder->decode(f));
 			}
 			lucatchret;
 			return r;
@@ -218,7 +209,7 @@ namespace Luna
 			// Inserts the path to the registry if not nullptr.
 			if (!(ass->meta()->meta_path().empty()))
 			{
-				g_path_mapping.get().insert_or_assign(ass->meta()->meta_path(), ass->meta()->guid());
+				g_path_mapping.get().insert_or_assign(InternedPath(ass->meta()->meta_path()), ass->meta()->guid());
 			}
 
 			// Checks unresolved and removes them if any.
@@ -430,7 +421,7 @@ namespace Luna
 		RP<IAsset> fetch_asset(const Path& meta_path)
 		{
 			MutexGuard g(g_lock);
-			auto iter = g_path_mapping.get().find(meta_path);
+			auto iter = g_path_mapping.get().find(InternedPath::find(meta_path));
 			if (iter != g_path_mapping.get().end())
 			{
 				return fetch_asset(iter->second);
@@ -484,7 +475,7 @@ namespace Luna
 #endif
 			meta->m_type_obj = nullptr;
 			g_assets.get().erase(iter);
-			auto piter = g_path_mapping.get().find(meta->m_meta_path);
+			auto piter = g_path_mapping.get().find(InternedPath::find(meta->m_meta_path));
 			if (piter != g_path_mapping.get().end())
 			{
 				g_path_mapping.get().erase(piter);
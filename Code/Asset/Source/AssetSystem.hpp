@@ -8,6 +8,7 @@
 #include "AssetHeader.hpp"
 #include <Core/Interface.hpp>
 #include <Runtime/HashMap.hpp>
+#include <Runtime/InternedPath.hpp>
 #include <Runtime/RingDeque.hpp>
 #include <Runtime/Functional.hpp>
 namespace Luna
@@ -32,7 +33,7 @@ namespace Luna
 		extern Unconstructed<HashMap<Guid, P<IAsset>>> g_assets;
 
 		//! The mapping from meta path to asset Guid.
-		extern Unconstructed<HashMap<Path, Guid>> g_path_mapping;
+		extern Unconstructed<HashMap<InternedPath, Guid>> g_path_mapping;
 
 		//! The lock for the asset registry.
 		extern P<IMutex> g_lock;
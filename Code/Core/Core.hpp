@@ -8,6 +8,8 @@
 #pragma once
 #include "IFile.hpp"
 #include "IFileIterator.hpp"
+#include "IMappedFile.hpp"
+#include "IAsyncFileSystem.hpp"
 //#include "IRandom.hpp"
 #include "ISignal.hpp"
 #include "IMutex.hpp"
@@ -24,6 +26,8 @@
 #include "IMemoryStream.hpp"
 #include "IDispatchQueue.hpp"
 #include "Error.hpp"
+#include "Job.hpp"
+#include "Parallel.hpp"
 
 #ifndef LUNA_CORE_API
 #define LUNA_CORE_API
@@ -57,6 +61,18 @@ namespace Luna
 	//! * BasicError::not_directory
 	//! * BasicError::bad_system_call for all errors that cannot be identified.
 	LUNA_CORE_API RP<IFile>	platform_open_file(const c8* filename, EFileOpenFlag flags, EFileCreationMode creation);
+	//! Maps one whole file to memory as read-only data. Use this instead of reading the file to one heap buffer when the
+	//! data is only read, since pages are loaded by the system on demand and are shared with the system file cache.
+	//! @param[in] filename The path of the file.
+	//! @param[in] hint The expected access pattern of the mapped data.
+	//! @return If succeeded, returns the mapped file object. If failed, returns one of the following error codes:
+	//! * BasicError::bad_arguments
+	//! * BasicError::access_denied
+	//! * BasicError::not_found
+	//! * BasicError::bad_memory_alloc
+	//! * BasicError::overflow if the file is too large to be mapped to the address space.
+	//! * BasicError::bad_system_call for all errors that cannot be identified.
+	LUNA_CORE_API RP<IMappedFile> platform_map_file(const c8* filename, EFileMapHint hint = EFileMapHint::normal);
 	//! Gets the file or directory attribute.
 	//! @param[in] filename The path of the file to check.
 	//! @return Returns the file attribute structure, or one of the following error codes if failed:
@@ -156,6 +172,18 @@ namespace Luna
 	LUNA_CORE_API f64 random_f64(f64 range_begin, f64 range_end);
 	LUNA_CORE_API Guid random_guid();
 
+	//! Fills the buffer with random bytes.
+	//! @param[in] buffer The buffer to fill.
+	//! @param[in] size The size of the buffer in bytes.
+	LUNA_CORE_API void fill_random(void* buffer, usize size);
+
+	//! Fills the array with random floating-point numbers in [`range_begin`, `range_end`).
+	//! @param[in] dst The array to fill.
+	//! @param[in] count The number of elements in the array.
+	//! @remark This generates 4 numbers at a time using SIMD instructions when possible, and is much faster than
+	//! calling `random_f32` for every element.
+	LUNA_CORE_API void fill_random_f32(f32* dst, usize count, f32 range_begin, f32 range_end);
+
 	// ---------------------------------------------------------------------------------------------------------
 	//		SYNCHRONIZATION OBJECTS CREATION
 	// ---------------------------------------------------------------------------------------------------------
@@ -301,9 +329,11 @@ namespace Luna
 	//! Set frame governing feature enabled/disabled. This feature is disabled by default.
 	//! When the frame governing is enabled, the system will try to control the frame time between two
 	//! `ISystem::update` call to a specified value set_char by `ITimeSystem::set_frame_governing_fps'.
-	//! If the frame time is smaller than the govern period value, the system will suspend the thread or
-	//! yield the thread several times until the govern frame time is reached. If the frame time is greater
-	//! than the govern frame time, the system does nothing.
+	//! Frames are scheduled on one fixed timeline, the deadline of every frame is the deadline of the last frame
+	//! plus the govern period, so errors of single frames do not accumulate. If the frame finishes before its deadline,
+	//! the system suspends the thread until the deadline is close, then spins until the deadline is reached. If the frame
+	//! is late for more than one govern period, the timeline restarts from the current time so that the following frames
+	//! do not run without waiting to catch up. See `get_frame_pacing_stats`.
 	LUNA_CORE_API void set_frame_governing_enabled(bool enabled);
 
 	//! Check if the frame governing feature is enabled.
@@ -331,6 +361,39 @@ namespace Luna
 	//! Get the value used to clamping max frame time.
 	LUNA_CORE_API f32 get_min_frame_fps();
 
+	//! The statistics of frame pacing, which is the difference between the time that one frame is scheduled to start
+	//! and the time that the frame actually starts when frame governing is enabled.
+	struct FramePacingStats
+	{
+		//! The average pacing error.
+		f64 mean_error_seconds;
+		//! The maximum pacing error.
+		f64 max_error_seconds;
+		//! The standard deviation of pacing errors, which measures the frame jitter.
+		f64 stddev_error_seconds;
+		//! The number of frames measured.
+		u32 num_frames;
+		//! The number of frames that are finished after their deadlines, which are not delayed by frame governing.
+		u32 num_missed_frames;
+		//! The number of frames that sleep before their deadlines. Other frames that are not missed spin until their deadlines.
+		u32 num_slept_frames;
+		//! The current estimate of the time that `sleep` wakes the thread later than requested. Frames spin for this time
+		//! before their deadlines.
+		f64 sleep_overshoot_seconds;
+	};
+
+	//! Gets the frame pacing statistics of last 120 frames with frame governing enabled.
+	//! @remark When frame governing is enabled, frames are scheduled on one fixed timeline with the period set by
+	//! `set_frame_governing_fps`. The system sleeps until the deadline is close, then spins until the deadline, so
+	//! the pacing error is usually within a few microseconds if the frame is not missed.
+	LUNA_CORE_API FramePacingStats get_frame_pacing_stats();
+
+	//! Sets the estimate of the time that `sleep` wakes the thread later than requested, which is 2ms by default. The
+	//! estimate is updated by the measured oversleep time of every frame, and is limited to a quarter of the frame period.
+	//! @remark Set this to the timer granularity of the platform if it is known to be coarse, so that the first frames
+	//! are not woken late.
+	LUNA_CORE_API void set_frame_pacing_sleep_overshoot(f64 seconds);
+
 	// ---------------------------------------------------------------------------------------------------------
 	//		VIRTUAL FILE SYSTEM
 	// ---------------------------------------------------------------------------------------------------------
@@ -342,11 +405,23 @@ namespace Luna
 	//! @return If succeeded, returns the new opened file object.
 	LUNA_CORE_API RP<IFile>	open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation);
 
+	//! Maps one file from the virtual file system to memory as read-only data. See `platform_map_file` for details.
+	//! @param[in] filename The path of the file.
+	//! @param[in] hint The expected access pattern of the mapped data.
+	//! @return If succeeded, returns the mapped file object.
+	LUNA_CORE_API RP<IMappedFile> map_file(const Path& filename, EFileMapHint hint = EFileMapHint::normal);
+
+	//! Gets the native path of one file in the virtual file system, see `IFileSystem::native_path`.
+	//! @return Returns `BasicError::not_found` if the path is not in any mounted file system, or the error returned by 
+	//! `IFileSystem::native_path` if the file does not have a native path.
+	LUNA_CORE_API R<Path> native_path(const Path& filename);
+
 	//! Gets the file attribute from the LUNA_CORE_API file system.
 	LUNA_CORE_API R<FileAttribute> file_attribute(const Path& filename);
 
 	//! Copies the file from the source path to the destination path in the LUNA_CORE_API file system.
-	//! If the source file system and the destination file system is not the same, the file will always be copied
+	//! If the source file system and the destination file system is not the same, the file will be copied by the
+	//! platform if both files are in platform file systems (directly or through virtual mounts), otherwise the file will be copied
 	//! by loading all of its content into the temp buffer and writes them to the destination file system.
 	//! @param[in] from_filename Source file path.
 	//! @param[in] to_filename Destination file path.
@@ -410,12 +485,24 @@ namespace Luna
 	//! Gets the file system interface mounted on the specified mount point.
 	LUNA_CORE_API RP<IFileSystem> get_fs(const Path& mount_point);
 
+	//! Creates one asynchronous file system that reads and writes files of the virtual file system asynchronously.
+	//! 
+	//! On Linux, requests are submitted to `io_uring` in batches, and are completed by one completion thread. If `io_uring`
+	//! is not available, or on other platforms, requests are performed by a pool of I/O threads using blocking reads and writes.
+	//! @param[in] max_inflight_requests The maximum number of requests being processed by the kernel at the same time. Requests
+	//! beyond this limit are queued by priority. This is used only by the `io_uring` backend.
+	//! @param[in] num_threads The number of I/O threads used by the thread pool backend.
+	//! @param[in] force_thread_pool If `true`, always uses the thread pool backend.
+	//! @remark Requests not issued to the system are canceled when the file system is destroyed, and requests being processed
+	//! are waited. Callbacks called by the I/O threads must not release the last reference to the file system.
+	LUNA_CORE_API RP<IAsyncFileSystem> new_async_file_system(u32 max_inflight_requests = 64, u32 num_threads = 4, bool force_thread_pool = false);
+
 	// ---------------------------------------------------------------------------------------------------------
 	//		DISPATCHING SYSTEM
 	// ---------------------------------------------------------------------------------------------------------
 
-	//! Creates a new dispatch queue.
-	//! @param[in] thread_limit Determines how many tasks in the queue can be executed at the same time by 
+	//! Creates a new dispatch queue. Tasks in dispatch queues are executed by the job system, see `Job.hpp` for details.
+	//! @param[in] concurrency_limit Determines how many tasks in the queue can be executed at the same time by 
 	//! worker threads. Two special values are 0 and 1: value 0 means no limit, value 1 means the next
 	//! task in the queue will not be executed until the last task has been finished, such queue is called 
 	//! a serialized queue, because tasks in the queue are executed one by one.
@@ -435,6 +522,24 @@ namespace Luna
 	//! Creates one text decoder.
 	LUNA_CORE_API P<IDecoder> new_text_decoder();
 
+	//! Creates one binary encoder.
+	//! @remark The binary encoder stores names in one name table, so that every name is stored once, and stores blob data
+	//! in one blob section after all other data. Every blob is aligned to 16 bytes relative to the beginning of the 
+	//! encoded data.
+	LUNA_CORE_API P<IEncoder> new_binary_encoder();
+
+	//! Creates one binary decoder that decodes data encoded by the binary encoder. Blobs are copied from the stream.
+	LUNA_CORE_API P<IDecoder> new_binary_decoder();
+
+	//! Decodes one variant encoded by the binary encoder from memory.
+	//! @param[in] data The encoded data.
+	//! @param[in] size The size of the encoded data in bytes.
+	//! @param[in] owner The object that owns the memory. If this is not `nullptr`, decoded blobs reference the memory
+	//! directly instead of copying it, and every such blob keeps one strong reference to `owner` until the blob is
+	//! destroyed or resized. If this is `nullptr`, blobs are copied.
+	//! @remark Blobs that reference the memory can be modified only if the memory is writable.
+	LUNA_CORE_API R<Variant> decode_binary_variant(const void* data, usize size, IObject* owner = nullptr);
+
 	//---------------------------- Auxiliary APIs ----------------------------
 	//	APIs that provides convenient functions to use the Core APIs.
 
@@ -0,0 +1,197 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file IAsyncFileSystem.hpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#pragma once
+#include "IFile.hpp"
+#include "IWaitable.hpp"
+#include "IRunnable.hpp"
+#include "IDispatchQueue.hpp"
+#include "Job.hpp"
+#include <Runtime/Path.hpp>
+
+namespace Luna
+{
+	//! The operation of one asynchronous I/O request.
+	enum class EAsyncIOOp : u32
+	{
+		read = 1,
+		write = 2,
+	};
+
+	//! The priority of one asynchronous I/O request. Requests with higher priority are issued to the system before
+	//! requests with lower priority when the number of requests being processed by the system reaches the limit.
+	//! Requests with the same priority are issued in submission order.
+	enum class EAsyncIOPriority : u32
+	{
+		low = 0,
+		normal = 1,
+		high = 2,
+		count = 3,
+	};
+
+	enum class EAsyncIOStatus : u32
+	{
+		//! The request is queued and is not issued to the system yet.
+		pending = 0,
+		//! The request is being processed by the system.
+		running = 1,
+		//! The request is finished, check `IAsyncIORequest::result` for whether the request succeeds.
+		finished = 2,
+		//! The request is canceled before it is finished.
+		canceled = 3,
+	};
+
+	//! The implementation used to perform asynchronous I/O requests.
+	enum class EAsyncIOBackend : u32
+	{
+		//! Requests are performed by blocking reads and writes on a pool of I/O threads. This is used when no native
+		//! asynchronous I/O interface is available.
+		thread_pool = 0,
+		//! Requests are batched and submitted to `io_uring` of the Linux kernel, and are completed by one completion thread.
+		io_uring = 1,
+	};
+
+	//! @interface IAsyncFile
+	//! @threadsafe
+	//! Represents one file opened for asynchronous I/O. Unlike `IFile`, the asynchronous file does not have a cursor, every
+	//! request specifies the position to read or write, so multiple requests to the same file can be processed concurrently.
+	struct IAsyncFile : public IObject
+	{
+		luiid("{5d8c3e71-2a4f-4b06-9e1d-7c3a8f0b6e25}");
+
+		//! Gets the size of the file in bytes.
+		virtual u64 size() = 0;
+	};
+
+	//! @interface IAsyncIORequest
+	//! @threadsafe
+	//! Represents one submitted asynchronous I/O request. Waiting for the request suspends the current thread until the
+	//! request is finished or canceled. Jobs should wait for `AsyncIORequestDesc::counter` instead, which does not block
+	//! the worker thread.
+	struct IAsyncIORequest : public IWaitable
+	{
+		luiid("{b1f7a4c2-68d3-4e5a-8c09-3e2d6b7f1a48}");
+
+		virtual EAsyncIOStatus status() = 0;
+
+		//! Gets the result of the request. Valid only if the status is `finished` or `canceled`.
+		//! Canceled requests report `BasicError::user_canceled`.
+		virtual RV result() = 0;
+
+		//! Gets the number of bytes read or written. Valid only if the status is `finished`. Reading at or beyond the
+		//! end of the file succeeds with fewer bytes than requested.
+		virtual usize transferred_bytes() = 0;
+
+		//! Cancels the request. Pending requests are always canceled. Requests being processed by the system are canceled only
+		//! if the backend supports canceling them, otherwise they are finished normally. Canceling finished requests
+		//! does nothing.
+		//!
+		//! The request is completed (the counter is decreased and the callback is called) once no matter whether the request
+		//! is canceled or not.
+		virtual void cancel() = 0;
+	};
+
+	//! Describes one asynchronous I/O request.
+	struct AsyncIORequestDesc
+	{
+		IAsyncFile* file;
+		EAsyncIOOp op;
+		//! The position in the file to read or write, in bytes from the beginning of the file.
+		u64 offset;
+		//! The buffer to read data to or write data from. The buffer must be valid until the request is completed.
+		void* buffer;
+		u32 size;
+		//! The index of the buffer registered by `IAsyncFileSystem::register_buffers` that contains `buffer`, or `u32_max`
+		//! if `buffer` is not in one registered buffer. Registered buffers are not mapped by the kernel for every request.
+		u32 buffer_index;
+		EAsyncIOPriority priority;
+		//! The optional callback to call when the request is completed.
+		IRunnable* callback;
+		//! The optional dispatch queue to dispatch `callback` to. If this is `nullptr`, `callback` is called directly by the
+		//! I/O thread, which blocks other completions until the callback returns.
+		IDispatchQueue* callback_queue;
+		//! The optional counter to track the request. The counter is increased by 1 when the request is submitted, and is
+		//! decreased by 1 when the request is completed, so jobs can wait for requests by `wait_for_counter`.
+		JobCounter* counter;
+
+		AsyncIORequestDesc() = default;
+		AsyncIORequestDesc(
+			IAsyncFile* file,
+			EAsyncIOOp op,
+			u64 offset,
+			void* buffer,
+			u32 size,
+			EAsyncIOPriority priority = EAsyncIOPriority::normal,
+			u32 buffer_index = u32_max
+		) :
+			file(file),
+			op(op),
+			offset(offset),
+			buffer(buffer),
+			size(size),
+			buffer_index(buffer_index),
+			priority(priority),
+			callback(nullptr),
+			callback_queue(nullptr),
+			counter(nullptr) {}
+
+		static inline AsyncIORequestDesc as_read(IAsyncFile* file, u64 offset, void* buffer, u32 size, EAsyncIOPriority priority = EAsyncIOPriority::normal)
+		{
+			return AsyncIORequestDesc(file, EAsyncIOOp::read, offset, buffer, size, priority);
+		}
+		static inline AsyncIORequestDesc as_write(IAsyncFile* file, u64 offset, const void* buffer, u32 size, EAsyncIOPriority priority = EAsyncIOPriority::normal)
+		{
+			return AsyncIORequestDesc(file, EAsyncIOOp::write, offset, const_cast<void*>(buffer), size, priority);
+		}
+	};
+
+	//! @interface IAsyncFileSystem
+	//! @threadsafe
+	//! Performs file reads and writes asynchronously.
+	//!
+	//! Requests are issued to the system in priority order. The number of requests being processed by the system at the
+	//! same time is limited, so that high priority requests (like the data needed by the current frame) are not queued
+	//! behind lots of low priority requests (like streaming data) in the system.
+	struct IAsyncFileSystem : public IObject
+	{
+		luiid("{7e2a9d54-0c1b-4f83-b6e7-5a4c2d8f9b13}");
+
+		//! Gets the backend used by this file system.
+		virtual EAsyncIOBackend backend() = 0;
+
+		//! Opens one file from the virtual file system for asynchronous I/O. The file must be in one platform file system, directly
+		//! or through virtual mounts, otherwise this fails with `BasicError::not_supported`.
+		//! @param[in] flags The file open flags. `EFileOpenFlag::user_buffering` is not supported. If `EFileOpenFlag::unbuffered`
+		//! is set, the offset, size and buffer address of every request to the file should be aligned to the sector size of the
+		//! volume (4096 bytes is enough in most cases).
+		virtual RP<IAsyncFile> open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation) = 0;
+
+		//! Registers buffers that are used by I/O requests frequently, so that the buffers are mapped by the kernel once
+		//! instead of for every request. Registered buffers must be valid until the file system is destroyed. This does
+		//! nothing if the backend does not support registered buffers.
+		//! @remark This can be called only once for every file system, and fails with `BasicError::busy` if buffers
+		//! are already registered.
+		virtual RV register_buffers(void* const* buffers, const usize* sizes, u32 count) = 0;
+
+		//! Submits one batch of I/O requests.
+		//! @param[in] descs The requests to submit.
+		//! @param[in] count The number of requests to submit.
+		//! @param[out] out_requests If not `nullptr`, receives `count` request objects in the same order as `descs`.
+		virtual RV submit(const AsyncIORequestDesc* descs, u32 count, P<IAsyncIORequest>* out_requests = nullptr) = 0;
+
+		//! Submits one I/O request.
+		RP<IAsyncIORequest> submit(const AsyncIORequestDesc& desc)
+		{
+			P<IAsyncIORequest> r;
+			RV res = submit(&desc, 1, &r);
+			if (failed(res))
+			{
+				return res.errcode();
+			}
+			return r;
+		}
+	};
+}
@@ -26,10 +26,9 @@ namespace Luna
 	//! to different threads, even if they are in the same queue and get processed one after another. 
 	//! The task can be blocked, which cause the worker thread to be blocked or suspended.
 	//! 
-	//! The worker threads are reused in one engine-level thread pool. When the engine starts, the pool is empty, and 
-	//! worker threads are created and reused when tasks are pushed into the queue. For every platform, the maximum number
-	//! of worker threads the pool will have is hard-coded, if this number exceeds, the succeeding added tasks will have to 
-	//! wait to be executed after the previous tasks are finished.
+	//! Tasks are executed by the worker threads of the job system. Tasks of one queue with no concurrency limit are 
+	//! submitted as jobs directly, while queues with concurrency limit submit at most `concurrency_limit` jobs at the 
+	//! same time, every such job executes tasks in the queue one after another until the queue is empty.
 	//! 
 	//! Dispatch queues are much lighter to create, use and destroy than threads, so prefer using the 
 	//! dispatch queue whenever possible.
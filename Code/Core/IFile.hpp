@@ -33,6 +33,13 @@ namespace Luna
 		//! 
 		//! `IAsyncFile` does not support user-mode buffering, since its I/O model is request-based, not stream-based.
 		user_buffering = 0x04,
+		//! Bypasses the page cache of the system, so that data is transferred between the device and the user buffer
+		//! directly. This avoids polluting the page cache when streaming large files that are read once.
+		//! 
+		//! The offset and size of every read/write and the address of the user buffer should be aligned to the sector
+		//! size of the volume (4096 bytes is enough in most cases), or the operation may fail. This cannot be used with 
+		//! `user_buffering`.
+		unbuffered = 0x08,
 	};
 
 	enum class EFileCreationMode : u32
@@ -8,6 +8,7 @@
 #include "IObject.hpp"
 #include "IFile.hpp"
 #include "IFileIterator.hpp"
+#include "IMappedFile.hpp"
 #include <Runtime/Result.hpp>
 #include <Runtime/Path.hpp>
 namespace Luna
@@ -29,6 +30,12 @@ namespace Luna
 		//! @return If succeeded, returns the new opened file object.
 		virtual RP<IFile> open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation) = 0;
 
+		//! Maps one file to memory as read-only data.
+		//! @param[in] filename The path of the file relative to the root path of the file system.
+		//! @param[in] hint The expected access pattern of the mapped data.
+		//! @return If succeeded, returns the mapped file object.
+		virtual RP<IMappedFile> map_file(const Path& filename, EFileMapHint hint = EFileMapHint::normal) = 0;
+
 		//! Gets the file attribute.
 		virtual R<FileAttribute> file_attribute(const Path& filename) = 0;
 
@@ -0,0 +1,42 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file IMappedFile.hpp
+* @author JXMaster
+* @date 2021/7/3
+*/
+#pragma once
+#include "IObject.hpp"
+
+namespace Luna
+{
+	//! Specifies the expected access pattern of one mapped file, so that the system can schedule reads better.
+	enum class EFileMapHint : u32
+	{
+		//! No special access pattern.
+		normal = 0,
+		//! The data will be accessed from the beginning to the end once, like when being decoded or uploaded.
+		sequential = 1,
+		//! The data will be accessed in random order, like when looking up glyphs in one font file.
+		random = 2,
+		//! The data will be accessed soon, the system may start reading the data before the map call returns.
+		will_need = 3,
+	};
+
+	//! @interface IMappedFile
+	//! Represents one file mapped to the memory of the process as read-only data. The data is loaded by the system
+	//! on demand when being accessed, and is not copied to the heap.
+	//!
+	//! The data is valid until the last reference to the mapped file object is released, so one object that keeps referencing
+	//! the data (like one `Blob` decoded by `decode_binary_variant`) should also keep a reference to the mapped file.
+	struct IMappedFile : public IObject
+	{
+		luiid("{8a5e0c3d-7f21-4b96-a4d8-1e6c9b2f5d70}");
+
+		//! Gets the mapped data. Returns `nullptr` if the file is empty.
+		//! The data is read-only, writing to the data causes a segmentation fault.
+		virtual const void* data() = 0;
+
+		//! Gets the size of the mapped data in bytes.
+		virtual usize size() = 0;
+	};
+}
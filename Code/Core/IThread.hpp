@@ -26,5 +26,11 @@ namespace Luna
 
 		//! Set thread priority.
 		virtual RV set_priority(EThreadPriority priority) = 0;
+
+		//! Restricts the thread to run only on the specified logical processors, see `Platform::get_processor_topology`.
+		//! @param[in] processors The indices of logical processors the thread can run on.
+		//! @param[in] num_processors The number of elements in `processors`. If this is 0, the thread can run on all
+		//! processors.
+		virtual RV set_affinity(const u32* processors, u32 num_processors) = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,288 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Job.hpp
+* @author JXMaster
+* @date 2021/6/17
+* @brief Core job system APIs.
+*/
+#pragma once
+#include <Runtime/Base.hpp>
+#include <Runtime/Atomic.hpp>
+
+#ifndef LUNA_CORE_API
+#define LUNA_CORE_API
+#endif
+
+namespace Luna
+{
+	//! The job entry function.
+	//! @param[in] params The parameter buffer of the job, see `new_job` for details.
+	using job_func_t = void(void* params);
+
+	//! Gets the parameter buffer of the job.
+	//! @remark The parameter buffer should be written before the job is submitted. The system does not construct or destruct
+	//! the parameter buffer, so the job function should destruct parameters when it returns if needed.
+	LUNA_CORE_API void* get_job_params(handle_t job);
+
+	//! @class JobCounter
+	//! One atomic counter that jobs can wait for. The counter is usually increased when jobs are submitted and decreased
+	//! when jobs are finished, see `submit_job` for details.
+	//!
+	//! Jobs running on worker threads that wait for one counter by `wait_for_counter` suspend their fibers, and the
+	//! worker thread continues executing other jobs until the counter reaches the expected value, so waiting jobs
+	//! do not block worker threads.
+	//! @remark The counter must not be destroyed when there are jobs that are not finished and will decrease the counter, 
+	//! or there are fibers waiting for the counter.
+	class JobCounter
+	{
+	public:
+		volatile u32 m_value;
+		//! The lock for the waiting fiber list.
+		volatile u32 m_lock;
+		//! The fibers that wait for this counter.
+		void* m_waiters;
+
+		JobCounter(u32 initial_value = 0) :
+			m_value(initial_value),
+			m_lock(0),
+			m_waiters(nullptr) {}
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		u32 get() const
+		{
+			return m_value;
+		}
+		//! Increases the counter. Increasing the counter does not resume any waiting fiber.
+		void add(u32 value = 1)
+		{
+			atom_add_u32(&m_value, (i32)value);
+		}
+		//! Decreases the counter, and resumes fibers that wait for the new counter value.
+		inline void sub(u32 value = 1);
+	};
+
+	//! Decreases the counter, and resumes fibers that wait for the new counter value.
+	//! @return Returns the counter value after the decrement.
+	LUNA_CORE_API u32 sub_job_counter(JobCounter* counter, u32 value);
+
+	//! Waits until the counter is decreased to `value` or less.
+	//! @remark If this is called in one job executed by one worker thread, the job fiber is suspended and the worker
+	//! thread executes other jobs or resumes other fibers. Otherwise, the calling thread executes other jobs while 
+	//! waiting like `wait_job`.
+	LUNA_CORE_API void wait_for_counter(JobCounter& counter, u32 value = 0);
+
+	inline void JobCounter::sub(u32 value)
+	{
+		sub_job_counter(this, value);
+	}
+
+	//! Adds one dependency to the job, so that the job is not executed until the dependency job is finished.
+	//! @param[in] job The job to add dependency to. This must be called before the job is submitted.
+	//! @param[in] dependency The job that must be finished before `job` is executed. This can be finished or unfinished,
+	//! but must be submitted or will be submitted by the user.
+	LUNA_CORE_API void add_job_dependency(handle_t job, handle_t dependency);
+
+	//! Submits the job to the job system. The job will be executed by one worker thread after all dependencies are finished.
+	//! Every job must be submitted exactly once.
+	//! @param[in] counter The optional counter to track the job. The counter is increased by 1 when the job is submitted, 
+	//! and is decreased by 1 when the job and all of its children jobs are finished.
+	LUNA_CORE_API void submit_job(handle_t job, JobCounter* counter = nullptr);
+
+	//! Checks if the job and all of its children jobs are finished.
+	LUNA_CORE_API bool is_job_finished(handle_t job);
+
+	//! Waits for the job and all of its children jobs to finish. The job must be submitted.
+	//! @remark This suspends the job fiber if called in one job executed by one worker thread, see `wait_for_counter`
+	//! for details. Otherwise, the calling thread executes other jobs while waiting.
+	LUNA_CORE_API void wait_job(handle_t job);
+
+	//! Increases the reference count of the job. Use `JobHandle` instead of calling this directly.
+	LUNA_CORE_API void add_job_ref(handle_t job);
+
+	//! Decreases the reference count of the job. Use `JobHandle` instead of calling this directly.
+	LUNA_CORE_API void release_job_ref(handle_t job);
+
+	//! Gets the number of worker threads of the job system. The number of worker threads is decided by the number of
+	//! logical processors when the system is initialized, and does not change after that.
+	LUNA_CORE_API u32 get_job_worker_count();
+
+	//! Gets the stack size of job fibers.
+	LUNA_CORE_API usize get_job_fiber_stack_size();
+
+	//! Pins job worker threads to logical processors.
+	//! 
+	//! Workers are placed on different physical cores first, and are placed on SMT siblings of used cores only after all
+	//! cores are used. Workers on the same NUMA node get adjacent worker indices. If there are more workers than
+	//! logical processors available, every worker is pinned to all available processors instead of one processor.
+	//! @param[in] num_reserved_cores The number of physical cores that workers do not run on. These cores are reserved
+	//! for threads that are not workers, like the main thread and the render thread, see `get_job_reserved_processors`.
+	//! @return Returns `BasicError::bad_arguments` if no processor is left for workers.
+	//! @remark This must not be called concurrently with itself or `clear_job_worker_affinity`.
+	LUNA_CORE_API RV set_job_worker_affinity(u32 num_reserved_cores);
+
+	//! Restores job worker threads to run on all processors. Workers are not pinned when the job system is initialized.
+	LUNA_CORE_API RV clear_job_worker_affinity();
+
+	//! Gets the logical processors of one core reserved by `set_job_worker_affinity`. Threads that use the core can
+	//! pin themselves by `IThread::set_affinity`.
+	//! @param[in] reserved_core_index The index of the reserved core, which is smaller than the `num_reserved_cores`
+	//! value passed to `set_job_worker_affinity`.
+	//! @param[out] processors The array to receive the processor indices.
+	//! @param[in] max_processors The number of elements in `processors`.
+	//! @return Returns the number of logical processors of the core, or 0 if the core is not reserved.
+	LUNA_CORE_API u32 get_job_reserved_processors(u32 reserved_core_index, u32* processors, u32 max_processors);
+
+	//! Gets the index of the worker thread that runs the current job.
+	//! @return Returns the worker index, or `u32_max` if the current thread is not one worker thread.
+	//! @remark One job that waits for other jobs may be resumed by another worker, so the index may change after waiting.
+	LUNA_CORE_API u32 get_current_job_worker_index();
+
+	//! Gets the NUMA node of the processors that the worker thread is pinned to. Use this with `Platform::numa_memalloc`
+	//! to allocate memory that is mostly accessed by one worker.
+	//! @return Returns the NUMA node, or `u32_max` if the worker is not pinned to processors of one node.
+	LUNA_CORE_API u32 get_job_worker_numa_node(u32 worker_index);
+
+	//! @class JobHandle
+	//! JobHandle is one strong reference to one job. The job object is freed when the job is finished and all handles
+	//! to the job are released.
+	//!
+	//! The job system is one work-stealing scheduler: every worker thread has its own job queue, jobs submitted by
+	//! one worker thread are pushed to the queue of that thread, and idle worker threads steal jobs from other queues.
+	//! Prefer creating jobs from job functions (fork/join) over creating all jobs from one thread.
+	//!
+	//! Worker threads execute jobs on fibers allocated from one fiber pool. When one job waits for other jobs or
+	//! counters, its fiber is suspended and the worker thread switches to one ready or free fiber, so deep dependency
+	//! chains do not need more threads. Job fibers have limited stack size (`get_job_fiber_stack_size`), so avoid large 
+	//! stack allocations in job functions.
+	class JobHandle
+	{
+		handle_t m_job;
+	public:
+		//! Constructs one null handle.
+		JobHandle() :
+			m_job(nullptr) {}
+		//! Takes the job reference without increasing the reference count.
+		static JobHandle attach(handle_t job)
+		{
+			JobHandle r;
+			r.m_job = job;
+			return r;
+		}
+		JobHandle(const JobHandle& rhs) :
+			m_job(rhs.m_job)
+		{
+			if (m_job) add_job_ref(m_job);
+		}
+		JobHandle(JobHandle&& rhs) :
+			m_job(rhs.m_job)
+		{
+			rhs.m_job = nullptr;
+		}
+		JobHandle& operator=(const JobHandle& rhs)
+		{
+			if (rhs.m_job) add_job_ref(rhs.m_job);
+			if (m_job) release_job_ref(m_job);
+			m_job = rhs.m_job;
+			return *this;
+		}
+		JobHandle& operator=(JobHandle&& rhs)
+		{
+			if (this != &rhs)
+			{
+				if (m_job) release_job_ref(m_job);
+				m_job = rhs.m_job;
+				rhs.m_job = nullptr;
+			}
+			return *this;
+		}
+		~JobHandle()
+		{
+			if (m_job) release_job_ref(m_job);
+		}
+		handle_t get() const
+		{
+			return m_job;
+		}
+		bool valid() const
+		{
+			return m_job != nullptr;
+		}
+		operator bool() const
+		{
+			return valid();
+		}
+		void* params() const
+		{
+			return get_job_params(m_job);
+		}
+		void depends_on(const JobHandle& dependency) const
+		{
+			add_job_dependency(m_job, dependency.m_job);
+		}
+		void submit(JobCounter* counter = nullptr) const
+		{
+			submit_job(m_job, counter);
+		}
+		bool finished() const
+		{
+			return is_job_finished(m_job);
+		}
+		void wait() const
+		{
+			wait_job(m_job);
+		}
+	};
+
+	//! Creates one job. The job is not executed until `submit_job` is called for it.
+	//! @param[in] func The job entry function.
+	//! @param[in] params_size The size of the parameter buffer allocated with the job. The buffer can be fetched by
+	//! `get_job_params` and is passed to `func` when the job is executed. Specify 0 if the job does not need parameters.
+	//! @param[in] params_alignment The alignment of the parameter buffer. Specify 0 to use the default alignment.
+	//! @param[in] parent The optional parent job. If specified, the parent job is not finished until this job is
+	//! finished. The parent job must not be finished when this is called, so this is usually called by the parent job
+	//! function, or before the parent job is submitted.
+	//! @return Returns the new created job.
+	LUNA_CORE_API JobHandle new_job(job_func_t* func, usize params_size = 0, usize params_alignment = 0, const JobHandle& parent = JobHandle());
+
+	namespace impl
+	{
+		template <typename _Func>
+		void job_entry(void* params)
+		{
+			_Func* func = (_Func*)params;
+			(*func)();
+			func->~_Func();
+		}
+	}
+
+	//! Creates one job that calls the function object, and optionally submits it.
+	//! @param[in] func The function object to call. The object is moved into the parameter buffer of the job,
+	//! and is destructed after it is called.
+	//! @param[in] parent The optional parent job, see `new_job` for details.
+	//! @param[in] submit Whether to submit the job. Specify `false` if dependencies need to be added to the job, and call
+	//! `JobHandle::submit` after that.
+	template <typename _Func>
+	inline JobHandle dispatch_job(_Func&& func, const JobHandle& parent = JobHandle(), bool submit = true)
+	{
+		using func_t = decay_t<_Func>;
+		JobHandle job = new_job(impl::job_entry<func_t>, sizeof(func_t), alignof(func_t), parent);
+		new (job.params()) func_t(forward<_Func>(func));
+		if (submit)
+		{
+			job.submit();
+		}
+		return job;
+	}
+
+	//! Creates one job that calls the function object and submits it with the counter.
+	//! @param[in] func The function object to call.
+	//! @param[in] counter The counter to track the job, see `submit_job` for details.
+	template <typename _Func>
+	inline JobHandle dispatch_job(_Func&& func, JobCounter& counter)
+	{
+		JobHandle job = dispatch_job(forward<_Func>(func), JobHandle(), false);
+		job.submit(&counter);
+		return job;
+	}
+}
@@ -0,0 +1,296 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Parallel.hpp
+* @author JXMaster
+* @date 2021/6/22
+* @brief Parallel algorithms built on the job system.
+*/
+#pragma once
+#include "Job.hpp"
+#include <Runtime/Algorithm.hpp>
+#include <Runtime/Memory.hpp>
+#include <Runtime/Sync.hpp>
+
+/*
+	Functions in Parallel.hpp:
+
+	parallel_for_range
+	parallel_for
+	parallel_reduce
+	parallel_sort
+	parallel_scan
+
+	All functions split the work into chunks of `grain_size` elements and execute chunks on job system workers. The calling
+	thread also executes chunks, and returns after all chunks are finished. These functions can be called from job functions.
+
+	If `grain_size` is 0, the grain size is selected automatically so that every worker gets about `parallel_chunks_per_worker`
+	chunks, which is enough for work stealing to balance uneven chunks. Specify the grain size explicitly if the work of
+	every element is very small (so that bigger chunks are needed to amortize the job overhead), or if the partition must
+	not depend on the number of workers.
+*/
+
+namespace Luna
+{
+	//! The number of chunks that every worker gets when the grain size is selected automatically.
+	constexpr usize parallel_chunks_per_worker = 8;
+
+	//! The number of chunks used by `parallel_reduce` with `deterministic` set when the grain size is selected automatically.
+	constexpr usize parallel_deterministic_chunks = 256;
+
+	//! The minimal grain size selected automatically by `parallel_sort`. Smaller ranges are sorted faster by one thread.
+	constexpr usize parallel_sort_min_grain_size = 2048;
+
+	namespace impl
+	{
+		inline usize parallel_grain_size(usize count, usize grain_size)
+		{
+			if (grain_size)
+			{
+				return grain_size;
+			}
+			usize num_chunks = (usize)get_job_worker_count() * parallel_chunks_per_worker;
+			return max<usize>((count + num_chunks - 1) / num_chunks, 1);
+		}
+
+		//! Splits the range in halves recursively. One half is dispatched as one job so that idle workers can steal it, and
+		//! the other half is split again by the current job.
+		template <typename _Func>
+		void parallel_for_split(usize begin, usize end, usize grain_size, const _Func& func)
+		{
+			JobCounter counter;
+			while (end - begin > grain_size)
+			{
+				usize mid = begin + (end - begin) / 2;
+				dispatch_job([mid, end, grain_size, &func]() { parallel_for_split(mid, end, grain_size, func); }, counter);
+				end = mid;
+			}
+			func(begin, end);
+			wait_for_counter(counter);
+		}
+
+		//! One array allocated from the heap, used for per-chunk results.
+		template <typename _Ty>
+		class ParallelArray
+		{
+			_Ty* m_data;
+			usize m_size;
+		public:
+			ParallelArray(usize size, const _Ty& value) :
+				m_size(size)
+			{
+				m_data = (_Ty*)memalloc(sizeof(_Ty) * size, alignof(_Ty));
+				for (usize i = 0; i < size; ++i)
+				{
+					new (m_data + i) _Ty(value);
+				}
+			}
+			ParallelArray(const ParallelArray&) = delete;
+			ParallelArray& operator=(const ParallelArray&) = delete;
+			~ParallelArray()
+			{
+				for (usize i = 0; i < m_size; ++i)
+				{
+					m_data[i].~_Ty();
+				}
+				memfree(m_data, alignof(_Ty));
+			}
+			_Ty& operator[](usize i)
+			{
+				return m_data[i];
+			}
+		};
+
+		template <typename _RandomIter, typename _LessComp>
+		void parallel_sort_split(_RandomIter first, _RandomIter last, usize grain_size, u32 depth_limit, _LessComp& less_comp)
+		{
+			JobCounter counter;
+			while ((usize)(last - first) > grain_size && depth_limit)
+			{
+				--depth_limit;
+				_RandomIter j = Impl::partition_median_of_three(first, last, less_comp);
+				// Dispatches the smaller part and keeps partitioning the larger part.
+				_RandomIter sub_first = first;
+				_RandomIter sub_last = j;
+				if (j - first < last - j)
+				{
+					first = j + 1;
+				}
+				else
+				{
+					sub_first = j + 1;
+					sub_last = last;
+					last = j;
+				}
+				dispatch_job([sub_first, sub_last, grain_size, depth_limit, &less_comp]() {
+					parallel_sort_split(sub_first, sub_last, grain_size, depth_limit, less_comp);
+				}, counter);
+			}
+			sort(first, last, less_comp);
+			wait_for_counter(counter);
+		}
+	}
+
+	//! Calls `func(chunk_begin, chunk_end)` for every chunk of the range [`begin`, `end`) in parallel.
+	//! @param[in] func The function to call. This is called concurrently from multiple threads.
+	//! @param[in] grain_size The maximum number of elements in one chunk. Specify 0 to select the grain size automatically.
+	template <typename _Func>
+	inline void parallel_for_range(usize begin, usize end, _Func&& func, usize grain_size = 0)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		grain_size = impl::parallel_grain_size(end - begin, grain_size);
+		if (end - begin <= grain_size)
+		{
+			func(begin, end);
+			return;
+		}
+		impl::parallel_for_split(begin, end, grain_size, func);
+	}
+
+	//! Calls `func(i)` for every `i` in [`begin`, `end`) in parallel.
+	//! @param[in] func The function to call. This is called concurrently from multiple threads.
+	//! @param[in] grain_size The maximum number of elements in one chunk. Specify 0 to select the grain size automatically.
+	template <typename _Func>
+	inline void parallel_for(usize begin, usize end, _Func&& func, usize grain_size = 0)
+	{
+		parallel_for_range(begin, end, [&func](usize chunk_begin, usize chunk_end) {
+			for (usize i = chunk_begin; i < chunk_end; ++i)
+			{
+				func(i);
+			}
+		}, grain_size);
+	}
+
+	//! Reduces the range [`begin`, `end`) in parallel.
+	//! @param[in] identity The identity value of `reduce_func`, which is returned if the range is empty.
+	//! @param[in] range_func The function that reduces one chunk, in form of `_Ty range_func(usize chunk_begin, usize chunk_end)`.
+	//! @param[in] reduce_func The function that combines two results, in form of `_Ty reduce_func(const _Ty& a, const _Ty& b)`.
+	//! This must be associative, but needs not to be commutative: chunk results are stored and combined from left to right
+	//! after all chunks are finished.
+	//! @param[in] deterministic If `true` and `grain_size` is 0, the range is split to the same chunks regardless of the number
+	//! of workers, so the result is the same on every machine even if `reduce_func` is only approximately associative (like
+	//! floating-point addition). If `false`, the chunks depend on the number of workers.
+	//! @param[in] grain_size The maximum number of elements in one chunk. Specify 0 to select the grain size automatically.
+	//! @return Returns the reduced result.
+	template <typename _Ty, typename _RangeFunc, typename _ReduceFunc>
+	inline _Ty parallel_reduce(usize begin, usize end, const _Ty& identity, _RangeFunc&& range_func, _ReduceFunc&& reduce_func,
+		bool deterministic = false, usize grain_size = 0)
+	{
+		if (begin >= end)
+		{
+			return identity;
+		}
+		usize count = end - begin;
+		if (!grain_size)
+		{
+			grain_size = deterministic ?
+				max<usize>((count + parallel_deterministic_chunks - 1) / parallel_deterministic_chunks, 1) :
+				impl::parallel_grain_size(count, 0);
+		}
+		usize num_chunks = (count + grain_size - 1) / grain_size;
+		impl::ParallelArray<_Ty> results(num_chunks, identity);
+		parallel_for(0, num_chunks, [&](usize chunk) {
+			usize chunk_begin = begin + chunk * grain_size;
+			results[chunk] = range_func(chunk_begin, min(chunk_begin + grain_size, end));
+		}, 1);
+		_Ty r = results[0];
+		for (usize i = 1; i < num_chunks; ++i)
+		{
+			r = reduce_func(r, results[i]);
+		}
+		return r;
+	}
+
+	//! Sorts the range in ascending order in parallel. The sort is not stable.
+	//! @remark The range is partitioned like quick sort, and partitions are sorted by different workers. Partitions smaller
+	//! than `grain_size` are sorted by `sort`.
+	//! @param[in] grain_size The size of the range that is sorted by one thread. Specify 0 to select the grain size
+	//! automatically. Grain sizes smaller than `Impl::insertion_sort_threshold` are raised to it.
+	template <typename _RandomIter, typename _LessComp>
+	inline void parallel_sort(_RandomIter first, _RandomIter last, _LessComp less_comp, usize grain_size = 0)
+	{
+		usize count = (usize)(last - first);
+		if (!grain_size)
+		{
+			grain_size = max(impl::parallel_grain_size(count, 0), parallel_sort_min_grain_size);
+		}
+		// Partitioning needs at least 3 elements, and smaller ranges are sorted faster by insertion sort.
+		grain_size = max(grain_size, Impl::insertion_sort_threshold);
+		if (count <= grain_size)
+		{
+			sort(first, last, less_comp);
+			return;
+		}
+		// Falls back to `sort` if the partitions are badly unbalanced.
+		u32 depth_limit = 0;
+		for (usize n = count; n > 1; n >>= 1)
+		{
+			depth_limit += 2;
+		}
+		impl::parallel_sort_split(first, last, grain_size, depth_limit, less_comp);
+	}
+
+	template <typename _RandomIter>
+	inline void parallel_sort(_RandomIter first, _RandomIter last)
+	{
+		parallel_sort(first, last, Impl::SortLess());
+	}
+
+	//! Computes the inclusive prefix scan of the range in parallel, so that `dst[i]` is `op(src[0], ..., src[i])`.
+	//! @param[in] first The beginning of the source range.
+	//! @param[in] last The end of the source range.
+	//! @param[in] dst The beginning of the destination range. This can be the same as `first`.
+	//! @param[in] identity The identity value of `op`.
+	//! @param[in] op The function that combines two values, in form of `_Ty op(const _Ty& a, const _Ty& b)`. This must be
+	//! associative.
+	//! @param[in] grain_size The maximum number of elements in one chunk. Specify 0 to select the grain size automatically.
+	//! @remark The scan is done in three passes: chunk sums are computed in parallel, then prefixed by the calling thread,
+	//! then every chunk is scanned in parallel starting from its prefix. This reads the source range twice.
+	template <typename _InputIter, typename _OutputIter, typename _Ty, typename _Op>
+	inline void parallel_scan(_InputIter first, _InputIter last, _OutputIter dst, const _Ty& identity, _Op&& op, usize grain_size = 0)
+	{
+		usize count = (usize)(last - first);
+		grain_size = impl::parallel_grain_size(count, grain_size);
+		usize num_chunks = (count + grain_size - 1) / grain_size;
+		auto scan_chunk = [&](usize chunk, _Ty acc) {
+			usize end = min((chunk + 1) * grain_size, count);
+			for (usize i = chunk * grain_size; i < end; ++i)
+			{
+				acc = op(acc, first[i]);
+				dst[i] = acc;
+			}
+		};
+		if (num_chunks <= 1)
+		{
+			if (count)
+			{
+				scan_chunk(0, identity);
+			}
+			return;
+		}
+		impl::ParallelArray<_Ty> sums(num_chunks, identity);
+		// The last chunk does not need its sum.
+		parallel_for(0, num_chunks - 1, [&](usize chunk) {
+			_Ty acc = identity;
+			usize end = (chunk + 1) * grain_size;
+			for (usize i = chunk * grain_size; i < end; ++i)
+			{
+				acc = op(acc, first[i]);
+			}
+			sums[chunk] = acc;
+		}, 1);
+		// Converts chunk sums to chunk prefixes.
+		_Ty prefix = identity;
+		for (usize i = 0; i < num_chunks; ++i)
+		{
+			_Ty sum = sums[i];
+			sums[i] = prefix;
+			prefix = op(prefix, sum);
+		}
+		parallel_for(0, num_chunks, [&](usize chunk) {
+			scan_chunk(chunk, sums[chunk]);
+		}, 1);
+	}
+}
@@ -0,0 +1,404 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AsyncFileSystem.cpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_CORE_API LUNA_EXPORT
+#include "AsyncFileSystem.hpp"
+#include "Vfs.hpp"
+
+namespace Luna
+{
+	//! The number of requests issued to or fetched from the system queue in one call.
+	constexpr u32 async_io_batch_size = 32;
+
+	//! The user data of the request that wakes up the completion thread.
+	constexpr u64 async_io_wake_up_user_data = 0;
+
+	void AsyncIORequest::complete(errcode_t result, usize transferred_bytes)
+	{
+		m_result = result;
+		m_transferred_bytes = transferred_bytes;
+		atom_fence_release();
+		m_status = result == BasicError::user_canceled() ? EAsyncIOStatus::canceled : EAsyncIOStatus::finished;
+		if (m_callback)
+		{
+			if (m_callback_queue)
+			{
+				m_callback_queue->dispatch(m_callback);
+			}
+			else
+			{
+				m_callback->run();
+			}
+		}
+		// The counter may be destroyed by the waiting job as soon as it is decreased.
+		if (m_counter)
+		{
+			m_counter->sub();
+		}
+		m_completed.trigger();
+	}
+
+	void AsyncIORequest::cancel()
+	{
+		P<AsyncFileSystem> fs = m_fs.lock();
+		if (fs)
+		{
+			fs->cancel(this);
+		}
+	}
+
+	void AsyncIOWorker::run()
+	{
+		if (m_fs->m_backend == EAsyncIOBackend::io_uring)
+		{
+			m_fs->run_completion_thread();
+		}
+		else
+		{
+			m_fs->run_pool_thread();
+		}
+	}
+
+	AsyncFileSystem::~AsyncFileSystem()
+	{
+		// Requests that are not issued are canceled, requests being processed by the system are waited.
+		RingDeque<P<AsyncIORequest>> canceled;
+		MutexGuard guard(m_mtx.get());
+		m_exiting = true;
+		P<AsyncIORequest> r = pop_pending_request();
+		while (r)
+		{
+			canceled.push_back(move(r));
+			r = pop_pending_request();
+		}
+		if (m_backend == EAsyncIOBackend::io_uring)
+		{
+			Platform::AsyncIORequest req;
+			req.op = Platform::AsyncIOOp::nop;
+			req.user_data = async_io_wake_up_user_data;
+			auto _ = Platform::submit_async_io(m_queue, &req, 1);
+		}
+		guard.unlock();
+		for (auto& i : canceled)
+		{
+			i->complete(BasicError::user_canceled(), 0);
+		}
+		if (m_pending_sema)
+		{
+			m_pending_sema->unacquire((i32)m_threads.size());
+		}
+		for (auto& i : m_threads)
+		{
+			i->wait();
+		}
+		m_threads.clear();
+		if (m_queue)
+		{
+			Platform::delete_async_io_queue(m_queue);
+			m_queue = nullptr;
+		}
+	}
+
+	RV AsyncFileSystem::init(u32 max_inflight_requests, u32 num_threads, bool force_thread_pool)
+	{
+		m_mtx = new_mutex();
+		if (!force_thread_pool)
+		{
+			auto q = Platform::new_async_io_queue(max_inflight_requests);
+			if (succeeded(q))
+			{
+				m_queue = q.get();
+				m_backend = EAsyncIOBackend::io_uring;
+				m_max_inflight_requests = max_inflight_requests;
+			}
+		}
+		if (m_backend == EAsyncIOBackend::io_uring)
+		{
+			// The kernel performs requests concurrently, so one thread is enough for completions.
+			num_threads = 1;
+		}
+		else
+		{
+			m_pending_sema = new_semaphore(0, i32_max);
+		}
+		lutry
+		{
+			for (u32 i = 0; i < num_threads; ++i)
+			{
+				P<AsyncIOWorker> worker = newobj<AsyncIOWorker>();
+				worker->m_fs = this;
+				lulet(t, new_thread(worker));
+				m_threads.push_back(t);
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	P<AsyncIORequest> AsyncFileSystem::pop_pending_request()
+	{
+		for (u32 i = (u32)EAsyncIOPriority::count; i > 0; --i)
+		{
+			auto& q = m_pending[i - 1];
+			if (!q.empty())
+			{
+				P<AsyncIORequest> r = move(q.front());
+				q.pop_front();
+				return r;
+			}
+		}
+		return P<AsyncIORequest>();
+	}
+
+	void AsyncFileSystem::issue_pending_requests()
+	{
+		while (m_num_inflight_requests < m_max_inflight_requests)
+		{
+			P<AsyncIORequest> reqs[async_io_batch_size];
+			Platform::AsyncIORequest descs[async_io_batch_size];
+			u32 n = 0;
+			while (n < async_io_batch_size && m_num_inflight_requests + n < m_max_inflight_requests)
+			{
+				P<AsyncIORequest> r = pop_pending_request();
+				if (!r)
+				{
+					break;
+				}
+				Platform::AsyncIORequest& desc = descs[n];
+				desc.op = r->m_op == EAsyncIOOp::read ? Platform::AsyncIOOp::read : Platform::AsyncIOOp::write;
+				desc.file = r->native_file();
+				desc.offset = r->m_offset;
+				desc.buffer = r->m_buffer;
+				desc.size = r->m_size;
+				desc.buffer_index = r->m_buffer_index;
+				desc.user_data = (u64)(usize)r.get();
+				r->m_status = EAsyncIOStatus::running;
+				reqs[n] = move(r);
+				++n;
+			}
+			if (!n)
+			{
+				return;
+			}
+			auto submitted = Platform::submit_async_io(m_queue, descs, n);
+			if (failed(submitted))
+			{
+				for (u32 i = 0; i < n; ++i)
+				{
+					reqs[i]->complete(submitted.errcode(), 0);
+				}
+				continue;
+			}
+			// Requests being processed are referenced by the system queue, and are released by the completion thread.
+			for (u32 i = 0; i < submitted.get(); ++i)
+			{
+				reqs[i]->add_ref();
+			}
+			m_num_inflight_requests += submitted.get();
+			if (submitted.get() < n)
+			{
+				if (!m_num_inflight_requests)
+				{
+					// The system is busy while no request is being processed, so no completion will issue these
+					// requests again.
+					for (u32 i = submitted.get(); i < n; ++i)
+					{
+						reqs[i]->complete(BasicError::busy(), 0);
+					}
+					continue;
+				}
+				// The system queue is full, requests not submitted are issued again when requests are completed.
+				for (u32 i = n; i > submitted.get(); --i)
+				{
+					auto& r = reqs[i - 1];
+					r->m_status = EAsyncIOStatus::pending;
+					m_pending[(u32)r->m_priority].push_front(move(r));
+				}
+				return;
+			}
+		}
+	}
+
+	void AsyncFileSystem::cancel(AsyncIORequest* request)
+	{
+		MutexGuard guard(m_mtx.get());
+		if (request->m_status == EAsyncIOStatus::pending)
+		{
+			auto& q = m_pending[(u32)request->m_priority];
+			for (auto iter = q.begin(); iter != q.end(); ++iter)
+			{
+				if (iter->get() == request)
+				{
+					P<AsyncIORequest> r = move(*iter);
+					q.erase(iter);
+					guard.unlock();
+					r->complete(BasicError::user_canceled(), 0);
+					return;
+				}
+			}
+		}
+		else if (request->m_status == EAsyncIOStatus::running && m_backend == EAsyncIOBackend::io_uring)
+		{
+			// The request completes with `BasicError::user_canceled` if it is canceled by the system.
+			auto _ = Platform::cancel_async_io(m_queue, (u64)(usize)request);
+		}
+	}
+
+	void AsyncFileSystem::run_completion_thread()
+	{
+		Platform::AsyncIOCompletion completions[async_io_batch_size];
+		while (true)
+		{
+			u32 n = Platform::wait_async_io(m_queue, completions, async_io_batch_size, true);
+			u32 num_completed = 0;
+			for (u32 i = 0; i < n; ++i)
+			{
+				auto& c = completions[i];
+				if (c.user_data == async_io_wake_up_user_data)
+				{
+					continue;
+				}
+				AsyncIORequest* r = (AsyncIORequest*)(usize)c.user_data;
+				r->complete(c.result, c.transferred_bytes);
+				r->release();
+				++num_completed;
+			}
+			MutexGuard guard(m_mtx.get());
+			m_num_inflight_requests -= num_completed;
+			if (m_exiting)
+			{
+				if (!m_num_inflight_requests)
+				{
+					break;
+				}
+			}
+			else
+			{
+				issue_pending_requests();
+			}
+		}
+	}
+
+	void AsyncFileSystem::run_pool_thread()
+	{
+		while (true)
+		{
+			m_pending_sema->wait();
+			MutexGuard guard(m_mtx.get());
+			P<AsyncIORequest> r = pop_pending_request();
+			if (!r)
+			{
+				// The semaphore is also released for requests that are canceled before being processed.
+				if (m_exiting)
+				{
+					break;
+				}
+				continue;
+			}
+			r->m_status = EAsyncIOStatus::running;
+			guard.unlock();
+			usize transferred_bytes = 0;
+			RV res = r->m_op == EAsyncIOOp::read ?
+				Platform::read_file_at(r->native_file(), r->m_offset, r->m_buffer, r->m_size, &transferred_bytes) :
+				Platform::write_file_at(r->native_file(), r->m_offset, r->m_buffer, r->m_size, &transferred_bytes);
+			r->complete(res.errcode(), failed(res) ? 0 : transferred_bytes);
+		}
+	}
+
+	RP<IAsyncFile> AsyncFileSystem::open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation)
+	{
+		if ((flags & EFileOpenFlag::user_buffering) != EFileOpenFlag::none)
+		{
+			return BasicError::bad_arguments();
+		}
+		lutry
+		{
+			lulet(path, platform_path(filename));
+			auto path_str = path.encode();
+			lulet(h, Platform::open_file(path_str.c_str(), (Platform::FileOpenFlag)flags, (Platform::FileCreationMode)creation));
+			auto f = newobj<AsyncFile>();
+			f->m_file = h;
+			return f;
+		}
+		lucatchret;
+	}
+
+	RV AsyncFileSystem::register_buffers(void* const* buffers, const usize* sizes, u32 count)
+	{
+		if (m_backend != EAsyncIOBackend::io_uring)
+		{
+			return RV();
+		}
+		MutexGuard guard(m_mtx.get());
+		return Platform::register_async_io_buffers(m_queue, buffers, sizes, count);
+	}
+
+	RV AsyncFileSystem::submit(const AsyncIORequestDesc* descs, u32 count, P<IAsyncIORequest>* out_requests)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			const AsyncIORequestDesc& desc = descs[i];
+			if (!desc.file || (!desc.buffer && desc.size) || (u32)desc.priority >= (u32)EAsyncIOPriority::count ||
+				(desc.op != EAsyncIOOp::read && desc.op != EAsyncIOOp::write))
+			{
+				return BasicError::bad_arguments();
+			}
+		}
+		P<AsyncFileSystem> self(this);
+		MutexGuard guard(m_mtx.get());
+		for (u32 i = 0; i < count; ++i)
+		{
+			const AsyncIORequestDesc& desc = descs[i];
+			P<AsyncIORequest> r = newobj<AsyncIORequest>();
+			r->m_fs = self;
+			r->m_file = (IAsyncFile*)desc.file;
+			r->m_callback = (IRunnable*)desc.callback;
+			r->m_callback_queue = (IDispatchQueue*)desc.callback_queue;
+			r->m_counter = desc.counter;
+			r->m_offset = desc.offset;
+			r->m_buffer = desc.buffer;
+			r->m_size = desc.size;
+			r->m_buffer_index = m_backend == EAsyncIOBackend::io_uring ? desc.buffer_index : u32_max;
+			r->m_op = desc.op;
+			r->m_priority = desc.priority;
+			if (desc.counter)
+			{
+				desc.counter->add();
+			}
+			if (out_requests)
+			{
+				out_requests[i] = r;
+			}
+			m_pending[(u32)desc.priority].push_back(move(r));
+		}
+		if (m_backend == EAsyncIOBackend::io_uring)
+		{
+			issue_pending_requests();
+		}
+		else
+		{
+			guard.unlock();
+			m_pending_sema->unacquire((i32)count);
+		}
+		return RV();
+	}
+
+	LUNA_CORE_API RP<IAsyncFileSystem> new_async_file_system(u32 max_inflight_requests, u32 num_threads, bool force_thread_pool)
+	{
+		if (!max_inflight_requests || !num_threads)
+		{
+			return BasicError::bad_arguments();
+		}
+		P<AsyncFileSystem> fs = newobj<AsyncFileSystem>();
+		lutry
+		{
+			luexp(fs->init(max_inflight_requests, num_threads, force_thread_pool));
+		}
+		lucatchret;
+		return fs;
+	}
+}
@@ -0,0 +1,176 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AsyncFileSystem.hpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#pragma once
+#include "../IAsyncFileSystem.hpp"
+#include "../Core.hpp"
+#include "../Interface.hpp"
+#include <Runtime/RingDeque.hpp>
+#include <Runtime/Vector.hpp>
+#include <Runtime/Sync.hpp>
+#include <Runtime/Platform.hpp>
+
+namespace Luna
+{
+	class AsyncFile final : public IAsyncFile
+	{
+	public:
+		lucid("{2f6b8d13-95e4-4a7c-b0d2-6e1a3c9f7b84}");
+		luiimpl(AsyncFile, IAsyncFile, IObject);
+
+		handle_t m_file;
+
+		AsyncFile() :
+			m_file(nullptr) {}
+		~AsyncFile()
+		{
+			if (m_file)
+			{
+				Platform::close_file(m_file);
+				m_file = nullptr;
+			}
+		}
+		virtual u64 size() override
+		{
+			auto r = Platform::get_file_size(m_file);
+			return succeeded(r) ? r.get() : 0;
+		}
+	};
+
+	class AsyncFileSystem;
+
+	class AsyncIORequest final : public IAsyncIORequest
+	{
+	public:
+		lucid("{c4a91e06-7b3d-4f58-a2e6-8d0b5f1c3a97}");
+		luiimpl(AsyncIORequest, IAsyncIORequest, IWaitable, IObject);
+
+		//! The file system is weak referenced, so releasing the last request on the I/O thread never destroys the file
+		//! system on the thread. The file system completes all requests before it is destroyed.
+		WP<AsyncFileSystem> m_fs;
+		P<IAsyncFile> m_file;
+		P<IRunnable> m_callback;
+		P<IDispatchQueue> m_callback_queue;
+		JobCounter* m_counter;
+		u64 m_offset;
+		void* m_buffer;
+		u32 m_size;
+		u32 m_buffer_index;
+		EAsyncIOOp m_op;
+		EAsyncIOPriority m_priority;
+
+		volatile EAsyncIOStatus m_status;
+		errcode_t m_result;
+		usize m_transferred_bytes;
+		//! Triggered when the request is completed.
+		FutexEvent m_completed;
+
+		AsyncIORequest() :
+			m_counter(nullptr),
+			m_status(EAsyncIOStatus::pending),
+			m_result(0),
+			m_transferred_bytes(0),
+			m_completed(true) {}
+
+		handle_t native_file() const
+		{
+			return static_cast<AsyncFile*>(m_file.get())->m_file;
+		}
+
+		//! Sets the result of the request and notifies the user. Called once for every request.
+		void complete(errcode_t result, usize transferred_bytes);
+
+		virtual void wait() override
+		{
+			m_completed.wait();
+		}
+		virtual RV try_wait() override
+		{
+			return m_completed.try_wait() ? RV() : BasicError::timeout();
+		}
+		virtual EAsyncIOStatus status() override
+		{
+			return m_status;
+		}
+		virtual RV result() override
+		{
+			return m_result;
+		}
+		virtual usize transferred_bytes() override
+		{
+			return m_transferred_bytes;
+		}
+		virtual void cancel() override;
+	};
+
+	//! The thread that waits for completions from the system queue, or performs requests of the thread pool.
+	class AsyncIOWorker : public IRunnable
+	{
+	public:
+		lucid("{91d3f5a8-0e27-4c6b-8f4a-b53e7d2c1906}");
+		luiimpl(AsyncIOWorker, IRunnable, IObject);
+
+		AsyncFileSystem* m_fs;
+
+		virtual void run() override;
+	};
+
+	class AsyncFileSystem final : public IAsyncFileSystem
+	{
+	public:
+		lucid("{e83c2b97-4d16-4a05-9c7e-1f6a8b3d5e20}");
+		luiimpl(AsyncFileSystem, IAsyncFileSystem, IObject);
+
+		EAsyncIOBackend m_backend;
+
+		//! Locks the pending queues and the system queue submission.
+		P<IMutex> m_mtx;
+		//! Requests that are not issued to the system, one queue for every priority.
+		RingDeque<P<AsyncIORequest>> m_pending[(u32)EAsyncIOPriority::count];
+
+		//! The system queue, used by the `io_uring` backend.
+		handle_t m_queue;
+		//! The maximum number of requests issued to the system queue at the same time.
+		u32 m_max_inflight_requests;
+		//! The number of requests issued to the system queue and not completed.
+		u32 m_num_inflight_requests;
+
+		//! Counts the pending requests, used by the thread pool backend.
+		P<ISemaphore> m_pending_sema;
+
+		Vector<P<IThread>> m_threads;
+		volatile bool m_exiting;
+
+		AsyncFileSystem() :
+			m_backend(EAsyncIOBackend::thread_pool),
+			m_queue(nullptr),
+			m_max_inflight_requests(0),
+			m_num_inflight_requests(0),
+			m_exiting(false) {}
+		~AsyncFileSystem();
+
+		RV init(u32 max_inflight_requests, u32 num_threads, bool force_thread_pool);
+
+		//! Pops the pending request with the highest priority. `m_mtx` must be locked.
+		P<AsyncIORequest> pop_pending_request();
+		//! Issues pending requests to the system queue until the in-flight limit is reached. `m_mtx` must be locked.
+		void issue_pending_requests();
+		void cancel(AsyncIORequest* request);
+
+		//! The loop of the completion thread of the `io_uring` backend.
+		void run_completion_thread();
+		//! The loop of the threads of the thread pool backend.
+		void run_pool_thread();
+
+		virtual EAsyncIOBackend backend() override
+		{
+			return m_backend;
+		}
+		virtual RP<IAsyncFile> open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation) override;
+		virtual RV register_buffers(void* const* buffers, const usize* sizes, u32 count) override;
+		virtual RV submit(const AsyncIORequestDesc* descs, u32 count, P<IAsyncIORequest>* out_requests) override;
+	};
+}
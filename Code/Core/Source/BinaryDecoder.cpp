@@ -0,0 +1,333 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file BinaryDecoder.cpp
+* @author JXMaster
+* @date 2021/6/26
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_CORE_API LUNA_EXPORT
+#include "BinaryDecoder.hpp"
+#include "BinaryFormat.hpp"
+#include "../Core.hpp"
+
+namespace Luna
+{
+	static Variant new_variant(EVariantType t, u8 dim, const usize* l)
+	{
+		switch (dim)
+		{
+		case 1: return Variant(t, l[0]);
+		case 2: return Variant(t, l[0], l[1]);
+		case 3: return Variant(t, l[0], l[1], l[2]);
+		case 4: return Variant(t, l[0], l[1], l[2], l[3]);
+		case 5: return Variant(t, l[0], l[1], l[2], l[3], l[4]);
+		case 6: return Variant(t, l[0], l[1], l[2], l[3], l[4], l[5]);
+		case 7: return Variant(t, l[0], l[1], l[2], l[3], l[4], l[5], l[6]);
+		default: return Variant(t, l[0], l[1], l[2], l[3], l[4], l[5], l[6], l[7]);
+		}
+	}
+
+	static void release_blob_owner(void* userdata)
+	{
+		((IObject*)userdata)->release();
+	}
+
+	static RV check_header(const BinaryHeader& header)
+	{
+		if (header.m_magic != binary_variant_magic)
+		{
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - The data is not one binary encoded variant.");
+		}
+		if (header.m_version != binary_variant_version)
+		{
+			return custom_error(BasicError::not_supported(), "IDecoder::decode - Unsupported binary variant version %u.", header.m_version);
+		}
+		if (header.m_tree_size > (u64)usize_max - sizeof(BinaryHeader))
+		{
+			return BasicError::overflow();
+		}
+		return RV();
+	}
+
+	R<Variant> BinaryDecoder::decode(IStream* source_stream)
+	{
+		luassert(source_stream);
+		lutsassert();
+		Variant r;
+		Vector<u8> tree;
+		lutry
+		{
+			lulet(base, source_stream->tell());
+			BinaryHeader header;
+			usize read_bytes;
+			luexp(source_stream->read(&header, sizeof(BinaryHeader), &read_bytes));
+			if (read_bytes != sizeof(BinaryHeader))
+			{
+				return BasicError::end_of_file();
+			}
+			luexp(check_header(header));
+			tree.resize((usize)header.m_tree_size);
+			luexp(source_stream->read(tree.data(), tree.size(), &read_bytes));
+			if (read_bytes != tree.size())
+			{
+				return BasicError::end_of_file();
+			}
+			m_cur = tree.data();
+			m_end = tree.data() + tree.size();
+			m_stream = source_stream;
+			m_blob_section_pos = base + get_binary_blob_section_offset(header.m_tree_size);
+			m_blob_section_size = header.m_blob_section_size;
+			luexp(read_names());
+			luexp(decode_variant(r));
+			// Blobs are read by seeking, moves the cursor to the end of the encoded data.
+			if (header.m_blob_section_size)
+			{
+				luexp(source_stream->seek(m_blob_section_pos + m_blob_section_size, ESeekMode::begin));
+			}
+		}
+		lucatch
+		{
+			m_stream = nullptr;
+			m_names.clear();
+			return lures;
+		}
+		m_stream = nullptr;
+		m_names.clear();
+		return r;
+	}
+
+	RV BinaryDecoder::read_names()
+	{
+		m_names.clear();
+		lutry
+		{
+			usize num_names;
+			luexp(read_size(num_names));
+			m_names.reserve(num_names);
+			for (usize i = 0; i < num_names; ++i)
+			{
+				usize size;
+				luexp(read_size(size));
+				m_names.push_back(Name((const c8*)m_cur, size));
+				m_cur += size;
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	RV BinaryDecoder::decode_blob(u64 offset, usize size, Blob& out)
+	{
+		if (offset > m_blob_section_size || size > m_blob_section_size - offset)
+		{
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - The blob is out of the blob section.");
+		}
+		if (m_stream)
+		{
+			lutry
+			{
+				luexp(m_stream->seek(m_blob_section_pos + offset, ESeekMode::begin));
+				out.resize(size);
+				usize read_bytes;
+				luexp(m_stream->read(out.data(), size, &read_bytes));
+				if (read_bytes != size)
+				{
+					return BasicError::end_of_file();
+				}
+			}
+			lucatchret;
+			return RV();
+		}
+		if (m_owner)
+		{
+			m_owner->add_ref();
+			out = Blob((void*)(m_blob_section + offset), size, release_blob_owner, m_owner);
+		}
+		else
+		{
+			out = Blob(m_blob_section + offset, size);
+		}
+		return RV();
+	}
+
+	RV BinaryDecoder::decode_variant(Variant& out)
+	{
+		lutry
+		{
+			u8 type;
+			luexp(read_u8(type));
+			EVariantType t = (EVariantType)type;
+			if (t == EVariantType::null)
+			{
+				out = Variant();
+				return RV();
+			}
+			if (type > (u8)EVariantType::table || t == EVariantType::object)
+			{
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Unknown variant type %u.", (u32)type);
+			}
+			u8 dim;
+			luexp(read_u8(dim));
+			if (dim < 1 || dim > 8)
+			{
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Invalid dimension %u.", (u32)dim);
+			}
+			usize lengths[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+			// Every element takes at least one bit, which limits the size before the variant is allocated.
+			usize max_elements = (usize)(m_end - m_cur) * 8;
+			usize num_elements = 1;
+			for (u8 i = 0; i < dim; ++i)
+			{
+				u64 l;
+				luexp(read_varint(l));
+				if (l && (l > max_elements || num_elements > max_elements / (usize)l))
+				{
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - The variant size is out of the data range.");
+				}
+				lengths[i] = (usize)l;
+				num_elements *= (usize)l;
+			}
+			out = new_variant(t, dim, lengths);
+			usize sz = out.size();
+			switch (t)
+			{
+			case EVariantType::boolean:
+			case EVariantType::u8:
+			case EVariantType::i8:
+			case EVariantType::u16:
+			case EVariantType::i16:
+			case EVariantType::u32:
+			case EVariantType::i32:
+			case EVariantType::f32:
+			case EVariantType::u64:
+			case EVariantType::i64:
+			case EVariantType::f64:
+			{
+				usize buffer_size = out.buffer_size();
+				if (buffer_size > (usize)(m_end - m_cur))
+				{
+					return BasicError::end_of_file();
+				}
+				memcpy(out.buffer(), m_cur, buffer_size);
+				m_cur += buffer_size;
+				break;
+			}
+			case EVariantType::string:
+				for (usize i = 0; i < sz; ++i)
+				{
+					usize size;
+					luexp(read_size(size));
+					out.to_str_buf()[i].assign((const c8*)m_cur, size);
+					m_cur += size;
+				}
+				break;
+			case EVariantType::name:
+				for (usize i = 0; i < sz; ++i)
+				{
+					u64 index;
+					luexp(read_varint(index));
+					if (index > m_names.size())
+					{
+						return custom_error(BasicError::syntax_error(), "IDecoder::decode - Name index %llu is out of the name table.", index);
+					}
+					out.to_name_buf()[i] = index ? m_names[(usize)index - 1] : Name();
+				}
+				break;
+			case EVariantType::path:
+				for (usize i = 0; i < sz; ++i)
+				{
+					usize size;
+					luexp(read_size(size));
+					out.to_path_buf()[i] = Path((const c8*)m_cur, size);
+					m_cur += size;
+				}
+				break;
+			case EVariantType::blob:
+				for (usize i = 0; i < sz; ++i)
+				{
+					u64 size;
+					luexp(read_varint(size));
+					if (size)
+					{
+						u64 offset;
+						luexp(read_varint(offset));
+						if (size > (u64)usize_max)
+						{
+							return BasicError::overflow();
+						}
+						luexp(decode_blob(offset, (usize)size, out.to_blob_buf()[i]));
+					}
+				}
+				break;
+			case EVariantType::variant:
+				for (usize i = 0; i < sz; ++i)
+				{
+					luexp(decode_variant(out.to_var_buf()[i]));
+				}
+				break;
+			case EVariantType::table:
+				for (usize i = 0; i < sz; ++i)
+				{
+					usize num_fields;
+					luexp(read_size(num_fields));
+					auto& table = out.to_var_table_buf()[i];
+					for (usize j = 0; j < num_fields; ++j)
+					{
+						u64 index;
+						luexp(read_varint(index));
+						if (!index || index > m_names.size())
+						{
+							return custom_error(BasicError::syntax_error(), "IDecoder::decode - Name index %llu is out of the name table.", index);
+						}
+						Variant field;
+						luexp(decode_variant(field));
+						table.insert_or_assign(m_names[(usize)index - 1], move(field));
+					}
+				}
+				break;
+			default:
+				lupanic();
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	LUNA_CORE_API P<IDecoder> new_binary_decoder()
+	{
+		return newobj<BinaryDecoder>();
+	}
+
+	LUNA_CORE_API R<Variant> decode_binary_variant(const void* data, usize size, IObject* owner)
+	{
+		luassert(data || !size);
+		const u8* begin = (const u8*)data;
+		if (size < sizeof(BinaryHeader))
+		{
+			return BasicError::end_of_file();
+		}
+		BinaryHeader header;
+		memcpy(&header, begin, sizeof(BinaryHeader));
+		Variant r;
+		lutry
+		{
+			luexp(check_header(header));
+			u64 blob_section_offset = get_binary_blob_section_offset(header.m_tree_size);
+			if (header.m_tree_size > size - sizeof(BinaryHeader) ||
+				(header.m_blob_section_size && (blob_section_offset > size || header.m_blob_section_size > size - blob_section_offset)))
+			{
+				return BasicError::end_of_file();
+			}
+			P<BinaryDecoder> decoder = newobj<BinaryDecoder>();
+			decoder->m_cur = begin + sizeof(BinaryHeader);
+			decoder->m_end = decoder->m_cur + (usize)header.m_tree_size;
+			decoder->m_blob_section = begin + (usize)blob_section_offset;
+			decoder->m_blob_section_size = header.m_blob_section_size;
+			decoder->m_owner = owner;
+			luexp(decoder->read_names());
+			luexp(decoder->decode_variant(r));
+		}
+		lucatchret;
+		return r;
+	}
+}
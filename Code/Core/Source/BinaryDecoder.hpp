@@ -0,0 +1,97 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file BinaryDecoder.hpp
+* @author JXMaster
+* @date 2021/6/26
+*/
+#pragma once
+#include "../IDecoder.hpp"
+#include "../Interface.hpp"
+#include <Runtime/Vector.hpp>
+
+namespace Luna
+{
+	class BinaryDecoder : public IDecoder
+	{
+	public:
+		lucid("{c2d75e91-4b0f-4a36-8f2e-1d9a3b6c7e54}");
+		luiimpl(BinaryDecoder, IDecoder, IObject);
+		lutsassert_lock();
+
+		//! The tree being decoded.
+		const u8* m_cur;
+		const u8* m_end;
+		Vector<Name> m_names;
+
+		//! Set when decoding from memory, see `decode_binary_variant`.
+		const u8* m_blob_section;
+		u64 m_blob_section_size;
+		IObject* m_owner;
+
+		//! Set when decoding from stream.
+		IStream* m_stream;
+		u64 m_blob_section_pos;
+
+		BinaryDecoder() :
+			m_cur(nullptr),
+			m_end(nullptr),
+			m_blob_section(nullptr),
+			m_blob_section_size(0),
+			m_owner(nullptr),
+			m_stream(nullptr),
+			m_blob_section_pos(0) {}
+
+		RV read_u8(u8& v)
+		{
+			if (m_cur >= m_end)
+			{
+				return BasicError::end_of_file();
+			}
+			v = *m_cur;
+			++m_cur;
+			return RV();
+		}
+
+		RV read_varint(u64& v)
+		{
+			v = 0;
+			for (u32 shift = 0; shift < 64; shift += 7)
+			{
+				if (m_cur >= m_end)
+				{
+					return BasicError::end_of_file();
+				}
+				u8 b = *m_cur;
+				++m_cur;
+				v |= (u64)(b & 0x7F) << shift;
+				if (!(b & 0x80))
+				{
+					return RV();
+				}
+			}
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Invalid variable-length integer.");
+		}
+
+		RV read_size(usize& v)
+		{
+			u64 r;
+			RV res = read_varint(r);
+			if (failed(res))
+			{
+				return res;
+			}
+			if (r > (u64)(m_end - m_cur))
+			{
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - The size %llu is out of the data range.", r);
+			}
+			v = (usize)r;
+			return RV();
+		}
+
+		virtual R<Variant> decode(IStream* source_stream) override;
+
+		RV read_names();
+		RV decode_variant(Variant& out);
+		RV decode_blob(u64 offset, usize size, Blob& out);
+	};
+}
@@ -0,0 +1,211 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file BinaryEncoder.cpp
+* @author JXMaster
+* @date 2021/6/26
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_CORE_API LUNA_EXPORT
+#include "BinaryEncoder.hpp"
+#include "BinaryFormat.hpp"
+#include "../Core.hpp"
+
+namespace Luna
+{
+	RV BinaryEncoder::encode(const Variant& variant, IStream* stream)
+	{
+		luassert(stream);
+		lutsassert();
+
+		if (variant.type() == EVariantType::object)
+		{
+			return BasicError::bad_arguments();
+		}
+
+		m_tree.clear();
+		m_names.clear();
+		m_name_indices.clear();
+		m_blobs.clear();
+		m_blob_section_size = 0;
+
+		RV r = encode_variant(variant);
+		if (succeeded(r))
+		{
+			r = write_stream(stream);
+		}
+		m_tree.clear();
+		m_names.clear();
+		m_name_indices.clear();
+		m_blobs.clear();
+		return r;
+	}
+
+	RV BinaryEncoder::encode_variant(const Variant& v)
+	{
+		EVariantType t = v.type();
+		write_u8((u8)t);
+		if (t == EVariantType::null)
+		{
+			return RV();
+		}
+		u8 dim = v.dimension();
+		write_u8(dim);
+		for (u8 i = 1; i <= dim; ++i)
+		{
+			write_varint(m_tree, v.length(i));
+		}
+		usize sz = v.size();
+		lutry
+		{
+			switch (t)
+			{
+			case EVariantType::boolean:
+			case EVariantType::u8:
+			case EVariantType::i8:
+			case EVariantType::u16:
+			case EVariantType::i16:
+			case EVariantType::u32:
+			case EVariantType::i32:
+			case EVariantType::f32:
+			case EVariantType::u64:
+			case EVariantType::i64:
+			case EVariantType::f64:
+				write_bytes(m_tree, v.buffer(), v.buffer_size());
+				break;
+			case EVariantType::string:
+				for (usize i = 0; i < sz; ++i)
+				{
+					const String& s = v.to_str_buf()[i];
+					write_varint(m_tree, s.size());
+					write_bytes(m_tree, s.c_str(), s.size());
+				}
+				break;
+			case EVariantType::name:
+				for (usize i = 0; i < sz; ++i)
+				{
+					write_varint(m_tree, get_name_index(v.to_name_buf()[i]));
+				}
+				break;
+			case EVariantType::path:
+				for (usize i = 0; i < sz; ++i)
+				{
+					String s = v.to_path_buf()[i].encode();
+					write_varint(m_tree, s.size());
+					write_bytes(m_tree, s.c_str(), s.size());
+				}
+				break;
+			case EVariantType::blob:
+				for (usize i = 0; i < sz; ++i)
+				{
+					const Blob& blob = v.to_blob_buf()[i];
+					write_varint(m_tree, blob.size());
+					if (blob.size())
+					{
+						m_blob_section_size = (m_blob_section_size + binary_blob_alignment - 1) / binary_blob_alignment * binary_blob_alignment;
+						write_varint(m_tree, m_blob_section_size);
+						m_blobs.push_back(&blob);
+						m_blob_section_size += blob.size();
+					}
+				}
+				break;
+			case EVariantType::variant:
+				for (usize i = 0; i < sz; ++i)
+				{
+					const Variant& var = v.to_var_buf()[i];
+					if (var.type() == EVariantType::object)
+					{
+						return BasicError::bad_arguments();
+					}
+					luexp(encode_variant(var));
+				}
+				break;
+			case EVariantType::table:
+				for (usize i = 0; i < sz; ++i)
+				{
+					luexp(encode_table(v.to_var_table_buf()[i]));
+				}
+				break;
+			default:
+				return BasicError::bad_arguments();
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	RV BinaryEncoder::encode_table(const Variant::VariantTable& table)
+	{
+		// Objects cannot be serialized and are skipped, like `TextEncoder` does.
+		usize num_fields = 0;
+		for (auto& i : table)
+		{
+			if (i.second.type() != EVariantType::object)
+			{
+				++num_fields;
+			}
+		}
+		write_varint(m_tree, num_fields);
+		lutry
+		{
+			for (auto& i : table)
+			{
+				if (i.second.type() == EVariantType::object)
+				{
+					continue;
+				}
+				write_varint(m_tree, get_name_index(i.first));
+				luexp(encode_variant(i.second));
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	RV BinaryEncoder::write_stream(IStream* stream)
+	{
+		Vector<u8> name_table;
+		write_varint(name_table, m_names.size());
+		for (auto& name : m_names)
+		{
+			write_varint(name_table, name.size());
+			write_bytes(name_table, name.c_str(), name.size());
+		}
+		BinaryHeader header;
+		header.m_magic = binary_variant_magic;
+		header.m_version = binary_variant_version;
+		header.m_tree_size = name_table.size() + m_tree.size();
+		header.m_blob_section_size = m_blob_section_size;
+		u8 zeros[binary_blob_alignment];
+		memzero(zeros, sizeof(zeros));
+		lutry
+		{
+			luexp(stream->write(&header, sizeof(BinaryHeader)));
+			luexp(stream->write(name_table.data(), name_table.size()));
+			luexp(stream->write(m_tree.data(), m_tree.size()));
+			u64 offset = sizeof(BinaryHeader) + header.m_tree_size;
+			u64 padding = get_binary_blob_section_offset(header.m_tree_size) - offset;
+			if (padding)
+			{
+				luexp(stream->write(zeros, (usize)padding));
+			}
+			offset = 0;
+			for (const Blob* blob : m_blobs)
+			{
+				padding = (offset + binary_blob_alignment - 1) / binary_blob_alignment * binary_blob_alignment - offset;
+				if (padding)
+				{
+					luexp(stream->write(zeros, (usize)padding));
+				}
+				luexp(stream->write(blob->data(), blob->size()));
+				offset += padding + blob->size();
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+
+	LUNA_CORE_API P<IEncoder> new_binary_encoder()
+	{
+		return newobj<BinaryEncoder>();
+	}
+}
@@ -0,0 +1,77 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file BinaryEncoder.hpp
+* @author JXMaster
+* @date 2021/6/26
+*/
+#pragma once
+#include "../IEncoder.hpp"
+#include "../Interface.hpp"
+#include <Runtime/HashMap.hpp>
+#include <Runtime/Vector.hpp>
+
+namespace Luna
+{
+	class BinaryEncoder : public IEncoder
+	{
+	public:
+		lucid("{6b1f0a3c-2a8e-4f5d-9e1b-7c4d2e8a9f30}");
+		luiimpl(BinaryEncoder, IEncoder, IObject);
+		lutsassert_lock();
+
+		//! The encoded tree.
+		Vector<u8> m_tree;
+		//! Names in the name table, in index order starting from 1.
+		Vector<Name> m_names;
+		HashMap<Name, u64> m_name_indices;
+		//! Blobs in the blob section, in offset order.
+		Vector<const Blob*> m_blobs;
+		u64 m_blob_section_size;
+
+		BinaryEncoder() {}
+
+		void write_bytes(Vector<u8>& dst, const void* data, usize size)
+		{
+			const u8* src = (const u8*)data;
+			dst.insert(dst.end(), src, src + size);
+		}
+
+		void write_u8(u8 v)
+		{
+			m_tree.push_back(v);
+		}
+
+		static void write_varint(Vector<u8>& dst, u64 v)
+		{
+			while (v >= 0x80)
+			{
+				dst.push_back((u8)(v | 0x80));
+				v >>= 7;
+			}
+			dst.push_back((u8)v);
+		}
+
+		u64 get_name_index(const Name& name)
+		{
+			if (name.empty())
+			{
+				return 0;
+			}
+			auto iter = m_name_indices.find(name);
+			if (iter != m_name_indices.end())
+			{
+				return iter->second;
+			}
+			m_names.push_back(name);
+			u64 index = (u64)m_names.size();
+			m_name_indices.insert(make_pair(name, index));
+			return index;
+		}
+
+		virtual RV encode(const Variant& variant, IStream* stream) override;
+
+		RV encode_variant(const Variant& v);
+		RV encode_table(const Variant::VariantTable& table);
+		RV write_stream(IStream* stream);
+	};
+}
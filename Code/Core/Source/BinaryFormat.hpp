@@ -0,0 +1,60 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file BinaryFormat.hpp
+* @author JXMaster
+* @date 2021/6/26
+* @brief The layout of variants encoded by `BinaryEncoder`.
+*/
+#pragma once
+#include <Runtime/Base.hpp>
+
+/*
+	All values are stored in little-endian. One encoded variant is laid out as:
+
+	[Header]		BinaryHeader
+	[Name table]	varint name count, then varint size and characters (without null terminator) of every name.
+	[Tree]			The root variant node.
+	[Padding]		Zeros up to the next multiple of `binary_blob_alignment`, counting from the beginning of the header.
+	[Blob section]	Data of all blobs. Every blob begins at a multiple of `binary_blob_alignment` from the beginning of the
+					section.
+
+	One variant node is:
+	u8 type (EVariantType). Nothing follows for `EVariantType::null`.
+	u8 dimension, then varint length of every dimension from 1 to dimension.
+	The data of all elements:
+		boolean and numeric types: `Variant::buffer_size()` bytes copied from the variant buffer.
+		string, path: varint size, then characters. Paths are stored in their encoded form.
+		name: varint index to the name table. Index 0 is the null name, index 1 is the first name in the table.
+		blob: varint size, then varint offset relative to the blob section if the size is not 0.
+		variant: one variant node.
+		table: varint field count, then varint name index and one variant node for every field.
+
+	Since blobs are aligned relative to the beginning of the header, blobs that are decoded from memory that begins at an
+	aligned address (like one memory-mapped file) can reference that memory directly.
+*/
+
+namespace Luna
+{
+	struct BinaryHeader
+	{
+		//! `binary_variant_magic`.
+		u32 m_magic;
+		//! `binary_variant_version`.
+		u32 m_version;
+		//! The size of the name table and the tree in bytes.
+		u64 m_tree_size;
+		//! The size of the blob section in bytes.
+		u64 m_blob_section_size;
+	};
+
+	//! "LUNB" in little-endian.
+	constexpr u32 binary_variant_magic = 0x424E554C;
+	constexpr u32 binary_variant_version = 1;
+	constexpr usize binary_blob_alignment = 16;
+
+	//! Gets the offset of the blob section from the beginning of the header.
+	inline u64 get_binary_blob_section_offset(u64 tree_size)
+	{
+		return (sizeof(BinaryHeader) + tree_size + binary_blob_alignment - 1) / binary_blob_alignment * binary_blob_alignment;
+	}
+}
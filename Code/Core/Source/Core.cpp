@@ -18,15 +18,15 @@ namespace Luna
 	void update_loop_init();
 	void thread_init();
 	void thread_close();
-	void dispatch_init();
-	void dispatch_deinit();
+	void job_init();
+	void job_close();
 	void random_init();
 	void random_deinit();
 	RV core_init()
 	{
 		thread_init();
 		update_loop_init();
-		dispatch_init();
+		job_init();
 		random_init();
 		vfs_init();
 		return RV();
@@ -36,7 +36,7 @@ namespace Luna
 	{
 		vfs_deinit();
 		random_deinit();
-		dispatch_deinit();
+		job_close();
 		thread_close();
 	}
 
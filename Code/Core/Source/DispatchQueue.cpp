@@ -4,42 +4,59 @@
 * @author JXMaster
 * @date 2020/3/8
 */
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_CORE_API LUNA_EXPORT
 #include "DispatchQueue.hpp"
-#include "ThreadPool.hpp"
 
 namespace Luna
 {
+	void DispatchQueue::drain()
+	{
+		while (true)
+		{
+			MutexGuard g(m_mtx);
+			if (m_tasks.empty())
+			{
+				// Detaches from the queue. This must be done with the lock held, so that `dispatch` can see it
+				// and attach a new job.
+				--m_num_attached_jobs;
+				return;
+			}
+			P<IRunnable> task = m_tasks.front();
+			m_tasks.pop_front();
+			g.unlock();
+			run_task(task);
+		}
+	}
+
 	void DispatchQueue::dispatch(IRunnable* task)
 	{
 		lucheck(task);
+		atom_inc_u64(&m_enqueue_count);
+		P<DispatchQueue> queue = (DispatchQueue*)this;
+		if (!m_concurrency_limit)
+		{
+			// Every task is executed by one job.
+			P<IRunnable> t = task;
+			dispatch_job([queue, t]() { queue->run_task(t); });
+			return;
+		}
 		MutexGuard g(m_mtx);
 		m_tasks.push_back(task);
-		atom_inc_u64(&m_enqueue_count);
-		//! Try to awake a new thread to process this task if concurrency limit is not reached.
-		if (!m_concurrency_limit || (m_num_attached_threads < m_concurrency_limit))
+		//! Attaches a new job to process this task if concurrency limit is not reached.
+		if (m_num_attached_jobs < m_concurrency_limit)
 		{
+			++m_num_attached_jobs;
 			g.unlock();
-			auto r_worker_thread = dispatch_consume_worker_thread();
-			if (failed(r_worker_thread))
-			{
-				// If all worker threads are working now, 
-				// we put this queue into the waiting list.
-				MutexGuard queue_mtx(g_dispatch_waiting_queue_mtx);
-				g_dispatch_waiting_queue.get().push_back(WP<DispatchQueue>((DispatchQueue*)this));
-
-				// This is a promise, because every queue in the waiting list will get one thread
-				// sooner or later. One queue can be added to the waiting list multiple times.
-				atom_inc_u32(&m_num_attached_threads);
-			}
-			else
-			{
-				// Attaches the thread and wakes up the thread.
-				atom_inc_u32(&m_num_attached_threads);
-				r_worker_thread.get()->m_working_queue = (DispatchQueue*)this;
-				r_worker_thread.get()->m_wake->trigger();
-			}
+			dispatch_job([queue]() { queue->drain(); });
 		}
 	}
-}
-
 
+	LUNA_CORE_API P<IDispatchQueue> new_dispatch_queue(u32 concurrency_limit)
+	{
+		P<DispatchQueue> q;
+		q = newobj<DispatchQueue>();
+		q->m_concurrency_limit = concurrency_limit;
+		return q;
+	}
+}
@@ -21,15 +21,15 @@ namespace Luna
 		volatile u64 m_execution_count;
 		volatile u64 m_completion_count;
 
-		//! The mutex to operate the task queue.
+		//! The mutex to operate the task queue. Only used by queues with concurrency limit.
 		P<IMutex> m_mtx;
 		RingDeque<P<IRunnable>> m_tasks;
 
-		// Number of threads that are working on this queue, 
+		// Number of jobs that are executing tasks of this queue, 
 		// for a serialized queue, this is 1 for most.
-		u32 m_num_attached_threads;
+		u32 m_num_attached_jobs;
 		//! The concurrency limit for this queue. Compare this
-		//! against `m_num_attached_threads` to check if the 
+		//! against `m_num_attached_jobs` to check if the 
 		//! concurrency limit is reached.
 		u32 m_concurrency_limit;
 
@@ -37,11 +37,21 @@ namespace Luna
 			m_enqueue_count(0),
 			m_execution_count(0),
 			m_completion_count(0),
-			m_num_attached_threads(0) 
+			m_num_attached_jobs(0) 
 		{
 			m_mtx = new_mutex();
 		}
 
+		void run_task(IRunnable* task)
+		{
+			atom_inc_u64(&m_execution_count);
+			task->run();
+			atom_inc_u64(&m_completion_count);
+		}
+
+		//! Executes tasks in the queue until the queue is empty. Called by jobs attached to queues with concurrency limit.
+		void drain();
+
 		virtual u32 concurrency_limit() override
 		{
 			return m_concurrency_limit;
@@ -103,6 +103,10 @@ namespace Luna
 
 		if ((flags & EFileOpenFlag::user_buffering) != EFileOpenFlag::none)
 		{
+			if ((flags & EFileOpenFlag::unbuffered) != EFileOpenFlag::none)
+			{
+				return BasicError::bad_arguments();
+			}
 			auto h = Platform::open_buffered_file(filename, (Platform::FileOpenFlag)flags, (Platform::FileCreationMode)creation);
 			if (failed(h))
 			{
@@ -146,6 +150,39 @@ namespace Luna
 			return f;
 		}
 	}
+	LUNA_CORE_API RP<IMappedFile> platform_map_file(const c8* filename, EFileMapHint hint)
+	{
+		lucheck(filename);
+		auto h = Platform::open_file(filename, Platform::FileOpenFlag::read, Platform::FileCreationMode::open_existing);
+		if (failed(h))
+		{
+			return h.errcode();
+		}
+		P<MappedFile> f;
+		lutry
+		{
+			lulet(size, Platform::get_file_size(h.get()));
+			if (size > (u64)usize_max)
+			{
+				luthrow(BasicError::overflow());
+			}
+			f = newobj<MappedFile>();
+			// Empty files cannot be mapped, and are represented by one mapped file with no data.
+			if (size)
+			{
+				luset(f->m_data, Platform::map_file(h.get(), 0, (usize)size, (Platform::FileMapHint)hint));
+				f->m_size = (usize)size;
+			}
+		}
+		lucatch
+		{
+			Platform::close_file(h.get());
+			return lures;
+		}
+		// The mapping does not need the file handle to be opened.
+		Platform::close_file(h.get());
+		return f;
+	}
 	LUNA_CORE_API R<FileAttribute> platform_file_attribute(const c8* filename)
 	{
 		lucheck(filename);
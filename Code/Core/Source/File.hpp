@@ -7,6 +7,7 @@
 #pragma once
 #include "../IFile.hpp"
 #include "../IFileIterator.hpp"
+#include "../IMappedFile.hpp"
 #include "../Interface.hpp"
 #include <Runtime/TSAssert.hpp>
 #include <Runtime/Platform.hpp>
@@ -83,6 +84,36 @@ namespace Luna
 		virtual void flush() override;
 	};
 
+	class MappedFile final : public IMappedFile
+	{
+	public:
+		lucid("{3f0b9d62-5c1e-4a87-b2e4-9d7a6c105e38}");
+		luiimpl(MappedFile, IMappedFile, IObject);
+
+		void* m_data;
+		usize m_size;
+
+		MappedFile() :
+			m_data(nullptr),
+			m_size(0) {}
+		~MappedFile()
+		{
+			if (m_data)
+			{
+				Platform::unmap_file(m_data, m_size);
+				m_data = nullptr;
+			}
+		}
+		virtual const void* data() override
+		{
+			return m_data;
+		}
+		virtual usize size() override
+		{
+			return m_size;
+		}
+	};
+
 	class FileIterator final : public IFileIterator
 	{
 	public:
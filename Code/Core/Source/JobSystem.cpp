@@ -0,0 +1,953 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file JobSystem.cpp
+* @author JXMaster
+* @date 2021/6/17
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_CORE_API LUNA_EXPORT
+#include "JobSystem.hpp"
+#include <Runtime/Platform.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/RingDeque.hpp>
+#include <Runtime/Sync.hpp>
+#include <Runtime/Profiler.hpp>
+#include <Runtime/Algorithm.hpp>
+
+namespace Luna
+{
+	//! One node in the continuation list of one job.
+	struct JobContinuation
+	{
+		//! The job to schedule when the job is finished, or `nullptr` if `m_counter` is used.
+		Job* m_job;
+		//! The counter to decrease when the job is finished.
+		JobCounter* m_counter;
+		JobContinuation* m_next;
+	};
+
+	struct Job
+	{
+		u32 m_ref_count;
+		//! The number of unfinished works of this job, which is 1 for the job itself plus the number of unfinished
+		//! children jobs. The job is finished when this reaches 0.
+		u32 m_unfinished;
+		//! The number of unfinished dependencies of this job plus 1 for the submit operation. The job is scheduled when
+		//! this reaches 0.
+		u32 m_pending;
+		u32 m_params_offset;
+		job_func_t* m_func;
+		Job* m_parent;
+		//! The counter specified when the job is submitted.
+		JobCounter* m_counter;
+		//! The jobs that depend on this job. Set to `finished_continuations` when this job is finished.
+		JobContinuation* volatile m_continuations;
+		usize m_alignment;
+
+		void* params()
+		{
+			return ((u8*)this) + m_params_offset;
+		}
+	};
+
+	//! The continuation list value of finished jobs.
+	static JobContinuation* const finished_continuations = (JobContinuation*)(usize)1;
+
+	//! The number of rounds one idle worker thread tries to find jobs before going to sleep.
+	constexpr u32 job_spin_rounds = 64;
+
+	//! The stack size of job fibers.
+	constexpr usize job_fiber_stack_size = 512_kb;
+
+	//! The number of job fibers created for every worker thread when the job system is initialized. More fibers are
+	//! created when all fibers are in use.
+	constexpr u32 job_fibers_per_worker = 8;
+
+	Unconstructed<Vector<P<JobWorker>>> g_job_workers;
+	u32 g_num_job_workers;
+	volatile u32 g_job_exiting;
+
+	// Jobs submitted by threads other than worker threads.
+	FutexMutex g_job_global_mtx;
+	Unconstructed<RingDeque<Job*>> g_job_global_queue;
+	volatile usize g_num_global_jobs;
+
+	// The job fiber pool.
+	FutexMutex g_job_fiber_mtx;
+	Unconstructed<Vector<JobFiber*>> g_job_fibers;
+	JobFiber* g_free_job_fibers;
+	// Fibers that are resumed from waiting and are waiting to be switched to.
+	Unconstructed<RingDeque<JobFiber*>> g_ready_job_fibers;
+	volatile usize g_num_ready_job_fibers;
+
+	// Idle worker threads sleep on this semaphore.
+	Unconstructed<FutexSemaphore> g_job_worker_sema;
+	volatile u32 g_num_sleeping_workers;
+
+	// Processors ordered by worker placement, see `set_job_worker_affinity`.
+	Unconstructed<Vector<Platform::ProcessorInfo>> g_job_processors;
+	u32 g_num_job_reserved_cores;
+
+	// Threads that wait for jobs and cannot find any job to execute sleep on this semaphore.
+	Unconstructed<FutexSemaphore> g_job_waiter_sema;
+	volatile u32 g_num_sleeping_waiters;
+
+	// Only read when entering the job system from user code. Job fibers may be resumed by another thread, so functions
+	// that may switch fibers fetch the worker from `JobFiber::m_worker` after switching.
+	thread_local JobWorker* tls_job_worker = nullptr;
+
+	inline void release_job(Job* job)
+	{
+		if (!atom_dec_u32(&job->m_ref_count))
+		{
+			memfree(job, job->m_alignment);
+		}
+	}
+
+	//! Decreases the counter by 1 if it is not 0.
+	//! @return Returns `true` if the counter is decreased.
+	static bool try_dec_counter(volatile u32* counter)
+	{
+		u32 v = *counter;
+		while (v)
+		{
+			u32 prev = atom_compare_exchange_u32(counter, v - 1, v);
+			if (prev == v)
+			{
+				return true;
+			}
+			v = prev;
+		}
+		return false;
+	}
+
+	//! Wakes all threads that sleep in `wait_job` or `wait_for_counter`.
+	static void wake_waiters()
+	{
+		if (g_num_sleeping_waiters)
+		{
+			u32 num_waiters = atom_exchange_u32(&g_num_sleeping_waiters, 0);
+			if (num_waiters)
+			{
+				g_job_waiter_sema.get().release(num_waiters);
+			}
+		}
+	}
+
+	//! Wakes one sleeping worker thread to execute the new job. If all worker threads are busy, wakes waiting threads so
+	//! that they can help executing the new job.
+	static void wake_one_worker()
+	{
+		// Pairs with the increment in `job_fiber_main`: either the worker finds the new job, or we find the worker.
+		atom_fence();
+		if (g_num_sleeping_workers && try_dec_counter(&g_num_sleeping_workers))
+		{
+			g_job_worker_sema.get().release();
+			return;
+		}
+		wake_waiters();
+	}
+
+	//! @param[in] worker The worker of the current thread, or `nullptr` if the current thread is not one worker thread.
+	static void schedule_job(Job* job, JobWorker* worker)
+	{
+		if (worker)
+		{
+			worker->m_jobs.push(job);
+		}
+		else
+		{
+			g_job_global_mtx.lock();
+			g_job_global_queue.get().push_back(job);
+			atom_inc_usize(&g_num_global_jobs);
+			g_job_global_mtx.unlock();
+		}
+		wake_one_worker();
+	}
+
+	static Job* pop_global_job()
+	{
+		if (!g_num_global_jobs)
+		{
+			return nullptr;
+		}
+		Job* job = nullptr;
+		g_job_global_mtx.lock();
+		if (!g_job_global_queue.get().empty())
+		{
+			job = g_job_global_queue.get().front();
+			g_job_global_queue.get().pop_front();
+			atom_dec_usize(&g_num_global_jobs);
+		}
+		g_job_global_mtx.unlock();
+		return job;
+	}
+
+	//! Finds one job to execute.
+	//! @param[in] worker The worker of the current thread, or `nullptr` if the current thread is not one worker thread.
+	static Job* find_job(JobWorker* worker)
+	{
+		Job* job;
+		if (worker && worker->m_jobs.pop(job))
+		{
+			return job;
+		}
+		// Steal from other workers, starting from one random worker to spread contention.
+		u32 num_workers = g_num_job_workers;
+		u32 start;
+		if (worker)
+		{
+			worker->m_seed = worker->m_seed * 1103515245 + 12345;
+			start = (worker->m_seed >> 16) % num_workers;
+		}
+		else
+		{
+			start = get_current_thread_id() % num_workers;
+		}
+		for (u32 i = 0; i < num_workers; ++i)
+		{
+			JobWorker* victim = g_job_workers.get()[(start + i) % num_workers].get();
+			if (victim != worker && victim->m_jobs.steal(job))
+			{
+				return job;
+			}
+		}
+		return pop_global_job();
+	}
+
+	static void job_fiber_main(void* cookie);
+
+	//! Creates one job fiber. The fiber mutex must be held.
+	static JobFiber* new_job_fiber()
+	{
+		JobFiber* fiber = memnew<JobFiber>();
+		auto r = Platform::new_fiber(job_fiber_main, fiber, job_fiber_stack_size);
+		if (failed(r))
+		{
+			lupanic_msg_always("Failed to create job fiber.");
+		}
+		fiber->m_fiber = r.get();
+		fiber->m_worker = nullptr;
+		fiber->m_next = nullptr;
+		fiber->m_wait_value = 0;
+		g_job_fibers.get().push_back(fiber);
+		return fiber;
+	}
+
+	static JobFiber* alloc_job_fiber()
+	{
+		g_job_fiber_mtx.lock();
+		JobFiber* fiber = g_free_job_fibers;
+		if (fiber)
+		{
+			g_free_job_fibers = fiber->m_next;
+		}
+		else
+		{
+			fiber = new_job_fiber();
+		}
+		g_job_fiber_mtx.unlock();
+		return fiber;
+	}
+
+	static void free_job_fiber(JobFiber* fiber)
+	{
+		g_job_fiber_mtx.lock();
+		fiber->m_next = g_free_job_fibers;
+		g_free_job_fibers = fiber;
+		g_job_fiber_mtx.unlock();
+	}
+
+	static void push_ready_fiber(JobFiber* fiber)
+	{
+		g_job_fiber_mtx.lock();
+		g_ready_job_fibers.get().push_back(fiber);
+		atom_inc_usize(&g_num_ready_job_fibers);
+		g_job_fiber_mtx.unlock();
+		wake_one_worker();
+	}
+
+	static JobFiber* pop_ready_fiber()
+	{
+		if (!g_num_ready_job_fibers)
+		{
+			return nullptr;
+		}
+		JobFiber* fiber = nullptr;
+		g_job_fiber_mtx.lock();
+		if (!g_ready_job_fibers.get().empty())
+		{
+			fiber = g_ready_job_fibers.get().front();
+			g_ready_job_fibers.get().pop_front();
+			atom_dec_usize(&g_num_ready_job_fibers);
+		}
+		g_job_fiber_mtx.unlock();
+		return fiber;
+	}
+
+	inline void lock_counter(JobCounter* counter)
+	{
+		while (atom_exchange_u32(&counter->m_lock, 1))
+		{
+			yield_current_thread();
+		}
+	}
+
+	inline void unlock_counter(JobCounter* counter)
+	{
+		atom_fence_release();
+		counter->m_lock = 0;
+	}
+
+	//! Adds the fiber to the waiting list of the counter, or makes the fiber ready if the counter already reaches the
+	//! value.
+	static void add_counter_waiter(JobCounter* counter, JobFiber* fiber)
+	{
+		lock_counter(counter);
+		if (counter->m_value <= fiber->m_wait_value)
+		{
+			unlock_counter(counter);
+			push_ready_fiber(fiber);
+			return;
+		}
+		fiber->m_next = (JobFiber*)counter->m_waiters;
+		counter->m_waiters = fiber;
+		unlock_counter(counter);
+	}
+
+	//! Finishes the fiber switch on the fiber switched to. This must be called by the new fiber immediately after the
+	//! switch.
+	static void complete_fiber_switch(JobWorker* worker)
+	{
+		JobFiber* prev = worker->m_prev_fiber;
+		if (!prev)
+		{
+			return;
+		}
+		worker->m_prev_fiber = nullptr;
+		JobCounter* counter = worker->m_prev_wait_counter;
+		worker->m_prev_wait_counter = nullptr;
+		if (counter)
+		{
+			add_counter_waiter(counter, prev);
+		}
+		else
+		{
+			free_job_fiber(prev);
+		}
+	}
+
+	//! Suspends the current job fiber and switches to another fiber.
+	//! @param[in] wait_counter If not `nullptr`, the current fiber waits for this counter and is resumed when the
+	//! counter reaches `m_wait_value` of the current fiber. Otherwise, the current fiber is returned to the pool.
+	static void switch_job_fiber(JobWorker* worker, JobFiber* to, JobCounter* wait_counter)
+	{
+		JobFiber* from = worker->m_fiber;
+		worker->m_prev_fiber = from;
+		worker->m_prev_wait_counter = wait_counter;
+		worker->m_fiber = to;
+		to->m_worker = worker;
+		Platform::switch_to_fiber(to->m_fiber);
+		// Resumed, possibly by another worker thread.
+		complete_fiber_switch(from->m_worker);
+	}
+
+	static void finish_job(Job* job, JobWorker* worker)
+	{
+		if (atom_dec_u32(&job->m_unfinished))
+		{
+			return;
+		}
+		while (true)
+		{
+			// Schedules jobs that depend on this job.
+			JobContinuation* c = (JobContinuation*)atom_exchange_pointer((void* volatile*)&job->m_continuations, finished_continuations);
+			while (c)
+			{
+				JobContinuation* next = c->m_next;
+				if (c->m_job)
+				{
+					if (!atom_dec_u32(&c->m_job->m_pending))
+					{
+						schedule_job(c->m_job, worker);
+					}
+					release_job(c->m_job);
+				}
+				else
+				{
+					sub_job_counter(c->m_counter, 1);
+				}
+				memdelete(c);
+				c = next;
+			}
+			if (job->m_counter)
+			{
+				sub_job_counter(job->m_counter, 1);
+			}
+			// Pairs with the increment in `wait_until`.
+			atom_fence();
+			wake_waiters();
+			Job* parent = job->m_parent;
+			// Releases the reference added by `submit_job`.
+			release_job(job);
+			if (!parent)
+			{
+				return;
+			}
+			bool parent_finished = !atom_dec_u32(&parent->m_unfinished);
+			// Releases the reference added by `new_job`. If the parent job is finished, it is still kept alive by the
+			// reference added by `submit_job`.
+			release_job(parent);
+			if (!parent_finished)
+			{
+				return;
+			}
+			job = parent;
+		}
+	}
+
+	//! @param[in] fiber The job fiber that executes the job, or `nullptr` if the job is executed by one thread that
+	//! is not one worker thread.
+	static void execute_job(Job* job, JobFiber* fiber)
+	{
+		job->m_func(job->params());
+		// The job may be suspended and resumed by another worker, so the worker is fetched after the job returns.
+		finish_job(job, fiber ? fiber->m_worker : nullptr);
+	}
+
+	//! The entry function of job fibers. Every job fiber runs the scheduling loop of worker threads, and the loop can
+	//! be suspended in any job and continued by another fiber.
+	static void job_fiber_main(void* cookie)
+	{
+		JobFiber* self = (JobFiber*)cookie;
+		complete_fiber_switch(self->m_worker);
+		u32 idle_rounds = 0;
+		while (true)
+		{
+			JobWorker* worker = self->m_worker;
+			// Resumes waiting fibers first, since they usually hold resources needed by other jobs.
+			JobFiber* ready = pop_ready_fiber();
+			if (ready)
+			{
+				// The current fiber is returned to the pool, and continues from here when it is allocated again.
+				switch_job_fiber(worker, ready, nullptr);
+				idle_rounds = 0;
+				continue;
+			}
+			Job* job = find_job(worker);
+			if (job)
+			{
+				execute_job(job, self);
+				idle_rounds = 0;
+				continue;
+			}
+			if (g_job_exiting)
+			{
+				break;
+			}
+			if (idle_rounds < job_spin_rounds)
+			{
+				// Spins for a while before going to sleep, since new jobs are usually submitted very soon.
+				++idle_rounds;
+				yield_current_thread();
+				continue;
+			}
+			atom_inc_u32(&g_num_sleeping_workers);
+			if (g_num_ready_job_fibers || g_job_exiting)
+			{
+				// If the counter is already decreased by `wake_one_worker`, the semaphore will be released and the next
+				// sleep of one worker returns immediately, which is harmless.
+				try_dec_counter(&g_num_sleeping_workers);
+				continue;
+			}
+			job = find_job(worker);
+			if (job)
+			{
+				try_dec_counter(&g_num_sleeping_workers);
+				execute_job(job, self);
+				idle_rounds = 0;
+				continue;
+			}
+			g_job_worker_sema.get().acquire();
+			idle_rounds = 0;
+		}
+		// Returns to the worker thread. The fiber is deleted when the job system is closed.
+		JobWorker* worker = self->m_worker;
+		worker->m_fiber = nullptr;
+		Platform::switch_to_fiber(worker->m_native_fiber);
+		lupanic_msg_always("Job fibers cannot be resumed after the job system is closed.");
+	}
+
+	void JobWorker::run()
+	{
+		tls_job_worker = this;
+		c8 name[32];
+		snprintf(name, sizeof(name), "Job Worker %u", m_index);
+		set_profiler_thread_name(name);
+		auto r = Platform::convert_thread_to_fiber();
+		luassert_always(succeeded(r));
+		m_native_fiber = r.get();
+		JobFiber* fiber = alloc_job_fiber();
+		m_fiber = fiber;
+		fiber->m_worker = this;
+		Platform::switch_to_fiber(fiber->m_fiber);
+		// Switched back by `job_fiber_main` when the job system is closed.
+		luassert_always(succeeded(Platform::convert_fiber_to_thread()));
+		m_native_fiber = nullptr;
+		tls_job_worker = nullptr;
+	}
+
+	//! Waits until `pred` returns `true` by executing other jobs on the current thread. Used by threads that are
+	//! not worker threads.
+	template <typename _Pred>
+	static void wait_until(_Pred pred)
+	{
+		u32 idle_rounds = 0;
+		while (!pred())
+		{
+			Job* other = find_job(nullptr);
+			if (other)
+			{
+				execute_job(other, nullptr);
+				idle_rounds = 0;
+				continue;
+			}
+			if (idle_rounds < job_spin_rounds)
+			{
+				++idle_rounds;
+				yield_current_thread();
+				continue;
+			}
+			atom_inc_u32(&g_num_sleeping_waiters);
+			if (pred())
+			{
+				try_dec_counter(&g_num_sleeping_waiters);
+				break;
+			}
+			// Wakes up when any job is finished or any counter is decreased.
+			g_job_waiter_sema.get().acquire();
+			idle_rounds = 0;
+		}
+		atom_fence_acquire();
+	}
+
+	//! Adds one continuation to the job.
+	//! @return Returns `false` if the job is already finished, in which case the continuation is not added.
+	static bool add_continuation(Job* job, JobContinuation* c)
+	{
+		JobContinuation* head = job->m_continuations;
+		while (head != finished_continuations)
+		{
+			c->m_next = head;
+			JobContinuation* prev = (JobContinuation*)atom_compare_exchange_pointer((void* volatile*)&job->m_continuations, c, head);
+			if (prev == head)
+			{
+				return true;
+			}
+			head = prev;
+		}
+		return false;
+	}
+
+	void job_init()
+	{
+		g_job_exiting = 0;
+		g_job_global_queue.construct();
+		g_num_global_jobs = 0;
+		g_job_worker_sema.construct(0);
+		g_num_sleeping_workers = 0;
+		g_job_waiter_sema.construct(0);
+		g_num_sleeping_waiters = 0;
+		g_job_workers.construct();
+		g_job_processors.construct();
+		g_num_job_reserved_cores = 0;
+		// The main thread also executes jobs when waiting for jobs, so that one less worker is created.
+		u32 num_processors = Platform::get_num_processors();
+		g_num_job_workers = num_processors > 1 ? num_processors - 1 : 1;
+		g_job_fibers.construct();
+		g_ready_job_fibers.construct();
+		g_num_ready_job_fibers = 0;
+		g_free_job_fibers = nullptr;
+		for (u32 i = 0; i < g_num_job_workers * job_fibers_per_worker; ++i)
+		{
+			JobFiber* fiber = new_job_fiber();
+			fiber->m_next = g_free_job_fibers;
+			g_free_job_fibers = fiber;
+		}
+		// All workers must be created before any of them starts stealing.
+		for (u32 i = 0; i < g_num_job_workers; ++i)
+		{
+			P<JobWorker> worker = newobj<JobWorker>();
+			worker->m_index = i;
+			worker->m_seed = i + 1;
+			g_job_workers.get().push_back(worker);
+		}
+		for (auto& i : g_job_workers.get())
+		{
+			i->m_thread = new_thread(i).get();
+		}
+	}
+
+	void job_close()
+	{
+		g_job_exiting = 1;
+		atom_fence();
+		g_job_worker_sema.get().release(g_num_job_workers);
+		for (auto& i : g_job_workers.get())
+		{
+			i->m_thread->wait();
+			i->m_thread = nullptr;
+		}
+		g_job_workers.destruct();
+		g_job_processors.destruct();
+		g_num_job_workers = 0;
+		for (JobFiber* fiber : g_job_fibers.get())
+		{
+			Platform::delete_fiber(fiber->m_fiber);
+			memdelete(fiber);
+		}
+		g_job_fibers.destruct();
+		g_ready_job_fibers.destruct();
+		g_free_job_fibers = nullptr;
+		g_job_global_queue.destruct();
+		g_job_worker_sema.destruct();
+		g_job_waiter_sema.destruct();
+	}
+
+	LUNA_CORE_API JobHandle new_job(job_func_t* func, usize params_size, usize params_alignment, const JobHandle& parent)
+	{
+		lucheck(func);
+		usize alignment = max(params_alignment, alignof(Job));
+		usize params_offset = align_upper(sizeof(Job), alignment);
+		Job* job = (Job*)memalloc(params_offset + params_size, alignment);
+		if (!job)
+		{
+			lupanic_msg_always("Failed to allocate memory for the job.");
+		}
+		job->m_ref_count = 1;
+		job->m_unfinished = 1;
+		job->m_pending = 1;
+		job->m_params_offset = (u32)params_offset;
+		job->m_func = func;
+		job->m_parent = (Job*)parent.get();
+		job->m_counter = nullptr;
+		job->m_continuations = nullptr;
+		job->m_alignment = alignment;
+		if (job->m_parent)
+		{
+			luassert(job->m_parent->m_unfinished);
+			atom_inc_u32(&job->m_parent->m_unfinished);
+			atom_inc_u32(&job->m_parent->m_ref_count);
+		}
+		return JobHandle::attach(job);
+	}
+	LUNA_CORE_API void* get_job_params(handle_t job)
+	{
+		return ((Job*)job)->params();
+	}
+	LUNA_CORE_API void add_job_dependency(handle_t job, handle_t dependency)
+	{
+		Job* j = (Job*)job;
+		Job* dep = (Job*)dependency;
+		lucheck(j && dep && j != dep);
+		atom_inc_u32(&j->m_pending);
+		atom_inc_u32(&j->m_ref_count);
+		JobContinuation* c = memnew<JobContinuation>();
+		c->m_job = j;
+		c->m_counter = nullptr;
+		if (!add_continuation(dep, c))
+		{
+			// The dependency is already finished.
+			memdelete(c);
+			atom_dec_u32(&j->m_pending);
+			atom_dec_u32(&j->m_ref_count);
+		}
+	}
+	LUNA_CORE_API void submit_job(handle_t job, JobCounter* counter)
+	{
+		Job* j = (Job*)job;
+		if (counter)
+		{
+			counter->add(1);
+			j->m_counter = counter;
+		}
+		// This reference is released when the job is finished.
+		atom_inc_u32(&j->m_ref_count);
+		if (!atom_dec_u32(&j->m_pending))
+		{
+			schedule_job(j, tls_job_worker);
+		}
+	}
+	LUNA_CORE_API bool is_job_finished(handle_t job)
+	{
+		return ((Job*)job)->m_unfinished == 0;
+	}
+	LUNA_CORE_API void wait_job(handle_t job)
+	{
+		Job* j = (Job*)job;
+		if (!j->m_unfinished)
+		{
+			atom_fence_acquire();
+			return;
+		}
+		JobWorker* worker = tls_job_worker;
+		if (worker && worker->m_fiber)
+		{
+			// Waits for one counter that is decreased when the job is finished.
+			JobCounter counter(1);
+			JobContinuation* c = memnew<JobContinuation>();
+			c->m_job = nullptr;
+			c->m_counter = &counter;
+			if (add_continuation(j, c))
+			{
+				wait_for_counter(counter, 0);
+			}
+			else
+			{
+				memdelete(c);
+				atom_fence_acquire();
+			}
+			return;
+		}
+		wait_until([j]() { return j->m_unfinished == 0; });
+	}
+	LUNA_CORE_API u32 sub_job_counter(JobCounter* counter, u32 value)
+	{
+		JobFiber* ready = nullptr;
+		// The value is decreased with the lock held, so that waiting threads can lock the counter to make sure that
+		// this call no longer accesses the counter before the counter is destroyed.
+		lock_counter(counter);
+		u32 v = atom_add_u32(&counter->m_value, -(i32)value) - value;
+		JobFiber** prev_next = (JobFiber**)&counter->m_waiters;
+		JobFiber* fiber = *prev_next;
+		while (fiber)
+		{
+			JobFiber* next = fiber->m_next;
+			if (v <= fiber->m_wait_value)
+			{
+				*prev_next = next;
+				fiber->m_next = ready;
+				ready = fiber;
+			}
+			else
+			{
+				prev_next = &fiber->m_next;
+			}
+			fiber = next;
+		}
+		unlock_counter(counter);
+		while (ready)
+		{
+			JobFiber* next = ready->m_next;
+			push_ready_fiber(ready);
+			ready = next;
+		}
+		// Pairs with the increment in `wait_until`.
+		atom_fence();
+		wake_waiters();
+		return v;
+	}
+	LUNA_CORE_API void wait_for_counter(JobCounter& counter, u32 value)
+	{
+		JobCounter* c = &counter;
+		if (c->m_value > value)
+		{
+			JobWorker* worker = tls_job_worker;
+			if (worker && worker->m_fiber)
+			{
+				JobFiber* next = pop_ready_fiber();
+				if (!next)
+				{
+					next = alloc_job_fiber();
+				}
+				worker->m_fiber->m_wait_value = value;
+				// Resumed when the counter reaches the value.
+				switch_job_fiber(worker, next, c);
+			}
+			else
+			{
+				wait_until([c, value]() { return c->m_value <= value; });
+			}
+		}
+		// Waits for the thread that decreases the counter to unlock the counter.
+		lock_counter(c);
+		unlock_counter(c);
+	}
+	LUNA_CORE_API void add_job_ref(handle_t job)
+	{
+		atom_inc_u32(&((Job*)job)->m_ref_count);
+	}
+	LUNA_CORE_API void release_job_ref(handle_t job)
+	{
+		release_job((Job*)job);
+	}
+	LUNA_CORE_API u32 get_job_worker_count()
+	{
+		return g_num_job_workers;
+	}
+	LUNA_CORE_API usize get_job_fiber_stack_size()
+	{
+		return job_fiber_stack_size;
+	}
+
+	//! Sorts processors in the order that workers are placed: the first logical processor of every core comes before
+	//! SMT siblings, then processors are grouped by NUMA node.
+	static void sort_job_processors(Vector<Platform::ProcessorInfo>& processors)
+	{
+		Vector<u32> smt_ranks;
+		for (usize i = 0; i < processors.size(); ++i)
+		{
+			u32 rank = 0;
+			for (usize j = 0; j < i; ++j)
+			{
+				if (processors[j].core == processors[i].core)
+				{
+					++rank;
+				}
+			}
+			smt_ranks.push_back(rank);
+		}
+		Vector<usize> order;
+		for (usize i = 0; i < processors.size(); ++i)
+		{
+			order.push_back(i);
+		}
+		sort(order.begin(), order.end(), [&](usize a, usize b) {
+			const Platform::ProcessorInfo& pa = processors[a];
+			const Platform::ProcessorInfo& pb = processors[b];
+			if (smt_ranks[a] != smt_ranks[b]) return smt_ranks[a] < smt_ranks[b];
+			if (pa.numa_node != pb.numa_node) return pa.numa_node < pb.numa_node;
+			if (pa.core != pb.core) return pa.core < pb.core;
+			return pa.processor < pb.processor;
+		});
+		Vector<Platform::ProcessorInfo> sorted;
+		for (usize i : order)
+		{
+			sorted.push_back(processors[i]);
+		}
+		processors = move(sorted);
+	}
+	//! Checks whether the processor belongs to one of the first `num_reserved_cores` cores in `g_job_processors`.
+	static bool is_job_processor_reserved(const Platform::ProcessorInfo& processor, u32 num_reserved_cores)
+	{
+		auto& processors = g_job_processors.get();
+		for (u32 i = 0; i < num_reserved_cores && i < processors.size(); ++i)
+		{
+			if (processors[i].core == processor.core)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	LUNA_CORE_API RV set_job_worker_affinity(u32 num_reserved_cores)
+	{
+		auto& processors = g_job_processors.get();
+		processors.clear();
+		u32 num_processors = Platform::get_processor_topology(nullptr, 0);
+		processors.resize(num_processors);
+		num_processors = min(Platform::get_processor_topology(processors.data(), num_processors), num_processors);
+		processors.resize(num_processors);
+		sort_job_processors(processors);
+		u32 num_cores = 0;
+		for (auto& p : processors)
+		{
+			if (!is_job_processor_reserved(p, num_cores))
+			{
+				++num_cores;
+			}
+		}
+		if (num_reserved_cores >= num_cores)
+		{
+			g_num_job_reserved_cores = 0;
+			return BasicError::bad_arguments();
+		}
+		// The first logical processor of every core comes first, so the first `num_reserved_cores` entries are on
+		// different cores.
+		g_num_job_reserved_cores = num_reserved_cores;
+		Vector<Platform::ProcessorInfo> slots;
+		for (auto& p : processors)
+		{
+			if (!is_job_processor_reserved(p, num_reserved_cores))
+			{
+				slots.push_back(p);
+			}
+		}
+		Vector<u32> all_slots;
+		u32 shared_node = slots[0].numa_node;
+		for (auto& p : slots)
+		{
+			all_slots.push_back(p.processor);
+			if (p.numa_node != shared_node)
+			{
+				shared_node = u32_max;
+			}
+		}
+		bool one_per_worker = g_num_job_workers <= slots.size();
+		lutry
+		{
+			for (auto& worker : g_job_workers.get())
+			{
+				if (one_per_worker)
+				{
+					const Platform::ProcessorInfo& p = slots[worker->m_index];
+					luexp(worker->m_thread->set_affinity(&p.processor, 1));
+					worker->m_numa_node = p.numa_node;
+				}
+				else
+				{
+					luexp(worker->m_thread->set_affinity(all_slots.data(), (u32)all_slots.size()));
+					worker->m_numa_node = shared_node;
+				}
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+	LUNA_CORE_API RV clear_job_worker_affinity()
+	{
+		g_num_job_reserved_cores = 0;
+		lutry
+		{
+			for (auto& worker : g_job_workers.get())
+			{
+				luexp(worker->m_thread->set_affinity(nullptr, 0));
+				worker->m_numa_node = u32_max;
+			}
+		}
+		lucatchret;
+		return RV();
+	}
+	LUNA_CORE_API u32 get_job_reserved_processors(u32 reserved_core_index, u32* processors, u32 max_processors)
+	{
+		if (reserved_core_index >= g_num_job_reserved_cores)
+		{
+			return 0;
+		}
+		auto& all = g_job_processors.get();
+		u32 core = all[reserved_core_index].core;
+		u32 n = 0;
+		for (auto& p : all)
+		{
+			if (p.core == core)
+			{
+				if (n < max_processors)
+				{
+					processors[n] = p.processor;
+				}
+				++n;
+			}
+		}
+		return n;
+	}
+	LUNA_CORE_API u32 get_current_job_worker_index()
+	{
+		JobWorker* worker = tls_job_worker;
+		return worker ? worker->m_index : u32_max;
+	}
+	LUNA_CORE_API u32 get_job_worker_numa_node(u32 worker_index)
+	{
+		lucheck(worker_index < g_num_job_workers);
+		return g_job_workers.get()[worker_index]->m_numa_node;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file JobSystem.hpp
+* @author JXMaster
+* @date 2021/6/17
+*/
+#pragma once
+#include "../Core.hpp"
+#include <Core/Interface.hpp>
+#include "WorkStealingDeque.hpp"
+
+namespace Luna
+{
+	struct Job;
+	class JobWorker;
+
+	//! One fiber in the job fiber pool. Worker threads execute jobs on job fibers.
+	struct JobFiber
+	{
+		handle_t m_fiber;
+		//! The worker thread that runs this fiber. This is updated every time the fiber is switched to, since suspended
+		//! fibers may be resumed by other worker threads.
+		JobWorker* m_worker;
+		//! The next fiber in the free fiber list or the waiting list of one counter.
+		JobFiber* m_next;
+		//! The counter value this fiber waits for.
+		u32 m_wait_value;
+	};
+
+	//! The context of one job worker thread.
+	class JobWorker : public IRunnable
+	{
+	public:
+		lucid("{3c2b1e5a-7f0d-4c8e-9a61-2d4b8e0f6a17}");
+		luiimpl(JobWorker, IRunnable, IObject);
+
+		//! The local job queue. Jobs submitted by this worker are pushed to this queue, and other workers steal
+		//! jobs from this queue when they are idle.
+		WorkStealingDeque<Job*> m_jobs;
+		//! The index of this worker in all workers.
+		u32 m_index;
+		//! The NUMA node of the processors that this worker is pinned to, or `u32_max` if not pinned to one node.
+		u32 m_numa_node;
+		//! The random seed used to select the steal victim.
+		u32 m_seed;
+		P<IThread> m_thread;
+
+		//! The fiber converted from the worker thread.
+		handle_t m_native_fiber;
+		//! The job fiber running on this worker thread.
+		JobFiber* m_fiber;
+		//! The fiber switched from. This is handled by the fiber switched to, since the fiber cannot be resumed by 
+		//! other threads before the switch is completed.
+		JobFiber* m_prev_fiber;
+		//! If not `nullptr`, `m_prev_fiber` waits for this counter, otherwise `m_prev_fiber` is returned to the pool.
+		JobCounter* m_prev_wait_counter;
+
+		JobWorker() :
+			m_index(0),
+			m_numa_node(u32_max),
+			m_seed(0),
+			m_native_fiber(nullptr),
+			m_fiber(nullptr),
+			m_prev_fiber(nullptr),
+			m_prev_wait_counter(nullptr) {}
+
+		virtual void run() override;
+	};
+}
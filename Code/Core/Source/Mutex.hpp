@@ -8,7 +8,7 @@
 #include <Runtime/PlatformDefines.hpp>
 #include <Core/IMutex.hpp>
 #include <Core/Interface.hpp>
-#include <Runtime/Platform.hpp>
+#include <Runtime/Sync.hpp>
 
 namespace Luna
 {
@@ -18,27 +18,19 @@ namespace Luna
 		lucid("{0df3d468-0d98-4aee-b11d-905ad291def2}");
 		luiimpl(Mutex, IMutex, IWaitable, IObject);
 
-		handle_t m_handle;
+		FutexRecursiveMutex m_mtx;
 
-		Mutex()
-		{
-			m_handle = Platform::new_mutex();
-		}
-		~Mutex()
-		{
-			Platform::delete_mutex(m_handle);
-		}
 		virtual void wait() override
 		{
-			Platform::lock_mutex(m_handle);
+			m_mtx.lock();
 		}
 		virtual RV try_wait() override
 		{
-			return Platform::try_lock_mutex(m_handle);
+			return m_mtx.try_lock() ? RV() : BasicError::timeout();
 		}
 		virtual void unlock() override
 		{
-			Platform::unlock_mutex(m_handle);
+			m_mtx.unlock();
 		}
 	};
 }
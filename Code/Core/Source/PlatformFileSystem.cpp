@@ -15,6 +15,12 @@ namespace Luna
 		return platform_open_file(path.c_str(), flags, creation);
 	}
 
+	RP<IMappedFile> PlatformFileSystem::map_file(const Path& filename, EFileMapHint hint)
+	{
+		auto path = make_native_path_str(filename);
+		return platform_map_file(path.c_str(), hint);
+	}
+
 	R<FileAttribute> PlatformFileSystem::file_attribute(const Path& filename)
 	{
 		auto path = make_native_path_str(filename);
@@ -40,6 +40,7 @@ namespace Luna
 			return path;
 		}
 		virtual RP<IFile> open_file(const Path& filename, EFileOpenFlag flags, EFileCreationMode creation) override;
+		virtual RP<IMappedFile> map_file(const Path& filename, EFileMapHint hint = EFileMapHint::normal) override;
 		virtual R<FileAttribute> file_attribute(const Path& filename) override;
 		virtual RV	copy_file(const Path& from_filename, const Path& to_filename, bool fail_if_exists = false) override;
 		virtual RV	move_file(const Path& from_filename, const Path& to_filename, bool allow_copy = true, bool fail_if_exists = false) override;
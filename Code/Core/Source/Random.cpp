@@ -9,20 +9,68 @@
 #include "Random.hpp"
 #include "../Core.hpp"
 #include <Runtime/Time.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/Atomic.hpp>
+
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#include <emmintrin.h>
+#define LUNA_RANDOM_SSE2 1
+#elif defined(LUNA_PLATFORM_ARM64)
+#include <arm_neon.h>
+#define LUNA_RANDOM_NEON 1
+#endif
+
 namespace Luna
 {
-	std::mt19937 g_random_engine;
-	P<IMutex> g_random_mutex;
+	//! The random state of one thread. Every thread has its own random engines so that generating random numbers
+	//! never needs synchronization.
+	struct ThreadRandomState
+	{
+		Xoshiro256 m_engine;
+		//! The 4-lane xoshiro128+ state used by `fill_random_f32`. `m_lanes[i][j]` is the ith state word of lane j,
+		//! so that one state word of all lanes can be loaded to one SIMD register.
+		alignas(16) u32 m_lanes[4][4];
+		bool m_seeded;
+	};
+
+	thread_local ThreadRandomState tls_random_state;
+
+	//! The seed used to generate seeds for all threads.
+	u64 g_random_seed;
+	//! Incremented for every thread that uses random numbers, so that threads seeded at the same tick still get
+	//! different sequences.
+	volatile u64 g_random_thread_count;
 
 	void random_init()
 	{
-		g_random_engine.seed((unsigned int)get_ticks());
-		g_random_mutex = new_mutex();
+		g_random_seed = get_ticks();
+		g_random_thread_count = 0;
 	}
 
-	void random_deinit()
+	void random_deinit() {}
+
+	inline ThreadRandomState& get_thread_random_state()
 	{
-		g_random_mutex = nullptr;
+		ThreadRandomState& state = tls_random_state;
+		if (!state.m_seeded)
+		{
+			u64 seed = g_random_seed ^ get_ticks() ^ ((u64)get_current_thread_id() << 32);
+			seed += atom_inc_u64(&g_random_thread_count) * 0x9E3779B97F4A7C15ULL;
+			state.m_engine.seed(seed);
+			// The lanes are seeded from the scalar engine output rather than from `seed`, which would repeat the
+			// splitmix sequence the scalar engine state is made of.
+			for (u32 i = 0; i < 4; ++i)
+			{
+				for (u32 j = 0; j < 4; j += 2)
+				{
+					u64 v = state.m_engine.next();
+					state.m_lanes[i][j] = (u32)v;
+					state.m_lanes[i][j + 1] = (u32)(v >> 32);
+				}
+			}
+			state.m_seeded = true;
+		}
+		return state;
 	}
 
 	LUNA_CORE_API P<IRandom> new_random(u32 initial_seed)
@@ -34,53 +82,141 @@ namespace Luna
 
 	LUNA_CORE_API u32 random_u32()
 	{
-		g_random_mutex->wait();
-		u32 r = g_random_engine();
-		g_random_mutex->unlock();
-		return r;
+		return (u32)(get_thread_random_state().m_engine.next() >> 32);
 	}
 	LUNA_CORE_API i32 random_i32()
 	{
-		g_random_mutex->wait();
-		i32 r = (i32)g_random_engine();
-		g_random_mutex->unlock();
-		return r;
+		return (i32)random_u32();
 	}
 	LUNA_CORE_API u64 random_u64()
 	{
-		g_random_mutex->wait();
-		u64 r = ((u64)g_random_engine()) + (((u64)g_random_engine()) << 32);
-		g_random_mutex->unlock();
-		return r;
+		return get_thread_random_state().m_engine.next();
 	}
 	LUNA_CORE_API i64 random_i64()
 	{
-		g_random_mutex->wait();
-		i64 r = ((i64)g_random_engine()) + (((i64)g_random_engine()) << 32);
-		g_random_mutex->unlock();
-		return r;
+		return (i64)random_u64();
 	}
 	LUNA_CORE_API f32 random_f32(f32 range_begin, f32 range_end)
 	{
-		g_random_mutex->wait();
-		f32 r = (((f32)random_u32() / (f32)UINT32_MAX) - range_begin) * (range_end - range_begin);
-		g_random_mutex->unlock();
-		return r;
+		return range_begin + random_bits_to_unorm_f32(random_u32()) * (range_end - range_begin);
 	}
 	LUNA_CORE_API f64 random_f64(f64 range_begin, f64 range_end)
 	{
-		g_random_mutex->wait();
-		f64 r = (((f64)random_u64() / (f64)UINT64_MAX) - range_begin) * (range_end - range_begin);
-		g_random_mutex->unlock();
-		return r;
+		return range_begin + random_bits_to_unorm_f64(random_u64()) * (range_end - range_begin);
 	}
 	LUNA_CORE_API Guid random_guid()
 	{
-		g_random_mutex->wait();
+		Xoshiro256& engine = get_thread_random_state().m_engine;
 		Guid guid;
-		guid.low = random_u64();
-		guid.high = random_u64();
-		g_random_mutex->unlock();
+		guid.low = engine.next();
+		guid.high = engine.next();
 		return guid;
 	}
-}
\ No newline at end of file
+	LUNA_CORE_API void fill_random(void* buffer, usize size)
+	{
+		Xoshiro256& engine = get_thread_random_state().m_engine;
+		u8* dst = (u8*)buffer;
+		while (size >= sizeof(u64))
+		{
+			u64 v = engine.next();
+			memcpy(dst, &v, sizeof(u64));
+			dst += sizeof(u64);
+			size -= sizeof(u64);
+		}
+		if (size)
+		{
+			u64 v = engine.next();
+			memcpy(dst, &v, size);
+		}
+	}
+
+	//! Steps one lane of the xoshiro128+ generator and returns 32 random bits.
+	inline u32 xoshiro128p_next(u32 (&s)[4][4], u32 lane)
+	{
+		u32 result = s[0][lane] + s[3][lane];
+		u32 t = s[1][lane] << 9;
+		s[2][lane] ^= s[0][lane];
+		s[3][lane] ^= s[1][lane];
+		s[1][lane] ^= s[2][lane];
+		s[0][lane] ^= s[3][lane];
+		s[2][lane] ^= t;
+		s[3][lane] = (s[3][lane] << 11) | (s[3][lane] >> 21);
+		return result;
+	}
+
+	//! Converts the high 23 bits to one float in [1, 2) by filling the mantissa of 1.0f directly, which needs no
+	//! integer-to-float conversion.
+	inline f32 random_bits_to_f32_1_2(u32 bits)
+	{
+		u32 v = (bits >> 9) | 0x3F800000;
+		f32 r;
+		memcpy(&r, &v, sizeof(f32));
+		return r;
+	}
+
+	LUNA_CORE_API void fill_random_f32(f32* dst, usize count, f32 range_begin, f32 range_end)
+	{
+		auto& s = get_thread_random_state().m_lanes;
+		f32 range = range_end - range_begin;
+		// The SIMD paths generate 4 numbers in one step, and produce the same sequence as the scalar path.
+		usize i = 0;
+#if defined(LUNA_RANDOM_SSE2)
+		__m128i s0 = _mm_load_si128((const __m128i*)s[0]);
+		__m128i s1 = _mm_load_si128((const __m128i*)s[1]);
+		__m128i s2 = _mm_load_si128((const __m128i*)s[2]);
+		__m128i s3 = _mm_load_si128((const __m128i*)s[3]);
+		const __m128i exp_one = _mm_set1_epi32(0x3F800000);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 begin = _mm_set1_ps(range_begin);
+		const __m128 scale = _mm_set1_ps(range);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i result = _mm_add_epi32(s0, s3);
+			__m128i t = _mm_slli_epi32(s1, 9);
+			s2 = _mm_xor_si128(s2, s0);
+			s3 = _mm_xor_si128(s3, s1);
+			s1 = _mm_xor_si128(s1, s2);
+			s0 = _mm_xor_si128(s0, s3);
+			s2 = _mm_xor_si128(s2, t);
+			s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+			__m128 f = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(result, 9), exp_one)), one);
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(f, scale), begin));
+		}
+		_mm_store_si128((__m128i*)s[0], s0);
+		_mm_store_si128((__m128i*)s[1], s1);
+		_mm_store_si128((__m128i*)s[2], s2);
+		_mm_store_si128((__m128i*)s[3], s3);
+#elif defined(LUNA_RANDOM_NEON)
+		uint32x4_t s0 = vld1q_u32(s[0]);
+		uint32x4_t s1 = vld1q_u32(s[1]);
+		uint32x4_t s2 = vld1q_u32(s[2]);
+		uint32x4_t s3 = vld1q_u32(s[3]);
+		const uint32x4_t exp_one = vdupq_n_u32(0x3F800000);
+		const float32x4_t one = vdupq_n_f32(1.0f);
+		const float32x4_t begin = vdupq_n_f32(range_begin);
+		const float32x4_t scale = vdupq_n_f32(range);
+		for (; i + 4 <= count; i += 4)
+		{
+			uint32x4_t result = vaddq_u32(s0, s3);
+			uint32x4_t t = vshlq_n_u32(s1, 9);
+			s2 = veorq_u32(s2, s0);
+			s3 = veorq_u32(s3, s1);
+			s1 = veorq_u32(s1, s2);
+			s0 = veorq_u32(s0, s3);
+			s2 = veorq_u32(s2, t);
+			s3 = vorrq_u32(vshlq_n_u32(s3, 11), vshrq_n_u32(s3, 21));
+			float32x4_t f = vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(result, 9), exp_one)), one);
+			vst1q_f32(dst + i, vmlaq_f32(begin, f, scale));
+		}
+		vst1q_u32(s[0], s0);
+		vst1q_u32(s[1], s1);
+		vst1q_u32(s[2], s2);
+		vst1q_u32(s[3], s3);
+#endif
+		for (; i < count; ++i)
+		{
+			f32 f = random_bits_to_f32_1_2(xoshiro128p_next(s, (u32)(i & 3))) - 1.0f;
+			dst[i] = range_begin + f * range;
+		}
+	}
+}
@@ -8,9 +8,62 @@
 #include "../IRandom.hpp"
 #include <Runtime/TSAssert.hpp>
 #include <Core/Interface.hpp>
-#include <random>
 namespace Luna
 {
+	//! The SplitMix64 generator. Used to expand one seed to the states of other generators, since xoshiro generators 
+	//! must not be seeded with all-zero states.
+	inline u64 splitmix64(u64& state)
+	{
+		u64 z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	//! The xoshiro256** generator. This is much faster than `std::mt19937` and has only 32 bytes of state, so every thread
+	//! can have its own generator.
+	//! See: David Blackman, Sebastiano Vigna. Scrambled Linear Pseudorandom Number Generators. https://prng.di.unimi.it/
+	struct Xoshiro256
+	{
+		u64 m_s[4];
+
+		static u64 rotl(u64 x, u32 k)
+		{
+			return (x << k) | (x >> (64 - k));
+		}
+
+		void seed(u64 seed)
+		{
+			for (u32 i = 0; i < 4; ++i)
+			{
+				m_s[i] = splitmix64(seed);
+			}
+		}
+		u64 next()
+		{
+			u64 result = rotl(m_s[1] * 5, 7) * 9;
+			u64 t = m_s[1] << 17;
+			m_s[2] ^= m_s[0];
+			m_s[3] ^= m_s[1];
+			m_s[1] ^= m_s[2];
+			m_s[0] ^= m_s[3];
+			m_s[2] ^= t;
+			m_s[3] = rotl(m_s[3], 45);
+			return result;
+		}
+	};
+
+	//! Converts 32 random bits to one float in [0, 1).
+	inline f32 random_bits_to_unorm_f32(u32 bits)
+	{
+		return (f32)(bits >> 8) * (1.0f / 16777216.0f);
+	}
+	//! Converts 64 random bits to one double in [0, 1).
+	inline f64 random_bits_to_unorm_f64(u64 bits)
+	{
+		return (f64)(bits >> 11) * (1.0 / 9007199254740992.0);
+	}
+
 	class Random final : public IRandom
 	{
 	public:
@@ -18,7 +71,7 @@ namespace Luna
 		luiimpl(Random, IRandom, IObject);
 		lutsassert_lock();
 
-		std::mt19937 m_engine;
+		Xoshiro256 m_engine;
 
 		Random() {}
 
@@ -31,30 +84,28 @@ namespace Luna
 		virtual u32 gen_u32() override
 		{
 			lutsassert();
-			return m_engine();
+			return (u32)(m_engine.next() >> 32);
 		}
 		virtual i32 gen_i32() override
 		{
-			lutsassert();
-			return (i32)m_engine();
+			return (i32)gen_u32();
 		}
 		virtual u64 gen_u64() override
 		{
 			lutsassert();
-			return ((u64)m_engine()) + (((u64)m_engine()) << 32);
+			return m_engine.next();
 		}
 		virtual i64 gen_i64() override
 		{
-			lutsassert();
-			return ((i64)m_engine()) + (((i64)m_engine()) << 32);
+			return (i64)gen_u64();
 		}
 		virtual f32 gen_f32(f32 range_begin, f32 range_end) override
 		{
-			return (((f32)gen_u32() / (f32)UINT32_MAX) - range_begin) * (range_end - range_begin);
+			return range_begin + random_bits_to_unorm_f32(gen_u32()) * (range_end - range_begin);
 		}
 		virtual f64 gen_f64(f64 range_begin, f64 range_end) override
 		{
-			return (((f64)gen_u64() / (f64)UINT64_MAX) - range_begin) * (range_end - range_begin);
+			return range_begin + random_bits_to_unorm_f64(gen_u64()) * (range_end - range_begin);
 		}
 		virtual Guid gen_guid() override
 		{
@@ -64,4 +115,4 @@ namespace Luna
 			return guid;
 		}
 	};
-}
\ No newline at end of file
+}
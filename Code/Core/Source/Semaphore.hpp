@@ -8,7 +8,7 @@
 #include <Runtime/PlatformDefines.hpp>
 #include <Core/ISemaphore.hpp>
 #include <Core/Interface.hpp>
-#include <Runtime/Platform.hpp>
+#include <Runtime/Sync.hpp>
 
 namespace Luna
 {
@@ -18,28 +18,22 @@ namespace Luna
 		lucid("{4d155da3-acdb-4ac6-aecb-70e43a5faedf}");
 		luiimpl(Semaphore, ISemaphore, IWaitable, IObject);
 
-		handle_t m_handle;
+		FutexSemaphore m_sema;
 
-		Semaphore(i32 initial_count, i32 max_count)
-		{
-			m_handle = Platform::new_semaphore(initial_count, max_count);
-		}
-		~Semaphore()
-		{
-			Platform::delete_semaphore(m_handle);
-		}
+		Semaphore(i32 initial_count, i32 max_count) :
+			m_sema((u32)initial_count, (u32)max_count) {}
 
 		virtual void wait() override
 		{
-			Platform::acquire_semaphore(m_handle);
+			m_sema.acquire();
 		}
 		virtual RV try_wait() override
 		{
-			return Platform::try_acquire_semaphore(m_handle);
+			return m_sema.try_acquire() ? RV() : BasicError::timeout();
 		}
 		virtual void unacquire(i32 release_count) override
 		{
-			Platform::release_semaphore(m_handle);
+			m_sema.release((u32)release_count);
 		}
 	};
 }
\ No newline at end of file
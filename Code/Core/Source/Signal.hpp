@@ -8,7 +8,7 @@
 #include <Runtime/PlatformDefines.hpp>
 #include <Core/ISignal.hpp>
 #include <Core/Interface.hpp>
-#include <Runtime/Platform.hpp>
+#include <Runtime/Sync.hpp>
 
 namespace Luna
 {
@@ -18,32 +18,25 @@ namespace Luna
 		lucid("{95a2e5b2-d48a-4f19-bfb8-22c273c0ad4b}");
 		luiimpl(Signal, ISignal, IWaitable, IObject);
 
-		handle_t m_handle;
+		FutexEvent m_event;
 
-		Signal(bool manual_reset)
-		{
-			m_handle = Platform::new_signal(manual_reset);
-		}
-		~Signal()
-		{
-			Platform::delete_signal(m_handle);
-			m_handle = nullptr;
-		}
+		Signal(bool manual_reset) :
+			m_event(manual_reset) {}
 		virtual void wait() override
 		{
-			Platform::wait_signal(m_handle);
+			m_event.wait();
 		}
 		virtual RV try_wait() override
 		{
-			return Platform::try_wait_signal(m_handle);
+			return m_event.try_wait() ? RV() : BasicError::timeout();
 		}
 		virtual void trigger() override
 		{
-			Platform::trigger_signal(m_handle);
+			m_event.trigger();
 		}
 		virtual void reset() override
 		{
-			Platform::reset_signal(m_handle);
+			m_event.reset();
 		}
 	};
 }
\ No newline at end of file
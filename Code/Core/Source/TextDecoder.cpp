@@ -10,84 +10,178 @@
 #include <Runtime/Base64.hpp>
 #include "../Core.hpp"
 
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#include <emmintrin.h>
+#define LUNA_TEXT_DECODER_SSE2 1
+#elif defined(LUNA_PLATFORM_ARM64)
+#include <arm_neon.h>
+#define LUNA_TEXT_DECODER_NEON 1
+#endif
+
+#ifdef LUNA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
 namespace Luna
 {
+	inline u32 count_trailing_zeros(u32 v)
+	{
+#ifdef LUNA_COMPILER_MSVC
+		unsigned long r;
+		_BitScanForward(&r, v);
+		return (u32)r;
+#else
+		return (u32)__builtin_ctz(v);
+#endif
+	}
+
+	inline bool is_null_char(c8 ch)
+	{
+		return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+	}
+
+	void TextDecoder::skip_null_chars()
+	{
+		c8* p = m_cur;
+#if defined(LUNA_TEXT_DECODER_SSE2)
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i cr = _mm_set1_epi8('\r');
+		const __m128i lf = _mm_set1_epi8('\n');
+		while (p + 16 <= m_end)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)p);
+			__m128i nl = _mm_cmpeq_epi8(v, lf);
+			__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)), _mm_or_si128(_mm_cmpeq_epi8(v, cr), nl));
+			u32 ws_mask = (u32)_mm_movemask_epi8(ws);
+			u32 nl_mask = (u32)_mm_movemask_epi8(nl);
+			u32 n = ws_mask == 0xFFFF ? 16 : count_trailing_zeros(~ws_mask);
+			nl_mask &= (n == 16) ? 0xFFFF : ((1u << n) - 1);
+			while (nl_mask)
+			{
+				new_line(p + count_trailing_zeros(nl_mask));
+				nl_mask &= nl_mask - 1;
+			}
+			p += n;
+			if (n != 16)
+			{
+				m_cur = p;
+				return;
+			}
+		}
+#elif defined(LUNA_TEXT_DECODER_NEON)
+		const uint8x16_t space = vdupq_n_u8(' ');
+		const uint8x16_t tab = vdupq_n_u8('\t');
+		const uint8x16_t cr = vdupq_n_u8('\r');
+		const uint8x16_t lf = vdupq_n_u8('\n');
+		while (p + 16 <= m_end)
+		{
+			uint8x16_t v = vld1q_u8((const u8*)p);
+			uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, tab)), vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, lf)));
+			if (vminvq_u8(ws) == 0)
+			{
+				// Not all characters are null characters, the rest are checked one by one.
+				break;
+			}
+			if (vmaxvq_u8(vceqq_u8(v, lf)))
+			{
+				for (u32 i = 0; i < 16; ++i)
+				{
+					if (p[i] == '\n') new_line(p + i);
+				}
+			}
+			p += 16;
+		}
+#endif
+		while (p < m_end && is_null_char(*p))
+		{
+			if (*p == '\n')
+			{
+				new_line(p);
+			}
+			++p;
+		}
+		m_cur = p;
+	}
+
 	RV TextDecoder::skip_null()
 	{
 		while (true)
 		{
-			c8 b;
-			RV r;
-			r = read_char(b);
-			if (failed(r))
+			if (m_cur == m_end)
 			{
-				return RV();
+				RV r = refill();
+				if (failed(r))
+				{
+					return r.errcode() == BasicError::end_of_file() ? RV() : r;
+				}
 			}
-			if (b == ' ' || b == '\t' || b == '\r' || b == '\n')
+			skip_null_chars();
+			if (m_cur == m_end)
 			{
 				continue;
 			}
+			if (*m_cur != '/')
+			{
+				return RV();
+			}
+			// may be a comment?
+			c8 b;
+			read_char(b);
+			RV r = read_char(b);
+			if (failed(r))
+			{
+				return r.errcode() == BasicError::end_of_file() ? RV() : r;
+			}
 			if (b == '/')
 			{
-				// may be a comment?
-				r = read_char(b);
-				if (failed(r))
-				{
-					return RV();
-				}
-				if (b == '/')
+				// skip until next line.
+				while (true)
 				{
-					// skip until next line.
-					while (true)
+					c8* p = (c8*)memchr(m_cur, '\n', (usize)(m_end - m_cur));
+					if (p)
 					{
-						r = read_char(b);
-						if (failed(r))
-						{
-							return RV();
-						}
-						if (b == '\n')
-						{
-							break;
-						}
+						new_line(p);
+						m_cur = p + 1;
+						break;
+					}
+					m_cur = m_end;
+					r = refill();
+					if (failed(r))
+					{
+						return r.errcode() == BasicError::end_of_file() ? RV() : r;
 					}
 				}
-				else if(b == '*')
+			}
+			else if(b == '*')
+			{
+				// skip until '*/'
+				while (true)
 				{
-					// skip until '*/'
-					while (true)
+					r = read_char(b);
+					if (failed(r))
+					{
+						return r.errcode() == BasicError::end_of_file() ? RV() : r;
+					}
+					if (b == '*')
 					{
 						r = read_char(b);
 						if (failed(r))
 						{
-							return RV();
+							return r.errcode() == BasicError::end_of_file() ? RV() : r;
 						}
-						if (b == '*')
+						if (b == '/')
 						{
-							r = read_char(b);
-							if (failed(r))
-							{
-								return RV();
-							}
-							if (b == '/')
-							{
-								break;
-							}
+							break;
 						}
+						seek_back_one(b);
 					}
 				}
-				else
-				{
-					lutry
-					{
-						luexp(m_stream->seek(-2, ESeekMode::current));
-					}
-					lucatchret;
-					return RV();
-				}
 			}
 			else
 			{
 				seek_back_one(b);
+				seek_back_one('/');
 				return RV();
 			}
 		}
@@ -105,6 +199,48 @@ namespace Luna
 		return (c >= 0 && c <= 9);
 	}
 
+	//! Returns the number of leading characters in [p, end) that are not '"', '\\' or new line, which can be copied to
+	//! the string directly.
+	static usize scan_string_chars(const c8* p, const c8* end)
+	{
+		const c8* begin = p;
+#if defined(LUNA_TEXT_DECODER_SSE2)
+		const __m128i quote = _mm_set1_epi8('\"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i lf = _mm_set1_epi8('\n');
+		while (p + 16 <= end)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)p);
+			__m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)), _mm_cmpeq_epi8(v, lf));
+			u32 mask = (u32)_mm_movemask_epi8(special);
+			if (mask)
+			{
+				return (usize)(p - begin) + count_trailing_zeros(mask);
+			}
+			p += 16;
+		}
+#elif defined(LUNA_TEXT_DECODER_NEON)
+		const uint8x16_t quote = vdupq_n_u8('\"');
+		const uint8x16_t backslash = vdupq_n_u8('\\');
+		const uint8x16_t lf = vdupq_n_u8('\n');
+		while (p + 16 <= end)
+		{
+			uint8x16_t v = vld1q_u8((const u8*)p);
+			uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vceqq_u8(v, lf));
+			if (vmaxvq_u8(special))
+			{
+				break;
+			}
+			p += 16;
+		}
+#endif
+		while (p < end && *p != '\"' && *p != '\\' && *p != '\n')
+		{
+			++p;
+		}
+		return (usize)(p - begin);
+	}
+
 	RV TextDecoder::decode_string_literal(String& to)
 	{
 		lutry
@@ -112,6 +248,12 @@ namespace Luna
 			c8 b;
 			while (true)
 			{
+				usize n = scan_string_chars(m_cur, m_end);
+				if (n)
+				{
+					to.append(m_cur, n);
+					m_cur += n;
+				}
 				luexp(read_char_and_report_eof(b));
 				if (b == '\"')
 				{
@@ -198,7 +340,7 @@ namespace Luna
 						}
 						else
 						{
-							return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown escape character got: \\%c.", m_line, m_idx, b);
+							return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown escape character got: \\%c.", m_line, column(), b);
 						}
 					}
 				}
@@ -231,6 +373,13 @@ namespace Luna
 				m_temp_buf.push_back(b);
 				while (true)
 				{
+					c8* p = m_cur;
+					while (p < m_end && is_identifier_char(*p))
+					{
+						++p;
+					}
+					m_temp_buf.append(m_cur, (usize)(p - m_cur));
+					m_cur = p;
 					if (failed(read_char(b)))
 					{
 						return RV();
@@ -246,7 +395,7 @@ namespace Luna
 			else
 			{
 				// an identifier expected, but not got.
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Identifier expected, got '%c'", m_line, m_idx, b);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Identifier expected, got '%c'", m_line, column(), b);
 			}
 		}
 		lucatchret;
@@ -258,20 +407,33 @@ namespace Luna
 		lucheck(source_stream);
 		lutsassert();
 
-		m_stream = source_stream;
-		m_line = 1;
-		m_idx = 1;
-		m_tmp_char = -1;
 		auto flags = source_stream->flags();
 		if ((flags & EStreamFlag::readable) == EStreamFlag::none)
 		{
 			return BasicError::not_supported();
 		}
+		m_stream = source_stream;
+		m_line = 1;
+		m_line_begin = 0;
+		if (!m_window.data())
+		{
+			m_window = Blob(text_decoder_window_size + 1);
+		}
+		m_cur = window_begin();
+		m_end = m_cur;
+		*m_end = '\0';
+		m_window_pos = 0;
+		m_eof = false;
 
 		lutry
 		{
 			m_temp_buf = String();
 			lulet(var, decode_variant_object());
+			// Moves the cursor back to the first character after the decoded part.
+			if (m_cur != m_end && (flags & EStreamFlag::seekable) != EStreamFlag::none)
+			{
+				luexp(m_stream->seek(-(i64)(m_end - m_cur), ESeekMode::current));
+			}
 			m_stream.clear();
 			return move(var);
 		}
@@ -318,7 +480,7 @@ namespace Luna
 		else if (!strcmp(ty, "var")) { t = EVariantType::variant; }
 		else
 		{
-			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown type indentifier : \"%s\"", m_line, m_idx, ty);
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown type indentifier : \"%s\"", m_line, column(), ty);
 		}
 		lutry2
 		{
@@ -354,7 +516,7 @@ namespace Luna
 				}
 				if (ch != '[')
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : '[' expected to start a type size field, got '%c'.", m_line, m_idx, ch);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : '[' expected to start a type size field, got '%c'.", m_line, column(), ch);
 				}
 				luexp(skip_null());
 				m_temp_buf.clear();
@@ -367,12 +529,12 @@ namespace Luna
 				u64 dim_num = strtoull(m_temp_buf.data(), nullptr, 0);
 				if (!dim_num)
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid dimension number is specified before.", m_line, m_idx);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid dimension number is specified before.", m_line, column());
 				}
 	#ifdef LUNA_PLATFORM_WINDOWS
 				if (dim_num > usize_max)
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : The dimension number before is too big for this platform: %llu", m_line, m_idx, dim_num);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : The dimension number before is too big for this platform: %llu", m_line, column(), dim_num);
 				}
 	#endif
 				len[dim] = (usize)dim_num;
@@ -456,7 +618,7 @@ namespace Luna
 						}
 						else if (ch != ',')
 						{
-							return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown character detected: '%c'", m_line, m_idx, ch);
+							return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Unknown character detected: '%c'", m_line, column(), ch);
 						}
 						luexp(skip_null());
 						++index;
@@ -464,7 +626,7 @@ namespace Luna
 				}
 				else
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : '{' expected to start the variant object value array, got '%c'", m_line, m_idx, ch);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : '{' expected to start the variant object value array, got '%c'", m_line, column(), ch);
 				}
 			}
 		}
@@ -518,46 +680,260 @@ namespace Luna
 		return RV();
 	}
 
-	RV TextDecoder::decode_integer_value(Variant& var, usize index)
+	RV TextDecoder::begin_token(c8*& token, c8*& token_end)
 	{
-		m_temp_buf.clear();
-		c8 b;
-		RV r = RV();
-		while (succeeded(r = read_char(b)))
+		usize scanned = 0;
+		c8* p;
+		while (true)
 		{
-			if (b == '}' || b == ',')
+			p = m_cur + scanned;
+			while (p < m_end && *p != ',' && *p != '}')
+			{
+				if (*p == '\n')
+				{
+					new_line(p);
+				}
+				++p;
+			}
+			if (p != m_end)
 			{
-				seek_back_one(b);
 				break;
 			}
-			m_temp_buf.push_back(b);
+			// The token may continue in the stream.
+			scanned = (usize)(p - m_cur);
+			RV r = refill();
+			if (failed(r))
+			{
+				if (r.errcode() == BasicError::end_of_file())
+				{
+					// The window may be moved before the end of the stream is detected.
+					p = m_cur + scanned;
+					break;
+				}
+				return r;
+			}
+		}
+		token = m_cur;
+		token_end = p;
+		return RV();
+	}
+
+	//! Parses one decimal integer. Returns `false` if the integer should be parsed by the C library, like octal and
+	//! hexadecimal integers and integers that may overflow.
+	static bool parse_decimal_integer(const c8* s, u64& value, bool& negative)
+	{
+		negative = false;
+		if (*s == '-')
+		{
+			negative = true;
+			++s;
+		}
+		else if (*s == '+')
+		{
+			++s;
+		}
+		const c8* digits = s;
+		u64 v = 0;
+		while (*s >= '0' && *s <= '9')
+		{
+			v = v * 10 + (u64)(*s - '0');
+			++s;
+		}
+		usize num_digits = (usize)(s - digits);
+		if (!num_digits || num_digits > 18 || (num_digits > 1 && *digits == '0'))
+		{
+			return false;
+		}
+		while (is_null_char(*s))
+		{
+			++s;
+		}
+		if (*s)
+		{
+			return false;
+		}
+		value = v;
+		return true;
+	}
+
+	//! Parses one decimal floating-point number to `mantissa * 10 ^ exponent`. Returns `false` if the mantissa has more 
+	//! than 19 significant digits, or if the number is not one plain decimal number, like "inf" or "nan".
+	static bool parse_decimal_float(const c8* s, u64& mantissa, i32& exponent, bool& negative)
+	{
+		negative = false;
+		if (*s == '-')
+		{
+			negative = true;
+			++s;
+		}
+		else if (*s == '+')
+		{
+			++s;
+		}
+		u64 m = 0;
+		u32 num_digits = 0;
+		i32 e = 0;
+		bool has_digits = false;
+		while (*s >= '0' && *s <= '9')
+		{
+			has_digits = true;
+			if (m || *s != '0')
+			{
+				if (num_digits == 19) return false;
+				m = m * 10 + (u64)(*s - '0');
+				++num_digits;
+			}
+			++s;
+		}
+		if (*s == '.')
+		{
+			++s;
+			while (*s >= '0' && *s <= '9')
+			{
+				has_digits = true;
+				if (m || *s != '0')
+				{
+					if (num_digits == 19) return false;
+					m = m * 10 + (u64)(*s - '0');
+					++num_digits;
+				}
+				--e;
+				++s;
+			}
+		}
+		if (!has_digits)
+		{
+			return false;
+		}
+		if (*s == 'e' || *s == 'E')
+		{
+			++s;
+			bool exp_negative = false;
+			if (*s == '-')
+			{
+				exp_negative = true;
+				++s;
+			}
+			else if (*s == '+')
+			{
+				++s;
+			}
+			if (*s < '0' || *s > '9')
+			{
+				return false;
+			}
+			i32 x = 0;
+			while (*s >= '0' && *s <= '9')
+			{
+				if (x < 100000) x = x * 10 + (*s - '0');
+				++s;
+			}
+			e += exp_negative ? -x : x;
+		}
+		while (is_null_char(*s))
+		{
+			++s;
+		}
+		if (*s)
+		{
+			return false;
+		}
+		mantissa = m;
+		exponent = e;
+		return true;
+	}
+
+	// If both the mantissa and the power of 10 are exactly representable, one multiplication or division gives the
+	// correctly rounded result.
+	static const f64 g_pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	//! Parses one floating-point number exactly. Returns `false` if the number should be parsed by the C library.
+	static bool parse_f64(const c8* s, f64& value)
+	{
+		u64 m;
+		i32 e;
+		bool negative;
+		if (!parse_decimal_float(s, m, e, negative) || m > ((u64)1 << 53) || e < -22 || e > 22)
+		{
+			return false;
+		}
+		f64 v = (f64)m;
+		v = e < 0 ? v / g_pow10[-e] : v * g_pow10[e];
+		value = negative ? -v : v;
+		return true;
+	}
+
+	static bool parse_f32(const c8* s, f32& value)
+	{
+		f64 v;
+		if (!parse_f64(s, v))
+		{
+			return false;
 		}
-		if (failed(r) && get_errcode(r) != BasicError::end_of_file())
+		// Rounding the correctly rounded f64 value to f32 gives the correctly rounded f32 value, unless the f64 value is
+		// exactly halfway between two f32 values, or is too small to be one normalized f32 value.
+		u64 bits;
+		memcpy(&bits, &v, sizeof(f64));
+		if ((bits & 0x1FFFFFFF) == 0x10000000 || (v != 0.0 && v < 1.1754943508222875e-38 && v > -1.1754943508222875e-38))
+		{
+			return false;
+		}
+		value = (f32)v;
+		return true;
+	}
+
+	RV TextDecoder::decode_integer_value(Variant& var, usize index)
+	{
+		c8* token;
+		c8* token_end;
+		RV r = begin_token(token, token_end);
+		if (failed(r))
 		{
 			return r;
 		}
-		if (m_temp_buf.empty())
+		if (token == token_end)
 		{
-			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, m_idx);
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, column());
 		}
+		c8 end_char = *token_end;
+		*token_end = '\0';
+		u64 uv;
+		bool negative;
+		bool parsed = parse_decimal_integer(token, uv, negative);
 		EVariantType t = var.type();
 		if (t == EVariantType::u64)
 		{
-			char* endptr;
-			u64 v = strtoull(m_temp_buf.data(), &endptr, 0);
-			if (endptr == m_temp_buf.data())
+			if (!parsed || negative)
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, m_idx);
+				char* endptr;
+				uv = strtoull(token, &endptr, 0);
+				if (endptr == token)
+				{
+					end_token(token_end, end_char);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, column());
+				}
 			}
-			var.to_u64_buf()[index] = v;
+			var.to_u64_buf()[index] = uv;
 		}
 		else
 		{
-			char* endptr;
-			i64 v = strtoll(m_temp_buf.data(), &endptr, 0);
-			if (endptr == m_temp_buf.data())
+			i64 v;
+			if (parsed)
+			{
+				v = negative ? -(i64)uv : (i64)uv;
+			}
+			else
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, m_idx);
+				char* endptr;
+				v = strtoll(token, &endptr, 0);
+				if (endptr == token)
+				{
+					end_token(token_end, end_char);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Integer expected, got none.", m_line, column());
+				}
 			}
 			switch (t)
 			{
@@ -587,49 +963,53 @@ namespace Luna
 				break;
 			}
 		}
+		end_token(token_end, end_char);
 		return RV();
 	}
 
 	RV TextDecoder::decode_float_value(Variant& var, usize index)
 	{
-		m_temp_buf.clear();
-		c8 b;
-		RV r = RV();
-		while (succeeded(r = read_char(b)))
-		{
-			if (b == '}' || b == ',')
-			{
-				seek_back_one(b);
-				break;
-			}
-			m_temp_buf.push_back(b);
-		}
-		if (failed(r) && get_errcode(r) != BasicError::end_of_file())
+		c8* token;
+		c8* token_end;
+		RV r = begin_token(token, token_end);
+		if (failed(r))
 		{
 			return r;
 		}
-		if (m_temp_buf.empty())
+		if (token == token_end)
 		{
-			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, m_idx);
+			return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, column());
 		}
+		c8 end_char = *token_end;
+		*token_end = '\0';
 		EVariantType t = var.type();
 		if (t == EVariantType::f32)
 		{
-			char* endptr;
-			f32 v = strtof(m_temp_buf.data(), &endptr);
-			if (endptr == m_temp_buf.data())
+			f32 v;
+			if (!parse_f32(token, v))
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, m_idx);
+				char* endptr;
+				v = strtof(token, &endptr);
+				if (endptr == token)
+				{
+					end_token(token_end, end_char);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, column());
+				}
 			}
 			var.to_f32_buf()[index] = v;
 		}
 		else if (t == EVariantType::f64)
 		{
-			char* endptr;
-			f64 v = strtod(m_temp_buf.data(), &endptr);
-			if (endptr == m_temp_buf.data())
+			f64 v;
+			if (!parse_f64(token, v))
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, m_idx);
+				char* endptr;
+				v = strtod(token, &endptr);
+				if (endptr == token)
+				{
+					end_token(token_end, end_char);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Float expected, got none.", m_line, column());
+				}
 			}
 			var.to_f64_buf()[index] = v;
 		}
@@ -637,6 +1017,7 @@ namespace Luna
 		{
 			lupanic();
 		}
+		end_token(token_end, end_char);
 		return RV();
 	}
 
@@ -663,7 +1044,7 @@ namespace Luna
 				}
 				else
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got \"%s\".", m_line, m_idx, v);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got \"%s\".", m_line, column(), v);
 				}
 			}
 			else if (b == 'f')
@@ -683,12 +1064,12 @@ namespace Luna
 				}
 				else
 				{
-					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got \"%s\".", m_line, m_idx, v);
+					return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got \"%s\".", m_line, column(), v);
 				}
 			}
 			else
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got '%c'.", m_line, m_idx, b);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid character, boolean expected, got '%c'.", m_line, column(), b);
 			}
 		}
 		lucatchret;
@@ -703,7 +1084,7 @@ namespace Luna
 			luexp(read_char_and_report_eof(b));
 			if (b != '\"')
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : String beginning '\"' expected, got '%c'.", m_line, m_idx, b);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : String beginning '\"' expected, got '%c'.", m_line, column(), b);
 			}
 			auto str = String();
 			luexp(decode_string_literal(str));
@@ -736,7 +1117,7 @@ namespace Luna
 			luexp(read_char_and_report_eof(b));
 			if (b != '\"')
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Blob string expected.", m_line, m_idx);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Blob string expected.", m_line, column());
 			}
 			// check header.
 			c8 header[9];
@@ -751,7 +1132,7 @@ namespace Luna
 			header[8] = '\0';
 			if (strcmp(header, "base64??"))
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Blob string does not start with \"base64??\".", m_line, m_idx);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Blob string does not start with \"base64??\".", m_line, column());
 			}
 			auto str = String();
 			luexp(read_char_and_report_eof(b));
@@ -791,7 +1172,7 @@ namespace Luna
 					}
 					else
 					{
-						return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid base64 character detected.", m_line, m_idx);
+						return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : Invalid base64 character detected.", m_line, column());
 					}
 				}
 			}
@@ -818,7 +1199,7 @@ namespace Luna
 			luexp(read_char_and_report_eof(b));
 			if (b != '{')
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : `{` expected to start a table scope, got '%c'.", m_line, m_idx, b);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : `{` expected to start a table scope, got '%c'.", m_line, column(), b);
 			}
 			luexp(skip_null());
 			luexp(read_char_and_report_eof(b));
@@ -845,7 +1226,7 @@ namespace Luna
 					}
 					if (b != ',')
 					{
-						return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : ',' expected at the end of every table entry.", m_line, m_idx);
+						return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : ',' expected at the end of every table entry.", m_line, column());
 					}
 					luexp(skip_null());
 				}
@@ -866,7 +1247,7 @@ namespace Luna
 			luexp(read_char_and_report_eof(b));
 			if (b != ':')
 			{
-				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : ':' expected at the end of table entry name.", m_line, m_idx);
+				return custom_error(BasicError::syntax_error(), "IDecoder::decode - Line %u Character %u : ':' expected at the end of table entry name.", m_line, column());
 			}
 			luexp(skip_null());
 			lulet(var2, decode_variant_object());
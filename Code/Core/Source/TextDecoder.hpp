@@ -7,9 +7,15 @@
 #pragma once
 #include "../IDecoder.hpp"
 #include "../Interface.hpp"
+#include <Runtime/Blob.hpp>
 
 namespace Luna
 {
+	//! The number of characters read from the stream at one time.
+	constexpr usize text_decoder_window_size = 64 * 1024;
+	//! The number of read characters kept in the window when the window is refilled, so that the decoder can go back.
+	constexpr usize text_decoder_history_size = 2;
+
 	class TextDecoder : public IDecoder
 	{
 	public:
@@ -20,67 +26,117 @@ namespace Luna
 		P<IStream> m_stream;
 		String m_temp_buf;
 
+		//! The read window. Characters are read from the stream in big chunks, and are parsed in the window directly.
+		//! The window holds `text_decoder_window_size` characters and one null terminator after the last character.
+		Blob m_window;
+		//! The next character to read.
+		c8* m_cur;
+		//! One past the last character in the window.
+		c8* m_end;
+		//! The offset of the first character in the window, counting from the position where the decoding begins.
+		u64 m_window_pos;
+		bool m_eof;
+
 		// For debug purpose.
 		u32 m_line;
-		u32 m_idx;
-		i16 m_tmp_char;	// buffer at most one char to present seek back operation.
+		//! The offset of the first character of the current line, counting from the position where the decoding begins.
+		u64 m_line_begin;
 
 		TextDecoder() {}
 
-		//! using this to read one char from stream.
-		RV read_char(c8& ch)
+		c8* window_begin()
+		{
+			return (c8*)m_window.data();
+		}
+
+		//! Gets the column of the next character, starting from 1.
+		u32 column()
+		{
+			return (u32)(m_window_pos + (u64)(m_cur - window_begin()) - m_line_begin + 1);
+		}
+
+		//! Records one new line character at `p` in the window.
+		void new_line(const c8* p)
 		{
-			if (m_tmp_char >= 0)
+			++m_line;
+			m_line_begin = m_window_pos + (u64)(p - window_begin()) + 1;
+		}
+
+		//! Moves characters that are not read and at most `text_decoder_history_size` characters that are read to the 
+		//! beginning of the window, then fills the window with characters from the stream.
+		//! Returns `BasicError::end_of_file` if no character is read from the stream.
+		RV refill()
+		{
+			if (m_eof)
 			{
-				ch = (c8)m_tmp_char;
-				m_tmp_char = -1;
-				return RV();
+				return BasicError::end_of_file();
 			}
+			c8* begin = window_begin();
+			usize history = min<usize>((usize)(m_cur - begin), text_decoder_history_size);
+			c8* src = m_cur - history;
+			usize keep = (usize)(m_end - src);
+			if (keep == text_decoder_window_size)
+			{
+				return custom_error(BasicError::data_too_long(), "IDecoder::decode - Line %u Character %u : The token is too long.", m_line, column());
+			}
+			memmove(begin, src, keep);
+			m_window_pos += (u64)(src - begin);
+			m_cur = begin + history;
+			m_end = begin + keep;
 			usize bytes;
-			RV r = m_stream->read(&ch, sizeof(c8), &bytes);
+			RV r = m_stream->read(m_end, text_decoder_window_size - keep, &bytes);
 			if (failed(r))
 			{
 				return r;
 			}
-			if (bytes != sizeof(c8))
+			m_end += bytes;
+			*m_end = '\0';
+			if (!bytes)
 			{
+				m_eof = true;
 				return BasicError::end_of_file();
 			}
-			if (ch == '\n')
+			return RV();
+		}
+
+		//! using this to read one char from stream.
+		RV read_char(c8& ch)
+		{
+			if (m_cur == m_end)
 			{
-				++m_line;
-				m_idx = 1;
+				RV r = refill();
+				if (failed(r))
+				{
+					return r;
+				}
 			}
-			else
+			ch = *m_cur;
+			if (ch == '\n')
 			{
-				++m_idx;
+				new_line(m_cur);
 			}
+			++m_cur;
 			return RV();
 		}
 
 		RV read_chars(String& buf, usize num_chars_to_read)
 		{
 			// Must be in one line.
-			if (m_tmp_char >= 0)
+			while (num_chars_to_read)
 			{
-				c8 ch = (c8)m_tmp_char;
-				m_tmp_char = -1;
-				buf.push_back(ch);
-				--num_chars_to_read;
-			}
-			usize bytes;
-			usize begin_pos = buf.size();
-			buf.resize(buf.size() + num_chars_to_read, '\0');
-			RV r = m_stream->read(buf.data() + begin_pos, sizeof(c8) * num_chars_to_read, &bytes);
-			if (failed(r))
-			{
-				return r;
+				if (m_cur == m_end)
+				{
+					RV r = refill();
+					if (failed(r))
+					{
+						return r;
+					}
+				}
+				usize n = min((usize)(m_end - m_cur), num_chars_to_read);
+				buf.append(m_cur, n);
+				m_cur += n;
+				num_chars_to_read -= n;
 			}
-			if (bytes != sizeof(c8) * num_chars_to_read)
-			{
-				return BasicError::end_of_file();
-			}
-			m_idx += (u32)num_chars_to_read;
 			return RV();
 		}
 
@@ -89,19 +145,36 @@ namespace Luna
 			RV r = read_char(ch);
 			if (r.errcode() == BasicError::end_of_file())
 			{
-				get_error_object() = Error(BasicError::end_of_file(), "IDecoder::decode - Line %u Character %u : Unexpected EOF got.", m_line, m_idx);
+				get_error_object() = Error(BasicError::end_of_file(), "IDecoder::decode - Line %u Character %u : Unexpected EOF got.", m_line, column());
 				return BasicError::error_object();
 			}
 			return r;
 		}
 		void seek_back_one(c8 ch)
 		{
-			m_tmp_char = ch;
+			// The window always keeps the last read character.
+			--m_cur;
+			if (ch == '\n')
+			{
+				--m_line;
+				// The column is only used for error messages, so the beginning of the last line is not restored.
+			}
+		}
+
+		//! Reads characters until the next ',' or '}', which is not consumed. The characters are null-terminated in place
+		//! until `end_token` is called.
+		RV begin_token(c8*& token, c8*& token_end);
+		void end_token(c8* token_end, c8 end_char)
+		{
+			*token_end = end_char;
+			m_cur = token_end;
 		}
 
 		//! Skips any null characters, including space character, tab character, return character
 		//! and comments. The cursor points to the next non-null character after this operation.
 		RV skip_null();
+		//! Skips null characters in the window, not including comments.
+		void skip_null_chars();
 
 		//bool is_first_identifier_char(char ch)
 		//{
@@ -50,6 +50,10 @@ namespace Luna
 		{
 			return Platform::set_thread_priority(m_handle, (Platform::ThreadPriority)priority);
 		}
+		virtual RV set_affinity(const u32* processors, u32 num_processors) override
+		{
+			return Platform::set_thread_affinity(m_handle, processors, num_processors);
+		}
 		virtual void wait() override
 		{
 			Platform::wait_thread(m_handle);
@@ -103,6 +107,15 @@ namespace Luna
 		{
 			return Platform::set_thread_priority(m_handle, (Platform::ThreadPriority)priority);
 		}
+		virtual RV set_affinity(const u32* processors, u32 num_processors) override
+		{
+			// The main thread is not created by `Platform::new_thread`, so it can only set the affinity of itself.
+			if (get_current_thread() != this)
+			{
+				return BasicError::bad_calling_time();
+			}
+			return Platform::set_current_thread_affinity(processors, num_processors);
+		}
 		virtual void wait() override
 		{
 			lupanic_msg_always("The main thread cannot be waited, since it never returns.");
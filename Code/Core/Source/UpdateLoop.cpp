@@ -9,6 +9,9 @@
 #include "../Core.hpp"
 #include <Runtime/Platform.hpp>
 #include <Runtime/Thread.hpp>
+#include <Runtime/Memory.hpp>
+#include <Runtime/Profiler.hpp>
+#include <Runtime/Sync.hpp>
 namespace Luna
 {
 	u64 m_frame_ticks[256];	// the frame end ticks of last 256 frames.
@@ -23,12 +26,25 @@ namespace Luna
 	bool m_frame_governing_enabled;
 	bool m_min_frame_fps_clamping_enabled;
 
+	// Frame pacing.
+	u64 m_frame_deadline_ticks;	// The absolute time point that the current frame should end at.
+	bool m_frame_deadline_valid;	// `false` if the deadline timeline needs to be restarted.
+	u64 m_sleep_overshoot_ticks;	// The decaying maximum time that `sleep` oversleeps.
+	u64 m_frame_pacing_errors[256];	// The time between the deadline and the actual frame start of last 256 governed frames.
+	bool m_frame_pacing_missed[256];	// Whether the frame is finished after its deadline.
+	bool m_frame_pacing_slept[256];	// Whether the frame sleeps before its deadline.
+	u32 m_frame_pacing_index;
+	u32 m_num_frame_pacing_records;
+
+	//! The minimal time to spin before the deadline instead of sleeping.
+	constexpr f64 frame_pacing_min_spin_seconds = 0.0003;
+
 	void update_loop_init()
 	{
 		memzero(m_frame_ticks, sizeof(u64) * 256);
 		memzero(m_frame_ticks_raw, sizeof(u64) * 256);
 		m_frame_governing_ticks = (u64)(1.0f / 60.0f * Platform::get_ticks_per_second());
-		m_frame_governing_ticks = (u64)(1.0f / 10.0f * Platform::get_ticks_per_second());
+		m_frame_clamping_ticks = (u64)(1.0f / 10.0f * Platform::get_ticks_per_second());
 		m_frame_begin_ticks = get_ticks();
 		m_frame_ticks_sum120 = 0;
 		m_frame_ticks_raw_sum120 = 0;
@@ -36,6 +52,57 @@ namespace Luna
 		m_frame_index = 0;
 		m_frame_governing_enabled = false;
 		m_min_frame_fps_clamping_enabled = false;
+		m_frame_deadline_ticks = 0;
+		m_frame_deadline_valid = false;
+		// Assumes 2ms before the first measurement, which covers most systems.
+		m_sleep_overshoot_ticks = (u64)(0.002 * get_ticks_per_second());
+		memzero(m_frame_pacing_errors, sizeof(u64) * 256);
+		memzero(m_frame_pacing_missed, sizeof(bool) * 256);
+		memzero(m_frame_pacing_slept, sizeof(bool) * 256);
+		m_frame_pacing_index = 0;
+		m_num_frame_pacing_records = 0;
+	}
+
+	//! Waits until `deadline`. The thread sleeps until the deadline is close, then spins for the remaining time, since
+	//! `sleep` may wake the thread later than required by the scheduler granularity.
+	//! @return Returns `true` if the thread sleeps before the deadline.
+	static bool wait_until_ticks(u64 deadline)
+	{
+		f64 ticks_per_second = get_ticks_per_second();
+		u64 min_spin_ticks = (u64)(frame_pacing_min_spin_seconds * ticks_per_second);
+		u64 ticks_per_ms = (u64)(ticks_per_second / 1000.0);
+		// The oversleep time is limited to a quarter of the frame period, and decays once per frame even if the frame
+		// does not sleep, so that one late wake (like the thread being preempted) does not make all following frames
+		// spin for the whole period.
+		u64 max_overshoot_ticks = m_frame_governing_ticks / 4;
+		m_sleep_overshoot_ticks = min(m_sleep_overshoot_ticks - m_sleep_overshoot_ticks / 16, max_overshoot_ticks);
+		bool slept = false;
+		while (true)
+		{
+			u64 now = get_ticks();
+			if (now >= deadline)
+			{
+				return slept;
+			}
+			u64 remaining = deadline - now;
+			u64 spin_ticks = min_spin_ticks + m_sleep_overshoot_ticks;
+			if (remaining > spin_ticks + ticks_per_ms)
+			{
+				u32 sleep_ms = (u32)((remaining - spin_ticks) / ticks_per_ms);
+				sleep(sleep_ms);
+				slept = true;
+				// Tracks the oversleep time, which decays slowly so that one lucky wake does not cause the next
+				// wake to be late.
+				u64 slept_ticks = get_ticks() - now;
+				u64 expected = sleep_ms * ticks_per_ms;
+				u64 overshoot = slept_ticks > expected ? slept_ticks - expected : 0;
+				m_sleep_overshoot_ticks = min(max(overshoot, m_sleep_overshoot_ticks), max_overshoot_ticks);
+			}
+			else
+			{
+				spin_pause();
+			}
+		}
 	}
 	LUNA_CORE_API void new_frame()
 	{
@@ -58,23 +125,49 @@ namespace Luna
 		}
 
 		// wait if needed.
-		if (m_frame_governing_enabled && (time_delta < m_frame_governing_ticks))
+		if (m_frame_governing_enabled)
 		{
-			time_now = get_ticks();
-			i64 waittimeus = i64((m_frame_begin_ticks + m_frame_governing_ticks - time_now) * 1000000 / get_ticks_per_second());
-			if (waittimeus > 0)
+			// Frames are scheduled on one absolute timeline: every deadline is the previous deadline plus the frame
+			// period, so the time that one frame wakes late is not carried to the next frame.
+			if (!m_frame_deadline_valid)
+			{
+				m_frame_deadline_ticks = m_frame_begin_ticks + m_frame_governing_ticks;
+				m_frame_deadline_valid = true;
+			}
+			u64 deadline = m_frame_deadline_ticks;
+			bool missed = time_now > deadline;
+			bool slept = false;
+			if (!missed)
+			{
+				LUNA_PROFILE_SCOPE("Frame Governing");
+				slept = wait_until_ticks(deadline);
+				time_now = get_ticks();
+				time_delta = time_now - m_frame_begin_ticks;
+			}
+			m_frame_pacing_index = (m_frame_pacing_index + 1) % 256;
+			m_frame_pacing_errors[m_frame_pacing_index] = time_now - deadline;
+			m_frame_pacing_missed[m_frame_pacing_index] = missed;
+			m_frame_pacing_slept[m_frame_pacing_index] = slept;
+			m_num_frame_pacing_records = min(m_num_frame_pacing_records + 1, 256u);
+			// If the frame is late for more than one period, restarts the timeline from now instead of running 
+			// the following frames without waiting to catch up.
+			if (time_now - deadline > m_frame_governing_ticks)
 			{
-				fast_sleep((u32)waittimeus);
+				deadline = time_now;
 			}
-			time_now = get_ticks();
-			time_delta = time_now - m_frame_begin_ticks;
+			m_frame_deadline_ticks = deadline + m_frame_governing_ticks;
 		}
 
 		// update modified data.
 		m_frame_ticks[m_last_frame_index] = time_delta;
 		m_frame_ticks_sum120 += time_delta;
-		m_frame_ticks_sum120 -= m_frame_ticks_raw[(m_last_frame_index + 256 - 120) % 256];
+		m_frame_ticks_sum120 -= m_frame_ticks[(m_last_frame_index + 256 - 120) % 256];
 		m_frame_begin_ticks = time_now;
+
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		memory_profiler_new_frame();
+#endif
+		profiler_new_frame(m_frame_index);
 	}
 	LUNA_CORE_API u32 get_frame_index()
 	{
@@ -128,6 +221,10 @@ namespace Luna
 	}
 	LUNA_CORE_API void set_frame_governing_enabled(bool enabled)
 	{
+		if (enabled && !m_frame_governing_enabled)
+		{
+			m_frame_deadline_valid = false;
+		}
 		m_frame_governing_enabled = enabled;
 	}
 	LUNA_CORE_API bool is_frame_governing_enabled()
@@ -142,6 +239,7 @@ namespace Luna
 		}
 		f64 frame_period = 1.0 / (f64)frames_per_second;
 		m_frame_governing_ticks = (u64)(frame_period * get_ticks_per_second());
+		m_frame_deadline_valid = false;
 		return RV();
 	}
 	LUNA_CORE_API f32 get_frame_governing_fps()
@@ -170,4 +268,46 @@ namespace Luna
 	{
 		return 1.0f / (f32)((f64)m_frame_clamping_ticks / (f64)get_ticks_per_second());
 	}
+	LUNA_CORE_API void set_frame_pacing_sleep_overshoot(f64 seconds)
+	{
+		m_sleep_overshoot_ticks = seconds > 0.0 ? (u64)(seconds * get_ticks_per_second()) : 0;
+	}
+	LUNA_CORE_API FramePacingStats get_frame_pacing_stats()
+	{
+		FramePacingStats stats;
+		stats.num_frames = min(m_num_frame_pacing_records, 120u);
+		stats.num_missed_frames = 0;
+		stats.num_slept_frames = 0;
+		stats.sleep_overshoot_seconds = (f64)m_sleep_overshoot_ticks / get_ticks_per_second();
+		stats.mean_error_seconds = 0.0;
+		stats.max_error_seconds = 0.0;
+		stats.stddev_error_seconds = 0.0;
+		if (!stats.num_frames)
+		{
+			return stats;
+		}
+		f64 seconds_per_tick = 1.0 / get_ticks_per_second();
+		f64 sum = 0.0;
+		f64 sum_sq = 0.0;
+		for (u32 i = 0; i < stats.num_frames; ++i)
+		{
+			u32 index = (m_frame_pacing_index + 256 - i) % 256;
+			f64 error = (f64)m_frame_pacing_errors[index] * seconds_per_tick;
+			sum += error;
+			sum_sq += error * error;
+			stats.max_error_seconds = max(stats.max_error_seconds, error);
+			if (m_frame_pacing_missed[index])
+			{
+				++stats.num_missed_frames;
+			}
+			if (m_frame_pacing_slept[index])
+			{
+				++stats.num_slept_frames;
+			}
+		}
+		stats.mean_error_seconds = sum / stats.num_frames;
+		f64 variance = sum_sq / stats.num_frames - stats.mean_error_seconds * stats.mean_error_seconds;
+		stats.stddev_error_seconds = variance > 0.0 ? sqrt(variance) : 0.0;
+		return stats;
+	}
 }
\ No newline at end of file
@@ -13,42 +13,125 @@ namespace Luna
 {
 	P<IMutex> m_lock;
 	Unconstructed<Vector<MountPair>> m_mounts;
+	Unconstructed<HashMultiMap<InternedPath, usize>> m_mount_index;
 
 	void vfs_init()
 	{
 		m_lock = new_mutex();
 		m_mounts.construct();
+		m_mount_index.construct();
 	}
 	void vfs_deinit()
 	{
+		m_mount_index.destruct();
 		m_mounts.destruct();
 		m_lock = nullptr;
 	}
 
+	//! Rebuilds `m_mount_index` after `m_mounts` is changed. `m_lock` must be held.
+	static void rebuild_mount_index()
+	{
+		auto& index = m_mount_index.get();
+		index.clear();
+		auto& mounts = m_mounts.get();
+		for (usize i = 0; i < mounts.size(); ++i)
+		{
+			index.insert(make_pair(InternedPath(mounts[i].m_path, EPathComponent::nodes), i));
+		}
+	}
+
 	LUNA_CORE_API P<IFileSystem> route_path(const Path& filename, Path& mount_point, Path& fs_path)
 	{
-		auto iter = m_mounts.get().rbegin();
-		while (iter != m_mounts.get().rend())
+		// Every mount point whose nodes are the prefix of the filename is one ancestor of the longest interned prefix of
+		// the filename, so we only need to check the ancestors rather than all mount points. The last mounted file
+		// system is used if multiple mount points match the filename.
+		auto& mounts = m_mounts.get();
+		InternedPath node = InternedPath::from_id(find_interned_path_prefix(filename, EPathComponent::nodes));
+		usize matched = (usize)-1;
+		auto& root = filename.root();
+		while (node)
 		{
-			if (filename.is_subpath_of(iter->m_path))
+			auto range = m_mount_index.get().equal_range(node);
+			for (auto iter = range.first; iter != range.second; ++iter)
 			{
-				// matched.
-				auto fs = iter->m_fs;
-				mount_point = iter->m_path;
-				fs_path = Path();
-				fs_path.assign_relative(mount_point, filename);
-				return fs;
+				// The root names must match if both paths have root names.
+				auto& mount_root = mounts[iter->second].m_path.root();
+				if (root && mount_root && (root != mount_root))
+				{
+					continue;
+				}
+				if (matched == (usize)-1 || iter->second > matched)
+				{
+					matched = iter->second;
+				}
 			}
-			else
+			node = node.empty() ? InternedPath() : node.parent();
+		}
+		if (matched == (usize)-1)
+		{
+			// Not found.
+			return nullptr;
+		}
+		auto& mount = mounts[matched];
+		mount_point = mount.m_path;
+		fs_path = Path();
+		fs_path.assign_relative(mount_point, filename);
+		return mount.m_fs;
+	}
+	R<Path> platform_path(IFileSystem* fs, const Path& fs_path)
+	{
+		Path path = fs_path;
+		// Virtual file systems may be mounted to paths of each other, limits the depth to break cycles.
+		for (u32 depth = 0; depth < 16; ++depth)
+		{
+			PlatformFileSystem* pfs;
+			if (succeeded(fs->query_interface_raw(PlatformFileSystem::__guid, (void**)&pfs)))
 			{
-				++iter;
+				return pfs->make_native_path(path);
+			}
+			VirtualFileSystem* vfs;
+			if (failed(fs->query_interface_raw(VirtualFileSystem::__guid, (void**)&vfs)))
+			{
+				return BasicError::not_supported();
+			}
+			Path vfs_path = vfs->make_native_path(path);
+			Path mount_point;
+			// The file system is kept alive by `m_mounts`.
+			fs = route_path(vfs_path, mount_point, path).get();
+			if (!fs)
+			{
+				return BasicError::not_found();
 			}
 		}
-		// Not found.
-		return nullptr;
+		return BasicError::not_supported();
 	}
+
+	R<Path> platform_path(const Path& filename)
+	{
+		MutexGuard _guard(m_lock.get());
+		Path mount_path;
+		Path fs_path;
+		auto fs = route_path(filename, mount_path, fs_path);
+		if (!fs)
+		{
+			return BasicError::not_found();
+		}
+		return platform_path(fs, fs_path);
+	}
+
 	LUNA_CORE_API RV copy_file_between_fs(IFileSystem* from, IFileSystem* to, const Path& from_path, const Path& to_path, bool fail_if_exists)
 	{
+		// If both files are platform files, let the platform copy the file, which copies the data in the kernel
+		// or clones the file instead of passing the data through the temp buffer.
+		auto from_platform = platform_path(from, from_path);
+		auto to_platform = platform_path(to, to_path);
+		if (succeeded(from_platform) && succeeded(to_platform))
+		{
+			auto from_platform_str = from_platform.get().encode();
+			auto to_platform_str = to_platform.get().encode();
+			return platform_copy_file(from_platform_str.c_str(), to_platform_str.c_str(), fail_if_exists);
+		}
+
 		// try open file.
 		P<IFile> from_file;
 		P<IFile> to_file;
@@ -143,6 +226,32 @@ namespace Luna
 		return fs->open_file(fs_path, flags, creation);
 	}
 
+	LUNA_CORE_API RP<IMappedFile> map_file(const Path& filename, EFileMapHint hint)
+	{
+		MutexGuard _guard(m_lock.get());
+		Path mount_path;
+		Path fs_path;
+		auto fs = route_path(filename, mount_path, fs_path);
+		if (!fs)
+		{
+			return BasicError::not_found();
+		}
+		return fs->map_file(fs_path, hint);
+	}
+
+	LUNA_CORE_API R<Path> native_path(const Path& filename)
+	{
+		MutexGuard _guard(m_lock.get());
+		Path mount_path;
+		Path fs_path;
+		auto fs = route_path(filename, mount_path, fs_path);
+		if (!fs)
+		{
+			return BasicError::not_found();
+		}
+		return fs->native_path(fs_path);
+	}
+
 	LUNA_CORE_API R<FileAttribute> file_attribute(const Path& filename)
 	{
 		MutexGuard _guard(m_lock.get());
@@ -317,6 +426,7 @@ namespace Luna
 			}
 		}
 		m_mounts.get().push_back(move(p));
+		rebuild_mount_index();
 		return RV();
 	}
 
@@ -344,6 +454,7 @@ namespace Luna
 			if (mount_point.equal_to(iter->m_path))
 			{
 				m_mounts.get().erase(iter);
+				rebuild_mount_index();
 				return RV();
 			}
 		}
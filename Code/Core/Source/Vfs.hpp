@@ -6,6 +6,8 @@
 */
 #pragma once
 #include <Runtime/Vector.hpp>
+#include <Runtime/HashMultiMap.hpp>
+#include <Runtime/InternedPath.hpp>
 #include "PlatformFileSystem.hpp"
 #include "VirtualFileSystem.hpp"
 #include "../IMutex.hpp"
@@ -20,7 +22,16 @@ namespace Luna
 
 	extern P<IMutex> m_lock;
 	extern Unconstructed<Vector<MountPair>> m_mounts;
+	//! Maps the nodes of every mount point (interned with `EPathComponent::nodes`) to the index of the mount in `m_mounts`.
+	extern Unconstructed<HashMultiMap<InternedPath, usize>> m_mount_index;
 
 	void vfs_init();
 	void vfs_deinit();
+
+	//! Gets the path of one file in `fs` on the platform file system. Virtual file systems are resolved to the file systems
+	//! mounted to their paths until one platform file system is reached. `m_lock` must be held.
+	//! @return Returns `BasicError::not_supported` if the file is not in one platform file system.
+	R<Path> platform_path(IFileSystem* fs, const Path& fs_path);
+	//! Gets the path of one file in the virtual file system on the platform file system.
+	R<Path> platform_path(const Path& filename);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 * @date 2020/3/2
 */
 #include "VirtualFileSystem.hpp"
+#include "../Core.hpp"
 
 namespace Luna
 {
@@ -14,6 +15,12 @@ namespace Luna
 		return open_file(path, flags, creation);
 	}
 
+	RP<IMappedFile> VirtualFileSystem::map_file(const Path& filename, EFileMapHint hint)
+	{
+		auto path = make_native_path(filename);
+		return Luna::map_file(path, hint);
+	}
+
 	R<FileAttribute> VirtualFileSystem::file_attribute(const Path& filename)
 	{
 		auto path = make_native_path(filename);
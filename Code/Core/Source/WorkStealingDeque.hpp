@@ -0,0 +1,169 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file WorkStealingDeque.hpp
+* @author JXMaster
+* @date 2021/6/17
+*/
+#pragma once
+#include <Runtime/Atomic.hpp>
+#include <Runtime/Memory.hpp>
+
+namespace Luna
+{
+	//! The Chase-Lev work-stealing deque.
+	//! The owner thread pushes and pops elements at the bottom end of the deque, other threads steal elements from the
+	//! top end of the deque. Only the steal operation and the pop operation for the last element use atomic
+	//! compare-exchange, push and pop operations in other cases only use memory barriers.
+	//!
+	//! See: Chase, Lev. Dynamic Circular Work-Stealing Deque. SPAA 2005.
+	//! See: Le, Pop, Cohen, Zappa Nardelli. Correct and Efficient Work-Stealing for Weak Memory Models. PPoPP 2013.
+	//! @remark `_Ty` must be trivially copyable and no larger than one pointer, since stealing threads may read one
+	//! element that is being written by the owner thread and discard it later.
+	template <typename _Ty>
+	class WorkStealingDeque
+	{
+		struct Buffer
+		{
+			usize m_capacity;
+			//! The previous buffer. Buffers are not freed until the deque is destroyed, since stealing threads may
+			//! still read elements from old buffers.
+			Buffer* m_prev;
+
+			_Ty* data()
+			{
+				return (_Ty*)(this + 1);
+			}
+			_Ty get(usize i)
+			{
+				return ((volatile _Ty*)data())[i & (m_capacity - 1)];
+			}
+			void put(usize i, _Ty v)
+			{
+				((volatile _Ty*)data())[i & (m_capacity - 1)] = v;
+			}
+		};
+
+		static Buffer* new_buffer(usize capacity, Buffer* prev)
+		{
+			Buffer* buf = (Buffer*)memalloc(sizeof(Buffer) + sizeof(_Ty) * capacity, alignof(Buffer));
+			buf->m_capacity = capacity;
+			buf->m_prev = prev;
+			return buf;
+		}
+
+		// `m_top` is written by stealing threads and `m_bottom` is written by the owner thread, so they are placed in
+		// different cache lines.
+		volatile usize m_top;
+		u8 m_padding1[64 - sizeof(usize)];
+		volatile usize m_bottom;
+		Buffer* volatile m_buffer;
+		u8 m_padding2[64 - sizeof(usize) - sizeof(Buffer*)];
+
+		//! Indices are increased monotonically and compared by their signed difference, so they can wrap around.
+		static isize diff(usize a, usize b)
+		{
+			return (isize)(a - b);
+		}
+	public:
+		WorkStealingDeque(usize initial_capacity = 256) :
+			m_top(0),
+			m_bottom(0)
+		{
+			luassert(initial_capacity && !(initial_capacity & (initial_capacity - 1)));
+			m_buffer = new_buffer(initial_capacity, nullptr);
+		}
+		~WorkStealingDeque()
+		{
+			Buffer* buf = m_buffer;
+			while (buf)
+			{
+				Buffer* prev = buf->m_prev;
+				memfree(buf, alignof(Buffer));
+				buf = prev;
+			}
+		}
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		//! Gets the approximate number of elements in the deque.
+		usize size() const
+		{
+			isize n = diff(m_bottom, m_top);
+			return n > 0 ? (usize)n : 0;
+		}
+
+		//! Pushes one element to the bottom of the deque. Only the owner thread can call this.
+		void push(_Ty v)
+		{
+			usize b = m_bottom;
+			usize t = m_top;
+			atom_fence_acquire();
+			Buffer* buf = m_buffer;
+			if (diff(b, t) >= (isize)buf->m_capacity)
+			{
+				// Grows the buffer.
+				Buffer* new_buf = new_buffer(buf->m_capacity * 2, buf);
+				for (usize i = t; i != b; ++i)
+				{
+					new_buf->put(i, buf->get(i));
+				}
+				atom_fence_release();
+				m_buffer = new_buf;
+				buf = new_buf;
+			}
+			buf->put(b, v);
+			atom_fence_release();
+			m_bottom = b + 1;
+		}
+
+		//! Pops one element from the bottom of the deque. Only the owner thread can call this.
+		//! @return Returns `true` if one element is popped, `false` if the deque is empty.
+		bool pop(_Ty& out)
+		{
+			usize b = m_bottom - 1;
+			Buffer* buf = m_buffer;
+			m_bottom = b;
+			atom_fence();
+			usize t = m_top;
+			if (diff(b, t) < 0)
+			{
+				// Empty.
+				m_bottom = b + 1;
+				return false;
+			}
+			out = buf->get(b);
+			if (b != t)
+			{
+				return true;
+			}
+			// This is the last element, race with stealing threads.
+			bool succeeded = atom_compare_exchange_usize(&m_top, t + 1, t) == t;
+			m_bottom = b + 1;
+			return succeeded;
+		}
+
+		//! Steals one element from the top of the deque. Any thread can call this.
+		//! @return Returns `true` if one element is stolen. Returns `false` if the deque is empty or the element is
+		//! taken by another thread.
+		bool steal(_Ty& out)
+		{
+			usize t = m_top;
+			atom_fence();
+			usize b = m_bottom;
+			atom_fence_acquire();
+			if (diff(b, t) <= 0)
+			{
+				return false;
+			}
+			Buffer* buf = m_buffer;
+			atom_fence_acquire();
+			_Ty v = buf->get(t);
+			if (atom_compare_exchange_usize(&m_top, t + 1, t) != t)
+			{
+				return false;
+			}
+			out = v;
+			return true;
+		}
+	};
+}
@@ -0,0 +1,169 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AsyncIOTest.cpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#include "TestCommon.hpp"
+#include <Core/Interface.hpp>
+#include <Runtime/Thread.hpp>
+
+namespace Luna
+{
+	class AsyncIOCallback : public IRunnable
+	{
+	public:
+		lucid("{4e9a7c21-5d03-4b8f-a6e1-0c2f8b3d9a56}");
+		luiimpl(AsyncIOCallback, IRunnable, IObject);
+
+		Vector<u32>* m_order;
+		u32 m_index;
+		//! If not `nullptr`, blocks the I/O thread until triggered.
+		P<ISignal> m_block;
+
+		AsyncIOCallback() :
+			m_order(nullptr),
+			m_index(0) {}
+
+		virtual void run() override
+		{
+			if (m_block)
+			{
+				m_block->wait();
+			}
+			m_order->push_back(m_index);
+		}
+	};
+
+	static void async_io_test_fs(bool force_thread_pool)
+	{
+		// Allow one request being processed at one time, so that pending requests are issued by priority.
+		P<IAsyncFileSystem> fs = new_async_file_system(1, 1, force_thread_pool).get();
+		if (force_thread_pool)
+		{
+			lutest(fs->backend() == EAsyncIOBackend::thread_pool);
+		}
+
+		constexpr u32 num_blocks = 16;
+		constexpr u32 block_size = 4096;
+		Vector<u8> data(num_blocks * block_size);
+		for (usize i = 0; i < data.size(); ++i)
+		{
+			data[i] = (u8)(i * 31 + i / block_size);
+		}
+		P<IAsyncFile> file = fs->open_file(u8"/Platform/AsyncFile.bin", EFileOpenFlag::read | EFileOpenFlag::write, EFileCreationMode::create_always).get();
+
+		{
+			// Writes all blocks in one batch and waits for them with one counter.
+			JobCounter counter;
+			AsyncIORequestDesc descs[num_blocks];
+			P<IAsyncIORequest> requests[num_blocks];
+			for (u32 i = 0; i < num_blocks; ++i)
+			{
+				descs[i] = AsyncIORequestDesc::as_write(file, (u64)i * block_size, data.data() + i * block_size, block_size);
+				descs[i].counter = &counter;
+			}
+			lutest(succeeded(fs->submit(descs, num_blocks, requests)));
+			wait_for_counter(counter);
+			for (u32 i = 0; i < num_blocks; ++i)
+			{
+				lutest(requests[i]->status() == EAsyncIOStatus::finished);
+				lutest(succeeded(requests[i]->result()));
+				lutest(requests[i]->transferred_bytes() == block_size);
+			}
+			lutest(file->size() == data.size());
+		}
+
+		{
+			// Reads all blocks with different priorities. The callback of the first request blocks the I/O thread, so other
+			// requests are pending until it returns.
+			Vector<u8> read_data(data.size());
+			Vector<u32> order;
+			Vector<P<AsyncIOCallback>> callbacks;
+			P<ISignal> block = new_signal(true);
+			AsyncIORequestDesc descs[num_blocks];
+			P<IAsyncIORequest> requests[num_blocks];
+			for (u32 i = 0; i < num_blocks; ++i)
+			{
+				EAsyncIOPriority priority = i % 3 == 0 ? EAsyncIOPriority::high : EAsyncIOPriority::low;
+				descs[i] = AsyncIORequestDesc::as_read(file, (u64)i * block_size, read_data.data() + i * block_size, block_size, priority);
+				auto callback = newobj<AsyncIOCallback>();
+				callback->m_order = &order;
+				callback->m_index = i;
+				descs[i].callback = callback;
+				callbacks.push_back(callback);
+			}
+			callbacks[0]->m_block = block;
+			lutest(succeeded(fs->submit(descs, 1, requests)));
+			while (requests[0]->status() == EAsyncIOStatus::pending)
+			{
+				yield_current_thread();
+			}
+			lutest(succeeded(fs->submit(descs + 1, num_blocks - 1, requests + 1)));
+
+			// Pending requests are canceled immediately, and the callback is still called.
+			lutest(requests[5]->status() == EAsyncIOStatus::pending);
+			requests[5]->cancel();
+			lutest(requests[5]->status() == EAsyncIOStatus::canceled);
+			lutest(requests[5]->result().errcode() == BasicError::user_canceled());
+			lutest(succeeded(requests[5]->try_wait()));
+
+			block->trigger();
+			for (u32 i = 0; i < num_blocks; ++i)
+			{
+				requests[i]->wait();
+			}
+			const u32 expected_order[num_blocks] = { 5, 0, 3, 6, 9, 12, 15, 1, 2, 4, 7, 8, 10, 11, 13, 14 };
+			lutest(order.size() == num_blocks);
+			for (u32 i = 0; i < num_blocks; ++i)
+			{
+				lutest(order[i] == expected_order[i]);
+				if (i != 5)
+				{
+					lutest(!memcmp(read_data.data() + i * block_size, data.data() + i * block_size, block_size));
+				}
+			}
+		}
+
+		{
+			// Reading beyond the end of the file returns the remaining bytes.
+			u8 buf[64];
+			P<IAsyncIORequest> request = fs->submit(AsyncIORequestDesc::as_read(file, data.size() - 16, buf, sizeof(buf))).get();
+			request->wait();
+			lutest(succeeded(request->result()));
+			lutest(request->transferred_bytes() == 16);
+			lutest(!memcmp(buf, data.data() + data.size() - 16, 16));
+		}
+
+		{
+			// Callbacks can be dispatched to one dispatch queue.
+			u8 buf[block_size];
+			Vector<u32> order;
+			auto callback = newobj<AsyncIOCallback>();
+			callback->m_order = &order;
+			auto queue = new_dispatch_queue(1);
+			auto desc = AsyncIORequestDesc::as_read(file, 0, buf, block_size, EAsyncIOPriority::high);
+			desc.callback = callback;
+			desc.callback_queue = queue;
+			P<IAsyncIORequest> request = fs->submit(desc).get();
+			request->wait();
+			while (queue->completion_count() != 1)
+			{
+				yield_current_thread();
+			}
+			lutest(order.size() == 1);
+		}
+
+		file = nullptr;
+		fs = nullptr;
+		lutest(succeeded(delete_file(u8"/Platform/AsyncFile.bin")));
+	}
+
+	void async_io_test()
+	{
+		mount_platfrom_path(u8"/Platform/", u8".");
+		async_io_test_fs(false);
+		async_io_test_fs(true);
+		unmount_fs(u8"/Platform/");
+	}
+}
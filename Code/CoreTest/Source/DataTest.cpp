@@ -6,6 +6,8 @@
 */
 #include "TestCommon.hpp"
 #include <Core/Variant.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
 
 /*
 table = {
@@ -39,7 +41,7 @@ table = {
 
 namespace Luna
 {
-	static void serialize()
+	static Variant new_monster()
 	{
 		auto table = Variant(EVariantType::table);
 
@@ -118,22 +120,11 @@ namespace Luna
 			userdata.to_var_buf()[2] = move(s3);
 		}
 		table.set_field(0, u8"userdata", move(userdata));
-
-		auto encoder = new_text_encoder();
-		auto file = platform_open_file(u8"./Monster.la", EFileOpenFlag::write | EFileOpenFlag::user_buffering, EFileCreationMode::create_always).get();
-		lutest(succeeded(encoder->encode(table, file)));
-		file = nullptr;
+		return table;
 	}
 
-	static void deserialize()
+	static void check_monster(Variant& var)
 	{
-		auto file = platform_open_file(u8"./Monster.la", EFileOpenFlag::read | EFileOpenFlag::user_buffering, EFileCreationMode::open_existing).get();
-		auto decoder = new_text_decoder();
-		auto r = decoder->decode(file);
-		auto& var = r.get();
-		file = nullptr;
-		//platform_delete_file(u8"./Monster.la");
-
 		auto& pos = var.field(0, u8"pos");
 		lutest(pos.to_f32_buf()[0] == 0.0f);
 		lutest(pos.to_f32_buf()[1] == 10.0f);
@@ -198,9 +189,161 @@ namespace Luna
 		lutest(userdata_2.type() == EVariantType::null);
 	}
 
+	static void serialize()
+	{
+		auto table = new_monster();
+		auto encoder = new_text_encoder();
+		auto file = platform_open_file(u8"./Monster.la", EFileOpenFlag::write | EFileOpenFlag::user_buffering, EFileCreationMode::create_always).get();
+		lutest(succeeded(encoder->encode(table, file)));
+		file = nullptr;
+	}
+
+	static void deserialize()
+	{
+		auto file = platform_open_file(u8"./Monster.la", EFileOpenFlag::read | EFileOpenFlag::user_buffering, EFileCreationMode::open_existing).get();
+		auto decoder = new_text_decoder();
+		auto r = decoder->decode(file);
+		auto& var = r.get();
+		file = nullptr;
+		//platform_delete_file(u8"./Monster.la");
+		check_monster(var);
+	}
+
+	static void binary_serialize()
+	{
+		auto table = new_monster();
+		auto blobs = Variant(EVariantType::blob, 3);
+		blobs.to_blob_buf()[0] = Blob(u8"abc", 3);
+		blobs.to_blob_buf()[2] = Blob(100);
+		memset(blobs.to_blob_buf()[2].data(), 7, 100);
+		table.set_field(0, u8"blobs", move(blobs));
+
+		auto stream = new_memory_stream();
+		lutest(succeeded(stream->write(u8"head", 4)));
+		auto encoder = new_binary_encoder();
+		lutest(succeeded(encoder->encode(table, stream)));
+		u64 end = stream->tell().get();
+		lutest(succeeded(stream->write(u8"tail", 4)));
+
+		// Decodes from stream.
+		lutest(succeeded(stream->seek(4, ESeekMode::begin)));
+		auto decoder = new_binary_decoder();
+		auto r = decoder->decode(stream);
+		lutest(succeeded(r));
+		lutest(stream->tell().get() == end);
+		check_monster(r.get());
+		auto& decoded_blobs = r.get().field(0, u8"blobs");
+		lutest(!memcmp(decoded_blobs.to_blob_buf()[0].data(), u8"abc", 3));
+		lutest(decoded_blobs.to_blob_buf()[1].size() == 0);
+		lutest(((const u8*)decoded_blobs.to_blob_buf()[2].data())[99] == 7);
+
+		// Decodes from memory, blobs reference the memory.
+		usize size = (usize)end - 4;
+		auto data = Blob((const u8*)stream->get_data() + 4, size);
+		auto owner = new_memory_stream();
+		owner->set_blob(move(data));
+		auto r2 = decode_binary_variant(owner->get_data(), size, owner);
+		lutest(succeeded(r2));
+		check_monster(r2.get());
+		auto& aliased_blobs = r2.get().field(0, u8"blobs");
+		for (usize i = 0; i < 3; i += 2)
+		{
+			const Blob& blob = aliased_blobs.to_blob_buf()[i];
+			lutest(blob.is_external());
+			usize offset = (usize)blob.data() - (usize)owner->get_data();
+			lutest(offset < size && (offset % 16) == 0);
+		}
+		lutest(((const u8*)aliased_blobs.to_blob_buf()[2].data())[99] == 7);
+
+		// Corrupted data is rejected.
+		lutest(failed(decode_binary_variant(owner->get_data(), size / 2, nullptr)));
+
+		// Decodes from one mapped file, blobs reference the mapped data.
+		{
+			auto file = platform_open_file(u8"./Monster.lb", EFileOpenFlag::write, EFileCreationMode::create_always).get();
+			lutest(succeeded(encoder->encode(table, file)));
+		}
+		{
+			auto mapped = platform_map_file(u8"./Monster.lb", EFileMapHint::sequential).get();
+			auto r3 = decode_binary_variant(mapped->data(), mapped->size(), mapped);
+			lutest(succeeded(r3));
+			mapped = nullptr;
+			// The mapped file is kept alive by the decoded blobs.
+			check_monster(r3.get());
+			auto& mapped_blobs = r3.get().field(0, u8"blobs");
+			lutest(mapped_blobs.to_blob_buf()[2].is_external());
+			lutest(((const u8*)mapped_blobs.to_blob_buf()[2].data())[99] == 7);
+		}
+		platform_delete_file(u8"./Monster.lb");
+	}
+
+	static void text_decoder_benchmark()
+	{
+		// One document with many small tables and one big array, which is about 8 MB when encoded.
+		constexpr u32 num_entities = 20000;
+		constexpr u32 num_samples = 200000;
+		auto doc = Variant(EVariantType::table);
+		auto entities = Variant(EVariantType::table, num_entities);
+		for (u32 i = 0; i < num_entities; ++i)
+		{
+			auto pos = Variant(EVariantType::f32, 3);
+			pos.to_f32_buf()[0] = (f32)i * 0.25f;
+			pos.to_f32_buf()[1] = -(f32)i / 3.0f;
+			pos.to_f32_buf()[2] = (f32)i * 0.001f;
+			entities.set_field(i, u8"pos", move(pos));
+			auto id = Variant(EVariantType::u64);
+			id.to_u64() = (u64)i * 1234567;
+			entities.set_field(i, u8"id", move(id));
+			auto name = Variant(EVariantType::string);
+			c8 buf[64];
+			snprintf(buf, sizeof(buf), u8"Entity \"%u\"\tof the benchmark", i);
+			name.to_str() = buf;
+			entities.set_field(i, u8"name", move(name));
+			auto visible = Variant(EVariantType::boolean);
+			bit_set(visible.to_boolean_buf(), 0);
+			entities.set_field(i, u8"visible", move(visible));
+		}
+		doc.set_field(0, u8"entities", move(entities));
+		auto samples = Variant(EVariantType::f64, num_samples);
+		for (u32 i = 0; i < num_samples; ++i)
+		{
+			samples.to_f64_buf()[i] = (f64)i * 0.37;
+		}
+		doc.set_field(0, u8"samples", move(samples));
+
+		auto encoder = new_text_encoder();
+		auto file = platform_open_file(u8"./Benchmark.la", EFileOpenFlag::write | EFileOpenFlag::user_buffering, EFileCreationMode::create_always).get();
+		lutest(succeeded(encoder->encode(doc, file)));
+		u64 size = file->size();
+		file = nullptr;
+
+		f64 freq = get_ticks_per_second();
+		file = platform_open_file(u8"./Benchmark.la", EFileOpenFlag::read | EFileOpenFlag::user_buffering, EFileCreationMode::open_existing).get();
+		auto decoder = new_text_decoder();
+		u64 begin = get_ticks();
+		auto r = decoder->decode(file);
+		u64 file_ticks = get_ticks() - begin;
+		lutest(succeeded(r));
+		file = nullptr;
+		platform_delete_file(u8"./Benchmark.la");
+
+		auto& decoded = r.get();
+		auto& decoded_entities = decoded.field(0, u8"entities");
+		lutest(decoded_entities.size() == num_entities);
+		lutest(decoded_entities.field(7, u8"pos").to_f32_buf()[0] == 1.75f);
+		lutest(decoded_entities.field(7, u8"id").to_u64() == 7 * 1234567);
+		lutest(decoded_entities.field(7, u8"name").to_str() == u8"Entity \"7\"\tof the benchmark");
+		lutest(decoded.field(0, u8"samples").size() == num_samples);
+
+		f64 mb = (f64)size / (1024.0 * 1024.0);
+		debug_printf("[Text Decoder Benchmark]%.2f MB document: %.2f ms, %.1f MB/s\n", mb, file_ticks * 1000.0 / freq, mb * freq / file_ticks);
+	}
+
 	void data_test()
 	{
 		serialize();
 		deserialize();
+		binary_serialize();
+		text_decoder_benchmark();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FramePacingTest.cpp
+* @author JXMaster
+* @date 2021/6/24
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Time.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	static void frame_pacing_benchmark()
+	{
+		constexpr u32 num_frames = 120;
+		f64 freq = get_ticks_per_second();
+		u64 period = (u64)(freq / 120.0);
+		// The single `fast_sleep` from the frame beginning that was used before.
+		f64 sum = 0.0;
+		f64 sum_sq = 0.0;
+		u64 frame_begin = get_ticks();
+		for (u32 i = 0; i < num_frames; ++i)
+		{
+			u64 now = get_ticks();
+			i64 wait_us = i64((frame_begin + period - now) * 1000000 / freq);
+			if (wait_us > 0)
+			{
+				fast_sleep((u32)wait_us);
+			}
+			now = get_ticks();
+			f64 error = (f64)(now - frame_begin) / freq - 1.0 / 120.0;
+			sum += error;
+			sum_sq += error * error;
+			frame_begin = now;
+		}
+		f64 mean = sum / num_frames;
+		f64 stddev = sqrt(max(sum_sq / num_frames - mean * mean, 0.0));
+		FramePacingStats stats = get_frame_pacing_stats();
+		debug_printf("[Frame Pacing Benchmark]fast_sleep: mean error %.1f us, stddev %.1f us\n", mean * 1000000.0, stddev * 1000000.0);
+		debug_printf("[Frame Pacing Benchmark]hybrid sleep: mean error %.1f us, stddev %.1f us, max %.1f us, %u of %u frames missed\n",
+			stats.mean_error_seconds * 1000000.0, stats.stddev_error_seconds * 1000000.0, stats.max_error_seconds * 1000000.0,
+			stats.num_missed_frames, stats.num_frames);
+	}
+
+	void frame_pacing_test()
+	{
+		bool governing_enabled = is_frame_governing_enabled();
+		f32 governing_fps = get_frame_governing_fps();
+		lutest(succeeded(set_frame_governing_fps(120.0f)));
+		set_frame_governing_enabled(true);
+		new_frame();
+		u64 begin = get_ticks();
+		for (u32 i = 0; i < 120; ++i)
+		{
+			new_frame();
+		}
+		f64 seconds = (f64)(get_ticks() - begin) / get_ticks_per_second();
+		// Frames are scheduled on one timeline, so 120 frames take about one second.
+		lutest(seconds > 0.98 && seconds < 1.1);
+		FramePacingStats stats = get_frame_pacing_stats();
+		lutest(stats.num_frames == 120);
+		lutest(stats.mean_error_seconds >= 0.0 && stats.mean_error_seconds <= stats.max_error_seconds);
+
+		// One frame that is late for more than one period restarts the timeline instead of running frames without
+		// waiting.
+		sleep(50);
+		new_frame();
+		begin = get_ticks();
+		for (u32 i = 0; i < 12; ++i)
+		{
+			new_frame();
+		}
+		seconds = (f64)(get_ticks() - begin) / get_ticks_per_second();
+		lutest(seconds > 0.09);
+		stats = get_frame_pacing_stats();
+		lutest(stats.num_missed_frames >= 1);
+
+		// One wake that is later than the frame period (like the thread being preempted for 20ms) must not make following
+		// frames spin for the whole period.
+		set_frame_pacing_sleep_overshoot(0.02);
+		sleep(50);
+		new_frame();
+		for (u32 i = 0; i < 120; ++i)
+		{
+			new_frame();
+		}
+		stats = get_frame_pacing_stats();
+		lutest(stats.sleep_overshoot_seconds <= 1.0 / 120.0 / 4.0);
+		lutest(stats.num_slept_frames > 60);
+
+		frame_pacing_benchmark();
+
+		lutest(succeeded(set_frame_governing_fps(governing_fps)));
+		set_frame_governing_enabled(governing_enabled);
+	}
+}
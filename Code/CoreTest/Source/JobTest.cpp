@@ -0,0 +1,296 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file JobTest.cpp
+* @author JXMaster
+* @date 2021/6/17
+*/
+#include "TestCommon.hpp"
+#include <Core/Interface.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/Debug.hpp>
+#include <Runtime/Platform.hpp>
+
+namespace Luna
+{
+	class CounterTask : public IRunnable
+	{
+	public:
+		lucid("{8d0e4c39-2b61-4f57-a3d4-6c1f0e9b7a25}");
+		luiimpl(CounterTask, IRunnable, IObject);
+
+		volatile u32* m_counter;
+		Vector<u32>* m_order;
+		u32 m_index;
+
+		CounterTask() :
+			m_counter(nullptr),
+			m_order(nullptr),
+			m_index(0) {}
+
+		virtual void run() override
+		{
+			if (m_order)
+			{
+				m_order->push_back(m_index);
+			}
+			atom_inc_u32(m_counter);
+		}
+	};
+
+	static u64 fork_sum(u32 depth)
+	{
+		if (!depth)
+		{
+			return 1;
+		}
+		u64 a = 0;
+		JobHandle job = dispatch_job([&a, depth]() { a = fork_sum(depth - 1); });
+		u64 b = fork_sum(depth - 1);
+		job.wait();
+		return a + b;
+	}
+
+	//! Fans out 4 jobs at every level and waits for them with one counter.
+	static u64 counter_sum(u32 depth)
+	{
+		if (!depth)
+		{
+			return 1;
+		}
+		u64 results[4] = {};
+		JobCounter counter;
+		for (u32 i = 0; i < 4; ++i)
+		{
+			dispatch_job([&results, i, depth]() { results[i] = counter_sum(depth - 1); }, counter);
+		}
+		wait_for_counter(counter);
+		return results[0] + results[1] + results[2] + results[3];
+	}
+
+	static void wait_queue(IDispatchQueue* queue, u64 count)
+	{
+		while (queue->completion_count() != count)
+		{
+			yield_current_thread();
+		}
+	}
+
+	static void job_benchmark()
+	{
+		constexpr u32 num_tasks = 100000;
+		f64 freq = get_ticks_per_second();
+		volatile u32 counter = 0;
+		u64 begin = get_ticks();
+		{
+			P<IDispatchQueue> queue = new_dispatch_queue();
+			for (u32 i = 0; i < num_tasks; ++i)
+			{
+				P<CounterTask> task = newobj<CounterTask>();
+				task->m_counter = &counter;
+				queue->dispatch(task);
+			}
+			wait_queue(queue, num_tasks);
+		}
+		u64 queue_ticks = get_ticks() - begin;
+		lutest(counter == num_tasks);
+		counter = 0;
+		begin = get_ticks();
+		{
+			JobHandle root = dispatch_job([]() {}, JobHandle(), false);
+			for (u32 i = 0; i < num_tasks; ++i)
+			{
+				volatile u32* c = &counter;
+				dispatch_job([c]() { atom_inc_u32(c); }, root);
+			}
+			root.submit();
+			root.wait();
+		}
+		u64 job_ticks = get_ticks() - begin;
+		lutest(counter == num_tasks);
+		begin = get_ticks();
+		lutest(fork_sum(16) == 65536);
+		u64 fork_ticks = get_ticks() - begin;
+		begin = get_ticks();
+		u64 result = 0;
+		JobHandle root = dispatch_job([&result]() { result = counter_sum(8); });
+		root.wait();
+		lutest(result == 65536);
+		u64 counter_ticks = get_ticks() - begin;
+		debug_printf("[Job Benchmark]%u workers, %u tasks: dispatch queue %.2f ms, child jobs %.2f ms, 65536 fork/join leaves %.2f ms, 65536 counter wait leaves %.2f ms\n",
+			get_job_worker_count(), num_tasks, queue_ticks * 1000.0 / freq, job_ticks * 1000.0 / freq, fork_ticks * 1000.0 / freq, counter_ticks * 1000.0 / freq);
+	}
+
+	void job_test()
+	{
+		lutest(get_job_worker_count() >= 1);
+
+		{
+			// Parent job is finished after all children jobs are finished.
+			volatile u32 counter = 0;
+			JobHandle parent = dispatch_job([]() {}, JobHandle(), false);
+			for (u32 i = 0; i < 1000; ++i)
+			{
+				volatile u32* c = &counter;
+				dispatch_job([c]() { atom_inc_u32(c); }, parent);
+			}
+			parent.submit();
+			parent.wait();
+			lutest(parent.finished());
+			lutest(counter == 1000);
+		}
+
+		{
+			// Jobs waiting for other jobs.
+			lutest(fork_sum(12) == 4096);
+		}
+
+		{
+			// Counters.
+			JobCounter counter;
+			u64 result = 0;
+			dispatch_job([&result]() { result = counter_sum(6); }, counter);
+			wait_for_counter(counter);
+			lutest(result == 4096);
+			lutest(counter.get() == 0);
+
+			// Waiting for one value other than 0.
+			JobCounter counter2;
+			volatile u32 done = 0;
+			for (u32 i = 0; i < 64; ++i)
+			{
+				volatile u32* d = &done;
+				dispatch_job([d]() { atom_inc_u32(d); }, counter2);
+			}
+			wait_for_counter(counter2, 32);
+			lutest(done >= 32);
+			wait_for_counter(counter2);
+			lutest(done == 64);
+		}
+
+		{
+			// Dependencies.
+			volatile u32 step = 0;
+			bool ordered = true;
+			JobHandle prev;
+			for (u32 i = 0; i < 100; ++i)
+			{
+				volatile u32* s = &step;
+				bool* o = &ordered;
+				JobHandle job = dispatch_job([s, o, i]() { if (atom_inc_u32(s) != i + 1) *o = false; }, JobHandle(), false);
+				if (prev)
+				{
+					job.depends_on(prev);
+				}
+				job.submit();
+				prev = job;
+			}
+			prev.wait();
+			lutest(ordered && step == 100);
+
+			// Dependency that is already finished.
+			u32 value = 0;
+			JobHandle a = dispatch_job([&value]() { value = 1; });
+			a.wait();
+			JobHandle b = dispatch_job([&value]() { value *= 2; }, JobHandle(), false);
+			b.depends_on(a);
+			b.submit();
+			b.wait();
+			lutest(value == 2);
+		}
+
+		{
+			// Serialized dispatch queue executes tasks in order.
+			P<IDispatchQueue> queue = new_dispatch_queue(1);
+			lutest(queue->concurrency_limit() == 1);
+			volatile u32 counter = 0;
+			Vector<u32> order;
+			for (u32 i = 0; i < 500; ++i)
+			{
+				P<CounterTask> task = newobj<CounterTask>();
+				task->m_counter = &counter;
+				task->m_order = &order;
+				task->m_index = i;
+				queue->dispatch(task);
+			}
+			wait_queue(queue, 500);
+			lutest(queue->enqueue_count() == 500);
+			lutest(queue->execution_count() == 500);
+			lutest(order.size() == 500);
+			for (u32 i = 0; i < 500; ++i)
+			{
+				lutest(order[i] == i);
+			}
+		}
+
+		{
+			// Concurrent dispatch queues.
+			P<IDispatchQueue> queues[2] = { new_dispatch_queue(0), new_dispatch_queue(2) };
+			for (auto& queue : queues)
+			{
+				volatile u32 counter = 0;
+				for (u32 i = 0; i < 500; ++i)
+				{
+					P<CounterTask> task = newobj<CounterTask>();
+					task->m_counter = &counter;
+					queue->dispatch(task);
+				}
+				wait_queue(queue, 500);
+				lutest(counter == 500);
+			}
+		}
+
+		{
+			// Worker placement.
+			u32 num_processors = Platform::get_processor_topology(nullptr, 0);
+			lutest(num_processors >= 1);
+			Vector<Platform::ProcessorInfo> processors;
+			processors.resize(num_processors);
+			Platform::get_processor_topology(processors.data(), num_processors);
+			u32 num_cores = 0;
+			for (auto& p : processors)
+			{
+				lutest(p.numa_node < Platform::get_num_numa_nodes());
+				num_cores = max(num_cores, p.core + 1);
+			}
+			lutest(succeeded(set_job_worker_affinity(0)));
+			lutest(get_job_reserved_processors(0, nullptr, 0) == 0);
+			lutest(failed(set_job_worker_affinity(num_cores)));
+			if (num_cores > 1)
+			{
+				lutest(succeeded(set_job_worker_affinity(1)));
+				u32 reserved[64];
+				u32 num_reserved = get_job_reserved_processors(0, reserved, 64);
+				lutest(num_reserved >= 1);
+				lutest(succeeded(get_main_thread()->set_affinity(reserved, min(num_reserved, 64u))));
+			}
+			// Jobs still run on pinned workers. Jobs may also be executed by the main thread when waiting, which is
+			// not one worker.
+			volatile u32 counter = 0;
+			bool valid_index = true;
+			JobCounter jc;
+			for (u32 i = 0; i < 100; ++i)
+			{
+				volatile u32* c = &counter;
+				bool* v = &valid_index;
+				dispatch_job([c, v]() {
+					u32 index = get_current_job_worker_index();
+					if (index != u32_max && index >= get_job_worker_count()) *v = false;
+					atom_inc_u32(c);
+				}, jc);
+			}
+			wait_for_counter(jc);
+			lutest(counter == 100);
+			lutest(valid_index);
+			lutest(get_current_job_worker_index() == u32_max);
+			lutest(succeeded(clear_job_worker_affinity()));
+			lutest(succeeded(get_main_thread()->set_affinity(nullptr, 0)));
+			for (u32 i = 0; i < get_job_worker_count(); ++i)
+			{
+				lutest(get_job_worker_numa_node(i) == u32_max);
+			}
+		}
+
+		job_benchmark();
+	}
+}
@@ -0,0 +1,206 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file ParallelTest.cpp
+* @author JXMaster
+* @date 2021/6/22
+*/
+#include "TestCommon.hpp"
+#include <Core/Parallel.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <Runtime/Vector.hpp>
+
+namespace Luna
+{
+	static f32 parallel_test_work(usize i)
+	{
+		// Some floating-point work that the compiler cannot remove.
+		f32 x = (f32)i;
+		for (u32 j = 0; j < 64; ++j)
+		{
+			x = x * 0.999f + 1.0f / (x + 1.0f);
+		}
+		return x;
+	}
+
+	//! Measures every algorithm with 1, 2, 4... workers. The number of workers is limited by splitting the range into
+	//! as many chunks as workers.
+	static void parallel_benchmark()
+	{
+		f64 freq = get_ticks_per_second();
+		u32 num_workers = get_job_worker_count();
+		constexpr usize num_elements = 1 << 20;
+		Vector<f32> dst;
+		dst.resize(num_elements, 0.0f);
+		Vector<u32> src;
+		src.resize(num_elements, 0);
+		auto ms = [freq](u64 ticks) { return ticks * 1000.0 / freq; };
+		for (u32 concurrency = 1; ; concurrency = min(concurrency * 2, num_workers))
+		{
+			usize grain_size = (num_elements + concurrency - 1) / concurrency;
+			u64 begin = get_ticks();
+			parallel_for(0, num_elements, [&dst](usize i) { dst[i] = parallel_test_work(i); }, grain_size);
+			u64 for_ticks = get_ticks() - begin;
+			begin = get_ticks();
+			f32 sum = parallel_reduce(0, num_elements, 0.0f, [](usize chunk_begin, usize chunk_end) {
+				f32 s = 0.0f;
+				for (usize i = chunk_begin; i < chunk_end; ++i) s += parallel_test_work(i);
+				return s;
+			}, [](f32 a, f32 b) { return a + b; }, false, grain_size);
+			u64 reduce_ticks = get_ticks() - begin;
+			lutest(sum > 0.0f);
+			for (usize i = 0; i < num_elements; ++i)
+			{
+				src[i] = random_u32();
+			}
+			begin = get_ticks();
+			parallel_sort(src.begin(), src.end(), [](u32 a, u32 b) { return a < b; }, max<usize>(grain_size / 8, parallel_sort_min_grain_size));
+			u64 sort_ticks = get_ticks() - begin;
+			begin = get_ticks();
+			parallel_scan(src.begin(), src.end(), src.begin(), (u32)0, [](u32 a, u32 b) { return a + b; }, grain_size);
+			u64 scan_ticks = get_ticks() - begin;
+			debug_printf("[Parallel Benchmark]%u workers, %u elements: parallel_for %.2f ms, parallel_reduce %.2f ms, parallel_sort %.2f ms, parallel_scan %.2f ms\n",
+				concurrency, (u32)num_elements, ms(for_ticks), ms(reduce_ticks), ms(sort_ticks), ms(scan_ticks));
+			if (concurrency == num_workers)
+			{
+				break;
+			}
+		}
+	}
+
+	void parallel_test()
+	{
+		{
+			// parallel_for visits every index exactly once.
+			Vector<u32> values;
+			values.resize(100003, 0);
+			parallel_for(0, values.size(), [&values](usize i) { values[i] += (u32)i; });
+			for (usize i = 0; i < values.size(); ++i)
+			{
+				lutest(values[i] == (u32)i);
+			}
+			// Empty range and explicit grain size.
+			parallel_for(5, 5, [](usize) { lutest(false); });
+			volatile u32 chunks = 0;
+			parallel_for_range(0, 1000, [&chunks](usize chunk_begin, usize chunk_end) {
+				lutest(chunk_end - chunk_begin <= 100);
+				atom_inc_u32(&chunks);
+			}, 100);
+			lutest(chunks >= 10);
+		}
+
+		{
+			// parallel_reduce.
+			auto range_sum = [](usize chunk_begin, usize chunk_end) {
+				u64 s = 0;
+				for (usize i = chunk_begin; i < chunk_end; ++i) s += i;
+				return s;
+			};
+			auto add = [](u64 a, u64 b) { return a + b; };
+			lutest(parallel_reduce(0, 1000001, (u64)0, range_sum, add) == 1000000ull * 1000001 / 2);
+			lutest(parallel_reduce(0, 1000001, (u64)0, range_sum, add, true) == 1000000ull * 1000001 / 2);
+			lutest(parallel_reduce(3, 3, (u64)7, range_sum, add) == 7);
+			// Reductions need not to be commutative: finds the first index that matches.
+			auto range_find = [](usize chunk_begin, usize chunk_end) {
+				for (usize i = chunk_begin; i < chunk_end; ++i)
+				{
+					if (i % 1000 == 7) return i;
+				}
+				return (usize)-1;
+			};
+			auto first = [](usize a, usize b) { return a != (usize)-1 ? a : b; };
+			lutest(parallel_reduce(0, 1000000, (usize)-1, range_find, first, false, 100) == 7);
+			// Deterministic floating-point reduction gives the same result on every run.
+			auto range_harmonic = [](usize chunk_begin, usize chunk_end) {
+				f64 s = 0.0;
+				for (usize i = chunk_begin; i < chunk_end; ++i) s += 1.0 / (f64)(i + 1);
+				return s;
+			};
+			auto addf = [](f64 a, f64 b) { return a + b; };
+			f64 r = parallel_reduce(0, 1000000, 0.0, range_harmonic, addf, true);
+			for (u32 i = 0; i < 8; ++i)
+			{
+				lutest(parallel_reduce(0, 1000000, 0.0, range_harmonic, addf, true) == r);
+			}
+		}
+
+		{
+			// sort and parallel_sort.
+			for (usize n : { 0, 1, 2, 17, 1000, 100000 })
+			{
+				Vector<u32> a;
+				for (usize i = 0; i < n; ++i)
+				{
+					a.push_back(random_u32() % 1000);
+				}
+				Vector<u32> b = a;
+				sort(a.begin(), a.end());
+				parallel_sort(b.begin(), b.end());
+				for (usize i = 1; i < n; ++i)
+				{
+					lutest(a[i - 1] <= a[i]);
+				}
+				lutest(equal(a.begin(), a.end(), b.begin()));
+				parallel_sort(b.begin(), b.end(), [](u32 x, u32 y) { return x > y; }, 1000);
+				for (usize i = 0; i < n; ++i)
+				{
+					lutest(b[i] == a[n - 1 - i]);
+				}
+			}
+			// Tiny grain sizes must not partition ranges that are too small.
+			for (usize grain_size : { 1, 2 })
+			{
+				for (usize n : { 2, 3, 5, 100, 10000 })
+				{
+					Vector<u32> a;
+					for (usize i = 0; i < n; ++i)
+					{
+						a.push_back(random_u32() % 100);
+					}
+					parallel_sort(a.begin(), a.end(), [](u32 x, u32 y) { return x < y; }, grain_size);
+					for (usize i = 1; i < n; ++i)
+					{
+						lutest(a[i - 1] <= a[i]);
+					}
+				}
+			}
+			// Sorted input must not degrade to quadratic time.
+			Vector<u32> sorted;
+			for (u32 i = 0; i < 100000; ++i)
+			{
+				sorted.push_back(i);
+			}
+			parallel_sort(sorted.begin(), sorted.end());
+			for (u32 i = 0; i < 100000; ++i)
+			{
+				lutest(sorted[i] == i);
+			}
+		}
+
+		{
+			// parallel_scan, both out-of-place and in-place.
+			for (usize n : { 0, 1, 7, 100000 })
+			{
+				Vector<u64> src;
+				for (usize i = 0; i < n; ++i)
+				{
+					src.push_back(random_u32() % 10);
+				}
+				Vector<u64> dst;
+				dst.resize(n, 0);
+				auto add = [](u64 a, u64 b) { return a + b; };
+				parallel_scan(src.begin(), src.end(), dst.begin(), (u64)0, add, 333);
+				u64 acc = 0;
+				for (usize i = 0; i < n; ++i)
+				{
+					acc += src[i];
+					lutest(dst[i] == acc);
+				}
+				parallel_scan(src.begin(), src.end(), src.begin(), (u64)0, add);
+				lutest(equal(src.begin(), src.end(), dst.begin()));
+			}
+		}
+
+		parallel_benchmark();
+	}
+}
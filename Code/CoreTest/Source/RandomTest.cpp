@@ -0,0 +1,145 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file RandomTest.cpp
+* @author JXMaster
+* @date 2021/6/21
+*/
+#include "TestCommon.hpp"
+#include <Core/Interface.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <random>
+
+namespace Luna
+{
+	static void random_benchmark()
+	{
+		constexpr u32 num_numbers = 1000000;
+		f64 freq = get_ticks_per_second();
+		volatile f32 sink = 0.0f;
+		// The mutex-guarded global `std::mt19937` that was used before.
+		std::mt19937 engine((u32)get_ticks());
+		P<IMutex> mtx = new_mutex();
+		u64 begin = get_ticks();
+		for (u32 i = 0; i < num_numbers; ++i)
+		{
+			mtx->wait();
+			sink = (f32)engine() / 4294967296.0f;
+			mtx->unlock();
+		}
+		u64 locked_ticks = get_ticks() - begin;
+		begin = get_ticks();
+		for (u32 i = 0; i < num_numbers; ++i)
+		{
+			sink = random_f32(0.0f, 1.0f);
+		}
+		u64 tls_ticks = get_ticks() - begin;
+		f32* buffer = (f32*)memalloc(sizeof(f32) * num_numbers);
+		begin = get_ticks();
+		fill_random_f32(buffer, num_numbers, 0.0f, 1.0f);
+		u64 fill_ticks = get_ticks() - begin;
+		memfree(buffer);
+		auto ns = [freq](u64 ticks) { return (f64)ticks * 1000000000.0 / freq / num_numbers; };
+		debug_printf("[Random Benchmark]mutex+mt19937 %.2f ns, random_f32 %.2f ns, fill_random_f32 %.2f ns per number\n",
+			ns(locked_ticks), ns(tls_ticks), ns(fill_ticks));
+
+		// Generates numbers from all workers at the same time, so that the global mutex is contended.
+		u32 num_jobs = get_job_worker_count();
+		constexpr u32 num_numbers_per_job = 200000;
+		JobCounter counter;
+		begin = get_ticks();
+		for (u32 i = 0; i < num_jobs; ++i)
+		{
+			dispatch_job([&engine, &mtx, &sink]() {
+				for (u32 j = 0; j < num_numbers_per_job; ++j)
+				{
+					mtx->wait();
+					sink = (f32)engine() / 4294967296.0f;
+					mtx->unlock();
+				}
+			}, counter);
+		}
+		wait_for_counter(counter);
+		locked_ticks = get_ticks() - begin;
+		begin = get_ticks();
+		for (u32 i = 0; i < num_jobs; ++i)
+		{
+			dispatch_job([&sink]() {
+				for (u32 j = 0; j < num_numbers_per_job; ++j)
+				{
+					sink = random_f32(0.0f, 1.0f);
+				}
+			}, counter);
+		}
+		wait_for_counter(counter);
+		tls_ticks = get_ticks() - begin;
+		debug_printf("[Random Benchmark]%u workers: mutex+mt19937 %.2f ms, random_f32 %.2f ms\n",
+			num_jobs, locked_ticks * 1000.0 / freq, tls_ticks * 1000.0 / freq);
+	}
+
+	void random_test()
+	{
+		{
+			// Ranges.
+			for (u32 i = 0; i < 10000; ++i)
+			{
+				f32 f = random_f32(-2.0f, 3.0f);
+				lutest(f >= -2.0f && f < 3.0f);
+				f64 d = random_f64(10.0, 20.0);
+				lutest(d >= 10.0 && d < 20.0);
+			}
+			constexpr usize num_numbers = 100003;
+			f32* buffer = (f32*)memalloc(sizeof(f32) * num_numbers);
+			fill_random_f32(buffer, num_numbers, -2.0f, 3.0f);
+			f64 sum = 0.0;
+			u32 buckets[5] = {};
+			for (usize i = 0; i < num_numbers; ++i)
+			{
+				lutest(buffer[i] >= -2.0f && buffer[i] < 3.0f);
+				sum += buffer[i];
+				++buckets[min((u32)(buffer[i] + 2.0f), 4u)];
+			}
+			memfree(buffer);
+			// The mean and distribution should be close to uniform.
+			f64 mean = sum / num_numbers;
+			lutest(mean > 0.45 && mean < 0.55);
+			for (u32 b : buckets)
+			{
+				lutest(b > num_numbers / 5 * 9 / 10 && b < num_numbers / 5 * 11 / 10);
+			}
+		}
+
+		{
+			// Bytes.
+			u8 bytes[1027] = {};
+			fill_random(bytes, 1027);
+			u32 zeros = 0;
+			for (u8 b : bytes)
+			{
+				if (!b) ++zeros;
+			}
+			lutest(zeros < 20);
+			lutest(random_guid() != random_guid());
+		}
+
+		{
+			// Every thread has its own sequence.
+			u64 values[8];
+			JobCounter counter;
+			for (u32 i = 0; i < 8; ++i)
+			{
+				dispatch_job([&values, i]() { values[i] = random_u64(); }, counter);
+			}
+			wait_for_counter(counter);
+			for (u32 i = 0; i < 8; ++i)
+			{
+				for (u32 j = i + 1; j < 8; ++j)
+				{
+					lutest(values[i] != values[j]);
+				}
+			}
+		}
+
+		random_benchmark();
+	}
+}
@@ -11,7 +11,12 @@
 namespace Luna
 {
 	void vfs_test();
+	void async_io_test();
 	void data_test();
+	void job_test();
+	void random_test();
+	void parallel_test();
+	void frame_pacing_test();
 }
 
 #define lutest luassert_always
\ No newline at end of file
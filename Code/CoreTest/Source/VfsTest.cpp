@@ -39,6 +39,57 @@ namespace Luna
 			str[13] = 0;
 			lutest(!strcmp(s, str));
 			file = nullptr;
+		}
+
+		{
+			// Map the file from vfs and from platform, the data should be the same as the written data.
+			auto mapped = map_file(u8"/Platform/SampleFile.txt", EFileMapHint::sequential).get();
+			lutest(mapped->size() == sizeof(s) - sizeof(char));
+			lutest(!memcmp(mapped->data(), s, mapped->size()));
+			auto platform_mapped = platform_map_file(u8"SampleFile.txt").get();
+			lutest(platform_mapped->size() == mapped->size());
+			lutest(!memcmp(platform_mapped->data(), s, platform_mapped->size()));
+			mapped = nullptr;
+			platform_mapped = nullptr;
+
+			// Empty files are mapped with no data.
+			auto file = platform_open_file(u8"EmptyFile.txt", EFileOpenFlag::write, EFileCreationMode::create_always).get();
+			file = nullptr;
+			auto empty_mapped = platform_map_file(u8"EmptyFile.txt").get();
+			lutest(empty_mapped->size() == 0);
+			lutest(empty_mapped->data() == nullptr);
+			empty_mapped = nullptr;
+			platform_delete_file(u8"EmptyFile.txt");
+		}
+
+		{
+			// Copy the file between two platform file systems, which is performed by the platform.
+			mount_platfrom_path(u8"/Platform2/", u8".");
+			lutest(succeeded(copy_file(u8"/Platform/SampleFile.txt", u8"/Platform2/SampleFileCopy.txt", true)));
+			lutest(copy_file(u8"/Platform/SampleFile.txt", u8"/Platform2/SampleFileCopy.txt", true).errcode() == BasicError::already_exists());
+			auto copied = platform_map_file(u8"SampleFileCopy.txt").get();
+			lutest(copied->size() == sizeof(s) - sizeof(char));
+			lutest(!memcmp(copied->data(), s, copied->size()));
+			copied = nullptr;
+			delete_file(u8"/Platform2/SampleFileCopy.txt");
+
+			// Virtual mounts are resolved to the platform file system they are mounted to.
+			mount_virtual_path(u8"/Virtual/", u8"/Platform/");
+			lutest(succeeded(copy_file(u8"/Virtual/SampleFile.txt", u8"/Platform2/SampleFileCopy.txt", true)));
+			copied = platform_map_file(u8"SampleFileCopy.txt").get();
+			lutest(copied->size() == sizeof(s) - sizeof(char));
+			lutest(!memcmp(copied->data(), s, copied->size()));
+			copied = nullptr;
+			lutest(succeeded(copy_file(u8"/Platform2/SampleFileCopy.txt", u8"/Virtual/SampleFileCopy2.txt", true)));
+			auto file = open_file(u8"/Platform/SampleFileCopy2.txt", EFileOpenFlag::read, EFileCreationMode::open_existing).get();
+			char str[32];
+			lutest(succeeded(file->read(str, sizeof(s) - sizeof(char))));
+			lutest(!memcmp(str, s, sizeof(s) - sizeof(char)));
+			file = nullptr;
+			delete_file(u8"/Platform2/SampleFileCopy.txt");
+			delete_file(u8"/Platform/SampleFileCopy2.txt");
+			unmount_fs(u8"/Virtual/");
+			unmount_fs(u8"/Platform2/");
 
 			// Clean up.
 			delete_file(u8"/Platform/SampleFile.txt");
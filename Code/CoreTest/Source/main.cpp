@@ -14,6 +14,11 @@ int main()
 
 	data_test();
 	vfs_test();
+	async_io_test();
+	job_test();
+	random_test();
+	parallel_test();
+	frame_pacing_test();
 
 	close();
 
@@ -7,6 +7,7 @@
 #include "DrawList.hpp"
 #include "EasyDraw.hpp"
 #include <Runtime/Unicode.hpp>
+#include <Runtime/InlineVector.hpp>
 
 namespace Luna
 {
@@ -174,15 +175,20 @@ namespace Luna
 				f32 row_adv = 0.0f;
 				f32 char_adv = 0.0f;
 				f32 max_char_adv = char_adv;
-				const char* cur_char = text;
-				while (*cur_char && (!region_size.y || (row_adv + row_gap) < region_size.y))
+				// Decode the whole string first so that the kerning lookup does not decode every char twice.
+				usize text_len = strlen(text);
+				InlineVector<c32, 256> chars;
+				chars.resize_for_overwrite(text_len);
+				usize num_chars = utf8_decode_span(chars.data(), chars.size(), text, text_len);
+				usize cur_char = 0;
+				while (cur_char < num_chars && (!region_size.y || (row_adv + row_gap) < region_size.y))
 				{
 					// The y value of the base line.
 					f32 row_ori = row_adv + ascent;
-					while (*cur_char && (!region_size.x || char_adv < region_size.x))
+					while (cur_char < num_chars && (!region_size.x || char_adv < region_size.x))
 					{
 						// Get information about the char.
-						char32_t c = utf8_decode_char(cur_char);
+						char32_t c = chars[cur_char];
 						Font::FontAtlasChar ch_info;
 						luexp(m_font->get_font_atlas()->get_char(c, ch_info));
 						if (region_size.x && (ch_info.size.x + ch_info.left_side_bearing + char_adv > region_size.x))
@@ -191,7 +197,7 @@ namespace Luna
 							break;
 						}
 						// advance char string.
-						cur_char += utf8_charspan(c);
+						++cur_char;
 						if (ch_info.size.x != 0.0f && ch_info.size.y != 0.0f)
 						{
 							/*
@@ -226,7 +232,7 @@ namespace Luna
 							draw_triangle_list(4, v, 6, indices);
 						}
 
-						char32_t nc = utf8_decode_char(cur_char);
+						char32_t nc = cur_char < num_chars ? chars[cur_char] : 0;
 						f32 kern;
 						if (nc)
 						{
@@ -246,7 +252,7 @@ namespace Luna
 				}
 				res.region_width = max_char_adv;
 				res.region_height = row_adv;
-				res.overflow = *cur_char ? true : false;
+				res.overflow = cur_char < num_chars;
 				set_sampler(&prior_sampler);
 				set_texture(prior_tex);
 			}
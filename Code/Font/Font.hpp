@@ -7,6 +7,7 @@
 #pragma once
 #include "IFontFile.hpp"
 #include "IFontAtlas.hpp"
+#include <Core/IMappedFile.hpp>
 
 #ifndef LUNA_FONT_API
 #define LUNA_FONT_API
@@ -31,6 +32,14 @@ namespace Luna
 		//! font data.
 		LUNA_FONT_API RP<IFontFile> load_font_file(const Blob& data, EFontFileFormat format);
 
+		//! Creates a font file object from one mapped font file. The font file object references the mapped data directly 
+		//! and keeps a reference to the mapped file, so the font data is not copied.
+		//! @param[in] file The mapped font file, see `platform_map_file` and `map_file`.
+		//! @param[in] format The file format of the data font.
+		//! @return If succeeded, returns the created font file object which is initialized using the
+		//! font data.
+		LUNA_FONT_API RP<IFontFile> load_font_file(IMappedFile* file, EFontFileFormat format);
+
 		//! Creates a new font atlas.
 		//! @param[in] fontfile The font file to use.
 		//! @param[in] font_index The index of the font in the font file to use.
@@ -8,6 +8,9 @@
 #include "RectPack/IRectPackContext.hpp"
 #include "../IFontFile.hpp"
 #include <Runtime/Unicode.hpp>
+#include <Runtime/Allocator.hpp>
+#include <Runtime/InlineVector.hpp>
+#include <Core/Parallel.hpp>
 
 namespace Luna
 {
@@ -69,35 +72,45 @@ namespace Luna
 			}
 		}
 
-		void FontAtlas::add_glyphs_from_string(const char* str)
+		//! Decodes the UTF-8 string in blocks and calls `func` for every Unicode character in the string.
+		template <typename _Func>
+		inline void for_each_utf8_char(const char* str, usize len, _Func&& func)
 		{
-			lucheck(str);
-			while (*str)
+			c32 buf[256];
+			usize i = 0;
+			while (i < len)
 			{
-				char32_t ch = utf8_decode_char(str);
-				str += utf8_charlen(str);
-				auto p = m_glyphs.insert(make_pair(ch, FontChar()));
-				if (p.second == true)
+				usize read;
+				usize n = utf8_decode_span(buf, 256, str + i, len - i, &read);
+				if (!n)
 				{
-					m_is_dirty = true;
+					// The string ends with one truncated char.
+					break;
+				}
+				for (usize j = 0; j < n; ++j)
+				{
+					func(buf[j]);
 				}
+				i += read;
 			}
 		}
 
+		void FontAtlas::add_glyphs_from_string(const char* str)
+		{
+			lucheck(str);
+			add_glyphs_from_lstring(str, strlen(str));
+		}
+
 		void FontAtlas::add_glyphs_from_lstring(const char* str, usize len)
 		{
-			usize i = 0;
-			while (i < len)
+			for_each_utf8_char(str, len, [this](c32 ch)
 			{
-				char32_t ch = utf8_decode_char(str);
-				i += utf8_charlen(str);
-				str += utf8_charlen(str);
 				auto p = m_glyphs.insert(make_pair(ch, FontChar()));
 				if (p.second == true)
 				{
 					m_is_dirty = true;
 				}
-			}
+			});
 		}
 
 		void FontAtlas::remove_glyph_ranges(u32 num_ranges, const FontAtlasRange* ranges)
@@ -118,32 +131,19 @@ namespace Luna
 
 		void FontAtlas::remove_glyphs_from_string(const char* str)
 		{
-			while (*str)
-			{
-				char32_t ch = utf8_decode_char(str);
-				str += utf8_charlen(str);
-				usize erased = m_glyphs.erase(ch);
-				if (erased)
-				{
-					m_is_dirty = true;
-				}
-			}
+			remove_glyphs_from_lstring(str, strlen(str));
 		}
 
 		void FontAtlas::remove_glyphs_from_lstring(const char* str, usize len)
 		{
-			usize i = 0;
-			while (i < len)
+			for_each_utf8_char(str, len, [this](c32 ch)
 			{
-				char32_t ch = utf8_decode_char(str);
-				i += utf8_charlen(str);
-				str += utf8_charlen(str);
 				usize erased = m_glyphs.erase(ch);
 				if (erased)
 				{
 					m_is_dirty = true;
 				}
-			}
+			});
 		}
 
 		void FontAtlas::render()
@@ -154,9 +154,11 @@ namespace Luna
 			{
 				return;
 			}
-			// Packing.
-			Vector<RectPack::PackRect> packs;
-			Vector<glyph_t> glyphs;
+			// Packing. The temporary arrays are freed all at once when `render` returns.
+			LinearArena arena(m_glyphs.size() * (sizeof(RectPack::PackRect) + sizeof(glyph_t)) + 256);
+			ArenaAllocator<LinearArena> alloc(arena);
+			Vector<RectPack::PackRect, ArenaAllocator<LinearArena>> packs(alloc);
+			Vector<glyph_t, ArenaAllocator<LinearArena>> glyphs(alloc);
 			packs.reserve(m_glyphs.size());
 			glyphs.reserve(m_glyphs.size());
 			f32 pixel_scale = m_font_file->scale_for_pixel_height(m_font_index, m_font_height * m_pixel_scale);
@@ -210,19 +212,18 @@ namespace Luna
 
 			memset(img->data().data(), 0, img->data().size());
 
-			for (u32 i = 0; i < (u32)m_glyphs.size(); ++i)
+			// Glyphs are rendered to different rects, so they can be rendered in parallel.
+			parallel_for(0, m_glyphs.size(), [&](usize i)
 			{
 				void* dest = pixel_offset(img->data().data(), packs[i].x + half_gap, packs[i].y + half_gap, 0,
 					1, img_desc.width * Image::size_per_pixel(img_desc.format), img->data().size());
 				m_font_file->render_glyph_bitmap(m_font_index, glyphs[i], dest,
 					packs[i].width - char_gap, packs[i].height - char_gap, img_desc.width * (u32)Image::size_per_pixel(img_desc.format), pixel_scale, pixel_scale, 0.0f, 0.0f);
-			}
-			glyphs.clear();
-			glyphs.shrink_to_fit();
+			});
 			// Copy the bitmap to RGBA format.
 			img_desc.format = Image::EImagePixelFormat::rgba8_unorm;
 			auto img_rgba = Image::new_image(img_desc);
-			for (u32 i = 0; i < tex_size; ++i)
+			parallel_for(0, tex_size, [&](usize i)
 			{
 				for (u32 j = 0; j < tex_size; ++j)
 				{
@@ -233,7 +234,7 @@ namespace Luna
 					dest[2] = 255;
 					dest[3] = src[0];
 				}
-			}
+			});
 			// free origin image early.
 			img = nullptr;
 
@@ -289,18 +290,17 @@ namespace Luna
 		f32 FontAtlas::get_line_width(const char* text, u32 num_chars, f32 spacing)
 		{
 			f32 char_adv = 0.0f;
-			const char* cur_char = text;
-			u32 char_index = 0;
-			while (*cur_char)
+			usize text_len = strlen(text);
+			InlineVector<c32, 256> chars;
+			chars.resize_for_overwrite(text_len);
+			usize count = utf8_decode_span(chars.data(), chars.size(), text, text_len);
+			if (num_chars)
 			{
-				if (num_chars && char_index >= num_chars)
-				{
-					break;
-				}
-				char32_t c = utf8_decode_char(cur_char);
-				// Advance string.
-				cur_char += utf8_charspan(c);
-				++char_index;
+				count = min<usize>(count, num_chars);
+			}
+			for (usize i = 0; i < count; ++i)
+			{
+				char32_t c = chars[i];
 				// Get char info.
 				FontAtlasChar ch_info;
 				if (!get_char(c, ch_info).valid())
@@ -311,10 +311,9 @@ namespace Luna
 						continue;
 					}
 				}
-				char32_t nc = utf8_decode_char(cur_char);
-				if (nc && (!num_chars || (char_index < num_chars)))
+				if (i + 1 < count)
 				{
-					f32 kern = get_kern_advance(c, nc);
+					f32 kern = get_kern_advance(c, chars[i + 1]);
 					char_adv += ch_info.advance_width + spacing + kern;
 				}
 				else
@@ -332,22 +331,24 @@ namespace Luna
 			f32 row_adv = 0.0f;
 			f32 char_adv = 0.0f;
 			*width = 0.0f;
-			const char* cur_char = text;
-			u32 char_index = 0;
+			usize text_len = strlen(text);
+			InlineVector<c32, 256> chars;
+			chars.resize_for_overwrite(text_len);
+			usize count = utf8_decode_span(chars.data(), chars.size(), text, text_len);
+			usize char_index = 0;
 			// for each line.
-			while (*cur_char)
+			while (char_index < count)
 			{
 				row_adv += row_gap;
-				while (*cur_char && char_adv < region_width)
+				while (char_index < count && char_adv < region_width)
 				{
 					if (num_chars && char_index >= num_chars)
 					{
 						// breaks directly.
 						goto end;
 					}
-					char32_t c = utf8_decode_char(cur_char);
+					char32_t c = chars[char_index];
 					// advance char string.
-					cur_char += utf8_charspan(c);
 					++char_index;
 					// Get char info.
 					FontAtlasChar ch_info;
@@ -365,11 +366,10 @@ namespace Luna
 						// Jump to next line.
 						break;
 					}
-					char32_t nc = utf8_decode_char(cur_char);
-					if (nc && (!num_chars || (char_index < num_chars)))
+					if (char_index < count && (!num_chars || (char_index < num_chars)))
 					{
 						f32 kern;
-						kern = get_kern_advance(c, nc);
+						kern = get_kern_advance(c, chars[char_index]);
 						char_adv += ch_info.advance_width + spacing_x + kern;
 					}
 					else
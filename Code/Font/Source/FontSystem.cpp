@@ -29,7 +29,7 @@ namespace Luna
 			return RV();
 		}
 		StaticRegisterModule m("Font", "Core;Gfx;Image;RectPack", init, deinit);
-		RP<IFontFile> load_font_file(const Blob& data, EFontFileFormat format)
+		static RP<IFontFile> load_font_file(Blob&& data, EFontFileFormat format)
 		{
 			switch (format)
 			{
@@ -38,7 +38,7 @@ namespace Luna
 				P<FontFileTTF> f = newobj<FontFileTTF>();
 				lutry
 				{
-					luexp(f->init(Blob(data)));
+					luexp(f->init(move(data)));
 				}
 				lucatchret;
 				return f;
@@ -49,6 +49,20 @@ namespace Luna
 			}
 			return BasicError::not_supported();
 		}
+		RP<IFontFile> load_font_file(const Blob& data, EFontFileFormat format)
+		{
+			return load_font_file(Blob(data), format);
+		}
+		static void release_mapped_file(void* userdata)
+		{
+			((IMappedFile*)userdata)->release();
+		}
+		RP<IFontFile> load_font_file(IMappedFile* file, EFontFileFormat format)
+		{
+			lucheck(file);
+			file->add_ref();
+			return load_font_file(Blob((void*)file->data(), file->size(), release_mapped_file, file), format);
+		}
 		RP<IFontAtlas> new_font_atlas(Font::IFontFile* fontfile, u32 font_index, f32 char_height)
 		{
 			P<FontAtlas> atlas = newobj<FontAtlas>();
@@ -15,6 +15,9 @@
 	max
 	swap
 	equal
+	insertion_sort
+	heap_sort
+	sort
 */
 
 namespace Luna
@@ -83,4 +86,174 @@ namespace Luna
 		}
 		return true;
 	}
+
+	namespace Impl
+	{
+		struct SortLess
+		{
+			template <typename _Ty>
+			constexpr bool operator()(const _Ty& lhs, const _Ty& rhs) const
+			{
+				return lhs < rhs;
+			}
+		};
+
+		template <typename _RandomIter, typename _LessComp>
+		inline void sift_down(_RandomIter first, isize root, isize size, _LessComp& less_comp)
+		{
+			while (true)
+			{
+				isize child = root * 2 + 1;
+				if (child >= size)
+				{
+					return;
+				}
+				if (child + 1 < size && less_comp(first[child], first[child + 1]))
+				{
+					++child;
+				}
+				if (!less_comp(first[root], first[child]))
+				{
+					return;
+				}
+				swap(first[root], first[child]);
+				root = child;
+			}
+		}
+	}
+
+	//! Sorts the range using insertion sort. This is fast for small or nearly sorted ranges.
+	template <typename _RandomIter, typename _LessComp>
+	inline void insertion_sort(_RandomIter first, _RandomIter last, _LessComp less_comp)
+	{
+		if (first == last)
+		{
+			return;
+		}
+		for (_RandomIter i = first + 1; i != last; ++i)
+		{
+			if (less_comp(*i, *first))
+			{
+				auto value = move(*i);
+				for (_RandomIter j = i; j != first; --j)
+				{
+					*j = move(*(j - 1));
+				}
+				*first = move(value);
+			}
+			else
+			{
+				auto value = move(*i);
+				_RandomIter j = i;
+				for (; less_comp(value, *(j - 1)); --j)
+				{
+					*j = move(*(j - 1));
+				}
+				*j = move(value);
+			}
+		}
+	}
+
+	//! Sorts the range using heap sort.
+	template <typename _RandomIter, typename _LessComp>
+	inline void heap_sort(_RandomIter first, _RandomIter last, _LessComp less_comp)
+	{
+		isize size = last - first;
+		for (isize i = size / 2 - 1; i >= 0; --i)
+		{
+			Impl::sift_down(first, i, size, less_comp);
+		}
+		for (isize i = size - 1; i > 0; --i)
+		{
+			swap(first[0], first[i]);
+			Impl::sift_down(first, 0, i, less_comp);
+		}
+	}
+
+	namespace Impl
+	{
+		//! Ranges with no more elements than this are sorted by insertion sort instead of being partitioned.
+		constexpr usize insertion_sort_threshold = 16;
+
+		//! Partitions the range around the median of the first, middle and last elements.
+		//! @return Returns the final position of the pivot. Elements before the pivot are not greater than the pivot,
+		//! and elements after the pivot are not less than the pivot.
+		//! @remark The range must contain at least 3 elements.
+		template <typename _RandomIter, typename _LessComp>
+		inline _RandomIter partition_median_of_three(_RandomIter first, _RandomIter last, _LessComp& less_comp)
+		{
+			_RandomIter mid = first + (last - first) / 2;
+			_RandomIter back = last - 1;
+			if (less_comp(*mid, *first)) swap(*mid, *first);
+			if (less_comp(*back, *mid))
+			{
+				swap(*back, *mid);
+				if (less_comp(*mid, *first)) swap(*mid, *first);
+			}
+			// Moves the pivot to `first`. `*back` is not less than the pivot, so the scans below never run out of the range.
+			swap(*first, *mid);
+			_RandomIter i = first;
+			_RandomIter j = last;
+			while (true)
+			{
+				do { ++i; } while (less_comp(*i, *first));
+				do { --j; } while (less_comp(*first, *j));
+				if (!(i < j))
+				{
+					break;
+				}
+				swap(*i, *j);
+			}
+			swap(*first, *j);
+			return j;
+		}
+
+		template <typename _RandomIter, typename _LessComp>
+		inline void intro_sort(_RandomIter first, _RandomIter last, u32 depth_limit, _LessComp& less_comp)
+		{
+			while ((usize)(last - first) > insertion_sort_threshold)
+			{
+				if (!depth_limit)
+				{
+					// Falls back to heap sort for adversarial inputs, so that the time complexity is always O(NlogN).
+					heap_sort(first, last, less_comp);
+					return;
+				}
+				--depth_limit;
+				_RandomIter j = partition_median_of_three(first, last, less_comp);
+				// Recurses into the smaller part and loops on the larger part to limit the stack depth.
+				if (j - first < last - j)
+				{
+					intro_sort(first, j, depth_limit, less_comp);
+					first = j + 1;
+				}
+				else
+				{
+					intro_sort(j + 1, last, depth_limit, less_comp);
+					last = j;
+				}
+			}
+			insertion_sort(first, last, less_comp);
+		}
+	}
+
+	//! Sorts the range in ascending order. The sort is not stable.
+	//! @remark This uses introsort: quick sort with one median-of-three pivot, switching to heap sort if the recursion is too deep
+	//! and to insertion sort for small ranges.
+	template <typename _RandomIter, typename _LessComp>
+	inline void sort(_RandomIter first, _RandomIter last, _LessComp less_comp)
+	{
+		u32 depth_limit = 0;
+		for (isize n = last - first; n > 1; n >>= 1)
+		{
+			depth_limit += 2;
+		}
+		Impl::intro_sort(first, last, depth_limit, less_comp);
+	}
+
+	template <typename _RandomIter>
+	inline void sort(_RandomIter first, _RandomIter last)
+	{
+		sort(first, last, Impl::SortLess());
+	}
 }
\ No newline at end of file
@@ -0,0 +1,382 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Allocator.hpp
+* @author JXMaster
+* @date 2021/6/10
+* @brief Allocators and arenas that can be used by Runtime containers.
+*/
+#pragma once
+#include "Memory.hpp"
+#include "Algorithm.hpp"
+#include "Assert.hpp"
+
+namespace Luna
+{
+	//! The default allocator used by all Runtime containers, which allocates memory from `memalloc`.
+	//!
+	//! Every allocator used by Runtime containers shall provide the following functions:
+	//! * `void* allocate(usize size, usize alignment = 0)` allocates one memory block.
+	//! * `void deallocate(void* ptr, usize size, usize alignment = 0)` frees one memory block allocated by `allocate`, `size` and `alignment`
+	//! must be the same as those specified in `allocate`.
+	//! * `bool operator==(const _Alloc& rhs) const` checks whether memory allocated from one allocator can be freed by another allocator.
+	//!
+	//! Allocators are stored by value in containers, so they shall be cheap to copy, and allocators without any data member do not
+	//! increase the size of the container.
+	struct Allocator
+	{
+		void* allocate(usize size, usize alignment = 0)
+		{
+			return memalloc(size, alignment);
+		}
+		void deallocate(void* ptr, usize size, usize alignment = 0)
+		{
+			(void)size;
+			memfree(ptr, alignment);
+		}
+		bool operator==(const Allocator&) const
+		{
+			return true;
+		}
+		bool operator!=(const Allocator&) const
+		{
+			return false;
+		}
+	};
+
+	//! A linear (bump) allocator that allocates memory by increasing one offset in one memory chunk.
+	//!
+	//! Memory blocks allocated from the arena cannot be freed individually, they are freed all at once
+	//! when `reset` is called or when the arena is destructed. This makes allocating temporary objects
+	//! much cheaper than allocating from the heap.
+	//!
+	//! The arena is not thread safe.
+	class LinearArena
+	{
+	private:
+		struct Chunk
+		{
+			Chunk* m_next;
+			usize m_size;	// The size of the chunk, including this header.
+		};
+		//! The current chunk. Other chunks are linked after this chunk.
+		Chunk* m_chunks;
+		//! The current allocation position in the current chunk.
+		u8* m_cur;
+		//! The end of the current chunk.
+		u8* m_end;
+		//! The default chunk size.
+		usize m_chunk_size;
+		//! The number of bytes allocated from this arena since last reset, including paddings.
+		usize m_allocated;
+
+		void* allocate_from_new_chunk(usize size, usize alignment)
+		{
+			usize chunk_size = max(m_chunk_size, align_upper(sizeof(Chunk), alignment) + size);
+			Chunk* chunk = (Chunk*)memalloc(chunk_size);
+			if (!chunk) return nullptr;
+			chunk->m_next = m_chunks;
+			chunk->m_size = chunk_size;
+			m_chunks = chunk;
+			m_cur = (u8*)(chunk + 1);
+			m_end = (u8*)chunk + chunk_size;
+			u8* r = (u8*)align_upper((usize)m_cur, alignment);
+			m_allocated += (r - m_cur) + size;
+			m_cur = r + size;
+			return r;
+		}
+		void free_chunks(Chunk* chunk)
+		{
+			while (chunk)
+			{
+				Chunk* next = chunk->m_next;
+				memfree(chunk);
+				chunk = next;
+			}
+		}
+	public:
+		//! @param[in] chunk_size The size of every memory chunk allocated from the heap. Allocations larger than
+		//! this size get one dedicated chunk.
+		explicit LinearArena(usize chunk_size = 64 * 1024) :
+			m_chunks(nullptr),
+			m_cur(nullptr),
+			m_end(nullptr),
+			m_chunk_size(chunk_size),
+			m_allocated(0) {}
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+		LinearArena(LinearArena&& rhs) :
+			m_chunks(rhs.m_chunks),
+			m_cur(rhs.m_cur),
+			m_end(rhs.m_end),
+			m_chunk_size(rhs.m_chunk_size),
+			m_allocated(rhs.m_allocated)
+		{
+			rhs.m_chunks = nullptr;
+			rhs.m_cur = nullptr;
+			rhs.m_end = nullptr;
+			rhs.m_allocated = 0;
+		}
+		LinearArena& operator=(LinearArena&& rhs)
+		{
+			free_chunks(m_chunks);
+			m_chunks = rhs.m_chunks;
+			m_cur = rhs.m_cur;
+			m_end = rhs.m_end;
+			m_chunk_size = rhs.m_chunk_size;
+			m_allocated = rhs.m_allocated;
+			rhs.m_chunks = nullptr;
+			rhs.m_cur = nullptr;
+			rhs.m_end = nullptr;
+			rhs.m_allocated = 0;
+			return *this;
+		}
+		~LinearArena()
+		{
+			free_chunks(m_chunks);
+		}
+		//! Allocates one memory block from the arena.
+		//! @param[in] size The size of the memory block.
+		//! @param[in] alignment The alignment of the memory block. If this is 0, the block is aligned to `max_align`.
+		void* allocate(usize size, usize alignment = 0)
+		{
+			if (!size) return nullptr;
+			alignment = alignment ? alignment : max_align;
+			u8* r = (u8*)align_upper((usize)m_cur, alignment);
+			if (m_cur && r + size <= m_end)
+			{
+				m_allocated += (r - m_cur) + size;
+				m_cur = r + size;
+				return r;
+			}
+			return allocate_from_new_chunk(size, alignment);
+		}
+		//! Does nothing, memory is freed when the arena is reset.
+		void deallocate(void* ptr, usize size, usize alignment = 0)
+		{
+			(void)ptr;
+			(void)size;
+			(void)alignment;
+		}
+		//! Frees all memory blocks allocated from the arena. If only one chunk is allocated, the chunk is kept for further
+		//! allocations. Otherwise, all chunks are returned to the heap and the next chunk is allocated with the total size
+		//! of them, so that the arena stops growing once it reaches the peak memory usage.
+		void reset()
+		{
+			if (m_chunks)
+			{
+				if (m_chunks->m_next)
+				{
+					usize total_size = 0;
+					for (Chunk* chunk = m_chunks; chunk; chunk = chunk->m_next)
+					{
+						total_size += chunk->m_size;
+					}
+					free_chunks(m_chunks);
+					m_chunks = nullptr;
+					m_cur = nullptr;
+					m_end = nullptr;
+					m_chunk_size = max(m_chunk_size, total_size);
+				}
+				else
+				{
+					m_cur = (u8*)(m_chunks + 1);
+					m_end = (u8*)m_chunks + m_chunks->m_size;
+				}
+			}
+			m_allocated = 0;
+		}
+		//! Gets the number of bytes allocated since last reset, including alignment paddings.
+		usize get_allocated_size() const
+		{
+			return m_allocated;
+		}
+	};
+
+	//! A set of linear arenas used for per-frame temporary allocations.
+	//!
+	//! The arena keeps `_NumFrames` linear arenas and allocates from one of them in every frame. When `new_frame` is called,
+	//! the arena switches to the next linear arena and resets it, so memory allocated in one frame stays valid until
+	//! `new_frame` is called `_NumFrames` times. Use 2 (the default) if the memory is only used in the current frame and the
+	//! next frame, use 3 if the memory is used by GPU commands that may be delayed by one more frame.
+	//!
+	//! The arena is not thread safe.
+	template <u32 _NumFrames = 2>
+	class FrameArena
+	{
+		static_assert(_NumFrames >= 1, "FrameArena needs at least one frame.");
+	private:
+		LinearArena m_arenas[_NumFrames];
+		u32 m_current;
+	public:
+		explicit FrameArena(usize chunk_size = 64 * 1024) :
+			m_current(0)
+		{
+			for (u32 i = 0; i < _NumFrames; ++i)
+			{
+				m_arenas[i] = LinearArena(chunk_size);
+			}
+		}
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		void* allocate(usize size, usize alignment = 0)
+		{
+			return m_arenas[m_current].allocate(size, alignment);
+		}
+		//! Does nothing, memory is freed when `new_frame` is called.
+		void deallocate(void* ptr, usize size, usize alignment = 0)
+		{
+			(void)ptr;
+			(void)size;
+			(void)alignment;
+		}
+		//! Starts a new frame and frees memory allocated `_NumFrames` frames ago.
+		void new_frame()
+		{
+			m_current = (m_current + 1) % _NumFrames;
+			m_arenas[m_current].reset();
+		}
+		//! Gets the number of bytes allocated in the current frame.
+		usize get_allocated_size() const
+		{
+			return m_arenas[m_current].get_allocated_size();
+		}
+	};
+
+	//! The allocator that allocates memory from one arena (like `LinearArena` or `FrameArena`), which can be passed to containers.
+	//! The arena must be valid when the allocator and the containers that use this allocator are alive.
+	//!
+	//! Since arenas free memory in batch, containers that use arena allocators need not be destructed if the elements are trivially destructible.
+	template <typename _Arena>
+	struct ArenaAllocator
+	{
+		_Arena* m_arena;
+
+		ArenaAllocator() :
+			m_arena(nullptr) {}
+		ArenaAllocator(_Arena& arena) :
+			m_arena(&arena) {}
+		void* allocate(usize size, usize alignment = 0)
+		{
+			luassert(m_arena);
+			return m_arena->allocate(size, alignment);
+		}
+		void deallocate(void* ptr, usize size, usize alignment = 0)
+		{
+			m_arena->deallocate(ptr, size, alignment);
+		}
+		bool operator==(const ArenaAllocator& rhs) const
+		{
+			return m_arena == rhs.m_arena;
+		}
+		bool operator!=(const ArenaAllocator& rhs) const
+		{
+			return m_arena != rhs.m_arena;
+		}
+	};
+
+	//! An allocator that allocates fixed-size objects from memory chunks and recycles freed objects using one free list.
+	//! Allocating and freeing objects from the pool are O(1) and never call into the heap except when the pool grows.
+	//!
+	//! The pool is not thread safe.
+	template <typename _Ty>
+	class PoolAllocator
+	{
+	private:
+		union Slot
+		{
+			Slot* m_next;
+			alignas(_Ty) u8 m_data[sizeof(_Ty)];
+		};
+		struct Chunk
+		{
+			Chunk* m_next;
+		};
+		Chunk* m_chunks;
+		Slot* m_free_list;
+		usize m_objects_per_chunk;
+		usize m_num_allocated;
+
+		static usize slot_offset()
+		{
+			return align_upper(sizeof(Chunk), alignof(Slot));
+		}
+		bool grow()
+		{
+			Chunk* chunk = (Chunk*)memalloc(slot_offset() + sizeof(Slot) * m_objects_per_chunk, alignof(Slot));
+			if (!chunk) return false;
+			chunk->m_next = m_chunks;
+			m_chunks = chunk;
+			Slot* slots = (Slot*)((u8*)chunk + slot_offset());
+			for (usize i = 0; i < m_objects_per_chunk; ++i)
+			{
+				slots[i].m_next = (i + 1 == m_objects_per_chunk) ? m_free_list : slots + i + 1;
+			}
+			m_free_list = slots;
+			return true;
+		}
+	public:
+		//! @param[in] objects_per_chunk The number of objects allocated every time the pool grows.
+		explicit PoolAllocator(usize objects_per_chunk = 64) :
+			m_chunks(nullptr),
+			m_free_list(nullptr),
+			m_objects_per_chunk(max<usize>(objects_per_chunk, 1)),
+			m_num_allocated(0) {}
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+		//! Frees all chunks. All objects must be freed before the pool is destructed.
+		~PoolAllocator()
+		{
+			luassert(!m_num_allocated);
+			while (m_chunks)
+			{
+				Chunk* next = m_chunks->m_next;
+				memfree(m_chunks, alignof(Slot));
+				m_chunks = next;
+			}
+		}
+		//! Allocates memory for one object. The object is not constructed.
+		_Ty* allocate()
+		{
+			if (!m_free_list && !grow())
+			{
+				return nullptr;
+			}
+			Slot* slot = m_free_list;
+			m_free_list = slot->m_next;
+			++m_num_allocated;
+			return (_Ty*)slot->m_data;
+		}
+		//! Frees memory for one object allocated by `allocate`. The object is not destructed.
+		void deallocate(_Ty* ptr)
+		{
+			if (!ptr) return;
+			Slot* slot = (Slot*)ptr;
+			slot->m_next = m_free_list;
+			m_free_list = slot;
+			--m_num_allocated;
+		}
+		//! Allocates and constructs one object.
+		template <typename... _Args>
+		_Ty* new_object(_Args&&... args)
+		{
+			_Ty* o = allocate();
+			if (o)
+			{
+				new (o) _Ty(forward<_Args>(args)...);
+			}
+			return o;
+		}
+		//! Destructs and frees one object created by `new_object`.
+		void delete_object(_Ty* o)
+		{
+			if (!o) return;
+			o->~_Ty();
+			deallocate(o);
+		}
+		//! Gets the number of objects that are currently allocated from the pool.
+		usize get_num_allocated() const
+		{
+			return m_num_allocated;
+		}
+	};
+}
@@ -9,7 +9,7 @@
 
 #if defined(LUNA_PLATFORM_WINDOWS)
 #include "Source/Platform/Windows/AtomicImpl.hpp"
-#elif defined(LUNA_PLATFORM_MACOS)
+#elif defined(LUNA_PLATFORM_POSIX)
 #include "Source/Platform/POSIX/AtomicImpl.hpp"
 #endif
 
@@ -65,4 +65,14 @@ namespace Luna
 	inline u64 atom_compare_exchange_u64(u64 volatile* dest, u64 exchange, u64 comperand);
 #endif
 	inline usize atom_compare_exchange_usize(usize volatile* dest, usize exchange, usize comperand);
+
+	//! Issues one full memory barrier. Memory reads and writes before this call cannot be reordered after this call, and
+	//! memory reads and writes after this call cannot be reordered before this call.
+	inline void atom_fence();
+	//! Issues one acquire barrier. Memory reads and writes after this call cannot be reordered before memory reads before 
+	//! this call.
+	inline void atom_fence_acquire();
+	//! Issues one release barrier. Memory reads and writes before this call cannot be reordered after memory writes after
+	//! this call.
+	inline void atom_fence_release();
 }
@@ -8,33 +8,78 @@
 #include "Memory.hpp"
 namespace Luna
 {
+	//! The function called when one blob that references external memory is destroyed.
+	//! @param[in] userdata The user data passed when the blob is created.
+	using blob_release_func_t = void(void* userdata);
+
 	//! @class Blob
 	//! Blob encapsulates one block of memory.
+	//! 
+	//! The memory is usually allocated by the blob, but the blob can also reference memory owned by other objects without
+	//! copying, like one region of one memory-mapped file. Copying such blob allocates a new block of memory and copies
+	//! the data.
 	class Blob
 	{
 		void* m_buffer;
 		usize m_size;
+		//! If not `nullptr`, `m_buffer` references external memory and this is called with `m_userdata` instead of
+		//! freeing `m_buffer`.
+		blob_release_func_t* m_release;
+		void* m_userdata;
+
+		void free_buffer()
+		{
+			if (m_release)
+			{
+				m_release(m_userdata);
+				m_release = nullptr;
+				m_userdata = nullptr;
+			}
+			else if (m_buffer)
+			{
+				memfree(m_buffer);
+			}
+			m_buffer = nullptr;
+		}
 	public:
 		//! Creates the blob object without allocating any data.
 		Blob() :
 			m_buffer(nullptr),
-			m_size(0) {}
+			m_size(0),
+			m_release(nullptr),
+			m_userdata(nullptr) {}
 		//! Creates the blob object and allocated the specified size of bytes.
 		Blob(usize sz) :
-			m_size(sz)
+			m_size(sz),
+			m_release(nullptr),
+			m_userdata(nullptr)
 		{
 			m_buffer = memalloc(sz);
 		}
 		//! Creates the blob object with initial data.
 		Blob(const void* blob_data, usize data_sz) :
-			m_size(data_sz)
+			m_size(data_sz),
+			m_release(nullptr),
+			m_userdata(nullptr)
 		{
 			m_buffer = memalloc(data_sz);
 			memcpy(m_buffer, blob_data, data_sz);
 		}
+		//! Creates the blob object that references external memory without copying.
+		//! @param[in] blob_data The memory to reference. The memory must be valid until `release` is called.
+		//! @param[in] data_sz The size of the memory in bytes.
+		//! @param[in] release The function called with `userdata` when the blob no longer references the memory.
+		//! @param[in] userdata The user data passed to `release`, usually the object that owns the memory.
+		Blob(void* blob_data, usize data_sz, blob_release_func_t* release, void* userdata) :
+			m_buffer(blob_data),
+			m_size(data_sz),
+			m_release(release),
+			m_userdata(userdata) {}
 		Blob(const Blob& rhs) :
+			m_buffer(nullptr),
 			m_size(rhs.m_size),
-			m_buffer(nullptr)
+			m_release(nullptr),
+			m_userdata(nullptr)
 		{
 			if (m_size)
 			{
@@ -43,19 +88,23 @@ namespace Luna
 			}
 		}
 		Blob(Blob&& rhs) :
+			m_buffer(rhs.m_buffer),
 			m_size(rhs.m_size),
-			m_buffer(rhs.m_buffer)
+			m_release(rhs.m_release),
+			m_userdata(rhs.m_userdata)
 		{
 			rhs.m_size = 0;
 			rhs.m_buffer = nullptr;
+			rhs.m_release = nullptr;
+			rhs.m_userdata = nullptr;
 		}
 		Blob& operator=(const Blob& rhs)
 		{
-			if (m_buffer)
+			if (this == &rhs)
 			{
-				memfree(m_buffer);
-				m_buffer = nullptr;
+				return *this;
 			}
+			free_buffer();
 			m_size = rhs.m_size;
 			if (m_size)
 			{
@@ -66,24 +115,24 @@ namespace Luna
 		}
 		Blob& operator=(Blob&& rhs)
 		{
-			if (m_buffer)
+			if (this == &rhs)
 			{
-				memfree(m_buffer);
-				m_buffer = nullptr;
+				return *this;
 			}
+			free_buffer();
 			m_size = rhs.m_size;
 			m_buffer = rhs.m_buffer;
+			m_release = rhs.m_release;
+			m_userdata = rhs.m_userdata;
 			rhs.m_size = 0;
 			rhs.m_buffer = nullptr;
+			rhs.m_release = nullptr;
+			rhs.m_userdata = nullptr;
 			return *this;
 		}
 		~Blob()
 		{
-			if (m_buffer)
-			{
-				memfree(m_buffer);
-				m_buffer = nullptr;
-			}
+			free_buffer();
 		}
 		const void* data() const
 		{
@@ -99,8 +148,24 @@ namespace Luna
 		}
 		void resize(usize sz)
 		{
-			m_buffer = memrealloc(m_buffer, sz);
+			if (m_release)
+			{
+				// External memory cannot be reallocated, copies the data to one new memory block.
+				void* buffer = memalloc(sz);
+				memcpy(buffer, m_buffer, m_size < sz ? m_size : sz);
+				free_buffer();
+				m_buffer = buffer;
+			}
+			else
+			{
+				m_buffer = memrealloc(m_buffer, sz);
+			}
 			m_size = sz;
 		}
+		//! Checks whether the blob references external memory, see `Blob(void*, usize, blob_release_func_t*, void*)`.
+		bool is_external() const
+		{
+			return m_release != nullptr;
+		}
 	};
 }
\ No newline at end of file
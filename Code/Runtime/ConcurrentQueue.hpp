@@ -0,0 +1,496 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file ConcurrentQueue.hpp
+* @author JXMaster
+* @date 2021/6/20
+* @brief Lock-free queues for passing elements between threads.
+*/
+#pragma once
+#include "Memory.hpp"
+#include "MemoryUtils.hpp"
+#include "Atomic.hpp"
+#include "Assert.hpp"
+
+namespace Luna
+{
+	//! The assumed cache line size. Indices written by producers and consumers are placed in different cache lines
+	//! to avoid false sharing.
+	constexpr usize concurrent_queue_cache_line_size = 64;
+
+	namespace ConcurrentQueueImpl
+	{
+		inline bool is_pow_of_two(usize v)
+		{
+			return v && !(v & (v - 1));
+		}
+	}
+
+	//! @class SPSCQueue
+	//! One bounded single-producer single-consumer ring queue.
+	//!
+	//! Only one thread can push elements and only one thread can pop elements at the same time. The producer and the
+	//! consumer only write their own index and read the index of the other side with memory barriers, so no atomic
+	//! read-modify-write operation is needed.
+	//! @remark The producer and the consumer can be different threads in different times, so long as the handoff between
+	//! threads is synchronized.
+	template <typename _Ty>
+	class SPSCQueue
+	{
+		_Ty* m_buffer;
+		usize m_mask;
+		u8 m_padding0[concurrent_queue_cache_line_size - sizeof(_Ty*) - sizeof(usize)];
+		// Written by the consumer.
+		volatile usize m_head;
+		//! The last `m_tail` read by the consumer.
+		usize m_cached_tail;
+		u8 m_padding1[concurrent_queue_cache_line_size - sizeof(usize) * 2];
+		// Written by the producer.
+		volatile usize m_tail;
+		//! The last `m_head` read by the producer.
+		usize m_cached_head;
+		u8 m_padding2[concurrent_queue_cache_line_size - sizeof(usize) * 2];
+
+		//! Gets the number of free slots that can be written by the producer. The index of the consumer is read only if
+		//! the cached index does not give enough slots.
+		usize producer_free_slots(usize tail, usize wanted)
+		{
+			usize cap = m_mask + 1;
+			usize n = cap - (tail - m_cached_head);
+			if (n < wanted)
+			{
+				m_cached_head = m_head;
+				// The consumer must finish reading the slot before the slot is reused.
+				atom_fence_acquire();
+				n = cap - (tail - m_cached_head);
+			}
+			return n < wanted ? n : wanted;
+		}
+		//! Gets the number of elements that can be read by the consumer.
+		usize consumer_ready_slots(usize head, usize wanted)
+		{
+			usize n = m_cached_tail - head;
+			if (n < wanted)
+			{
+				m_cached_tail = m_tail;
+				atom_fence_acquire();
+				n = m_cached_tail - head;
+			}
+			return n < wanted ? n : wanted;
+		}
+	public:
+		using value_type = _Ty;
+
+		//! @param[in] capacity The maximum number of elements in the queue. This must be a power of two.
+		SPSCQueue(usize capacity) :
+			m_mask(capacity - 1),
+			m_head(0),
+			m_cached_tail(0),
+			m_tail(0),
+			m_cached_head(0)
+		{
+			luassert(ConcurrentQueueImpl::is_pow_of_two(capacity));
+			m_buffer = (_Ty*)memalloc(sizeof(_Ty) * capacity, alignof(_Ty));
+		}
+		~SPSCQueue()
+		{
+			for (usize i = m_head; i != m_tail; ++i)
+			{
+				destruct(m_buffer + (i & m_mask));
+			}
+			memfree(m_buffer, alignof(_Ty));
+		}
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		usize capacity() const
+		{
+			return m_mask + 1;
+		}
+		//! Gets the approximate number of elements in the queue.
+		usize size() const
+		{
+			return m_tail - m_head;
+		}
+		bool empty() const
+		{
+			return m_tail == m_head;
+		}
+
+		//! Pushes one element to the queue. Only the producer thread can call this.
+		//! @return Returns `true` if the element is pushed, `false` if the queue is full.
+		template <typename _Val>
+		bool push(_Val&& val)
+		{
+			usize tail = m_tail;
+			if (!producer_free_slots(tail, 1))
+			{
+				return false;
+			}
+			new (m_buffer + (tail & m_mask)) _Ty(forward<_Val>(val));
+			atom_fence_release();
+			m_tail = tail + 1;
+			return true;
+		}
+		//! Pushes elements to the queue. Only the producer thread can call this.
+		//! @param[in] src The elements to push. Elements are copied to the queue.
+		//! @param[in] count The number of elements to push.
+		//! @return Returns the number of elements pushed, which may be less than `count` if the queue is full.
+		usize push_range(const _Ty* src, usize count)
+		{
+			usize tail = m_tail;
+			usize n = producer_free_slots(tail, count);
+			for (usize i = 0; i < n; ++i)
+			{
+				new (m_buffer + ((tail + i) & m_mask)) _Ty(src[i]);
+			}
+			// Publishes all elements with one barrier.
+			atom_fence_release();
+			m_tail = tail + n;
+			return n;
+		}
+		//! Pops one element from the queue. Only the consumer thread can call this.
+		//! @return Returns `true` if one element is popped, `false` if the queue is empty.
+		bool pop(_Ty& out)
+		{
+			usize head = m_head;
+			if (!consumer_ready_slots(head, 1))
+			{
+				return false;
+			}
+			_Ty* slot = m_buffer + (head & m_mask);
+			out = move(*slot);
+			destruct(slot);
+			atom_fence_release();
+			m_head = head + 1;
+			return true;
+		}
+		//! Pops elements from the queue. Only the consumer thread can call this.
+		//! @param[in] dst The buffer to move popped elements to. The buffer must contain constructed elements.
+		//! @param[in] max_count The maximum number of elements to pop.
+		//! @return Returns the number of elements popped.
+		usize pop_range(_Ty* dst, usize max_count)
+		{
+			usize head = m_head;
+			usize n = consumer_ready_slots(head, max_count);
+			for (usize i = 0; i < n; ++i)
+			{
+				_Ty* slot = m_buffer + ((head + i) & m_mask);
+				dst[i] = move(*slot);
+				destruct(slot);
+			}
+			atom_fence_release();
+			m_head = head + n;
+			return n;
+		}
+	};
+
+	//! @class MPMCQueue
+	//! One bounded multi-producer multi-consumer ring queue.
+	//!
+	//! Every slot stores one sequence number that tells which lap of producers or consumers can use the slot, so
+	//! producers and consumers only contend on their own index with one compare-and-swap, and never block each other.
+	//!
+	//! See: Dmitry Vyukov. Bounded MPMC queue. https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	template <typename _Ty>
+	class MPMCQueue
+	{
+		struct Cell
+		{
+			volatile usize m_seq;
+			alignas(_Ty) u8 m_data[sizeof(_Ty)];
+
+			_Ty* data()
+			{
+				return (_Ty*)m_data;
+			}
+		};
+
+		Cell* m_buffer;
+		usize m_mask;
+		u8 m_padding0[concurrent_queue_cache_line_size - sizeof(Cell*) - sizeof(usize)];
+		volatile usize m_enqueue_pos;
+		u8 m_padding1[concurrent_queue_cache_line_size - sizeof(usize)];
+		volatile usize m_dequeue_pos;
+		u8 m_padding2[concurrent_queue_cache_line_size - sizeof(usize)];
+
+		static isize diff(usize a, usize b)
+		{
+			return (isize)(a - b);
+		}
+
+		//! Claims at most `max_count` consecutive slots whose sequence numbers equal to `pos + i + offset`.
+		//! @param[in] index The index to claim slots from, `m_enqueue_pos` or `m_dequeue_pos`.
+		//! @param[in] offset 0 to claim free slots for producers, 1 to claim ready slots for consumers.
+		//! @param[out] out_pos Receives the first claimed position.
+		//! @return Returns the number of claimed slots, or 0 if no slot is available.
+		usize claim(volatile usize* index, usize offset, usize max_count, usize& out_pos)
+		{
+			usize pos = *index;
+			while (true)
+			{
+				Cell* cell = m_buffer + (pos & m_mask);
+				usize seq = cell->m_seq;
+				atom_fence_acquire();
+				isize d = diff(seq, pos + offset);
+				if (d == 0)
+				{
+					// The first slot is available, counts the following available slots. Slots that are available
+					// now cannot be taken by other threads until the index is moved past them.
+					usize n = 1;
+					while (n < max_count && n <= m_mask && m_buffer[(pos + n) & m_mask].m_seq == pos + n + offset)
+					{
+						++n;
+					}
+					usize prev = atom_compare_exchange_usize(index, pos + n, pos);
+					if (prev == pos)
+					{
+						atom_fence_acquire();
+						out_pos = pos;
+						return n;
+					}
+					pos = prev;
+				}
+				else if (d < 0)
+				{
+					// The queue is full (for producers) or empty (for consumers).
+					return 0;
+				}
+				else
+				{
+					// Another thread claimed the slot.
+					pos = *index;
+				}
+			}
+		}
+	public:
+		using value_type = _Ty;
+
+		//! @param[in] capacity The maximum number of elements in the queue. This must be a power of two and at least 2.
+		MPMCQueue(usize capacity) :
+			m_mask(capacity - 1),
+			m_enqueue_pos(0),
+			m_dequeue_pos(0)
+		{
+			luassert(capacity >= 2 && ConcurrentQueueImpl::is_pow_of_two(capacity));
+			m_buffer = (Cell*)memalloc(sizeof(Cell) * capacity, alignof(Cell));
+			for (usize i = 0; i < capacity; ++i)
+			{
+				m_buffer[i].m_seq = i;
+			}
+		}
+		~MPMCQueue()
+		{
+			for (usize i = m_dequeue_pos; i != m_enqueue_pos; ++i)
+			{
+				destruct(m_buffer[i & m_mask].data());
+			}
+			memfree(m_buffer, alignof(Cell));
+		}
+		MPMCQueue(const MPMCQueue&) = delete;
+		MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+		usize capacity() const
+		{
+			return m_mask + 1;
+		}
+		//! Gets the approximate number of elements in the queue.
+		usize size() const
+		{
+			isize d = diff(m_enqueue_pos, m_dequeue_pos);
+			return d > 0 ? (usize)d : 0;
+		}
+
+		//! Pushes one element to the queue.
+		//! @return Returns `true` if the element is pushed, `false` if the queue is full.
+		template <typename _Val>
+		bool push(_Val&& val)
+		{
+			usize pos;
+			if (!claim(&m_enqueue_pos, 0, 1, pos))
+			{
+				return false;
+			}
+			Cell* cell = m_buffer + (pos & m_mask);
+			new (cell->data()) _Ty(forward<_Val>(val));
+			atom_fence_release();
+			cell->m_seq = pos + 1;
+			return true;
+		}
+		//! Pushes elements to the queue. Consecutive slots are claimed with one compare-and-swap, so elements pushed in one
+		//! call are popped in order.
+		//! @return Returns the number of elements pushed, which may be less than `count` if the queue is full.
+		usize push_range(const _Ty* src, usize count)
+		{
+			usize pos;
+			usize n = count ? claim(&m_enqueue_pos, 0, count, pos) : 0;
+			for (usize i = 0; i < n; ++i)
+			{
+				Cell* cell = m_buffer + ((pos + i) & m_mask);
+				new (cell->data()) _Ty(src[i]);
+				atom_fence_release();
+				cell->m_seq = pos + i + 1;
+			}
+			return n;
+		}
+		//! Pops one element from the queue.
+		//! @return Returns `true` if one element is popped, `false` if the queue is empty.
+		bool pop(_Ty& out)
+		{
+			usize pos;
+			if (!claim(&m_dequeue_pos, 1, 1, pos))
+			{
+				return false;
+			}
+			Cell* cell = m_buffer + (pos & m_mask);
+			out = move(*cell->data());
+			destruct(cell->data());
+			atom_fence_release();
+			cell->m_seq = pos + m_mask + 1;
+			return true;
+		}
+		//! Pops elements from the queue.
+		//! @param[in] dst The buffer to move popped elements to. The buffer must contain constructed elements.
+		//! @return Returns the number of elements popped.
+		usize pop_range(_Ty* dst, usize max_count)
+		{
+			usize pos;
+			usize n = max_count ? claim(&m_dequeue_pos, 1, max_count, pos) : 0;
+			for (usize i = 0; i < n; ++i)
+			{
+				Cell* cell = m_buffer + ((pos + i) & m_mask);
+				dst[i] = move(*cell->data());
+				destruct(cell->data());
+				atom_fence_release();
+				cell->m_seq = pos + i + m_mask + 1;
+			}
+			return n;
+		}
+	};
+
+	//! The node header of elements that can be pushed to `MPSCQueue`.
+	struct MPSCQueueNode
+	{
+		MPSCQueueNode* volatile m_next;
+	};
+
+	//! @class MPSCQueue
+	//! One unbounded intrusive multi-producer single-consumer queue.
+	//!
+	//! Elements are linked by the `MPSCQueueNode` header and are not copied or allocated by the queue, so `_Ty` must
+	//! derive from `MPSCQueueNode`. Pushing takes one atomic exchange and never fails, popping does not use atomic
+	//! operations in most cases.
+	//!
+	//! See: Dmitry Vyukov. Intrusive MPSC node-based queue. https://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+	//! @remark `pop` may return `nullptr` if one producer is in the middle of pushing one element, even if other
+	//! elements have been pushed after that element, the consumer should try again later in such case.
+	//! The queue object cannot be moved, since the queue contains one stub node that is linked with other nodes.
+	template <typename _Ty>
+	class MPSCQueue
+	{
+		// Written by producers.
+		MPSCQueueNode* volatile m_head;
+		u8 m_padding0[concurrent_queue_cache_line_size - sizeof(MPSCQueueNode*)];
+		// Only used by the consumer.
+		MPSCQueueNode* m_tail;
+		MPSCQueueNode m_stub;
+
+		void push_node_list(MPSCQueueNode* first, MPSCQueueNode* last)
+		{
+			last->m_next = nullptr;
+			// The nodes must be written before they are published to the consumer.
+			atom_fence_release();
+			MPSCQueueNode* prev = (MPSCQueueNode*)atom_exchange_pointer((void* volatile*)&m_head, last);
+			// The consumer cannot see nodes after `prev` until this is set.
+			prev->m_next = first;
+		}
+	public:
+		using value_type = _Ty;
+
+		MPSCQueue() :
+			m_head(&m_stub),
+			m_tail(&m_stub)
+		{
+			m_stub.m_next = nullptr;
+		}
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+		//! Pushes one element to the queue. Any thread can call this.
+		void push(_Ty* node)
+		{
+			push_node_list(node, node);
+		}
+		//! Pushes elements to the queue with one atomic operation. Any thread can call this.
+		//! @param[in] nodes The elements to push. Elements are popped in the same order as they are in the array.
+		//! @param[in] count The number of elements to push.
+		void push_range(_Ty* const* nodes, usize count)
+		{
+			if (!count) return;
+			for (usize i = 0; i + 1 < count; ++i)
+			{
+				static_cast<MPSCQueueNode*>(nodes[i])->m_next = nodes[i + 1];
+			}
+			push_node_list(nodes[0], nodes[count - 1]);
+		}
+		//! Pops one element from the queue. Only the consumer thread can call this.
+		//! @return Returns the popped element, or `nullptr` if the queue is empty or one producer has not finished pushing
+		//! the next element.
+		_Ty* pop()
+		{
+			MPSCQueueNode* tail = m_tail;
+			MPSCQueueNode* next = tail->m_next;
+			atom_fence_acquire();
+			if (tail == &m_stub)
+			{
+				if (!next)
+				{
+					return nullptr;
+				}
+				// Skips the stub node.
+				m_tail = next;
+				tail = next;
+				next = next->m_next;
+				atom_fence_acquire();
+			}
+			if (next)
+			{
+				m_tail = next;
+				return static_cast<_Ty*>(tail);
+			}
+			if (tail != m_head)
+			{
+				// One producer has exchanged the head but has not linked the node yet.
+				return nullptr;
+			}
+			// `tail` is the last node, pushes the stub node back so that `tail` can be detached from the queue.
+			push_node_list(&m_stub, &m_stub);
+			next = tail->m_next;
+			atom_fence_acquire();
+			if (next)
+			{
+				m_tail = next;
+				return static_cast<_Ty*>(tail);
+			}
+			return nullptr;
+		}
+		//! Pops elements from the queue. Only the consumer thread can call this.
+		//! @return Returns the number of elements popped.
+		usize pop_range(_Ty** dst, usize max_count)
+		{
+			usize n = 0;
+			while (n < max_count)
+			{
+				_Ty* node = pop();
+				if (!node) break;
+				dst[n++] = node;
+			}
+			return n;
+		}
+		//! Checks whether the queue is empty. Only the consumer thread can call this. The queue may be reported as empty
+		//! if one producer has not finished pushing.
+		bool empty() const
+		{
+			return m_tail == &m_stub && !m_stub.m_next;
+		}
+	};
+}
@@ -0,0 +1,186 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FlatHashSet.hpp
+* @author JXMaster
+* @date 2021/6/5
+*/
+#pragma once
+#include "Source/FlatHashTable.hpp"
+
+namespace Luna
+{
+	//! An open-addressing hash set that stores elements inline in one slot array.
+	//! 
+	//! `FlatHashSet` has the same interface as `HashSet` except for the bucket and node interfaces, and is faster for
+	//! insertions, lookups and iterations since no per-element memory allocation is performed. The differences are:
+	//! 1. Inserting elements may relocate all elements in the set, which invalidates all iterators, pointers and references
+	//! to the elements. Use `HashSet` if the element address must be stable.
+	//! 2. Erasing elements only invalidates iterators, pointers and references to the erased element.
+	//! 3. The maximum load factor is fixed to 0.875.
+	template <
+		typename _Kty,
+		typename _Hash = hash<_Kty>,		// Used to hash the key value.
+		typename _KeyEqual = equal_to<_Kty>>	// Used to compare the element.
+	class FlatHashSet
+	{
+	public:
+		using key_type = _Kty;
+		using value_type = _Kty;
+		using hasher = _Hash;
+		using key_equal = _KeyEqual;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+		using iterator = FlatHashTableImpl::Iterator<value_type, false>;
+		using const_iterator = FlatHashTableImpl::Iterator<value_type, true>;
+
+	private:
+
+		using table_type = FlatHashTableImpl::FlatHashTable<key_type, value_type, HashTableImpl::SetExtractKey<key_type, value_type>, hasher, key_equal>;
+
+		table_type m_base;
+
+	public:
+
+		FlatHashSet() :
+			m_base() {}
+		FlatHashSet(const FlatHashSet& rhs) :
+			m_base(rhs.m_base) {}
+		FlatHashSet(FlatHashSet&& rhs) :
+			m_base(move(rhs.m_base)) {}
+		FlatHashSet& operator=(const FlatHashSet& rhs)
+		{
+			m_base = rhs.m_base;
+			return *this;
+		}
+		FlatHashSet& operator=(FlatHashSet&& rhs)
+		{
+			m_base = move(rhs.m_base);
+			return *this;
+		}
+	public:
+
+		iterator begin()
+		{
+			return m_base.begin();
+		}
+		const_iterator begin() const
+		{
+			return m_base.begin();
+		}
+		const_iterator cbegin() const
+		{
+			return m_base.cbegin();
+		}
+		iterator end()
+		{
+			return m_base.end();
+		}
+		const_iterator end() const
+		{
+			return m_base.end();
+		}
+		const_iterator cend() const
+		{
+			return m_base.cend();
+		}
+		bool empty() const
+		{
+			return m_base.empty();
+		}
+		usize size() const
+		{
+			return m_base.size();
+		}
+		//! Gets the number of slots in the set.
+		usize bucket_count() const
+		{
+			return m_base.bucket_count();
+		}
+		//! Gets the number of elements the set can hold before next rehash.
+		usize capacity() const
+		{
+			return m_base.capacity();
+		}
+		f32 load_factor() const
+		{
+			return m_base.load_factor();
+		}
+		f32 max_load_factor() const
+		{
+			return m_base.max_load_factor();
+		}
+		void clear()
+		{
+			m_base.clear();
+		}
+		hasher hash_function() const
+		{
+			return m_base.hash_function();
+		}
+		key_equal key_eq() const
+		{
+			return m_base.key_eq();
+		}
+		void rehash(usize new_buckets_count)
+		{
+			m_base.rehash(new_buckets_count);
+		}
+		void reserve(usize new_cap)
+		{
+			m_base.reserve(new_cap);
+		}
+		iterator find(const key_type& key)
+		{
+			return m_base.find(key);
+		}
+		const_iterator find(const key_type& key) const
+		{
+			return m_base.find(key);
+		}
+		usize count(const key_type& key) const
+		{
+			return m_base.count(key);
+		}
+		Pair<iterator, iterator> equal_range(const key_type& key)
+		{
+			return m_base.equal_range(key);
+		}
+		Pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+		{
+			return m_base.equal_range(key);
+		}
+		bool contains(const key_type& key) const
+		{
+			return m_base.contains(key);
+		}
+		Pair<iterator, bool> insert(const value_type& value)
+		{
+			return m_base.insert(value);
+		}
+		Pair<iterator, bool> insert(value_type&& value)
+		{
+			return m_base.insert(move(value));
+		}
+		template <typename... _Args>
+		Pair<iterator, bool> emplace(_Args&&... args)
+		{
+			return m_base.emplace(forward<_Args>(args)...);
+		}
+		iterator erase(const_iterator pos)
+		{
+			return m_base.erase(pos);
+		}
+		usize erase(const key_type& key)
+		{
+			return m_base.erase(key);
+		}
+		void swap(FlatHashSet& rhs)
+		{
+			FlatHashSet tmp(move(rhs));
+			rhs = move(*this);
+			*this = move(tmp);
+		}
+	};
+}
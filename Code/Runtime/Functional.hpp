@@ -105,7 +105,7 @@ namespace Luna
 	{
 		usize operator()(const c8* p) const
 		{
-			return strhash<usize>(p);
+			return (usize)strwyhash(p);
 		}
 	};
 
@@ -113,7 +113,7 @@ namespace Luna
 	{
 		usize operator()(const c8* p) const
 		{
-			return strhash<usize>(p);
+			return (usize)strwyhash(p);
 		}
 	};
 
@@ -6,6 +6,15 @@
 */
 #pragma once
 #include "Base.hpp"
+
+#ifndef LUNA_RUNTIME_API
+#define LUNA_RUNTIME_API
+#endif
+
+#if defined(LUNA_COMPILER_MSVC) && defined(LUNA_PLATFORM_X86_64)
+#include <intrin.h>
+#endif
+
 namespace Luna
 {
 	// hash library.
@@ -83,6 +92,9 @@ namespace Luna
 	//! `memhash` is the basic hash function that uses crc32 hash algorithm to hash 
 	//! any kind of binary data stream to a single hash value. The value may be `uint32`, 
 	//! `uint64` or `size_t`.
+	//! 
+	//! `memhash` processes one byte per iteration and can be evaluated at compile time. For hashing at run time, prefer
+	//! `wyhash` for hash tables and identifiers, and `crc32c` for checksums.
 	//! @param[in] data A pointer to the data to be hashed.
 	//! @param[in] size The length of the data in bytes.
 	//! @param[in] h A initial hash value. If this is a new hash, set to 0 (which
@@ -142,4 +154,130 @@ namespace Luna
 	{
 		return strhash<u64>(s, h);
 	}
+
+	//! Computes the CRC32C (Castagnoli) checksum of the specified data.
+	//! This call uses the hardware CRC32 instructions (SSE4.2 on x86/x64 and CRC32 extension on ARM64) if they are
+	//! supported by the CPU, and falls back to one table-driven software implementation otherwise. The result is
+	//! always the same for the same data no matter which implementation is used.
+	//! @param[in] data A pointer to the data to be hashed.
+	//! @param[in] size The length of the data in bytes.
+	//! @param[in] h The checksum of the previous data block if the data is hashed in multiple calls. Specify 0 for the first block.
+	//! @return Returns the checksum value.
+	LUNA_RUNTIME_API u32 crc32c(const void* data, usize size, u32 h = 0);
+
+	namespace Impl
+	{
+		constexpr u64 wyhash_secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+		inline void wyhash_mum(u64* a, u64* b)
+		{
+#if defined(__SIZEOF_INT128__)
+			__uint128_t r = *a;
+			r *= *b;
+			*a = (u64)r;
+			*b = (u64)(r >> 64);
+#elif defined(LUNA_COMPILER_MSVC) && defined(LUNA_PLATFORM_X86_64)
+			*a = _umul128(*a, *b, b);
+#else
+			u64 ha = *a >> 32, hb = *b >> 32, la = (u32)*a, lb = (u32)*b;
+			u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+			u64 lo = t + (rm1 << 32);
+			c += lo < t;
+			u64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+			*a = lo;
+			*b = hi;
+#endif
+		}
+		inline u64 wyhash_mix(u64 a, u64 b)
+		{
+			wyhash_mum(&a, &b);
+			return a ^ b;
+		}
+		inline u64 wyhash_read8(const u8* p)
+		{
+			u64 v;
+			memcpy(&v, p, 8);
+			return v;
+		}
+		inline u64 wyhash_read4(const u8* p)
+		{
+			u32 v;
+			memcpy(&v, p, 4);
+			return v;
+		}
+		inline u64 wyhash_read3(const u8* p, usize k)
+		{
+			return (((u64)p[0]) << 16) | (((u64)p[k >> 1]) << 8) | p[k - 1];
+		}
+	}
+
+	//! Hashes the specified data using the wyhash algorithm.
+	//! 
+	//! wyhash is one non-cryptographic hash function that consumes the data 8 or 16 bytes at a time using 64-bit multiplications, 
+	//! which is much faster than `memhash` for both short strings and large data blocks, and gives good 64-bit distribution. 
+	//! Prefer this for hashing data at run time, and use `memhash` only when the hash needs to be computed at compile time.
+	//! The result is stable between processes and platforms with the same endianness.
+	//! @param[in] data A pointer to the data to be hashed.
+	//! @param[in] size The length of the data in bytes.
+	//! @param[in] seed The seed value. Different seeds produce different hash values for the same data.
+	//! @return Returns the hashed value.
+	inline u64 wyhash(const void* data, usize size, u64 seed = 0)
+	{
+		using namespace Impl;
+		const u8* p = (const u8*)data;
+		seed ^= wyhash_mix(seed ^ wyhash_secret[0], wyhash_secret[1]);
+		u64 a, b;
+		if (size <= 16)
+		{
+			if (size >= 4)
+			{
+				a = (wyhash_read4(p) << 32) | wyhash_read4(p + ((size >> 3) << 2));
+				b = (wyhash_read4(p + size - 4) << 32) | wyhash_read4(p + size - 4 - ((size >> 3) << 2));
+			}
+			else if (size > 0)
+			{
+				a = wyhash_read3(p, size);
+				b = 0;
+			}
+			else
+			{
+				a = b = 0;
+			}
+		}
+		else
+		{
+			usize i = size;
+			if (i > 48)
+			{
+				u64 see1 = seed, see2 = seed;
+				do
+				{
+					seed = wyhash_mix(wyhash_read8(p) ^ wyhash_secret[1], wyhash_read8(p + 8) ^ seed);
+					see1 = wyhash_mix(wyhash_read8(p + 16) ^ wyhash_secret[2], wyhash_read8(p + 24) ^ see1);
+					see2 = wyhash_mix(wyhash_read8(p + 32) ^ wyhash_secret[3], wyhash_read8(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i > 48);
+				seed ^= see1 ^ see2;
+			}
+			while (i > 16)
+			{
+				seed = wyhash_mix(wyhash_read8(p) ^ wyhash_secret[1], wyhash_read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = wyhash_read8(p + i - 16);
+			b = wyhash_read8(p + i - 8);
+		}
+		a ^= wyhash_secret[1];
+		b ^= seed;
+		wyhash_mum(&a, &b);
+		return wyhash_mix(a ^ wyhash_secret[0] ^ size, b ^ wyhash_secret[1]);
+	}
+
+	//! Same as `wyhash`, but accepts a null-terminated string as input.
+	inline u64 strwyhash(const c8* s, u64 seed = 0)
+	{
+		return wyhash(s, strlen(s), seed);
+	}
 }
\ No newline at end of file
@@ -13,7 +13,8 @@ namespace Luna
 		typename _Kty,
 		typename _Ty,
 		typename _Hash = hash<_Kty>,		// Used to hash the key value.
-		typename _KeyEqual = equal_to<_Kty>>	// Used to compare the element.
+		typename _KeyEqual = equal_to<_Kty>,	// Used to compare the element.
+		typename _Alloc = Allocator>		// Used to allocate nodes and buckets.
 	class HashMap
 	{
 	public:
@@ -22,6 +23,7 @@ namespace Luna
 		using value_type = Pair<const _Kty, _Ty>;
 		using hasher = _Hash;
 		using key_equal = _KeyEqual;
+		using allocator_type = _Alloc;
 		using reference = value_type&;
 		using const_reference = const value_type&;
 		using pointer = value_type*;
@@ -35,7 +37,7 @@ namespace Luna
 
 	private:
 
-		using table_type = HashTableImpl::HashTable<key_type, value_type, HashTableImpl::MapExtractKey<key_type, value_type>, hasher, key_equal>;
+		using table_type = HashTableImpl::HashTable<key_type, value_type, HashTableImpl::MapExtractKey<key_type, value_type>, hasher, key_equal, allocator_type>;
 
 		table_type m_base;
 
@@ -46,6 +48,8 @@ namespace Luna
 
 		HashMap() :
 			m_base() {}
+		explicit HashMap(const allocator_type& alloc) :
+			m_base(alloc) {}
 		HashMap(const HashMap& rhs) :
 			m_base(rhs.m_base) {}
 		HashMap(HashMap&& rhs) :
@@ -151,6 +155,10 @@ namespace Luna
 		{
 			return m_base.key_eq();
 		}
+		allocator_type get_allocator() const
+		{
+			return m_base.get_allocator();
+		}
 		void rehash(usize new_buckets_count)
 		{
 			m_base.rehash(new_buckets_count);
@@ -12,7 +12,8 @@ namespace Luna
 	template <
 		typename _Kty,
 		typename _Hash = hash<_Kty>,		// Used to hash the key value.
-		typename _KeyEqual = equal_to<_Kty>>	// Used to compare the element.
+		typename _KeyEqual = equal_to<_Kty>,	// Used to compare the element.
+		typename _Alloc = Allocator>		// Used to allocate nodes and buckets.
 	class HashSet
 	{
 	public:
@@ -20,6 +21,7 @@ namespace Luna
 		using value_type = _Kty;
 		using hasher = _Hash;
 		using key_equal = _KeyEqual;
+		using allocator_type = _Alloc;
 		using reference = value_type&;
 		using const_reference = const value_type&;
 		using pointer = value_type*;
@@ -33,7 +35,7 @@ namespace Luna
 
 	private:
 
-		using table_type = HashTableImpl::HashTable<key_type, value_type, HashTableImpl::SetExtractKey<key_type, value_type>, hasher, key_equal>;
+		using table_type = HashTableImpl::HashTable<key_type, value_type, HashTableImpl::SetExtractKey<key_type, value_type>, hasher, key_equal, allocator_type>;
 
 		table_type m_base;
 
@@ -44,6 +46,8 @@ namespace Luna
 
 		HashSet() :
 			m_base() {}
+		explicit HashSet(const allocator_type& alloc) :
+			m_base(alloc) {}
 		HashSet(const HashSet& rhs) :
 			m_base(rhs.m_base) {}
 		HashSet(HashSet&& rhs) :
@@ -149,6 +153,10 @@ namespace Luna
 		{
 			return m_base.key_eq();
 		}
+		allocator_type get_allocator() const
+		{
+			return m_base.get_allocator();
+		}
 		void rehash(usize new_buckets_count)
 		{
 			m_base.rehash(new_buckets_count);
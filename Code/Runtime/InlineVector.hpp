@@ -0,0 +1,529 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file InlineVector.hpp
+* @author JXMaster
+* @date 2021/6/14
+*/
+#pragma once
+#include "Memory.hpp"
+#include "Algorithm.hpp"
+#include "Iterator.hpp"
+#include "Assert.hpp"
+#include "Allocator.hpp"
+
+namespace Luna
+{
+	//! @class InlineVector
+	//! InlineVector is a vector that stores the first `_N` elements in the vector object directly, and allocates memory from
+	//! the allocator only when the number of elements exceeds `_N`.
+	//! @remark Use this for small arrays whose size is usually known to be small, like the component list of one entity. The vector
+	//! does not hold a pointer to itself, so it is trivially relocatable if the element type is trivially relocatable.
+	//!
+	//! The vector stores the elements in place when the capacity equals to `_N`, and stores the elements in the heap
+	//! otherwise. The capacity is never smaller than `_N`.
+	template <typename _Ty, usize _N, typename _Alloc = Allocator>
+	class InlineVector : private _Alloc
+	{
+		static_assert(_N > 0, "The inline capacity of InlineVector must be greater than 0.");
+	private:
+		usize m_size;			// Number of elements in the vector.
+		usize m_capacity;		// Number of elements that can be included in the buffer before a reallocation is needed.
+		union
+		{
+			_Ty* m_heap;		// The memory buffer if the elements are stored in the heap.
+			alignas(_Ty) u8 m_inline[sizeof(_Ty) * _N];
+		};
+
+		bool is_heap() const
+		{
+			return m_capacity > _N;
+		}
+		_Ty* get_buffer()
+		{
+			return is_heap() ? m_heap : (_Ty*)m_inline;
+		}
+		const _Ty* get_buffer() const
+		{
+			return is_heap() ? m_heap : (const _Ty*)m_inline;
+		}
+		// Destructs all elements and frees all dynamic memory.
+		void free_buffer()
+		{
+			destruct_range(begin(), end());
+			if (is_heap())
+			{
+				_Alloc::deallocate(m_heap, sizeof(_Ty) * m_capacity, alignof(_Ty));
+			}
+			m_size = 0;
+			m_capacity = _N;
+		}
+		// Relocates all elements from `rhs` to this vector. This vector must be empty and must not have dynamic memory.
+		void internal_steal(InlineVector& rhs)
+		{
+			if (rhs.is_heap())
+			{
+				m_heap = rhs.m_heap;
+				m_capacity = rhs.m_capacity;
+			}
+			else
+			{
+				copy_relocate_range(rhs.begin(), rhs.end(), (_Ty*)m_inline);
+			}
+			m_size = rhs.m_size;
+			rhs.m_size = 0;
+			rhs.m_capacity = _N;
+		}
+		void internal_expand_reserve(usize new_least_cap)
+		{
+			if (new_least_cap > m_capacity)
+			{
+				reserve(max(new_least_cap, m_capacity * 2));	// Double the size by default.
+			}
+		}
+		// Moves the elements after `index` backward to make a gap of `count` uninitialized elements, and returns the
+		// pointer to the first element of the gap. The size is increased by `count`.
+		_Ty* internal_insert_gap(usize index, usize count)
+		{
+			luassert(index <= m_size);
+			internal_expand_reserve(m_size + count);
+			_Ty* buf = get_buffer();
+			if (index != m_size)
+			{
+				move_relocate_range_backward(buf + index, buf + m_size, buf + m_size + count);
+			}
+			m_size += count;
+			return buf + index;
+		}
+
+	public:
+
+		using value_type = _Ty;
+		using allocator_type = _Alloc;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+		using iterator = pointer;
+		using const_iterator = const_pointer;
+		using reverse_iterator = ReverseIterator<iterator>;
+		using const_reverse_iterator = ReverseIterator<const_iterator>;
+
+		//! The number of elements that can be stored without allocating memory.
+		static constexpr usize inline_capacity = _N;
+
+		InlineVector() :
+			m_size(0),
+			m_capacity(_N) {}
+		explicit InlineVector(const allocator_type& alloc) :
+			_Alloc(alloc),
+			m_size(0),
+			m_capacity(_N) {}
+		InlineVector(usize count, const value_type& value, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
+			m_size(0),
+			m_capacity(_N)
+		{
+			reserve(count);
+			fill_construct_range(get_buffer(), get_buffer() + count, value);
+			m_size = count;
+		}
+		InlineVector(usize count, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
+			m_size(0),
+			m_capacity(_N)
+		{
+			reserve(count);
+			default_construct_range(get_buffer(), get_buffer() + count);
+			m_size = count;
+		}
+		InlineVector(const InlineVector& rhs) :
+			_Alloc(rhs.get_allocator()),
+			m_size(0),
+			m_capacity(_N)
+		{
+			reserve(rhs.m_size);
+			copy_construct_range(rhs.begin(), rhs.end(), get_buffer());
+			m_size = rhs.m_size;
+		}
+		InlineVector(InlineVector&& rhs) :
+			_Alloc(rhs.get_allocator()),
+			m_size(0),
+			m_capacity(_N)
+		{
+			internal_steal(rhs);
+		}
+		InlineVector(InitializerList<value_type> init, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
+			m_size(0),
+			m_capacity(_N)
+		{
+			reserve(init.size());
+			copy_construct_range(init.begin(), init.end(), get_buffer());
+			m_size = init.size();
+		}
+		InlineVector& operator=(const InlineVector& rhs)
+		{
+			if (this != &rhs)
+			{
+				clear();
+				reserve(rhs.m_size);
+				copy_construct_range(rhs.begin(), rhs.end(), get_buffer());
+				m_size = rhs.m_size;
+			}
+			return *this;
+		}
+		InlineVector& operator=(InlineVector&& rhs)
+		{
+			if (this != &rhs)
+			{
+				free_buffer();
+				Luna::swap(static_cast<_Alloc&>(*this), static_cast<_Alloc&>(rhs));
+				internal_steal(rhs);
+			}
+			return *this;
+		}
+		InlineVector& operator=(InitializerList<value_type> ilist)
+		{
+			clear();
+			reserve(ilist.size());
+			copy_construct_range(ilist.begin(), ilist.end(), get_buffer());
+			m_size = ilist.size();
+			return *this;
+		}
+		~InlineVector()
+		{
+			free_buffer();
+		}
+		allocator_type get_allocator() const
+		{
+			return *static_cast<const _Alloc*>(this);
+		}
+		iterator begin()
+		{
+			return get_buffer();
+		}
+		iterator end()
+		{
+			return get_buffer() + m_size;
+		}
+		const_iterator begin() const
+		{
+			return get_buffer();
+		}
+		const_iterator end() const
+		{
+			return get_buffer() + m_size;
+		}
+		const_iterator cbegin() const
+		{
+			return begin();
+		}
+		const_iterator cend() const
+		{
+			return end();
+		}
+		reverse_iterator rbegin()
+		{
+			return reverse_iterator(end());
+		}
+		reverse_iterator rend()
+		{
+			return reverse_iterator(begin());
+		}
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(end());
+		}
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(begin());
+		}
+		const_reverse_iterator crbegin() const
+		{
+			return const_reverse_iterator(cend());
+		}
+		const_reverse_iterator crend() const
+		{
+			return const_reverse_iterator(cbegin());
+		}
+		usize size() const
+		{
+			return m_size;
+		}
+		usize capacity() const
+		{
+			return m_capacity;
+		}
+		bool empty() const
+		{
+			return (m_size == 0);
+		}
+		void reserve(usize new_cap)
+		{
+			if (new_cap > m_capacity)
+			{
+				value_type* new_buf = (value_type*)_Alloc::allocate(new_cap * sizeof(_Ty), alignof(_Ty));
+				copy_relocate_range(begin(), end(), new_buf);
+				if (is_heap())
+				{
+					_Alloc::deallocate(m_heap, m_capacity * sizeof(_Ty), alignof(_Ty));
+				}
+				m_heap = new_buf;
+				m_capacity = new_cap;
+			}
+		}
+		void resize(usize n)
+		{
+			reserve(n);
+			if (n > m_size)
+			{
+				default_construct_range(get_buffer() + m_size, get_buffer() + n);
+			}
+			else if (n < m_size)
+			{
+				destruct_range(get_buffer() + n, get_buffer() + m_size);
+			}
+			m_size = n;
+		}
+		void resize(usize n, const value_type& v)
+		{
+			reserve(n);
+			if (n > m_size)
+			{
+				fill_construct_range(get_buffer() + m_size, get_buffer() + n, v);
+			}
+			else if (n < m_size)
+			{
+				destruct_range(get_buffer() + n, get_buffer() + m_size);
+			}
+			m_size = n;
+		}
+		//! Resizes the vector without value-initializing the new elements, see `Vector::resize_for_overwrite` for details.
+		void resize_for_overwrite(usize n)
+		{
+			reserve(n);
+			if (n > m_size)
+			{
+				for (value_type* i = get_buffer() + m_size; i < get_buffer() + n; ++i)
+				{
+					new ((void*)i) value_type;
+				}
+			}
+			else if (n < m_size)
+			{
+				destruct_range(get_buffer() + n, get_buffer() + m_size);
+			}
+			m_size = n;
+		}
+		//! Appends `count` uninitialized elements to the end of the vector, see `Vector::append_uninitialized` for details.
+		iterator append_uninitialized(usize count)
+		{
+			return internal_insert_gap(m_size, count);
+		}
+		//! Moves the elements back to the inline buffer if they fit, or shrinks the heap buffer to the number of elements.
+		void shrink_to_fit()
+		{
+			if (!is_heap() || m_capacity == m_size)
+			{
+				return;
+			}
+			value_type* old_buf = m_heap;
+			usize old_cap = m_capacity;
+			if (m_size <= _N)
+			{
+				copy_relocate_range(old_buf, old_buf + m_size, (value_type*)m_inline);
+				m_capacity = _N;
+			}
+			else
+			{
+				value_type* new_buf = (value_type*)_Alloc::allocate(m_size * sizeof(value_type), alignof(value_type));
+				copy_relocate_range(old_buf, old_buf + m_size, new_buf);
+				m_heap = new_buf;
+				m_capacity = m_size;
+			}
+			_Alloc::deallocate(old_buf, old_cap * sizeof(value_type), alignof(value_type));
+		}
+		reference operator[] (usize n)
+		{
+			luassert(n < m_size);
+			return get_buffer()[n];
+		}
+		const_reference operator[] (usize n) const
+		{
+			luassert(n < m_size);
+			return get_buffer()[n];
+		}
+		reference at(usize n)
+		{
+			luassert(n < m_size);
+			return get_buffer()[n];
+		}
+		const_reference at(usize n) const
+		{
+			luassert(n < m_size);
+			return get_buffer()[n];
+		}
+		reference front()
+		{
+			luassert(!empty());
+			return get_buffer()[0];
+		}
+		const_reference front() const
+		{
+			luassert(!empty());
+			return get_buffer()[0];
+		}
+		reference back()
+		{
+			luassert(!empty());
+			return get_buffer()[m_size - 1];
+		}
+		const_reference back() const
+		{
+			luassert(!empty());
+			return get_buffer()[m_size - 1];
+		}
+		pointer data()
+		{
+			return get_buffer();
+		}
+		const_pointer data() const
+		{
+			return get_buffer();
+		}
+		void clear()
+		{
+			destruct_range(begin(), end());
+			m_size = 0;
+		}
+		void push_back(const value_type& val)
+		{
+			internal_expand_reserve(m_size + 1);
+			new (get_buffer() + m_size) value_type(val);
+			++m_size;
+		}
+		void push_back(value_type&& val)
+		{
+			internal_expand_reserve(m_size + 1);
+			new (get_buffer() + m_size) value_type(move(val));
+			++m_size;
+		}
+		template <typename... _Args>
+		iterator emplace_back(_Args&&... args)
+		{
+			internal_expand_reserve(m_size + 1);
+			value_type* p = get_buffer() + m_size;
+			new (p) value_type(forward<_Args>(args)...);
+			++m_size;
+			return p;
+		}
+		void pop_back()
+		{
+			luassert(!empty());
+			destruct(get_buffer() + m_size - 1);
+			--m_size;
+		}
+		void assign(usize count, const value_type& value)
+		{
+			clear();
+			reserve(count);
+			fill_construct_range(get_buffer(), get_buffer() + count, value);
+			m_size = count;
+		}
+	private:
+		template <typename _Integer>
+		void internal_assign_iterator(_Integer count, _Integer val, true_type)
+		{
+			assign((usize)count, (value_type)val);
+		}
+		template <typename _InputIt>
+		void internal_assign_iterator(_InputIt first, _InputIt last, false_type)
+		{
+			clear();
+			for (auto iter = first; iter != last; ++iter)
+			{
+				push_back(*iter);
+			}
+		}
+	public:
+		template <typename _InputIter>
+		void assign(_InputIter first, _InputIter last)
+		{
+			internal_assign_iterator<_InputIter>(first, last, typename is_integral<_InputIter>::type());
+		}
+		void assign(InitializerList<value_type> il)
+		{
+			assign(il.begin(), il.end());
+		}
+		iterator insert(const_iterator pos, const value_type& val)
+		{
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* p = internal_insert_gap(pos - cbegin(), 1);
+			new ((void*)p) value_type(val);
+			return p;
+		}
+		iterator insert(const_iterator pos, value_type&& val)
+		{
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* p = internal_insert_gap(pos - cbegin(), 1);
+			new ((void*)p) value_type(move(val));
+			return p;
+		}
+		iterator insert(const_iterator pos, usize count, const value_type& val)
+		{
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* p = internal_insert_gap(pos - cbegin(), count);
+			fill_construct_range(p, p + count, val);
+			return p;
+		}
+		iterator insert(const_iterator pos, InitializerList<value_type> il)
+		{
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* p = internal_insert_gap(pos - cbegin(), il.size());
+			copy_construct_range(il.begin(), il.end(), p);
+			return p;
+		}
+		template <typename... _Args>
+		iterator emplace(const_iterator pos, _Args&&... args)
+		{
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* p = internal_insert_gap(pos - cbegin(), 1);
+			new ((void*)p) value_type(forward<_Args>(args)...);
+			return p;
+		}
+		iterator erase(const_iterator pos)
+		{
+			luassert((pos >= cbegin()) && (pos < cend()));
+			((value_type*)pos)->~value_type();
+			if (pos != (end() - 1))
+			{
+				move_relocate_range((value_type*)pos + 1, end(), (value_type*)pos);
+			}
+			--m_size;
+			return const_cast<iterator>(pos);
+		}
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			luassert((first >= cbegin()) && (first <= cend()));
+			luassert((last >= first) && (last <= cend()));
+			destruct_range((value_type*)first, (value_type*)last);
+			if (last != end())
+			{
+				move_relocate_range((value_type*)last, end(), (value_type*)first);
+			}
+			m_size -= (last - first);
+			return const_cast<iterator>(first);
+		}
+		void swap(InlineVector& rhs)
+		{
+			InlineVector tmp(move(*this));
+			(*this) = move(rhs);
+			rhs = move(tmp);
+		}
+	};
+
+	//! The inline elements are relocated together with the vector, so the vector is trivially relocatable only if the
+	//! element is trivially relocatable.
+	template <typename _Ty, usize _N, typename _Alloc>
+	struct is_trivially_relocatable<InlineVector<_Ty, _N, _Alloc>> : is_trivially_relocatable<_Ty> {};
+}
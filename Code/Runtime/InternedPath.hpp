@@ -0,0 +1,216 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file InternedPath.hpp
+* @author JXMaster
+* @date 2021/6/15
+* @brief Runtime interned path APIs.
+*/
+#pragma once
+#include "Path.hpp"
+
+#ifndef LUNA_RUNTIME_API
+#define LUNA_RUNTIME_API
+#endif
+
+namespace Luna
+{
+	//! One node in the interned path tree.
+	//! @remark All interned paths are stored in one global tree, every node in the tree represents one unique path, and
+	//! paths that share the same prefix share the same ancestor nodes. Every root node of the tree represents one unique
+	//! combination of the root name and the path flags, and has no path nodes.
+	struct InternedPathNode
+	{
+		//! The name of the last path node, or the root name of the path if this is a root node.
+		Name m_name;
+		//! The ID of the parent node. This is 0 for root nodes.
+		u32 m_parent;
+		//! The ID of the root node of the path. This is the ID of the node itself for root nodes.
+		u32 m_root;
+		//! The number of path nodes in the path. This is 0 for root nodes.
+		u32 m_depth;
+		//! The path flags.
+		EPathFlag m_flags;
+	};
+
+	//! Interns one path to the runtime and fetches the interned path ID for it.
+	//! @param[in] path The path to intern.
+	//! @param[in] components The path components to intern. Path nodes are always interned. If root or flags component is not
+	//! specified, the path is interned as if it has no root name or no flags.
+	//! @return Returns the interned path ID, which is never 0.
+	//! @remark Interned paths are never released until the runtime is closed, so only intern paths that are used as long-lived
+	//! keys, like mount points and asset paths.
+	LUNA_RUNTIME_API u32 intern_path(const Path& path, EPathComponent components = EPathComponent::all);
+
+	//! Finds the ID of the specified path without interning it.
+	//! @param[in] path The path to find.
+	//! @param[in] components The path components to find. See `intern_path` for details.
+	//! @return Returns the interned path ID, or 0 if the path is not interned.
+	LUNA_RUNTIME_API u32 find_interned_path(const Path& path, EPathComponent components = EPathComponent::all);
+
+	//! Finds the longest prefix of the specified path that is interned.
+	//! @param[in] path The path to find.
+	//! @param[in] components The path components to find. See `intern_path` for details.
+	//! @return Returns the ID of the interned path that has the most nodes and is a prefix of `path`, or 0 if the root of the path
+	//! is not interned.
+	LUNA_RUNTIME_API u32 find_interned_path_prefix(const Path& path, EPathComponent components = EPathComponent::all);
+
+	//! Fetches the interned path node by its ID.
+	//! @param[in] id The interned path ID. This must not be 0.
+	//! @return Returns the node of the path. The node address is valid until the runtime is closed.
+	LUNA_RUNTIME_API const InternedPathNode* get_interned_path_node(u32 id);
+
+	//! @class InternedPath
+	//! InternedPath is one handle to one interned path. It is a 32-bit integer, so copying one interned path does not
+	//! allocate memory or touch any reference count, and comparing two interned paths only compares two integers.
+	//! @remark Two interned paths are equal if they are interned with the same root name, flags and nodes. Checking if one interned
+	//! path is the subpath of another interned path only walks the parent links of the path, and does not compare names.
+	//!
+	//! Use `Path` for paths that are modified frequently or used only once, and convert them to interned paths when they are
+	//! used as keys of lookup tables.
+	class InternedPath
+	{
+		u32 m_id;
+
+		const InternedPathNode& node() const
+		{
+			return *get_interned_path_node(m_id);
+		}
+	public:
+		//! Constructs one null interned path.
+		InternedPath() :
+			m_id(0) {}
+		//! Interns the specified path. See `intern_path` for details.
+		explicit InternedPath(const Path& path, EPathComponent components = EPathComponent::all) :
+			m_id(intern_path(path, components)) {}
+
+		//! Creates one interned path from the interned path ID.
+		static InternedPath from_id(u32 id)
+		{
+			InternedPath r;
+			r.m_id = id;
+			return r;
+		}
+		//! Finds the interned path of the specified path without interning it.
+		//! @return Returns the interned path if found, or one null interned path otherwise.
+		static InternedPath find(const Path& path, EPathComponent components = EPathComponent::all)
+		{
+			return from_id(find_interned_path(path, components));
+		}
+
+		u32 id() const
+		{
+			return m_id;
+		}
+		//! Checks if this is not a null interned path.
+		bool valid() const
+		{
+			return m_id != 0;
+		}
+		operator bool() const
+		{
+			return valid();
+		}
+
+		//! Gets the number of nodes in the path.
+		usize size() const
+		{
+			return m_id ? node().m_depth : 0;
+		}
+		bool empty() const
+		{
+			return size() == 0;
+		}
+		//! Gets the root name of the path.
+		const Name& root() const
+		{
+			luassert(valid());
+			return get_interned_path_node(node().m_root)->m_name;
+		}
+		EPathFlag flags() const
+		{
+			return m_id ? node().m_flags : EPathFlag::none;
+		}
+		//! Gets the last node of the path. The path must not be empty.
+		const Name& back() const
+		{
+			luassert(!empty());
+			return node().m_name;
+		}
+		//! Gets the path with the last node removed. The path must not be empty.
+		InternedPath parent() const
+		{
+			luassert(!empty());
+			return from_id(node().m_parent);
+		}
+		//! Gets the path with only the first `count` nodes of this path. `count` must not be greater than `size`.
+		InternedPath prefix(usize count) const
+		{
+			luassert(count <= size());
+			u32 id = m_id;
+			const InternedPathNode* n = get_interned_path_node(id);
+			while (n->m_depth > count)
+			{
+				id = n->m_parent;
+				n = get_interned_path_node(id);
+			}
+			return from_id(id);
+		}
+		//! Checks if this path is the subsequent path of the specified base path.
+		//! @remark Unlike `Path::is_subpath_of`, both paths must have the same root name and flags, intern both paths with only
+		//! `EPathComponent::nodes` component if the root name and flags should be ignored.
+		bool is_subpath_of(const InternedPath& base) const
+		{
+			if (!m_id || !base.m_id)
+			{
+				return false;
+			}
+			usize base_size = base.size();
+			return (size() >= base_size) && (prefix(base_size) == base);
+		}
+
+		//! Converts the interned path to one path object.
+		Path to_path() const
+		{
+			Path r;
+			if (!m_id)
+			{
+				return r;
+			}
+			const InternedPathNode& n = node();
+			r.root() = root();
+			r.flags() = n.m_flags;
+			usize depth = n.m_depth;
+			for (usize i = 0; i < depth; ++i)
+			{
+				r.push_back(Name());
+			}
+			u32 id = m_id;
+			for (usize i = depth; i > 0; --i)
+			{
+				const InternedPathNode* p = get_interned_path_node(id);
+				r[i - 1] = p->m_name;
+				id = p->m_parent;
+			}
+			return r;
+		}
+		//! Generates a string that represents the path. See `Path::encode` for details.
+		String encode(EPathSeparator separator = EPathSeparator::slash, bool has_root = true) const
+		{
+			return to_path().encode(separator, has_root);
+		}
+
+		bool operator==(const InternedPath& rhs) const
+		{
+			return m_id == rhs.m_id;
+		}
+		bool operator!=(const InternedPath& rhs) const
+		{
+			return m_id != rhs.m_id;
+		}
+	};
+
+	template <> struct hash<InternedPath>
+	{
+		usize operator()(const InternedPath& val) const { return (usize)val.id(); }
+	};
+}
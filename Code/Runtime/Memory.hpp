@@ -12,7 +12,12 @@
 #define LUNA_RUNTIME_API
 #endif
 
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
+// The memory leak check is built on the memory profiler.
+#if defined(LUNA_RUNTIME_CHECK_MEMORY_LEAK) && !defined(LUNA_RUNTIME_PROFILE_MEMORY)
+#define LUNA_RUNTIME_PROFILE_MEMORY
+#endif
+
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
 #include <typeinfo>
 #endif
 
@@ -62,16 +67,119 @@ namespace Luna
 	LUNA_RUNTIME_API usize memsize(void* ptr, usize alignment = 0);
 
 	//! Counts the total memory allocated from heap in bytes.
+	//! @remark The allocated memory is recorded by every thread separately and is summed when this function is called, so
+	//! the returned value is exact only if no other thread is allocating or freeing memory during this call.
 	LUNA_RUNTIME_API usize get_allocated_memory();
 
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
 
-	//! Registers one memory block to the leak detection system.
+	//! Registers one memory block to the memory profiler with a debug name, which is shown in the memory leak report
+	//! instead of the tag of the block.
 	LUNA_RUNTIME_API void register_memory_block(void* blk, const c8* debug_name);
 
-	//! Unregisters one memory block from the leak detection system.
+	//! Unregisters one memory block from the memory profiler.
+	//! @remark The debug name of one memory block is removed automatically when the block is freed, so this function
+	//! does nothing and is kept for compatibility.
 	LUNA_RUNTIME_API void unregister_memory_block(void* blk);
 
+	//! Sets the memory tag of the current thread. All memory blocks allocated by the current thread will be tagged with
+	//! this tag, until the tag is changed.
+	//! @param[in] tag The tag to set. The string must be valid until the program exits, usually it is one string literal.
+	//! Tags with the same content are treated as the same tag. Pass `nullptr` to clear the tag.
+	//! @return Returns the previous tag of the current thread.
+	LUNA_RUNTIME_API const c8* set_memory_tag(const c8* tag);
+
+	//! Gets the memory tag of the current thread.
+	LUNA_RUNTIME_API const c8* get_memory_tag();
+
+	//! Enables or disables capturing call stacks for every allocation. When enabled, allocations with different call
+	//! stacks are recorded as different allocators, which makes allocations much slower. Default is disabled, and
+	//! allocations are identified by the address that calls `memalloc`.
+	LUNA_RUNTIME_API void set_memory_stack_capture_enabled(bool enabled);
+
+	//! Checks whether call stacks are captured for every allocation.
+	LUNA_RUNTIME_API bool is_memory_stack_capture_enabled();
+
+	//! Collects all allocations recorded by all threads since last update.
+	//! @remark Allocations are recorded to one per-thread log without taking any lock, and are collected by one background 
+	//! thread periodically. Call this to collect allocations immediately before reading statistics.
+	LUNA_RUNTIME_API void update_memory_profiler();
+
+	//! Notifies the memory profiler that one new frame is started, so that the per-frame statistics are updated.
+	//! This is called by `Luna::new_frame` in Core module.
+	LUNA_RUNTIME_API void memory_profiler_new_frame();
+
+	//! The memory statistics of one memory tag.
+	struct MemoryTagStats
+	{
+		//! The tag, or `nullptr` for allocations without tags.
+		const c8* tag;
+		//! The number of bytes that are currently allocated.
+		usize live_bytes;
+		//! The number of memory blocks that are currently allocated.
+		usize live_blocks;
+		//! The number of bytes allocated in the last frame.
+		usize frame_allocated_bytes;
+		//! The number of allocations in the last frame.
+		usize frame_allocations;
+		//! The number of bytes allocated since the program starts.
+		u64 total_allocated_bytes;
+		//! The number of allocations since the program starts.
+		u64 total_allocations;
+	};
+
+	//! Gets the memory statistics of all memory tags, sorted by the number of live bytes in descending order.
+	//! @param[out] stats The array to receive the statistics.
+	//! @param[in] max_stats The number of elements in `stats`.
+	//! @return Returns the number of tags recorded, which may be greater than `max_stats`.
+	LUNA_RUNTIME_API usize get_memory_tag_stats(MemoryTagStats* stats, usize max_stats);
+
+	//! The memory statistics of one allocator, which is the place that allocates the memory.
+	struct MemoryAllocatorStats
+	{
+		//! The address of the code that calls `memalloc` or `memrealloc`.
+		void* caller;
+		//! The hash of the call stack, or 0 if stack capture is disabled.
+		u32 stack_hash;
+		//! The memory tag of the first allocation of this allocator.
+		const c8* tag;
+		//! The number of bytes that are currently allocated.
+		usize live_bytes;
+		//! The number of memory blocks that are currently allocated.
+		usize live_blocks;
+		//! The number of bytes allocated in the last frame.
+		usize frame_allocated_bytes;
+		//! The number of allocations since the program starts.
+		u64 total_allocations;
+	};
+
+	//! Gets the allocators that have most live bytes, sorted by the number of live bytes in descending order.
+	//! @param[out] stats The array to receive the statistics.
+	//! @param[in] max_stats The number of allocators to get.
+	//! @return Returns the number of allocators written to `stats`.
+	LUNA_RUNTIME_API usize get_top_memory_allocators(MemoryAllocatorStats* stats, usize max_stats);
+
+	//! Sets the memory tag of the current thread in the current scope.
+	struct MemoryTagScope
+	{
+		const c8* m_prev;
+		MemoryTagScope(const c8* tag)
+		{
+			m_prev = set_memory_tag(tag);
+		}
+		~MemoryTagScope()
+		{
+			set_memory_tag(m_prev);
+		}
+	};
+
+	//! Tags all memory allocated by the current thread in the current scope. This can only be used once in every scope.
+#define lumemtag(_tag) Luna::MemoryTagScope _luna_memory_tag_scope(_tag)
+
+#else
+
+#define lumemtag(_tag)
+
 #endif
 
 	//! Global object creation function.
@@ -82,7 +190,7 @@ namespace Luna
 		if (o)
 		{
 			new (o) _Ty(forward<_Args>(args)...);
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
 			register_memory_block(o, typeid(_Ty).name());
 #endif
 			return o;
@@ -96,8 +204,5 @@ namespace Luna
 	{
 		o->~_Ty();
 		memfree(o, alignof(_Ty));
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-		unregister_memory_block(o);
-#endif
 	}
 }
@@ -39,8 +39,16 @@ namespace Luna
 	//! but the name memory block pointer may change.
 	//! @param[in] name The name address returned by `intern_name` or `fetch_name`.
 	//! @return Returns the string ID of the specified string. The string ID is 0 is `name` is `nullptr`.
+	//! @remark The string ID is the 64-bit hash of the name string. The name strings are always compared when being interned, so two different 
+	//! strings never share one name even if their hashes collide. In such rare case, the later interned string gets one different 
+	//! string ID derived from the hash, and that ID is only stable within the current process.
 	LUNA_RUNTIME_API u64 get_name_id(const c8* name);
 
+	//! Fetches the length of the specified name string.
+	//! @param[in] name The name address returned by `intern_name` or `fetch_name`.
+	//! @return Returns the number of characters in the name string, not including the null terminator. Returns 0 if `name` is `nullptr`.
+	LUNA_RUNTIME_API usize get_name_size(const c8* name);
+
 	//! Fetches the string entry by its string ID.
 	//! @param[in] id The string id returned by `intern_name` for the string.
 	//! @return Returns a pointer to the buffer of the string. This pointer is valid before the name is released by calling `release_name`.
@@ -49,6 +57,7 @@ namespace Luna
 
 	//! Increases the reference count of the name string by 1.
 	//! @param[in] name The string pointer returned by `intern_name` for the string. If this is `nullptr`, this call does nothing.
+	//! @remark The reference count is stored with the name string, so this call is one atomic increment and never locks the name table.
 	LUNA_RUNTIME_API void retain_name(const c8* name);
 
 	//! Releases one name string entry.
@@ -73,7 +82,7 @@ namespace Luna
 		Name(const c8* name, usize count) :
 			m_str(intern_name(name, count)) {}
 		Name(const String& str) :
-			m_str(intern_name(str.c_str())) {}
+			m_str(intern_name(str.c_str(), str.size())) {}
 		Name(const String& str, usize pos, usize count) :
 			m_str(intern_name(str.c_str() + pos, count)) {}
 		~Name()
@@ -113,7 +122,7 @@ namespace Luna
 		Name& operator=(const String& str)
 		{
 			release_name(m_str);
-			m_str = intern_name(str.c_str());
+			m_str = intern_name(str.c_str(), str.size());
 			return *this;
 		}
 
@@ -127,6 +136,11 @@ namespace Luna
 			return m_str;
 		}
 
+		usize size() const
+		{
+			return get_name_size(m_str);
+		}
+
 		bool empty() const
 		{
 			return m_str == nullptr;
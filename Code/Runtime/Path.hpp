@@ -698,13 +698,13 @@ namespace Luna
 			if (m_root)
 			{
 				id = m_root.id();
-				h = memhash<usize>(&id, sizeof(u64), h);
-				h = strhash<usize>("://", h);// To deferent "A://B" from "/A/B"
+				h = (usize)wyhash(&id, sizeof(u64), h);
+				h = (usize)wyhash("://", 3, h);// To deferent "A://B" from "/A/B"
 			}
 			for (auto& i : m_nodes)
 			{
 				id = i.id();
-				h = memhash<usize>(&id, sizeof(u64), h);
+				h = (usize)wyhash(&id, sizeof(u64), h);
 			}
 			return h;
 		}
@@ -0,0 +1,76 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Profiler.hpp
+* @author JXMaster
+* @date 2021/6/23
+* @brief The CPU timeline profiler that records named scopes of all threads.
+*/
+#pragma once
+#include "String.hpp"
+
+#ifndef LUNA_RUNTIME_API
+#define LUNA_RUNTIME_API
+#endif
+
+namespace Luna
+{
+	//! The maximum number of events kept for every thread. Every scope takes two events.
+	constexpr u32 profiler_events_per_thread = 65536;
+
+	//! Starts one capture. Scopes and frame markers are recorded only when one capture is running.
+	//! @remark Every thread records to its own ring buffer without taking any lock, so only the most recent events of every
+	//! thread are kept if the capture is too long. See `profiler_events_per_thread`.
+	LUNA_RUNTIME_API void begin_profiler_capture();
+
+	//! Stops the current capture. The captured events are kept until the next capture is started.
+	LUNA_RUNTIME_API void end_profiler_capture();
+
+	//! Checks whether one capture is running.
+	LUNA_RUNTIME_API bool is_profiler_capturing();
+
+	//! Records the beginning of one scope on the current thread. Use `LUNA_PROFILE_SCOPE` instead of calling this directly.
+	//! @param[in] name The name of the scope. The string must be valid until the capture is exported, usually it is one
+	//! string literal.
+	LUNA_RUNTIME_API void profiler_begin_scope(const c8* name);
+
+	//! Records the end of the last scope begun on the current thread.
+	LUNA_RUNTIME_API void profiler_end_scope(const c8* name);
+
+	//! Records one frame marker. This is called by `Luna::new_frame` in Core module.
+	LUNA_RUNTIME_API void profiler_new_frame(u32 frame_index);
+
+	//! Sets the name of the current thread shown in the exported capture.
+	//! @param[in] name The name of the thread. The string is copied.
+	LUNA_RUNTIME_API void set_profiler_thread_name(const c8* name);
+
+	//! Exports the last capture to one JSON string in Chrome trace event format, which can be opened by `chrome://tracing`
+	//! or Perfetto.
+	//! @param[out] out The string to append the JSON to.
+	//! @remark This can be called when one capture is running, in which case scopes that are not ended are not exported.
+	LUNA_RUNTIME_API void export_profiler_capture(String& out);
+
+	//! Records one scope from the construction to the destruction.
+	struct ProfilerScope
+	{
+		const c8* m_name;
+		ProfilerScope(const c8* name) :
+			m_name(name)
+		{
+			profiler_begin_scope(name);
+		}
+		~ProfilerScope()
+		{
+			profiler_end_scope(m_name);
+		}
+	};
+}
+
+#ifdef LUNA_PROFILE
+#define LUNA_PROFILE_SCOPE_CONCAT_IMPL(_a, _b) _a##_b
+#define LUNA_PROFILE_SCOPE_CONCAT(_a, _b) LUNA_PROFILE_SCOPE_CONCAT_IMPL(_a, _b)
+//! Records the current scope to the CPU timeline profiler. This is removed in release builds.
+//! @param[in] _name The name of the scope, usually one string literal.
+#define LUNA_PROFILE_SCOPE(_name) Luna::ProfilerScope LUNA_PROFILE_SCOPE_CONCAT(_luna_profile_scope_, __LINE__)(_name)
+#else
+#define LUNA_PROFILE_SCOPE(_name)
+#endif
@@ -0,0 +1,829 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FlatHashTable.hpp
+* @author JXMaster
+* @date 2021/6/5
+* @brief Defines the open-addressing hash table used by both flat hash set and flat hash map.
+*/
+#pragma once
+#include "../Base.hpp"
+#include "../Functional.hpp"
+#include "../Algorithm.hpp"
+#include "../Memory.hpp"
+#include "../MemoryUtils.hpp"
+#include "../Hash.hpp"
+#include "HashTable.hpp"
+
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#include <emmintrin.h>
+#define LUNA_FLAT_HASH_TABLE_SSE2 1
+#endif
+
+#ifdef LUNA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace Luna
+{
+	//! The flat hash table stores elements directly in one slot array, and stores one control byte for every slot in
+	//! one separated control array. The control byte records whether the slot is empty, deleted or full, and stores
+	//! 7 bits of the element hash if the slot is full. Lookups compare one group of control bytes (16 on SSE2, 8 on
+	//! other platforms) with the hash in one instruction, and only checks the slots whose control byte matches.
+	namespace FlatHashTableImpl
+	{
+		using ctrl_t = i8;
+
+		constexpr ctrl_t ctrl_empty = -128;		// 0b10000000
+		constexpr ctrl_t ctrl_deleted = -2;		// 0b11111110
+		constexpr ctrl_t ctrl_sentinel = -1;	// 0b11111111
+
+		inline bool is_full(ctrl_t c)
+		{
+			return c >= 0;
+		}
+		inline bool is_empty_or_deleted(ctrl_t c)
+		{
+			return c < ctrl_sentinel;
+		}
+
+		inline u32 count_trailing_zeros(u64 v)
+		{
+#ifdef LUNA_COMPILER_MSVC
+			unsigned long r;
+#ifdef LUNA_PLATFORM_64BIT
+			_BitScanForward64(&r, v);
+#else
+			if ((u32)v) _BitScanForward(&r, (u32)v);
+			else { _BitScanForward(&r, (u32)(v >> 32)); r += 32; }
+#endif
+			return (u32)r;
+#else
+			return (u32)__builtin_ctzll(v);
+#endif
+		}
+
+		inline u32 count_leading_zeros(u64 v)
+		{
+#ifdef LUNA_COMPILER_MSVC
+			unsigned long r;
+#ifdef LUNA_PLATFORM_64BIT
+			_BitScanReverse64(&r, v);
+#else
+			if (v >> 32) { _BitScanReverse(&r, (u32)(v >> 32)); r += 32; }
+			else _BitScanReverse(&r, (u32)v);
+#endif
+			return 63 - (u32)r;
+#else
+			return (u32)__builtin_clzll(v);
+#endif
+		}
+
+		//! A bit mask that records one bit for every slot in one group. Each slot takes `1 << _Shift` bits in the mask,
+		//! and only the highest bit of them may be set.
+		template <typename _Ty, u32 _Width, u32 _Shift>
+		struct BitMask
+		{
+			_Ty m_mask;
+
+			explicit BitMask(_Ty mask) :
+				m_mask(mask) {}
+			explicit operator bool() const
+			{
+				return m_mask != 0;
+			}
+			//! Gets the index of the lowest slot whose bit is set. The mask must not be empty.
+			u32 lowest_bit_set() const
+			{
+				return count_trailing_zeros(m_mask) >> _Shift;
+			}
+			//! Gets the number of slots before the first slot whose bit is set.
+			u32 trailing_zeros() const
+			{
+				return m_mask ? count_trailing_zeros(m_mask) >> _Shift : _Width;
+			}
+			//! Gets the number of slots after the last slot whose bit is set.
+			u32 leading_zeros() const
+			{
+				constexpr u32 total_bits = _Width << _Shift;
+				return m_mask ? (count_leading_zeros((u64)m_mask) - (64 - total_bits)) >> _Shift : _Width;
+			}
+			//! Clears the lowest bit set.
+			void clear_lowest_bit()
+			{
+				m_mask &= (m_mask - 1);
+			}
+		};
+
+#ifdef LUNA_FLAT_HASH_TABLE_SSE2
+		struct Group
+		{
+			static constexpr usize width = 16;
+
+			__m128i m_ctrl;
+
+			explicit Group(const ctrl_t* pos)
+			{
+				m_ctrl = _mm_loadu_si128((const __m128i*)pos);
+			}
+			//! Gets slots whose control byte equals to `h2`.
+			BitMask<u32, width, 0> match(ctrl_t h2) const
+			{
+				return BitMask<u32, width, 0>((u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl)));
+			}
+			BitMask<u32, width, 0> match_empty() const
+			{
+				return match(ctrl_empty);
+			}
+			BitMask<u32, width, 0> match_empty_or_deleted() const
+			{
+				return BitMask<u32, width, 0>((u32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), m_ctrl)));
+			}
+			//! Gets the number of empty or deleted slots from the beginning of the group.
+			u32 count_leading_empty_or_deleted() const
+			{
+				u32 mask = (u32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), m_ctrl));
+				return count_trailing_zeros(mask + 1);
+			}
+		};
+#else
+		//! The portable group implementation, which processes 8 control bytes in one 64-bit integer.
+		struct Group
+		{
+			static constexpr usize width = 8;
+			static constexpr u64 lsbs = 0x0101010101010101ULL;
+			static constexpr u64 msbs = 0x8080808080808080ULL;
+
+			u64 m_ctrl;
+
+			explicit Group(const ctrl_t* pos)
+			{
+				memcpy(&m_ctrl, pos, sizeof(u64));
+#ifdef LUNA_PLATFORM_BIG_ENDIAN
+				m_ctrl = __builtin_bswap64(m_ctrl);
+#endif
+			}
+			//! Gets slots whose control byte equals to `h2`. This may report false positive matches for full slots
+			//! right after one real match, which is fine since the keys are always compared.
+			BitMask<u64, width, 3> match(ctrl_t h2) const
+			{
+				u64 x = m_ctrl ^ (lsbs * (u8)h2);
+				return BitMask<u64, width, 3>((x - lsbs) & ~x & msbs);
+			}
+			BitMask<u64, width, 3> match_empty() const
+			{
+				return BitMask<u64, width, 3>((m_ctrl & (~m_ctrl << 6)) & msbs);
+			}
+			BitMask<u64, width, 3> match_empty_or_deleted() const
+			{
+				return BitMask<u64, width, 3>((m_ctrl & (~m_ctrl << 7)) & msbs);
+			}
+			u32 count_leading_empty_or_deleted() const
+			{
+				constexpr u64 gaps = 0x00FEFEFEFEFEFEFEULL;
+				return (count_trailing_zeros(((~m_ctrl & (m_ctrl >> 7)) | gaps) + 1) + 7) >> 3;
+			}
+		};
+#endif
+
+		//! The number of control bytes that are cloned after the sentinel byte, so that one group load starting from any
+		//! slot never reads out of the control array.
+		constexpr usize num_cloned_bytes = Group::width - 1;
+
+		//! The control array used by empty tables, so that lookups on empty tables need no special check.
+		inline const ctrl_t* empty_group()
+		{
+			alignas(16) static const ctrl_t g[Group::width] = {
+				ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+#ifdef LUNA_FLAT_HASH_TABLE_SSE2
+				ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty
+#endif
+			};
+			return g;
+		}
+
+		//! Converts the capacity (which is always 2^n-1) to the maximum number of elements that can be stored
+		//! before the table grows. The maximum load factor is 7/8.
+		inline usize capacity_to_growth(usize capacity)
+		{
+			return (capacity == 7 && Group::width == 8) ? 6 : capacity - capacity / 8;
+		}
+
+		inline usize normalize_capacity(usize n)
+		{
+			usize c = Group::width - 1;
+			while (c < n) c = c * 2 + 1;
+			return c;
+		}
+
+		//! Mixes the hash code so that hashers that returns the key directly (like `hash<u32>`) still get good
+		//! distribution in both control bytes and probing positions.
+		inline usize mix_hash_code(usize hash_code)
+		{
+			return (usize)Impl::wyhash_mix((u64)hash_code, 0x9E3779B97F4A7C15ULL);
+		}
+		inline usize h1(usize hash_code)
+		{
+			return hash_code >> 7;
+		}
+		inline ctrl_t h2(usize hash_code)
+		{
+			return (ctrl_t)(hash_code & 0x7F);
+		}
+
+		//! The triangular probing sequence that visits every group exactly once when the capacity is 2^n-1.
+		struct ProbeSeq
+		{
+			usize m_mask;
+			usize m_offset;
+			usize m_index;
+
+			ProbeSeq(usize hash, usize mask) :
+				m_mask(mask),
+				m_offset(hash & mask),
+				m_index(0) {}
+			usize offset(usize i) const
+			{
+				return (m_offset + i) & m_mask;
+			}
+			void next()
+			{
+				m_index += Group::width;
+				m_offset += m_index;
+				m_offset &= m_mask;
+			}
+		};
+
+		template <typename _Ty, bool _Const>
+		struct Iterator
+		{
+			using value_type = _Ty;
+			using pointer = conditional_t<_Const, const value_type*, value_type*>;
+			using reference = conditional_t<_Const, const value_type&, value_type&>;
+
+			const ctrl_t* m_ctrl;
+			value_type* m_slot;
+
+			Iterator() :
+				m_ctrl(nullptr),
+				m_slot(nullptr) {}
+
+			Iterator(const ctrl_t* ctrl, value_type* slot) :
+				m_ctrl(ctrl),
+				m_slot(slot) {}
+
+			Iterator(const Iterator<_Ty, false>& rhs) :
+				m_ctrl(rhs.m_ctrl),
+				m_slot(rhs.m_slot) {}
+
+			//! Moves the iterator to the next full slot, or to the sentinel byte.
+			void skip_empty_or_deleted()
+			{
+				while (is_empty_or_deleted(*m_ctrl))
+				{
+					u32 shift = Group(m_ctrl).count_leading_empty_or_deleted();
+					m_ctrl += shift;
+					m_slot += shift;
+				}
+			}
+
+			reference operator*() const
+			{
+				return *m_slot;
+			}
+
+			pointer operator->() const
+			{
+				return m_slot;
+			}
+
+			Iterator& operator++()
+			{
+				++m_ctrl;
+				++m_slot;
+				skip_empty_or_deleted();
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator temp(*this);
+				++*this;
+				return temp;
+			}
+
+			bool operator==(const Iterator& rhs) const
+			{
+				return m_ctrl == rhs.m_ctrl;
+			}
+
+			bool operator!=(const Iterator& rhs) const
+			{
+				return m_ctrl != rhs.m_ctrl;
+			}
+		};
+
+		template <typename _Kty,
+			typename _Vty,
+			typename _ExtractKey,				// HashTableImpl::MapExtractKey for FlatHashMap, HashTableImpl::SetExtractKey for FlatHashSet.
+			typename _Hash = hash<_Kty>,		// Used to hash the key value.
+			typename _KeyEqual = equal_to<_Kty>>	// Used to compare the element.
+		class FlatHashTable
+		{
+		public:
+			using key_type = _Kty;
+			using value_type = _Vty;
+			using hasher = _Hash;
+			using key_equal = _KeyEqual;
+			using reference = value_type&;
+			using const_reference = const value_type&;
+			using pointer = value_type*;
+			using const_pointer = const value_type*;
+			using iterator = Iterator<value_type, false>;
+			using const_iterator = Iterator<value_type, true>;
+
+			using extract_key = _ExtractKey;
+
+			//! The control array, `m_capacity + 1 + num_cloned_bytes` bytes. `m_ctrl[m_capacity]` is the sentinel byte.
+			ctrl_t* m_ctrl;
+			//! The slot array, allocated in the same memory block after the control array.
+			value_type* m_slots;
+			//! The number of slots, which is 0 or 2^n-1.
+			usize m_capacity;
+			//! The number of elements in the table.
+			usize m_size;
+			//! The number of elements that can be inserted before the table needs to be rehashed.
+			usize m_growth_left;
+
+			static usize slot_offset(usize capacity)
+			{
+				usize ctrl_size = capacity + 1 + num_cloned_bytes;
+				return (ctrl_size + alignof(value_type) - 1) & ~(alignof(value_type) - 1);
+			}
+
+			void internal_reset_ctrl()
+			{
+				memset(m_ctrl, ctrl_empty, m_capacity + 1 + num_cloned_bytes);
+				m_ctrl[m_capacity] = ctrl_sentinel;
+				m_growth_left = capacity_to_growth(m_capacity) - m_size;
+			}
+
+			//! Sets the control byte and its cloned byte.
+			void internal_set_ctrl(usize i, ctrl_t h)
+			{
+				m_ctrl[i] = h;
+				m_ctrl[((i - num_cloned_bytes) & m_capacity) + (num_cloned_bytes & m_capacity)] = h;
+			}
+
+			void internal_alloc(usize capacity)
+			{
+				u8* buf = (u8*)memalloc(slot_offset(capacity) + sizeof(value_type) * capacity, alignof(value_type));
+				m_ctrl = (ctrl_t*)buf;
+				m_slots = (value_type*)(buf + slot_offset(capacity));
+				m_capacity = capacity;
+				internal_reset_ctrl();
+			}
+
+			void internal_free()
+			{
+				if (m_capacity)
+				{
+					memfree(m_ctrl, alignof(value_type));
+				}
+				m_ctrl = const_cast<ctrl_t*>(empty_group());
+				m_slots = nullptr;
+				m_capacity = 0;
+				m_growth_left = 0;
+			}
+
+			void internal_destruct_all()
+			{
+				for (usize i = 0; i < m_capacity; ++i)
+				{
+					if (is_full(m_ctrl[i]))
+					{
+						destruct(m_slots + i);
+					}
+				}
+			}
+
+			void internal_clear()
+			{
+				internal_destruct_all();
+				m_size = 0;
+				internal_free();
+			}
+
+			//! Finds the first empty or deleted slot for the specified hash.
+			usize internal_find_first_non_full(usize hash_code) const
+			{
+				ProbeSeq seq(h1(hash_code), m_capacity);
+				while (true)
+				{
+					Group g(m_ctrl + seq.m_offset);
+					auto mask = g.match_empty_or_deleted();
+					if (mask)
+					{
+						return seq.offset(mask.lowest_bit_set());
+					}
+					seq.next();
+				}
+			}
+
+			//! Reallocates the table with the new capacity and moves all elements to the new table.
+			void internal_resize(usize new_capacity)
+			{
+				ctrl_t* old_ctrl = m_ctrl;
+				value_type* old_slots = m_slots;
+				usize old_capacity = m_capacity;
+				internal_alloc(new_capacity);
+				for (usize i = 0; i < old_capacity; ++i)
+				{
+					if (is_full(old_ctrl[i]))
+					{
+						usize hash_code = mix_hash_code(hasher()(extract_key()(old_slots[i])));
+						usize target = internal_find_first_non_full(hash_code);
+						internal_set_ctrl(target, h2(hash_code));
+						copy_relocate_range(old_slots + i, old_slots + i + 1, m_slots + target);
+					}
+				}
+				if (old_capacity)
+				{
+					memfree(old_ctrl, alignof(value_type));
+				}
+			}
+
+			void internal_rehash_and_grow_if_necessary()
+			{
+				if (m_capacity > Group::width && m_size * 32 <= m_capacity * 25)
+				{
+					// Most of the free slots are deleted slots, rehash without growing to purge them.
+					internal_resize(m_capacity);
+				}
+				else
+				{
+					internal_resize(m_capacity ? m_capacity * 2 + 1 : normalize_capacity(0));
+				}
+			}
+
+			//! Finds the slot that holds the specified key, returns `m_capacity` if not found.
+			usize internal_find(const key_type& key, usize hash_code) const
+			{
+				ProbeSeq seq(h1(hash_code), m_capacity);
+				ctrl_t h = h2(hash_code);
+				while (true)
+				{
+					Group g(m_ctrl + seq.m_offset);
+					for (auto mask = g.match(h); mask; mask.clear_lowest_bit())
+					{
+						usize i = seq.offset(mask.lowest_bit_set());
+						if (key_equal()(key, extract_key()(m_slots[i])))
+						{
+							return i;
+						}
+					}
+					if (g.match_empty())
+					{
+						return m_capacity;
+					}
+					seq.next();
+				}
+			}
+
+			//! Prepares one slot for inserting a new element with the specified hash code, the element is not constructed.
+			usize internal_prepare_insert(usize hash_code)
+			{
+				usize target = internal_find_first_non_full(hash_code);
+				if (!m_growth_left && m_ctrl[target] != ctrl_deleted)
+				{
+					internal_rehash_and_grow_if_necessary();
+					target = internal_find_first_non_full(hash_code);
+				}
+				++m_size;
+				m_growth_left -= (m_ctrl[target] == ctrl_empty) ? 1 : 0;
+				internal_set_ctrl(target, h2(hash_code));
+				return target;
+			}
+
+			void internal_erase_slot(usize i)
+			{
+				destruct(m_slots + i);
+				--m_size;
+				// If there has never been a full group that contains this slot, no probing sequence can pass this slot, so
+				// this slot can be marked as empty directly. Otherwise, this slot must be marked as deleted so that lookups do
+				// not stop here.
+				usize index_before = (i - Group::width) & m_capacity;
+				auto empty_after = Group(m_ctrl + i).match_empty();
+				auto empty_before = Group(m_ctrl + index_before).match_empty();
+				bool was_never_full = empty_before && empty_after &&
+					(empty_after.trailing_zeros() + empty_before.leading_zeros()) < Group::width;
+				internal_set_ctrl(i, was_never_full ? ctrl_empty : ctrl_deleted);
+				m_growth_left += was_never_full ? 1 : 0;
+			}
+
+			void internal_copy_from(const FlatHashTable& rhs)
+			{
+				if (rhs.m_size)
+				{
+					internal_alloc(normalize_capacity(rhs.m_capacity));
+					for (usize i = 0; i < rhs.m_capacity; ++i)
+					{
+						if (is_full(rhs.m_ctrl[i]))
+						{
+							usize hash_code = mix_hash_code(hasher()(extract_key()(rhs.m_slots[i])));
+							usize target = internal_find_first_non_full(hash_code);
+							internal_set_ctrl(target, h2(hash_code));
+							new (m_slots + target) value_type(rhs.m_slots[i]);
+							++m_size;
+							--m_growth_left;
+						}
+					}
+				}
+			}
+
+			iterator iterator_at(usize i)
+			{
+				return iterator(m_ctrl + i, m_slots + i);
+			}
+			const_iterator iterator_at(usize i) const
+			{
+				return const_iterator(m_ctrl + i, m_slots + i);
+			}
+
+			FlatHashTable() :
+				m_ctrl(const_cast<ctrl_t*>(empty_group())),
+				m_slots(nullptr),
+				m_capacity(0),
+				m_size(0),
+				m_growth_left(0) {}
+			FlatHashTable(const FlatHashTable& rhs) :
+				FlatHashTable()
+			{
+				internal_copy_from(rhs);
+			}
+			FlatHashTable(FlatHashTable&& rhs) :
+				m_ctrl(rhs.m_ctrl),
+				m_slots(rhs.m_slots),
+				m_capacity(rhs.m_capacity),
+				m_size(rhs.m_size),
+				m_growth_left(rhs.m_growth_left)
+			{
+				rhs.m_ctrl = const_cast<ctrl_t*>(empty_group());
+				rhs.m_slots = nullptr;
+				rhs.m_capacity = 0;
+				rhs.m_size = 0;
+				rhs.m_growth_left = 0;
+			}
+			FlatHashTable& operator=(const FlatHashTable& rhs)
+			{
+				if (this != &rhs)
+				{
+					internal_clear();
+					internal_copy_from(rhs);
+				}
+				return *this;
+			}
+			FlatHashTable& operator=(FlatHashTable&& rhs)
+			{
+				if (this != &rhs)
+				{
+					internal_clear();
+					m_ctrl = rhs.m_ctrl;
+					m_slots = rhs.m_slots;
+					m_capacity = rhs.m_capacity;
+					m_size = rhs.m_size;
+					m_growth_left = rhs.m_growth_left;
+					rhs.m_ctrl = const_cast<ctrl_t*>(empty_group());
+					rhs.m_slots = nullptr;
+					rhs.m_capacity = 0;
+					rhs.m_size = 0;
+					rhs.m_growth_left = 0;
+				}
+				return *this;
+			}
+			~FlatHashTable()
+			{
+				internal_clear();
+			}
+
+			iterator begin()
+			{
+				iterator i(m_ctrl, m_slots);
+				i.skip_empty_or_deleted();
+				return i;
+			}
+			const_iterator begin() const
+			{
+				const_iterator i(m_ctrl, m_slots);
+				i.skip_empty_or_deleted();
+				return i;
+			}
+			const_iterator cbegin() const
+			{
+				return begin();
+			}
+			iterator end()
+			{
+				// The sentinel byte.
+				return iterator_at(m_capacity);
+			}
+			const_iterator end() const
+			{
+				return iterator_at(m_capacity);
+			}
+			const_iterator cend() const
+			{
+				return end();
+			}
+			bool empty() const
+			{
+				return m_size == 0;
+			}
+			usize size() const
+			{
+				return m_size;
+			}
+			//! The number of slots in the table.
+			usize bucket_count() const
+			{
+				return m_capacity;
+			}
+			//! The number of elements this hash table can hold before next rehash.
+			usize capacity() const
+			{
+				return m_capacity ? capacity_to_growth(m_capacity) : 0;
+			}
+			f32 load_factor() const
+			{
+				if (!m_capacity)
+				{
+					return 0.0f;
+				}
+				return (f32)m_size / (f32)m_capacity;
+			}
+			f32 max_load_factor() const
+			{
+				return 0.875f;
+			}
+			void clear()
+			{
+				internal_clear();
+			}
+			hasher hash_function() const
+			{
+				return hasher();
+			}
+			key_equal key_eq() const
+			{
+				return key_equal();
+			}
+			//! Resizes the table so that it has at least `new_buckets_count` slots. All deleted slots are purged.
+			void rehash(usize new_buckets_count)
+			{
+				if (!new_buckets_count && !m_size)
+				{
+					internal_clear();
+					return;
+				}
+				usize min_capacity = m_size + (m_size + 6) / 7;	// Keeps the load factor under 7/8.
+				usize new_capacity = normalize_capacity(max(new_buckets_count, min_capacity));
+				internal_resize(new_capacity);
+			}
+			void reserve(usize new_cap)
+			{
+				if (new_cap > m_size + m_growth_left)
+				{
+					rehash(new_cap + (new_cap + 6) / 7);
+				}
+			}
+
+			iterator find(const key_type& key)
+			{
+				return iterator_at(internal_find(key, mix_hash_code(hasher()(key))));
+			}
+
+			const_iterator find(const key_type& key) const
+			{
+				return iterator_at(internal_find(key, mix_hash_code(hasher()(key))));
+			}
+
+			usize count(const key_type& key) const
+			{
+				return contains(key) ? 1 : 0;
+			}
+
+			Pair<iterator, iterator> equal_range(const key_type& key)
+			{
+				auto iter = find(key);
+				if (iter == end())
+				{
+					return Pair<iterator, iterator>(end(), end());
+				}
+				auto next = iter;
+				++next;
+				return Pair<iterator, iterator>(iter, next);
+			}
+
+			Pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+			{
+				auto iter = find(key);
+				if (iter == end())
+				{
+					return Pair<const_iterator, const_iterator>(end(), end());
+				}
+				auto next = iter;
+				++next;
+				return Pair<const_iterator, const_iterator>(iter, next);
+			}
+
+			bool contains(const key_type& key) const
+			{
+				return internal_find(key, mix_hash_code(hasher()(key))) != m_capacity;
+			}
+
+			Pair<iterator, bool> insert(const value_type& value)
+			{
+				usize hash_code = mix_hash_code(hasher()(extract_key()(value)));
+				usize i = internal_find(extract_key()(value), hash_code);
+				if (i != m_capacity)
+				{
+					return make_pair(iterator_at(i), false);
+				}
+				i = internal_prepare_insert(hash_code);
+				new (m_slots + i) value_type(value);
+				return make_pair(iterator_at(i), true);
+			}
+
+			Pair<iterator, bool> insert(value_type&& value)
+			{
+				usize hash_code = mix_hash_code(hasher()(extract_key()(value)));
+				usize i = internal_find(extract_key()(value), hash_code);
+				if (i != m_capacity)
+				{
+					return make_pair(iterator_at(i), false);
+				}
+				i = internal_prepare_insert(hash_code);
+				new (m_slots + i) value_type(move(value));
+				return make_pair(iterator_at(i), true);
+			}
+
+			template <typename _M>
+			Pair<iterator, bool> insert_or_assign(const key_type& key, _M&& value)
+			{
+				usize hash_code = mix_hash_code(hasher()(key));
+				usize i = internal_find(key, hash_code);
+				if (i != m_capacity)
+				{
+					m_slots[i].second = forward<_M>(value);
+					return make_pair(iterator_at(i), false);
+				}
+				i = internal_prepare_insert(hash_code);
+				new (m_slots + i) value_type(key, forward<_M>(value));
+				return make_pair(iterator_at(i), true);
+			}
+
+			template <typename _M>
+			Pair<iterator, bool> insert_or_assign(key_type&& key, _M&& value)
+			{
+				usize hash_code = mix_hash_code(hasher()(key));
+				usize i = internal_find(key, hash_code);
+				if (i != m_capacity)
+				{
+					m_slots[i].second = forward<_M>(value);
+					return make_pair(iterator_at(i), false);
+				}
+				i = internal_prepare_insert(hash_code);
+				new (m_slots + i) value_type(move(key), forward<_M>(value));
+				return make_pair(iterator_at(i), true);
+			}
+
+			template <typename... _Args>
+			Pair<iterator, bool> emplace(_Args&&... args)
+			{
+				// The key must be known before the slot can be chosen, so the value is constructed on stack first.
+				value_type value(forward<_Args>(args)...);
+				return insert(move(value));
+			}
+
+			//! Erases the element. Iterators to other elements are not invalidated.
+			iterator erase(const_iterator pos)
+			{
+				usize i = (usize)(pos.m_ctrl - m_ctrl);
+				internal_erase_slot(i);
+				iterator next = iterator_at(i);
+				++next;
+				return next;
+			}
+
+			usize erase(const key_type& key)
+			{
+				usize i = internal_find(key, mix_hash_code(hasher()(key)));
+				if (i != m_capacity)
+				{
+					internal_erase_slot(i);
+					return 1;
+				}
+				return 0;
+			}
+		};
+	}
+}
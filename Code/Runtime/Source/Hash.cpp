@@ -0,0 +1,151 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Hash.cpp
+* @author JXMaster
+* @date 2021/6/2
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_RUNTIME_API LUNA_EXPORT
+#include "../Hash.hpp"
+
+#if defined(LUNA_PLATFORM_X86_64) || defined(LUNA_PLATFORM_X86)
+#include <nmmintrin.h>
+#ifdef LUNA_COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define LUNA_CRC32C_X86 1
+#elif defined(LUNA_PLATFORM_ARM64) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define LUNA_CRC32C_ARM 1
+#endif
+
+#if defined(LUNA_CRC32C_X86) && !defined(LUNA_COMPILER_MSVC)
+// Allows the SSE4.2 intrinsics to be used in this function without enabling SSE4.2 for the whole module.
+#define LUNA_CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define LUNA_CRC32C_TARGET
+#endif
+
+namespace Luna
+{
+	namespace Impl
+	{
+		struct Crc32cTable
+		{
+			u32 m_table[256];
+
+			constexpr Crc32cTable() :
+				m_table()
+			{
+				for (u32 i = 0; i < 256; ++i)
+				{
+					u32 c = i;
+					for (u32 j = 0; j < 8; ++j)
+					{
+						c = (c & 1) ? (c >> 1) ^ 0x82F63B78 : (c >> 1);
+					}
+					m_table[i] = c;
+				}
+			}
+		};
+
+		constexpr Crc32cTable crc32c_table;
+
+		static u32 crc32c_sw(const u8* p, usize size, u32 crc)
+		{
+			for (usize i = 0; i < size; ++i)
+			{
+				crc = crc32c_table.m_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+			}
+			return crc;
+		}
+
+#if defined(LUNA_CRC32C_X86)
+		LUNA_CRC32C_TARGET static u32 crc32c_hw(const u8* p, usize size, u32 crc)
+		{
+			// Processes the leading bytes until the pointer is aligned.
+			while (size && ((usize)p & 7))
+			{
+				crc = _mm_crc32_u8(crc, *p);
+				++p;
+				--size;
+			}
+#ifdef LUNA_PLATFORM_X86_64
+			u64 crc64 = crc;
+			while (size >= 8)
+			{
+				u64 v;
+				memcpy(&v, p, 8);
+				crc64 = _mm_crc32_u64(crc64, v);
+				p += 8;
+				size -= 8;
+			}
+			crc = (u32)crc64;
+#endif
+			while (size >= 4)
+			{
+				u32 v;
+				memcpy(&v, p, 4);
+				crc = _mm_crc32_u32(crc, v);
+				p += 4;
+				size -= 4;
+			}
+			while (size)
+			{
+				crc = _mm_crc32_u8(crc, *p);
+				++p;
+				--size;
+			}
+			return crc;
+		}
+		static bool crc32c_hw_supported()
+		{
+#ifdef LUNA_COMPILER_MSVC
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+#else
+			unsigned int eax, ebx, ecx, edx;
+			if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+			return (ecx & (1 << 20)) != 0;
+#endif
+		}
+		static const bool g_crc32c_hw = crc32c_hw_supported();
+#elif defined(LUNA_CRC32C_ARM)
+		static u32 crc32c_hw(const u8* p, usize size, u32 crc)
+		{
+			while (size >= 8)
+			{
+				u64 v;
+				memcpy(&v, p, 8);
+				crc = __crc32cd(crc, v);
+				p += 8;
+				size -= 8;
+			}
+			while (size)
+			{
+				crc = __crc32cb(crc, *p);
+				++p;
+				--size;
+			}
+			return crc;
+		}
+		constexpr bool g_crc32c_hw = true;
+#endif
+	}
+
+	LUNA_RUNTIME_API u32 crc32c(const void* data, usize size, u32 h)
+	{
+		const u8* p = (const u8*)data;
+		u32 crc = ~h;
+#if defined(LUNA_CRC32C_X86) || defined(LUNA_CRC32C_ARM)
+		if (Impl::g_crc32c_hw)
+		{
+			return ~Impl::crc32c_hw(p, size, crc);
+		}
+#endif
+		return ~Impl::crc32c_sw(p, size, crc);
+	}
+}
@@ -10,6 +10,7 @@
 #include "../Functional.hpp"
 #include "../Algorithm.hpp"
 #include "../Memory.hpp"
+#include "../Allocator.hpp"
 
 namespace Luna
 {
@@ -237,8 +238,9 @@ namespace Luna
 			typename _Vty,
 			typename _ExtractKey,				// MapExtractKey for HashMap, SetExtractKey for HashSet.
 			typename _Hash = hash<_Kty>,		// Used to hash the key value.
-			typename _KeyEqual = equal_to<_Kty>>	// Used to compare the element.
-		class HashTable
+			typename _KeyEqual = equal_to<_Kty>,	// Used to compare the element.
+			typename _Alloc = Allocator>		// Used to allocate nodes and buckets.
+		class HashTable : private _Alloc
 		{
 		public:
 			using key_type = _Kty;
@@ -254,6 +256,7 @@ namespace Luna
 			using local_iterator = BucketIterator<value_type, false>;
 			using const_local_iterator = BucketIterator<value_type, true>;
 			using node_type = Node<value_type>;
+			using allocator_type = _Alloc;
 
 			using extract_key = _ExtractKey;
 
@@ -274,6 +277,20 @@ namespace Luna
 
 			static constexpr usize initial_bucket_v = 16;
 
+			template <typename... _Args>
+			node_type* internal_new_node(_Args&&... args)
+			{
+				node_type* node = (node_type*)_Alloc::allocate(sizeof(node_type), alignof(node_type));
+				new (node) node_type(forward<_Args>(args)...);
+				return node;
+			}
+
+			void internal_delete_node(node_type* node)
+			{
+				node->~node_type();
+				_Alloc::deallocate(node, sizeof(node_type), alignof(node_type));
+			}
+
 			//! Clear all nodes in the specified bucket.
 			void internal_clear_bucket(usize i)
 			{
@@ -281,7 +298,7 @@ namespace Luna
 				while (cur)
 				{
 					auto next = cur->m_next;
-					memdelete(cur);
+					internal_delete_node(cur);
 					cur = next;
 				}
 				m_buckets[i] = nullptr;
@@ -292,7 +309,7 @@ namespace Luna
 			{
 				if (m_buckets)
 				{
-					memfree(m_buckets);
+					_Alloc::deallocate(m_buckets, sizeof(node_type*) * (m_bucket_count + 1));
 					m_buckets = nullptr;
 				}
 			}
@@ -311,7 +328,7 @@ namespace Luna
 
 			node_type** internal_alloc_table(usize cap)
 			{
-				node_type** buf = (node_type**)(memalloc(sizeof(node_type*) * (cap + 1)));
+				node_type** buf = (node_type**)(_Alloc::allocate(sizeof(node_type*) * (cap + 1)));
 				if (!buf)
 				{
 					return nullptr;
@@ -326,7 +343,14 @@ namespace Luna
 				m_bucket_count(0),
 				m_size(0),
 				m_max_load_factor(16) {}
+			explicit HashTable(const allocator_type& alloc) :
+				_Alloc(alloc),
+				m_buckets(nullptr),
+				m_bucket_count(0),
+				m_size(0),
+				m_max_load_factor(16) {}
 			HashTable(const HashTable& rhs) :
+				_Alloc(rhs.get_allocator()),
 				m_buckets(nullptr),
 				m_bucket_count(0),
 				m_size(0),
@@ -342,7 +366,7 @@ namespace Luna
 						node_type* iter = rhs.m_buckets[i];
 						while (iter)
 						{
-							node_type* node = memnew<node_type>(*iter);
+							node_type* node = internal_new_node(*iter);
 							// insert.
 							node->m_next = m_buckets[i];
 							m_buckets[i] = node;
@@ -353,6 +377,7 @@ namespace Luna
 				}
 			}
 			HashTable(HashTable&& rhs) :
+				_Alloc(rhs.get_allocator()),
 				m_buckets(rhs.m_buckets),
 				m_bucket_count(rhs.m_bucket_count),
 				m_size(rhs.m_size),
@@ -375,7 +400,7 @@ namespace Luna
 						node_type* iter = rhs.m_buckets[i];
 						while (iter)
 						{
-							node_type* node = memnew<node_type>(*iter);
+							node_type* node = internal_new_node(*iter);
 							// insert.
 							node->m_next = m_buckets[i];
 							m_buckets[i] = node;
@@ -389,6 +414,7 @@ namespace Luna
 			HashTable& operator=(HashTable&& rhs)
 			{
 				internal_clear();
+				Luna::swap(static_cast<_Alloc&>(*this), static_cast<_Alloc&>(rhs));
 				m_buckets = rhs.m_buckets;
 				m_bucket_count = rhs.m_bucket_count;
 				m_size = rhs.m_size;
@@ -402,6 +428,10 @@ namespace Luna
 			{
 				internal_clear();
 			}
+			allocator_type get_allocator() const
+			{
+				return *static_cast<const _Alloc*>(this);
+			}
 
 			iterator begin()
 			{
@@ -654,7 +684,7 @@ namespace Luna
 				// In case that the table is rehashed, we need to defer the mediation until 
 				// the table is rehashed. 
 				usize bucket_index = hash_code_to_bucket_index(hash_code);
-				node_type* new_node = memnew<node_type>(forward<_Args>(args)...);
+				node_type* new_node = internal_new_node(forward<_Args>(args)...);
 				new_node->m_next = m_buckets[bucket_index];
 				m_buckets[bucket_index] = new_node;
 				++m_size;
@@ -799,12 +829,12 @@ namespace Luna
 			template <typename... _Args>
 			Pair<iterator, bool> emplace(_Args&&... args)
 			{
-				node_type* new_node = memnew<node_type>(value_type(forward<_Args>(args)...));
+				node_type* new_node = internal_new_node(value_type(forward<_Args>(args)...));
 				usize hash_code = hasher()(extract_key()(new_node->m_value));
 				auto iter = internal_find(extract_key()(new_node->m_value), hash_code_to_bucket_index(hash_code));
 				if (iter != end())
 				{
-					memdelete(new_node);
+					internal_delete_node(new_node);
 					return Pair<iterator, bool>(iter, false);
 				}
 				increment_reserve(m_size + 1);
@@ -843,23 +873,23 @@ namespace Luna
 			//! Same as insert, but allows multi values being inserted using the same key.
 			iterator multi_insert(const value_type& value)
 			{
-				node_type* new_node = memnew<node_type>(value);
+				node_type* new_node = internal_new_node(value);
 				return multi_insert_node(new_node);
 			}
 			iterator multi_insert(value_type&& value)
 			{
-				node_type* new_node = memnew<node_type>(move(value));
+				node_type* new_node = internal_new_node(move(value));
 				return multi_insert_node(new_node);
 			}
 			iterator multi_insert(node_type&& node)
 			{
-				node_type* new_node = memnew<node_type>(move(node));
+				node_type* new_node = internal_new_node(move(node));
 				return multi_insert_node(new_node);
 			}
 			template <typename... _Args>
 			iterator multi_emplace(_Args&&... args)
 			{
-				node_type* new_node = memnew<node_type>(value_type(forward<_Args>(args)...));
+				node_type* new_node = internal_new_node(value_type(forward<_Args>(args)...));
 				return multi_insert_node(new_node);
 			}
 			iterator erase(const_iterator pos)
@@ -886,7 +916,7 @@ namespace Luna
 					}
 					node_cur->m_next = node_next->m_next;
 				}
-				memdelete(node);
+				internal_delete_node(node);
 				--m_size;
 				return inext;
 			}
@@ -928,7 +958,7 @@ namespace Luna
 					++iter;
 					++num_erase;
 					node_after = erase_node.m_base.m_current_node->m_next;
-					memdelete(erase_node.m_base.m_current_node);
+					internal_delete_node(erase_node.m_base.m_current_node);
 				}
 				// Modify the pointer.
 				if (!node_before)
@@ -0,0 +1,358 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Heap.cpp
+* @author JXMaster
+* @date 2021/6/8
+*/
+#include "../PlatformDefines.hpp"
+#define LUNA_RUNTIME_API LUNA_EXPORT
+#include "Heap.hpp"
+#include "OS.hpp"
+#include "../Atomic.hpp"
+
+// The small object heap reserves one large range of virtual address space on the first allocation, and
+// splits it into spans of `heap_span_size` bytes. Every span is committed when it is used for the first
+// time, and is divided into blocks of one size class.
+//
+// Every thread keeps one free list for every size class, so most allocations and deallocations do not
+// take any lock. When the thread free list is empty, one batch of blocks is fetched from the central
+// depot of that size class; when the thread free list gets too long, one batch of blocks is returned to
+// the depot. Blocks can be freed by threads other than the allocating thread.
+//
+// Spans are never returned to the system.
+
+namespace Luna
+{
+	constexpr usize heap_span_size = 64 * 1024;
+#ifdef LUNA_PLATFORM_64BIT
+	constexpr usize heap_reserve_size = 16ULL * 1024 * 1024 * 1024;
+#else
+	constexpr usize heap_reserve_size = 256 * 1024 * 1024;
+#endif
+	constexpr usize heap_max_spans = heap_reserve_size / heap_span_size;
+	constexpr u32 heap_num_size_classes = 28;
+	constexpr usize heap_cache_line_size = 64;
+
+	struct alignas(heap_cache_line_size) HeapDepot
+	{
+		HeapLock m_lock;
+		//! The free blocks, linked using the first pointer of every block.
+		void* m_free_list;
+		usize m_num_free;
+	};
+
+	struct ThreadCacheBin
+	{
+		void* m_free_list;
+		u32 m_num_free;
+	};
+
+	struct ThreadCache
+	{
+		ThreadCacheBin m_bins[heap_num_size_classes];
+		//! The number of bytes allocated minus the number of bytes freed by this thread. This is only written by
+		//! the owning thread, and may be negative if this thread frees memory allocated by other threads.
+		isize m_allocated_memory;
+		ThreadCache* m_prev;
+		ThreadCache* m_next;
+	};
+
+	//! The size of every size class. Sizes are multiples of 16 so every block is aligned to 16 bytes.
+	constexpr u32 g_size_classes[heap_num_size_classes] = {
+		16, 32, 48, 64, 80, 96, 112, 128,
+		160, 192, 224, 256,
+		320, 384, 448, 512,
+		640, 768, 896, 1024,
+		1280, 1536, 1792, 2048,
+		2560, 3072, 3584, 4096
+	};
+
+	//! Maps `(size + 15) / 16` to the size class index.
+	u8 g_size_to_class[heap_max_small_size / 16 + 1];
+
+	//! The state of the heap. 0 = not initialized, 1 = initializing, 2 = initialized.
+	u32 g_heap_state = 0;
+	u8* g_heap_base = nullptr;
+	usize g_heap_num_spans = 0;
+	//! The size class index of every span.
+	u8 g_span_classes[heap_max_spans];
+
+	HeapDepot g_heap_depots[heap_num_size_classes];
+
+	//! All live thread caches, used to aggregate statistics.
+	HeapLock g_thread_cache_lock;
+	ThreadCache* g_thread_caches = nullptr;
+	//! The allocated memory recorded by threads that have exited, and by threads that are exiting.
+	usize g_retired_allocated_memory = 0;
+
+	//! The cache of the current thread. This is set to `exiting_thread_cache` when the cache of the thread is destroyed.
+	thread_local ThreadCache* tls_thread_cache = nullptr;
+	ThreadCache* const exiting_thread_cache = (ThreadCache*)(usize)1;
+
+	//! Destroys the thread cache when the thread exits.
+	struct ThreadCacheGuard
+	{
+		~ThreadCacheGuard();
+	};
+	thread_local ThreadCacheGuard tls_thread_cache_guard;
+
+	inline u32 get_batch_size(u32 size_class)
+	{
+		u32 n = 8192 / g_size_classes[size_class];
+		return n < 4 ? 4 : (n > 64 ? 64 : n);
+	}
+
+	static void heap_init()
+	{
+		if (atom_compare_exchange_u32(&g_heap_state, 1, 0) != 0)
+		{
+			// Other thread is initializing the heap.
+			while (((volatile u32&)g_heap_state) != 2)
+			{
+				OS::yield_current_thread();
+			}
+			return;
+		}
+		u32 c = 0;
+		for (usize i = 0; i <= heap_max_small_size / 16; ++i)
+		{
+			while (g_size_classes[c] < i * 16) ++c;
+			g_size_to_class[i] = (u8)c;
+		}
+		auto r = OS::virtual_reserve(nullptr, heap_reserve_size);
+		// If the address space cannot be reserved, all allocations fall back to `OS::memalloc`.
+		g_heap_base = r.valid() ? (u8*)r.get() : nullptr;
+		atom_exchange_u32(&g_heap_state, 2);
+	}
+
+	//! Links `count` blocks starting from `begin` to one free list, returns the last block.
+	static void* link_blocks(u8* begin, usize block_size, usize count)
+	{
+		for (usize i = 0; i + 1 < count; ++i)
+		{
+			*((void**)(begin + i * block_size)) = begin + (i + 1) * block_size;
+		}
+		return begin + (count - 1) * block_size;
+	}
+
+	//! Allocates one new span for the size class and adds all blocks in it to the depot. The depot lock must be held.
+	static bool depot_grow(HeapDepot& depot, u32 size_class)
+	{
+		if (!g_heap_base) return false;
+		usize index = atom_inc_usize(&g_heap_num_spans) - 1;
+		if (index >= heap_max_spans)
+		{
+			return false;
+		}
+		u8* span = g_heap_base + index * heap_span_size;
+		if (!OS::virtual_commit(span, heap_span_size).valid())
+		{
+			return false;
+		}
+		g_span_classes[index] = (u8)size_class;
+		usize block_size = g_size_classes[size_class];
+		usize count = heap_span_size / block_size;
+		void* last = link_blocks(span, block_size, count);
+		*((void**)last) = depot.m_free_list;
+		depot.m_free_list = span;
+		depot.m_num_free += count;
+		return true;
+	}
+
+	//! Fetches one batch of blocks from the depot to the bin.
+	static void depot_fetch(ThreadCacheBin& bin, u32 size_class)
+	{
+		HeapDepot& depot = g_heap_depots[size_class];
+		u32 batch = get_batch_size(size_class);
+		depot.m_lock.lock();
+		if (!depot.m_free_list && !depot_grow(depot, size_class))
+		{
+			depot.m_lock.unlock();
+			return;
+		}
+		void* first = depot.m_free_list;
+		void* last = first;
+		u32 n = 1;
+		while (n < batch && *((void**)last))
+		{
+			last = *((void**)last);
+			++n;
+		}
+		depot.m_free_list = *((void**)last);
+		depot.m_num_free -= n;
+		depot.m_lock.unlock();
+		*((void**)last) = bin.m_free_list;
+		bin.m_free_list = first;
+		bin.m_num_free += n;
+	}
+
+	//! Returns `count` blocks from the front of the bin to the depot.
+	static void depot_return(ThreadCacheBin& bin, u32 size_class, u32 count)
+	{
+		void* first = bin.m_free_list;
+		void* last = first;
+		for (u32 i = 1; i < count; ++i)
+		{
+			last = *((void**)last);
+		}
+		bin.m_free_list = *((void**)last);
+		bin.m_num_free -= count;
+		HeapDepot& depot = g_heap_depots[size_class];
+		depot.m_lock.lock();
+		*((void**)last) = depot.m_free_list;
+		depot.m_free_list = first;
+		depot.m_num_free += count;
+		depot.m_lock.unlock();
+	}
+
+	static ThreadCache* new_thread_cache()
+	{
+		ThreadCache* cache = (ThreadCache*)OS::memalloc(sizeof(ThreadCache));
+		if (!cache) return nullptr;
+		memzero(cache, sizeof(ThreadCache));
+		g_thread_cache_lock.lock();
+		cache->m_next = g_thread_caches;
+		if (g_thread_caches) g_thread_caches->m_prev = cache;
+		g_thread_caches = cache;
+		g_thread_cache_lock.unlock();
+		// Touches the guard so that it is constructed and destroyed with this thread.
+		(void)&tls_thread_cache_guard;
+		return cache;
+	}
+
+	ThreadCacheGuard::~ThreadCacheGuard()
+	{
+		ThreadCache* cache = tls_thread_cache;
+		tls_thread_cache = exiting_thread_cache;
+		if (!cache || cache == exiting_thread_cache) return;
+		for (u32 i = 0; i < heap_num_size_classes; ++i)
+		{
+			if (cache->m_bins[i].m_num_free)
+			{
+				depot_return(cache->m_bins[i], i, cache->m_bins[i].m_num_free);
+			}
+		}
+		g_thread_cache_lock.lock();
+		if (cache->m_prev) cache->m_prev->m_next = cache->m_next;
+		else g_thread_caches = cache->m_next;
+		if (cache->m_next) cache->m_next->m_prev = cache->m_prev;
+		atom_add_usize(&g_retired_allocated_memory, cache->m_allocated_memory);
+		g_thread_cache_lock.unlock();
+		OS::memfree(cache);
+	}
+
+	//! Gets the thread cache of the current thread, returns `nullptr` if the thread is exiting.
+	inline ThreadCache* get_thread_cache()
+	{
+		ThreadCache* cache = tls_thread_cache;
+		if (cache == exiting_thread_cache) return nullptr;
+		if (!cache)
+		{
+			cache = new_thread_cache();
+			tls_thread_cache = cache;
+		}
+		return cache;
+	}
+
+	void* heap_alloc(usize size, usize& block_size)
+	{
+		if (g_heap_state != 2)
+		{
+			heap_init();
+		}
+		u32 size_class = g_size_to_class[(size + 15) >> 4];
+		block_size = g_size_classes[size_class];
+		ThreadCache* cache = get_thread_cache();
+		if (!cache)
+		{
+			// Allocates one block from the depot directly.
+			HeapDepot& depot = g_heap_depots[size_class];
+			depot.m_lock.lock();
+			if (!depot.m_free_list && !depot_grow(depot, size_class))
+			{
+				depot.m_lock.unlock();
+				return nullptr;
+			}
+			void* block = depot.m_free_list;
+			depot.m_free_list = *((void**)block);
+			--depot.m_num_free;
+			depot.m_lock.unlock();
+			return block;
+		}
+		ThreadCacheBin& bin = cache->m_bins[size_class];
+		if (!bin.m_free_list)
+		{
+			depot_fetch(bin, size_class);
+			if (!bin.m_free_list) return nullptr;
+		}
+		void* block = bin.m_free_list;
+		bin.m_free_list = *((void**)block);
+		--bin.m_num_free;
+		return block;
+	}
+
+	bool heap_contains(const void* ptr)
+	{
+		return g_heap_base && (usize)((const u8*)ptr - g_heap_base) < heap_reserve_size;
+	}
+
+	usize heap_block_size(const void* ptr)
+	{
+		usize index = (usize)((const u8*)ptr - g_heap_base) / heap_span_size;
+		return g_size_classes[g_span_classes[index]];
+	}
+
+	usize heap_free(void* ptr)
+	{
+		usize index = (usize)((const u8*)ptr - g_heap_base) / heap_span_size;
+		u32 size_class = g_span_classes[index];
+		ThreadCache* cache = get_thread_cache();
+		if (!cache)
+		{
+			HeapDepot& depot = g_heap_depots[size_class];
+			depot.m_lock.lock();
+			*((void**)ptr) = depot.m_free_list;
+			depot.m_free_list = ptr;
+			++depot.m_num_free;
+			depot.m_lock.unlock();
+			return g_size_classes[size_class];
+		}
+		ThreadCacheBin& bin = cache->m_bins[size_class];
+		*((void**)ptr) = bin.m_free_list;
+		bin.m_free_list = ptr;
+		++bin.m_num_free;
+		u32 batch = get_batch_size(size_class);
+		if (bin.m_num_free > batch * 2)
+		{
+			depot_return(bin, size_class, batch);
+		}
+		return g_size_classes[size_class];
+	}
+
+	void heap_add_allocated_memory(isize delta)
+	{
+		ThreadCache* cache = get_thread_cache();
+		if (cache)
+		{
+			cache->m_allocated_memory += delta;
+		}
+		else
+		{
+			atom_add_usize(&g_retired_allocated_memory, delta);
+		}
+	}
+
+	usize heap_get_allocated_memory()
+	{
+		g_thread_cache_lock.lock();
+		usize r = ((volatile usize&)g_retired_allocated_memory);
+		for (ThreadCache* i = g_thread_caches; i; i = i->m_next)
+		{
+			// Other threads may be modifying the value, the result is only exact if no other thread is
+			// allocating or freeing memory at the same time.
+			r += ((volatile isize&)i->m_allocated_memory);
+		}
+		g_thread_cache_lock.unlock();
+		return r;
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Heap.hpp
+* @author JXMaster
+* @date 2021/6/8
+* @brief The small object heap used by `memalloc` and `memfree`.
+*/
+#pragma once
+#include "../Base.hpp"
+#include "../Atomic.hpp"
+#include "OS.hpp"
+
+namespace Luna
+{
+	//! A simple spin lock used by the memory system. The memory system cannot use `OS::new_mutex` since it may
+	//! be called before the platform layer is initialized.
+	struct HeapLock
+	{
+		u32 m_locked;
+
+		void lock()
+		{
+			while (atom_exchange_u32(&m_locked, 1))
+			{
+				OS::yield_current_thread();
+			}
+		}
+		void unlock()
+		{
+			atom_exchange_u32(&m_locked, 0);
+		}
+	};
+
+	//! The maximum size of the memory block allocated from the small object heap. Memory blocks larger than
+	//! this are allocated from `OS::memalloc` directly.
+	constexpr usize heap_max_small_size = 4096;
+
+	//! Allocates one memory block from the small object heap.
+	//! @param[in] size The size of the memory block. This must not be 0 or larger than `heap_max_small_size`.
+	//! @param[out] block_size Receives the real size of the allocated memory block.
+	//! @return Returns the allocated memory block, or `nullptr` if the heap is exhausted. The memory block is
+	//! aligned to `max_align`.
+	void* heap_alloc(usize size, usize& block_size);
+
+	//! Checks whether the memory block is allocated from the small object heap.
+	bool heap_contains(const void* ptr);
+
+	//! Gets the real size of the memory block allocated from the small object heap.
+	usize heap_block_size(const void* ptr);
+
+	//! Frees one memory block allocated from the small object heap.
+	//! @return Returns the real size of the freed memory block.
+	usize heap_free(void* ptr);
+
+	//! Adds the number of bytes allocated by the current thread. This is recorded per thread, and is
+	//! aggregated only when `heap_get_allocated_memory` is called.
+	void heap_add_allocated_memory(isize delta);
+
+	//! Sums the number of bytes allocated by all threads.
+	usize heap_get_allocated_memory();
+}
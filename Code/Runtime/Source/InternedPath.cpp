@@ -0,0 +1,174 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file InternedPath.cpp
+* @author JXMaster
+* @date 2021/6/15
+*/
+#include <Runtime/PlatformDefines.hpp>
+#define LUNA_RUNTIME_API LUNA_EXPORT
+#include "InternedPath.hpp"
+#include "../InternedPath.hpp"
+#include "../FlatHashMap.hpp"
+#include "../Sync.hpp"
+#include "OS.hpp"
+
+namespace Luna
+{
+	//! Identifies one child node in the interned path tree.
+	struct PathNodeKey
+	{
+		//! The parent node ID, 0 for root nodes.
+		u32 m_parent;
+		//! The path flags, only used for root nodes.
+		EPathFlag m_flags;
+		//! The interned name address of the node.
+		const c8* m_name;
+
+		bool operator==(const PathNodeKey& rhs) const
+		{
+			return m_parent == rhs.m_parent && m_flags == rhs.m_flags && m_name == rhs.m_name;
+		}
+	};
+
+	struct PathNodeKeyHash
+	{
+		usize operator()(const PathNodeKey& key) const
+		{
+			u64 data[2] = { ((u64)key.m_parent << 32) | (u64)key.m_flags, (u64)(usize)key.m_name };
+			return (usize)wyhash(data, sizeof(data));
+		}
+	};
+
+	// Nodes are allocated in chunks and never moved, so that nodes can be read by ID without locking.
+	constexpr u32 path_chunk_bits = 12;
+	constexpr u32 path_chunk_size = 1 << path_chunk_bits;
+	constexpr u32 max_path_chunks = 4096;
+
+	FutexMutex g_path_mtx;
+	InternedPathNode* g_path_chunks[max_path_chunks];
+	//! The number of allocated nodes, including the unused node 0.
+	u32 g_num_path_nodes;
+	Unconstructed<FlatHashMap<PathNodeKey, u32, PathNodeKeyHash>> g_path_children;
+
+	void interned_path_init()
+	{
+		g_path_children.construct();
+		memset(g_path_chunks, 0, sizeof(g_path_chunks));
+		// Node 0 is reserved for null paths.
+		g_num_path_nodes = 1;
+	}
+	void interned_path_close()
+	{
+		for (u32 i = 0; i < max_path_chunks; ++i)
+		{
+			InternedPathNode* chunk = g_path_chunks[i];
+			if (!chunk) break;
+			u32 begin = i ? 0 : 1;
+			u32 end = min(g_num_path_nodes - i * path_chunk_size, path_chunk_size);
+			for (u32 j = begin; j < end; ++j)
+			{
+				chunk[j].~InternedPathNode();
+			}
+			OS::memfree(chunk);
+			g_path_chunks[i] = nullptr;
+		}
+		g_num_path_nodes = 0;
+		g_path_children.destruct();
+	}
+
+	inline InternedPathNode* get_path_node(u32 id)
+	{
+		return g_path_chunks[id >> path_chunk_bits] + (id & (path_chunk_size - 1));
+	}
+
+	//! Finds the node identified by the key, and creates the node if it does not exist and `create` is `true`.
+	//! The path lock must be held.
+	static u32 get_child_node(u32 parent, EPathFlag flags, const Name& name, bool create)
+	{
+		PathNodeKey key = { parent, flags, name.c_str() };
+		auto iter = g_path_children.get().find(key);
+		if (iter != g_path_children.get().end())
+		{
+			return iter->second;
+		}
+		if (!create)
+		{
+			return 0;
+		}
+		u32 id = g_num_path_nodes;
+		u32 chunk = id >> path_chunk_bits;
+		if (chunk >= max_path_chunks)
+		{
+			lupanic_msg_always("Too many interned paths.");
+		}
+		if (!g_path_chunks[chunk])
+		{
+			g_path_chunks[chunk] = (InternedPathNode*)OS::memalloc(sizeof(InternedPathNode) * path_chunk_size, alignof(InternedPathNode));
+		}
+		InternedPathNode* node = get_path_node(id);
+		new (node) InternedPathNode();
+		node->m_name = name;
+		node->m_parent = parent;
+		if (parent)
+		{
+			InternedPathNode* parent_node = get_path_node(parent);
+			node->m_root = parent_node->m_root;
+			node->m_depth = parent_node->m_depth + 1;
+			node->m_flags = parent_node->m_flags;
+		}
+		else
+		{
+			node->m_root = id;
+			node->m_depth = 0;
+			node->m_flags = flags;
+		}
+		++g_num_path_nodes;
+		g_path_children.get().insert(make_pair(key, id));
+		return id;
+	}
+
+	//! Walks the path in the interned path tree.
+	//! @param[in] create Whether to create missing nodes.
+	//! @param[in] prefix Whether to return the deepest existing node if the path is not interned.
+	static u32 lookup_path(const Path& path, EPathComponent components, bool create, bool prefix)
+	{
+		EPathFlag flags = ((components & EPathComponent::flags) != EPathComponent::none) ? path.flags() : EPathFlag::none;
+		Name empty_root;
+		const Name& root = ((components & EPathComponent::root) != EPathComponent::none) ? path.root() : empty_root;
+		g_path_mtx.lock();
+		u32 id = get_child_node(0, flags, root, create);
+		if (id)
+		{
+			for (auto& i : path)
+			{
+				u32 child = get_child_node(id, EPathFlag::none, i, create);
+				if (!child)
+				{
+					id = prefix ? id : 0;
+					break;
+				}
+				id = child;
+			}
+		}
+		g_path_mtx.unlock();
+		return id;
+	}
+
+	LUNA_RUNTIME_API u32 intern_path(const Path& path, EPathComponent components)
+	{
+		return lookup_path(path, components, true, false);
+	}
+	LUNA_RUNTIME_API u32 find_interned_path(const Path& path, EPathComponent components)
+	{
+		return lookup_path(path, components, false, false);
+	}
+	LUNA_RUNTIME_API u32 find_interned_path_prefix(const Path& path, EPathComponent components)
+	{
+		return lookup_path(path, components, false, true);
+	}
+	LUNA_RUNTIME_API const InternedPathNode* get_interned_path_node(u32 id)
+	{
+		luassert(id && id < g_num_path_nodes);
+		return get_path_node(id);
+	}
+}
@@ -0,0 +1,13 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file InternedPath.hpp
+* @author JXMaster
+* @date 2021/6/15
+*/
+#pragma once
+
+namespace Luna
+{
+	void interned_path_init();
+	void interned_path_close();
+}
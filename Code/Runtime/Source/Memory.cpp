@@ -12,103 +12,155 @@
 #include "OS.hpp"
 #include "../Atomic.hpp"
 #include "Memory.hpp"
+#include "Heap.hpp"
+#include "../Algorithm.hpp"
+#include "MemoryProfiler.hpp"
 
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-#include <unordered_map>
-#include <mutex>
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+#ifdef LUNA_COMPILER_MSVC
+#include <intrin.h>
+#define LUNA_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define LUNA_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
 #endif
 
 namespace Luna
 {
-	usize g_allocated_memory = 0;
-
 #ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-	std::unordered_map<void*, const c8*> g_memory_leak_registry_map;
-	std::unordered_map<void*, usize> g_memory_leap_map;
-	std::mutex g_memory_leak_map_mtx;
-
-	LUNA_RUNTIME_API void register_memory_block(void* blk, const c8* debug_name)
+	void check_memory_leak()
 	{
-		g_memory_leak_map_mtx.lock();
-		g_memory_leak_registry_map.insert(std::make_pair(blk, debug_name));
-		g_memory_leak_map_mtx.unlock();
+		usize allocated_memory = heap_get_allocated_memory();
+		if (allocated_memory)
+		{
+			OS::debug_printf("[MEMORY LEAK CHECK]Memory leak detected: %llu bytes.\n", (u64)allocated_memory);
+		}
+		memory_profiler_report_leaks();
 	}
-	LUNA_RUNTIME_API void unregister_memory_block(void* blk)
+#endif
+
+	//! Memory blocks allocated from the small object heap are aligned to this.
+	constexpr usize heap_block_alignment = 16;
+
+	inline bool use_heap(usize size, usize alignment)
 	{
-		g_memory_leak_map_mtx.lock();
-		g_memory_leak_registry_map.erase(blk);
-		g_memory_leak_map_mtx.unlock();
+		return size <= heap_max_small_size && alignment <= heap_block_alignment;
 	}
 
-	void check_memory_leak()
+	static void* alloc_impl(usize size, usize alignment, void* caller)
 	{
-		if (g_allocated_memory)
+		if (!size) return nullptr;
+		void* mem = nullptr;
+		usize allocated = 0;
+		if (use_heap(size, alignment))
 		{
-			OS::debug_printf("[MEMORY LEAK CHECK]Memory leak detected: %llu bytes.\n", (u64)g_allocated_memory);
+			mem = heap_alloc(size, allocated);
 		}
-		for (auto& i : g_memory_leap_map)
+		if (!mem)
 		{
-			auto iter = g_memory_leak_registry_map.find(i.first);
-			if (iter != g_memory_leak_registry_map.end())
-			{
-				OS::debug_printf("[MEMORY LEAK CHECK]Leaked block: %s, %llu bytes.\n", iter->second, i.second);
-			}
-			else
-			{
-				OS::debug_printf("[MEMORY LEAK CHECK]Leaked block: [Unnamed], %llu bytes.\n", i.second);
-			}
+			mem = OS::memalloc(size, alignment);
+			allocated = OS::memsize(mem, alignment);
 		}
-	}
+		heap_add_allocated_memory(allocated);
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		if (mem)
+		{
+			memory_profiler_on_alloc(mem, allocated, caller);
+		}
+#else
+		(void)caller;
 #endif
-
+		return mem;
+	}
 	LUNA_RUNTIME_API void* memalloc(usize size, usize alignment)
 	{
-		void* mem = OS::memalloc(size, alignment);
-		usize allocated = OS::memsize(mem, alignment);
-		atom_add_usize(&g_allocated_memory, allocated);
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-		g_memory_leak_map_mtx.lock();
-		g_memory_leap_map.insert(std::make_pair(mem, allocated));
-		g_memory_leak_map_mtx.unlock();
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		return alloc_impl(size, alignment, LUNA_RETURN_ADDRESS());
+#else
+		return alloc_impl(size, alignment, nullptr);
 #endif
-		return mem;
 	}
 	LUNA_RUNTIME_API void memfree(void* ptr, usize alignment)
 	{
-		atom_add_usize(&g_allocated_memory, -(isize)OS::memsize(ptr, alignment));
-		OS::memfree(ptr, alignment);
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-		g_memory_leak_map_mtx.lock();
-		g_memory_leap_map.erase(ptr);
-		g_memory_leak_map_mtx.unlock();
+		if (!ptr) return;
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		memory_profiler_on_free(ptr);
 #endif
+		usize allocated;
+		if (heap_contains(ptr))
+		{
+			allocated = heap_free(ptr);
+		}
+		else
+		{
+			allocated = OS::memsize(ptr, alignment);
+			OS::memfree(ptr, alignment);
+		}
+		heap_add_allocated_memory(-(isize)allocated);
 	}
 	LUNA_RUNTIME_API void* memrealloc(void* ptr, usize size, usize alignment)
 	{
-		usize old_allocated = ptr ? OS::memsize(ptr, alignment) : 0;
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		void* caller = LUNA_RETURN_ADDRESS();
+#else
+		void* caller = nullptr;
+#endif
+		if (!ptr)
+		{
+			return alloc_impl(size, alignment, caller);
+		}
+		if (!size)
+		{
+			memfree(ptr, alignment);
+			return nullptr;
+		}
+		if (heap_contains(ptr) || use_heap(size, alignment))
+		{
+			// Moving between the small object heap and the system heap, or between size classes.
+			usize old_size = memsize(ptr, alignment);
+			if (size <= old_size && (size > old_size / 2 || old_size <= heap_block_alignment))
+			{
+				return ptr;
+			}
+			void* mem = alloc_impl(size, alignment, caller);
+			if (mem)
+			{
+				memcpy(mem, ptr, min(old_size, size));
+				memfree(ptr, alignment);
+			}
+			return mem;
+		}
+		usize old_allocated = OS::memsize(ptr, alignment);
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		// The old block must be recorded as freed before it can be reused by other threads.
+		memory_profiler_on_free(ptr);
+#endif
 		void* mem = OS::memrealloc(ptr, size, alignment);
 		usize new_allocated = mem ? OS::memsize(mem, alignment) : 0;
-		atom_add_usize(&g_allocated_memory, (isize)new_allocated - (isize)old_allocated);
-#ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
-		g_memory_leak_map_mtx.lock();
-		if (ptr)
+		if (mem)
 		{
-			g_memory_leap_map.erase(ptr);
+			heap_add_allocated_memory((isize)new_allocated - (isize)old_allocated);
 		}
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
 		if (mem)
 		{
-			g_memory_leap_map.insert(std::make_pair(mem, new_allocated));
+			memory_profiler_on_alloc(mem, new_allocated, caller);
+		}
+		else
+		{
+			// The old block is not changed.
+			memory_profiler_on_alloc(ptr, old_allocated, caller);
 		}
-		g_memory_leak_map_mtx.unlock();
 #endif
 		return mem;
 	}
 	LUNA_RUNTIME_API usize memsize(void* ptr, usize alignment)
 	{
-		return OS::memsize(ptr, alignment);
+		if (!ptr) return 0;
+		return heap_contains(ptr) ? heap_block_size(ptr) : OS::memsize(ptr, alignment);
 	}
 	LUNA_RUNTIME_API usize get_allocated_memory()
 	{
-		return g_allocated_memory;
+		return heap_get_allocated_memory();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,687 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file MemoryProfiler.cpp
+* @author JXMaster
+* @date 2021/6/12
+*/
+#include "../PlatformDefines.hpp"
+#define LUNA_RUNTIME_API LUNA_EXPORT
+#include "MemoryProfiler.hpp"
+
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+
+#include "Heap.hpp"
+#include "OS.hpp"
+#include "../Atomic.hpp"
+#include "../Hash.hpp"
+#include "../HashMap.hpp"
+#include "../HashSet.hpp"
+#include "../Vector.hpp"
+
+// Every thread records its allocations and deallocations to its own ring buffer (the thread log) without taking any
+// lock. Events are collected from all thread logs by one background thread, or by the allocating thread when its log
+// is full, and are applied to the statistics tables under one lock.
+//
+// Every event is stamped with the monotonic system tick count rather than one global counter, so that threads do not
+// contend on one shared cache line. Events of one thread are always in timestamp order, so all logs are merged by the
+// timestamp when collecting. Since one allocation is recorded before the memory block is returned to the user, and one
+// deallocation is recorded before the memory block is returned to the heap, the deallocation of one address never has
+// a larger timestamp than the next allocation of the same address. Events that cannot be applied yet, like one event
+// that is collected before another event of the same address that has the same timestamp or is not published yet,
+// are kept and retried in the next collection.
+//
+// The profiler allocates its own memory from `OS::memalloc`, so it is not recorded and not counted by
+// `get_allocated_memory`.
+
+namespace Luna
+{
+	constexpr u32 memory_log_capacity = 4096;
+	constexpr u32 memory_max_stack_frames = 16;
+	constexpr u32 memory_profiler_update_interval = 10;
+
+	enum class MemoryEventType : u32
+	{
+		allocate = 0,
+		free = 1,
+		name = 2,
+	};
+
+	struct MemoryEvent
+	{
+		//! The tick count when the event is recorded.
+		u64 m_ticks;
+		void* m_ptr;
+		usize m_size;
+		//! The tag for allocations, or the debug name for names.
+		const c8* m_tag;
+		void* m_caller;
+		u32 m_stack_hash;
+		MemoryEventType m_type;
+	};
+
+	struct ThreadLog
+	{
+		MemoryEvent m_events[memory_log_capacity];
+		//! The number of events written. This is only written by the owning thread.
+		alignas(64) u32 m_head;
+		//! The number of events collected. This is only written by the collecting thread.
+		alignas(64) u32 m_tail;
+		//! Non-zero if the owning thread is exited.
+		u32 m_retired;
+		//! The head and the retired state when the log is collected, used only by the collecting thread.
+		u32 m_collect_head;
+		bool m_collect_retired;
+		ThreadLog* m_next;
+	};
+
+	//! Allocates memory for profiler tables.
+	struct ProfilerAllocator
+	{
+		void* allocate(usize size, usize alignment = 0)
+		{
+			return OS::memalloc(size, alignment);
+		}
+		void deallocate(void* ptr, usize size, usize alignment = 0)
+		{
+			OS::memfree(ptr, alignment);
+		}
+		bool operator==(const ProfilerAllocator&) const
+		{
+			return true;
+		}
+		bool operator!=(const ProfilerAllocator&) const
+		{
+			return false;
+		}
+	};
+
+	struct PointerHash
+	{
+		usize operator()(const void* ptr) const
+		{
+			return (usize)Impl::wyhash_mix((u64)(usize)ptr, 0x9E3779B97F4A7C15ULL);
+		}
+	};
+
+	//! Tags are compared by content, so that the same string literal in different modules is treated as the same tag.
+	struct TagHash
+	{
+		usize operator()(const c8* tag) const
+		{
+			return tag ? (usize)strwyhash(tag) : 0;
+		}
+	};
+	struct TagEqual
+	{
+		bool operator()(const c8* lhs, const c8* rhs) const
+		{
+			if (lhs == rhs) return true;
+			if (!lhs || !rhs) return false;
+			return !strcmp(lhs, rhs);
+		}
+	};
+
+	struct AllocatorKey
+	{
+		void* m_caller;
+		u32 m_stack_hash;
+	};
+	struct AllocatorKeyHash
+	{
+		usize operator()(const AllocatorKey& key) const
+		{
+			return (usize)Impl::wyhash_mix((u64)(usize)key.m_caller, key.m_stack_hash ^ 0x9E3779B97F4A7C15ULL);
+		}
+	};
+	struct AllocatorKeyEqual
+	{
+		bool operator()(const AllocatorKey& lhs, const AllocatorKey& rhs) const
+		{
+			return lhs.m_caller == rhs.m_caller && lhs.m_stack_hash == rhs.m_stack_hash;
+		}
+	};
+
+	struct TagRecord
+	{
+		const c8* m_tag = nullptr;
+		usize m_live_bytes = 0;
+		usize m_live_blocks = 0;
+		usize m_frame_bytes = 0;
+		usize m_frame_allocations = 0;
+		usize m_last_frame_bytes = 0;
+		usize m_last_frame_allocations = 0;
+		u64 m_total_bytes = 0;
+		u64 m_total_allocations = 0;
+	};
+
+	struct AllocatorRecord
+	{
+		AllocatorKey m_key;
+		const c8* m_tag = nullptr;
+		usize m_live_bytes = 0;
+		usize m_live_blocks = 0;
+		usize m_frame_bytes = 0;
+		usize m_last_frame_bytes = 0;
+		u64 m_total_allocations = 0;
+	};
+
+	//! Records are never removed from tag and allocator tables, and nodes of `HashMap` are never moved, so every block
+	//! refers to its records directly.
+	struct BlockRecord
+	{
+		usize m_size;
+		TagRecord* m_tag;
+		AllocatorRecord* m_allocator;
+		const c8* m_name;
+	};
+
+	struct MemoryProfiler
+	{
+		HashMap<void*, BlockRecord, PointerHash, equal_to<void*>, ProfilerAllocator> m_blocks;
+		HashMap<const c8*, TagRecord, TagHash, TagEqual, ProfilerAllocator> m_tags;
+		HashMap<AllocatorKey, AllocatorRecord, AllocatorKeyHash, AllocatorKeyEqual, ProfilerAllocator> m_allocators;
+		//! Events that cannot be applied in the last collection, in sequence order.
+		Vector<MemoryEvent, ProfilerAllocator> m_deferred;
+		Vector<MemoryEvent, ProfilerAllocator> m_next_deferred;
+		//! Addresses that have deferred events in the current collection.
+		HashSet<void*, PointerHash, equal_to<void*>, ProfilerAllocator> m_blocked;
+		//! The records of the last allocation, since continuous allocations usually have the same tag and allocator.
+		TagRecord* m_last_tag = nullptr;
+		AllocatorRecord* m_last_allocator = nullptr;
+	};
+
+	HeapLock g_memory_profiler_lock;
+	Unconstructed<MemoryProfiler> g_memory_profiler;
+	bool g_memory_profiler_initialized = false;
+	//! All thread logs. Only accessed when `g_memory_profiler_lock` is held.
+	ThreadLog* g_thread_logs = nullptr;
+	//! The log used by threads that are exiting, only accessed when `g_memory_profiler_lock` is held.
+	ThreadLog* g_exiting_thread_log = nullptr;
+	bool g_memory_stack_capture_enabled = false;
+
+	handle_t g_memory_profiler_thread = nullptr;
+	u32 g_memory_profiler_exiting = 0;
+
+	thread_local ThreadLog* tls_thread_log = nullptr;
+	thread_local const c8* tls_memory_tag = nullptr;
+	ThreadLog* const exiting_thread_log = (ThreadLog*)(usize)1;
+
+	//! Retires the thread log when the thread exits.
+	struct ThreadLogGuard
+	{
+		~ThreadLogGuard();
+	};
+	thread_local ThreadLogGuard tls_thread_log_guard;
+
+	static ThreadLog* new_thread_log()
+	{
+		ThreadLog* log = (ThreadLog*)OS::memalloc(sizeof(ThreadLog), alignof(ThreadLog));
+		if (!log) return nullptr;
+		log->m_head = 0;
+		log->m_tail = 0;
+		log->m_retired = 0;
+		log->m_collect_head = 0;
+		log->m_collect_retired = false;
+		log->m_next = nullptr;
+		return log;
+	}
+
+	//! Must be called when `g_memory_profiler_lock` is held.
+	static void ensure_profiler_initialized()
+	{
+		if (!g_memory_profiler_initialized)
+		{
+			g_memory_profiler.construct();
+			// The block table may contain millions of blocks, so uses a low load factor to keep chains short.
+			g_memory_profiler.get().m_blocks.max_load_factor(1.0f);
+			g_exiting_thread_log = new_thread_log();
+			g_exiting_thread_log->m_next = g_thread_logs;
+			g_thread_logs = g_exiting_thread_log;
+			g_memory_profiler_initialized = true;
+		}
+	}
+
+	static TagRecord* get_tag_record(MemoryProfiler& p, const c8* tag)
+	{
+		if (p.m_last_tag && TagEqual()(p.m_last_tag->m_tag, tag))
+		{
+			return p.m_last_tag;
+		}
+		auto iter = p.m_tags.find(tag);
+		if (iter == p.m_tags.end())
+		{
+			TagRecord record;
+			record.m_tag = tag;
+			iter = p.m_tags.insert(make_pair(tag, record)).first;
+		}
+		p.m_last_tag = &iter->second;
+		return p.m_last_tag;
+	}
+
+	static AllocatorRecord* get_allocator_record(MemoryProfiler& p, const AllocatorKey& key, const c8* tag)
+	{
+		if (p.m_last_allocator && AllocatorKeyEqual()(p.m_last_allocator->m_key, key))
+		{
+			return p.m_last_allocator;
+		}
+		auto iter = p.m_allocators.find(key);
+		if (iter == p.m_allocators.end())
+		{
+			AllocatorRecord record;
+			record.m_key = key;
+			record.m_tag = tag;
+			iter = p.m_allocators.insert(make_pair(key, record)).first;
+		}
+		p.m_last_allocator = &iter->second;
+		return p.m_last_allocator;
+	}
+
+	static void apply_alloc(MemoryProfiler& p, const MemoryEvent& e)
+	{
+		AllocatorKey key;
+		key.m_caller = e.m_caller;
+		key.m_stack_hash = e.m_stack_hash;
+		BlockRecord block;
+		block.m_size = e.m_size;
+		block.m_tag = get_tag_record(p, e.m_tag);
+		block.m_allocator = get_allocator_record(p, key, e.m_tag);
+		block.m_name = nullptr;
+		p.m_blocks.insert(make_pair(e.m_ptr, block));
+		TagRecord& t = *block.m_tag;
+		t.m_live_bytes += e.m_size;
+		++t.m_live_blocks;
+		t.m_frame_bytes += e.m_size;
+		++t.m_frame_allocations;
+		t.m_total_bytes += e.m_size;
+		++t.m_total_allocations;
+		AllocatorRecord& a = *block.m_allocator;
+		a.m_live_bytes += e.m_size;
+		++a.m_live_blocks;
+		a.m_frame_bytes += e.m_size;
+		++a.m_total_allocations;
+	}
+
+	static void apply_free(MemoryProfiler& p, const BlockRecord& block)
+	{
+		block.m_tag->m_live_bytes -= block.m_size;
+		--block.m_tag->m_live_blocks;
+		block.m_allocator->m_live_bytes -= block.m_size;
+		--block.m_allocator->m_live_blocks;
+	}
+
+	//! Applies one event. Returns `false` if the event must be applied after one event that is not collected yet.
+	static bool apply_event(MemoryProfiler& p, const MemoryEvent& e)
+	{
+		if (!p.m_blocked.empty() && p.m_blocked.contains(e.m_ptr))
+		{
+			return false;
+		}
+		auto iter = p.m_blocks.find(e.m_ptr);
+		switch (e.m_type)
+		{
+		case MemoryEventType::allocate:
+			if (iter != p.m_blocks.end())
+			{
+				// The deallocation of the previous block at this address is not collected yet.
+				return false;
+			}
+			apply_alloc(p, e);
+			return true;
+		case MemoryEventType::free:
+			if (iter == p.m_blocks.end())
+			{
+				// The allocation of this block is not collected yet.
+				return false;
+			}
+			apply_free(p, iter->second);
+			p.m_blocks.erase(iter);
+			return true;
+		case MemoryEventType::name:
+			// The name is always recorded after the allocation by the same thread, so the block can be missing only if
+			// it is already freed.
+			if (iter != p.m_blocks.end())
+			{
+				iter->second.m_name = e.m_tag;
+			}
+			return true;
+		}
+		return true;
+	}
+
+	//! Collects events from all thread logs. Must be called when `g_memory_profiler_lock` is held.
+	static void collect_events()
+	{
+		ensure_profiler_initialized();
+		MemoryProfiler& p = g_memory_profiler.get();
+		// Takes a snapshot of every log. The retired flag must be read before the head, so that all events of one
+		// retired log are collected.
+		for (ThreadLog* log = g_thread_logs; log; log = log->m_next)
+		{
+			log->m_collect_retired = atom_add_u32(&log->m_retired, 0) != 0;
+			log->m_collect_head = atom_add_u32(&log->m_head, 0);
+		}
+		// Merges all logs and the deferred events by timestamp.
+		usize deferred_index = 0;
+		p.m_next_deferred.clear();
+		while (true)
+		{
+			const MemoryEvent* e = nullptr;
+			ThreadLog* src = nullptr;
+			if (deferred_index < p.m_deferred.size())
+			{
+				e = &p.m_deferred[deferred_index];
+			}
+			for (ThreadLog* log = g_thread_logs; log; log = log->m_next)
+			{
+				if (log->m_tail != log->m_collect_head)
+				{
+					const MemoryEvent* le = &log->m_events[log->m_tail % memory_log_capacity];
+					if (!e || le->m_ticks < e->m_ticks)
+					{
+						e = le;
+						src = log;
+					}
+				}
+			}
+			if (!e) break;
+			if (!apply_event(p, *e))
+			{
+				p.m_blocked.insert(e->m_ptr);
+				p.m_next_deferred.push_back(*e);
+			}
+			if (src)
+			{
+				// Releases the slot to the owning thread.
+				atom_exchange_u32(&src->m_tail, src->m_tail + 1);
+			}
+			else
+			{
+				++deferred_index;
+			}
+		}
+		p.m_blocked.clear();
+		p.m_deferred.swap(p.m_next_deferred);
+		// Frees retired logs.
+		ThreadLog** link = &g_thread_logs;
+		while (*link)
+		{
+			ThreadLog* log = *link;
+			if (log->m_collect_retired)
+			{
+				*link = log->m_next;
+				OS::memfree(log, alignof(ThreadLog));
+			}
+			else
+			{
+				link = &log->m_next;
+			}
+		}
+	}
+
+	ThreadLogGuard::~ThreadLogGuard()
+	{
+		ThreadLog* log = tls_thread_log;
+		tls_thread_log = exiting_thread_log;
+		if (log && log != exiting_thread_log)
+		{
+			atom_exchange_u32(&log->m_retired, 1);
+		}
+	}
+
+	static ThreadLog* get_thread_log()
+	{
+		ThreadLog* log = tls_thread_log;
+		if (log) return log;
+		(void)&tls_thread_log_guard;
+		log = new_thread_log();
+		if (!log) return nullptr;
+		g_memory_profiler_lock.lock();
+		ensure_profiler_initialized();
+		log->m_next = g_thread_logs;
+		g_thread_logs = log;
+		g_memory_profiler_lock.unlock();
+		tls_thread_log = log;
+		return log;
+	}
+
+	static void record_event(MemoryEvent& e)
+	{
+		ThreadLog* log = get_thread_log();
+		if (!log) return;
+		if (log == exiting_thread_log)
+		{
+			// The thread is exiting, records the event to the shared log. The timestamp is taken while the lock is held
+			// so that the shared log is in timestamp order.
+			g_memory_profiler_lock.lock();
+			log = g_exiting_thread_log;
+			if (log->m_head - log->m_tail >= memory_log_capacity)
+			{
+				collect_events();
+			}
+			e.m_ticks = OS::get_ticks();
+			log->m_events[log->m_head % memory_log_capacity] = e;
+			atom_exchange_u32(&log->m_head, log->m_head + 1);
+			g_memory_profiler_lock.unlock();
+			return;
+		}
+		u32 head = log->m_head;
+		if (head - ((volatile u32&)log->m_tail) >= memory_log_capacity)
+		{
+			g_memory_profiler_lock.lock();
+			collect_events();
+			g_memory_profiler_lock.unlock();
+		}
+		e.m_ticks = OS::get_ticks();
+		log->m_events[head % memory_log_capacity] = e;
+		// Publishes the event.
+		atom_exchange_u32(&log->m_head, head + 1);
+	}
+
+	void memory_profiler_on_alloc(void* ptr, usize size, void* caller)
+	{
+		MemoryEvent e;
+		e.m_ptr = ptr;
+		e.m_size = size;
+		e.m_tag = tls_memory_tag;
+		e.m_caller = caller;
+		e.m_stack_hash = 0;
+		e.m_type = MemoryEventType::allocate;
+		if (g_memory_stack_capture_enabled)
+		{
+			void* frames[memory_max_stack_frames];
+			u32 num_frames = OS::capture_stack_trace(frames, memory_max_stack_frames);
+			if (num_frames)
+			{
+				e.m_stack_hash = (u32)wyhash(frames, sizeof(void*) * num_frames);
+			}
+		}
+		record_event(e);
+	}
+
+	void memory_profiler_on_free(void* ptr)
+	{
+		MemoryEvent e;
+		e.m_ptr = ptr;
+		e.m_size = 0;
+		e.m_tag = nullptr;
+		e.m_caller = nullptr;
+		e.m_stack_hash = 0;
+		e.m_type = MemoryEventType::free;
+		record_event(e);
+	}
+
+	static void memory_profiler_thread_main(void*)
+	{
+		while (!((volatile u32&)g_memory_profiler_exiting))
+		{
+			OS::sleep(memory_profiler_update_interval);
+			update_memory_profiler();
+		}
+	}
+
+	void memory_profiler_init()
+	{
+		g_memory_profiler_exiting = 0;
+		auto r = OS::new_thread(memory_profiler_thread_main, nullptr, 256 * 1024);
+		if (succeeded(r))
+		{
+			g_memory_profiler_thread = r.get();
+		}
+	}
+
+	void memory_profiler_close()
+	{
+		if (g_memory_profiler_thread)
+		{
+			atom_exchange_u32(&g_memory_profiler_exiting, 1);
+			OS::wait_thread(g_memory_profiler_thread);
+			OS::detach_thread(g_memory_profiler_thread);
+			g_memory_profiler_thread = nullptr;
+		}
+		update_memory_profiler();
+	}
+
+	void memory_profiler_report_leaks()
+	{
+		g_memory_profiler_lock.lock();
+		collect_events();
+		MemoryProfiler& p = g_memory_profiler.get();
+		for (auto& i : p.m_blocks)
+		{
+			const BlockRecord& block = i.second;
+			const c8* name = block.m_name ? block.m_name : (block.m_tag->m_tag ? block.m_tag->m_tag : "[Unnamed]");
+			OS::debug_printf("[MEMORY LEAK CHECK]Leaked block: %s, %llu bytes, allocated at 0x%llx.\n",
+				name, (u64)block.m_size, (u64)(usize)block.m_allocator->m_key.m_caller);
+		}
+		g_memory_profiler_lock.unlock();
+	}
+
+	LUNA_RUNTIME_API void register_memory_block(void* blk, const c8* debug_name)
+	{
+		if (!blk) return;
+		MemoryEvent e;
+		e.m_ptr = blk;
+		e.m_size = 0;
+		e.m_tag = debug_name;
+		e.m_caller = nullptr;
+		e.m_stack_hash = 0;
+		e.m_type = MemoryEventType::name;
+		record_event(e);
+	}
+	LUNA_RUNTIME_API void unregister_memory_block(void* blk)
+	{
+		(void)blk;
+	}
+	LUNA_RUNTIME_API const c8* set_memory_tag(const c8* tag)
+	{
+		const c8* prev = tls_memory_tag;
+		tls_memory_tag = tag;
+		return prev;
+	}
+	LUNA_RUNTIME_API const c8* get_memory_tag()
+	{
+		return tls_memory_tag;
+	}
+	LUNA_RUNTIME_API void set_memory_stack_capture_enabled(bool enabled)
+	{
+		g_memory_stack_capture_enabled = enabled;
+	}
+	LUNA_RUNTIME_API bool is_memory_stack_capture_enabled()
+	{
+		return g_memory_stack_capture_enabled;
+	}
+	LUNA_RUNTIME_API void update_memory_profiler()
+	{
+		g_memory_profiler_lock.lock();
+		collect_events();
+		g_memory_profiler_lock.unlock();
+	}
+	LUNA_RUNTIME_API void memory_profiler_new_frame()
+	{
+		g_memory_profiler_lock.lock();
+		collect_events();
+		MemoryProfiler& p = g_memory_profiler.get();
+		for (auto& i : p.m_tags)
+		{
+			i.second.m_last_frame_bytes = i.second.m_frame_bytes;
+			i.second.m_last_frame_allocations = i.second.m_frame_allocations;
+			i.second.m_frame_bytes = 0;
+			i.second.m_frame_allocations = 0;
+		}
+		for (auto& i : p.m_allocators)
+		{
+			i.second.m_last_frame_bytes = i.second.m_frame_bytes;
+			i.second.m_frame_bytes = 0;
+		}
+		g_memory_profiler_lock.unlock();
+	}
+
+	//! Inserts `value` to `arr` (which has `size` elements and the capacity of `max_size`) so that `arr` is sorted by
+	//! live bytes in descending order. Returns the new size of `arr`.
+	template <typename _Ty>
+	static usize insert_top(_Ty* arr, usize size, usize max_size, const _Ty& value)
+	{
+		usize i = size;
+		while (i > 0 && arr[i - 1].live_bytes < value.live_bytes)
+		{
+			if (i < max_size)
+			{
+				arr[i] = arr[i - 1];
+			}
+			--i;
+		}
+		if (i < max_size)
+		{
+			arr[i] = value;
+		}
+		return size < max_size ? size + 1 : size;
+	}
+
+	LUNA_RUNTIME_API usize get_memory_tag_stats(MemoryTagStats* stats, usize max_stats)
+	{
+		g_memory_profiler_lock.lock();
+		collect_events();
+		MemoryProfiler& p = g_memory_profiler.get();
+		usize num_stats = 0;
+		for (auto& i : p.m_tags)
+		{
+			MemoryTagStats s;
+			s.tag = i.first;
+			s.live_bytes = i.second.m_live_bytes;
+			s.live_blocks = i.second.m_live_blocks;
+			s.frame_allocated_bytes = i.second.m_last_frame_bytes;
+			s.frame_allocations = i.second.m_last_frame_allocations;
+			s.total_allocated_bytes = i.second.m_total_bytes;
+			s.total_allocations = i.second.m_total_allocations;
+			num_stats = insert_top(stats, num_stats, max_stats, s);
+		}
+		usize r = p.m_tags.size();
+		g_memory_profiler_lock.unlock();
+		return r;
+	}
+
+	LUNA_RUNTIME_API usize get_top_memory_allocators(MemoryAllocatorStats* stats, usize max_stats)
+	{
+		g_memory_profiler_lock.lock();
+		collect_events();
+		MemoryProfiler& p = g_memory_profiler.get();
+		usize num_stats = 0;
+		for (auto& i : p.m_allocators)
+		{
+			if (!i.second.m_live_blocks) continue;
+			MemoryAllocatorStats s;
+			s.caller = i.first.m_caller;
+			s.stack_hash = i.first.m_stack_hash;
+			s.tag = i.second.m_tag;
+			s.live_bytes = i.second.m_live_bytes;
+			s.live_blocks = i.second.m_live_blocks;
+			s.frame_allocated_bytes = i.second.m_last_frame_bytes;
+			s.total_allocations = i.second.m_total_allocations;
+			num_stats = insert_top(stats, num_stats, max_stats, s);
+		}
+		g_memory_profiler_lock.unlock();
+		return num_stats;
+	}
+}
+
+#endif
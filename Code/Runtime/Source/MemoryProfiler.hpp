@@ -0,0 +1,34 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file MemoryProfiler.hpp
+* @author JXMaster
+* @date 2021/6/12
+* @brief The memory profiler that records every allocation when `LUNA_RUNTIME_PROFILE_MEMORY` is defined.
+*/
+#pragma once
+#include "../Memory.hpp"
+
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+
+namespace Luna
+{
+	//! Starts the background thread that collects allocations. This is called when the runtime is initialized.
+	//! Allocations that happen before this are recorded and collected when the logs are full or when statistics are read.
+	void memory_profiler_init();
+
+	//! Stops the background thread and collects all pending allocations.
+	void memory_profiler_close();
+
+	//! Records one allocation. This must be called before the memory block is returned to the user.
+	//! @param[in] caller The address of the code that calls `memalloc` or `memrealloc`.
+	void memory_profiler_on_alloc(void* ptr, usize size, void* caller);
+
+	//! Records one deallocation. This must be called before the memory block is returned to the heap, so that
+	//! the deallocation is always recorded before the same address is allocated again.
+	void memory_profiler_on_free(void* ptr);
+
+	//! Prints all live memory blocks to the debug console.
+	void memory_profiler_report_leaks();
+}
+
+#endif
@@ -8,83 +8,166 @@
 #define LUNA_RUNTIME_API LUNA_EXPORT
 #include "Name.hpp"
 #include "../Name.hpp"
-#include "../HashMap.hpp"
+#include "../FlatHashMap.hpp"
+#include "../Atomic.hpp"
+#include "../Sync.hpp"
 #include "OS.hpp"
 namespace Luna
 {
-	struct NameEntry
+	//! The header stored in front of every interned name string. The name pointer returned to the user points
+	//! to the first character right after the header, so the header can be fetched from the name pointer directly
+	//! without querying the name table.
+	struct NameHeader
 	{
-		c8* m_str;
+		//! The reference count of the name. This is modified atomically, so copying one `Name` only
+		//! needs one atomic increment and does not touch the name table.
 		u32 m_ref_count;
+		//! The length of the name string, not including the null terminator.
+		u32 m_size;
+		//! The string ID of the name. This equals to `m_hash` unless the hash collides with another name.
+		u64 m_id;
+		//! The hash of the name string.
+		u64 m_hash;
+		//! The next name that has the same hash as this name.
+		NameHeader* m_next;
+	};
 
-		NameEntry(c8* str, u32 ref_count) :
-			m_str(str),
-			m_ref_count(ref_count) {}
+	//! The name table is split into several shards, every shard has its own lock, so that threads
+	//! interning different names rarely contend on the same lock.
+	struct NameShard
+	{
+		FutexMutex m_mtx;
+		//! Maps name hashes to the names. Names with the same hash are chained using `NameHeader::m_next`.
+		FlatHashMap<u64, NameHeader*> m_map;
+		//! Maps the string IDs of names whose hash collides with other names (`m_id != m_hash`).
+		FlatHashMap<u64, NameHeader*> m_collided_names;
 	};
 
-	Unconstructed<HashMap<u64, NameEntry>> g_name_map;
-	handle_t g_name_mtx;
+	constexpr u32 name_shard_bits = 6;
+	constexpr usize name_shard_count = 1 << name_shard_bits;
+
+	Unconstructed<NameShard> g_name_shards[name_shard_count];
+
+	inline NameHeader* get_name_header(const c8* name)
+	{
+		return ((NameHeader*)name) - 1;
+	}
+
+	inline usize get_name_shard_index(u64 h)
+	{
+		// Uses the high bits of the multiplicative hash so that the shard index does not correlate with the
+		// bucket index (which uses the low bits) of the hash map in the shard.
+		return (usize)((h * 0x9E3779B97F4A7C15ULL) >> (64 - name_shard_bits));
+	}
+
+	inline NameShard& get_name_shard(u64 h)
+	{
+		return g_name_shards[get_name_shard_index(h)].get();
+	}
 
 	void name_init()
 	{
-		g_name_mtx = OS::new_mutex();
-		g_name_map.construct();
+		for (usize i = 0; i < name_shard_count; ++i)
+		{
+			g_name_shards[i].construct();
+		}
 	}
 	void name_close()
 	{
-		OS::delete_mutex(g_name_mtx);
-		g_name_mtx = nullptr;
-		g_name_map.destruct();
+		for (usize i = 0; i < name_shard_count; ++i)
+		{
+			g_name_shards[i].destruct();
+		}
 	}
-	LUNA_RUNTIME_API const c8* intern_name(const c8* name)
+	//! Finds the name with the specified string ID in the shard. The shard lock must be held.
+	static NameHeader* find_name_by_id(NameShard& shard, u64 id)
 	{
-		if (!name || (*name == '0')) return nullptr;
-		u64 h = strhash64(name);
-		OS::lock_mutex(g_name_mtx);
-		auto iter = g_name_map.get().find(h);
-		if (iter != g_name_map.get().end())
+		auto iter = shard.m_collided_names.find(id);
+		if (iter != shard.m_collided_names.end())
 		{
-			++iter->second.m_ref_count;
-			OS::unlock_mutex(g_name_mtx);
-			return iter->second.m_str;
+			return iter->second;
 		}
-		else
+		auto head = shard.m_map.find(id);
+		if (head != shard.m_map.end())
 		{
-			// Create new entry.
-			usize len = strlen(name);
-			u64* h_buf = (u64*)OS::memalloc(sizeof(c8) * (len + 1) + sizeof(u64));
-			c8* buf = (c8*)(h_buf + 1);
-			*h_buf = h;
-			strcpy(buf, name);
-			g_name_map.get().insert(make_pair(h, NameEntry(buf, 1)));
-			OS::unlock_mutex(g_name_mtx);
-			return buf;
+			for (NameHeader* i = head->second; i; i = i->m_next)
+			{
+				if (i->m_id == id) return i;
+			}
 		}
+		return nullptr;
 	}
-	LUNA_RUNTIME_API const c8* intern_name(const c8* name, usize count)
+	//! Allocates one unused string ID for the name whose hash collides with other names. The shard lock must be held.
+	static u64 alloc_collided_name_id(NameShard& shard, u64 h)
+	{
+		usize shard_index = get_name_shard_index(h);
+		u64 id = h;
+		// The new ID must be mapped to the same shard so that it can be checked and registered with only
+		// the lock of this shard being held.
+		do
+		{
+			id = wyhash(&id, sizeof(u64), h);
+		} while (!id || get_name_shard_index(id) != shard_index || find_name_by_id(shard, id));
+		return id;
+	}
+	static const c8* intern_name_with_hash(const c8* name, usize count, u64 h)
 	{
-		if (!name || (*name == '0')) return nullptr;
-		u64 h = memhash64(name, count);
-		OS::lock_mutex(g_name_mtx);
-		auto iter = g_name_map.get().find(h);
-		if (iter != g_name_map.get().end())
+		NameShard& shard = get_name_shard(h);
+		shard.m_mtx.lock();
+		auto iter = shard.m_map.find(h);
+		NameHeader* head = nullptr;
+		if (iter != shard.m_map.end())
 		{
-			++iter->second.m_ref_count;
-			OS::unlock_mutex(g_name_mtx);
-			return iter->second.m_str;
+			head = iter->second;
+			// Compares the string to rule out hash collisions.
+			for (NameHeader* header = head; header; header = header->m_next)
+			{
+				if (header->m_size == count && !memcmp(header + 1, name, sizeof(c8) * count))
+				{
+					// The entry may have its reference count dropped to 0 by another thread that is waiting for the
+					// shard lock to remove it, in such case we revive the entry, and the releasing thread will
+					// skip removing it.
+					atom_inc_u32(&header->m_ref_count);
+					shard.m_mtx.unlock();
+					return (const c8*)(header + 1);
+				}
+			}
+		}
+		// Create new entry.
+		NameHeader* header = (NameHeader*)OS::memalloc(sizeof(NameHeader) + sizeof(c8) * (count + 1));
+		header->m_ref_count = 1;
+		header->m_size = (u32)count;
+		header->m_hash = h;
+		header->m_id = find_name_by_id(shard, h) ? alloc_collided_name_id(shard, h) : h;
+		header->m_next = head;
+		c8* buf = (c8*)(header + 1);
+		memcpy(buf, name, sizeof(c8) * count);
+		buf[count] = 0;
+		if (head)
+		{
+			iter->second = header;
 		}
 		else
 		{
-			// Create new entry.
-			u64* h_buf = (u64*)OS::memalloc(sizeof(c8) * (count + 1) + sizeof(u64));
-			c8* buf = (c8*)(h_buf + 1);
-			*h_buf = h;
-			memcpy(buf, name, sizeof(c8) * count);
-			buf[count] = 0;
-			g_name_map.get().insert(make_pair(h, NameEntry(buf, 1)));
-			OS::unlock_mutex(g_name_mtx);
-			return buf;
+			shard.m_map.insert(make_pair(h, header));
+		}
+		if (header->m_id != h)
+		{
+			shard.m_collided_names.insert(make_pair(header->m_id, header));
 		}
+		shard.m_mtx.unlock();
+		return buf;
+	}
+	LUNA_RUNTIME_API const c8* intern_name(const c8* name)
+	{
+		if (!name || !(*name)) return nullptr;
+		usize len = strlen(name);
+		return intern_name_with_hash(name, len, wyhash(name, len));
+	}
+	LUNA_RUNTIME_API const c8* intern_name(const c8* name, usize count)
+	{
+		if (!name || !count) return nullptr;
+		return intern_name_with_hash(name, count, wyhash(name, count));
 	}
 	LUNA_RUNTIME_API u64 get_name_id(const c8* name)
 	{
@@ -92,52 +175,67 @@ namespace Luna
 		{
 			return 0;
 		}
-		return *(((u64*)name) - 1);
+		return get_name_header(name)->m_id;
 	}
-	LUNA_RUNTIME_API const c8* fetch_name(u64 id)
+	LUNA_RUNTIME_API usize get_name_size(const c8* name)
 	{
-		if (!id) return nullptr;
-		OS::lock_mutex(g_name_mtx);
-		auto iter = g_name_map.get().find(id);
-		if (iter == g_name_map.get().end())
+		if (!name)
 		{
-			OS::unlock_mutex(g_name_mtx);
-			return nullptr;
+			return 0;
 		}
-		OS::unlock_mutex(g_name_mtx);
-		return iter->second.m_str;
+		return get_name_header(name)->m_size;
+	}
+	LUNA_RUNTIME_API const c8* fetch_name(u64 id)
+	{
+		if (!id) return nullptr;
+		NameShard& shard = get_name_shard(id);
+		shard.m_mtx.lock();
+		NameHeader* header = find_name_by_id(shard, id);
+		shard.m_mtx.unlock();
+		return header ? (const c8*)(header + 1) : nullptr;
 	}
 	LUNA_RUNTIME_API void retain_name(const c8* name)
 	{
 		if (!name) return;
-		OS::lock_mutex(g_name_mtx);
-		auto iter = g_name_map.get().find(get_name_id(name));
-		if (iter == g_name_map.get().end())
-		{
-			OS::unlock_mutex(g_name_mtx);
-			return;
-		}
-		++iter->second.m_ref_count;
-		OS::unlock_mutex(g_name_mtx);
+		// The caller holds one reference to the name, so the entry cannot be freed during this call.
+		atom_inc_u32(&get_name_header(name)->m_ref_count);
 	}
 	LUNA_RUNTIME_API void release_name(const c8* name)
 	{
 		if (!name) return;
-		OS::lock_mutex(g_name_mtx);
-		auto iter = g_name_map.get().find(get_name_id(name));
-		if (iter == g_name_map.get().end())
+		NameHeader* header = get_name_header(name);
+		// Reads the hash before decreasing the reference count, since the entry may be freed by other threads
+		// as soon as the reference count drops to 0.
+		u64 h = header->m_hash;
+		if (atom_dec_u32(&header->m_ref_count))
 		{
-			OS::unlock_mutex(g_name_mtx);
 			return;
 		}
-		--iter->second.m_ref_count;
-		if (!iter->second.m_ref_count)
+		// Removes the entry from the table, unless another thread has revived it or has already removed it.
+		NameShard& shard = get_name_shard(h);
+		shard.m_mtx.lock();
+		auto iter = shard.m_map.find(h);
+		if (iter != shard.m_map.end())
 		{
-			// Release entry.
-			OS::memfree(((u64*)(iter->second.m_str)) - 1);
-			iter->second.m_str = nullptr;
-			g_name_map.get().erase(iter);
+			NameHeader** link = &(iter->second);
+			while (*link && *link != header)
+			{
+				link = &((*link)->m_next);
+			}
+			if (*link && !header->m_ref_count)
+			{
+				*link = header->m_next;
+				if (!iter->second)
+				{
+					shard.m_map.erase(iter);
+				}
+				if (header->m_id != h)
+				{
+					shard.m_collided_names.erase(header->m_id);
+				}
+				OS::memfree(header);
+			}
 		}
-		OS::unlock_mutex(g_name_mtx);
+		shard.m_mtx.unlock();
 	}
-}
\ No newline at end of file
+}
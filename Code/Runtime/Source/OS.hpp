@@ -29,6 +29,37 @@ namespace Luna
 		//! Fetches the number of logical processors on the platform.
 		u32 get_num_processors();
 
+		//! Describes one logical processor.
+		struct ProcessorInfo
+		{
+			//! The index of the logical processor, which is used to identify processors in `set_thread_affinity`.
+			u32 processor;
+			//! The index of the physical core that the processor belongs to. Logical processors with the same core index are
+			//! SMT siblings (hyper-threads) that share execution units.
+			u32 core;
+			//! The index of the physical package (socket) that the processor belongs to.
+			u32 package;
+			//! The NUMA node that the processor belongs to. This is 0 if the platform does not support NUMA.
+			u32 numa_node;
+			//! The identifier of the L2 cache used by the processor. Processors with the same identifier share one L2 cache.
+			//! This is `u32_max` if the platform does not report the cache topology.
+			u32 l2_cache;
+			//! The identifier of the L3 cache used by the processor. Processors with the same identifier share one L3 cache.
+			//! This is `u32_max` if the platform does not report the cache topology.
+			u32 l3_cache;
+		};
+
+		//! Queries the topology of logical processors that the process can run on.
+		//! @param[out] processors The array to receive the processor information, sorted by processor index. This can be
+		//! `nullptr` if `max_processors` is 0.
+		//! @param[in] max_processors The number of elements in `processors`.
+		//! @return Returns the number of logical processors. If this is greater than `max_processors`, only the first
+		//! `max_processors` processors are written.
+		u32 get_processor_topology(ProcessorInfo* processors, u32 max_processors);
+
+		//! Fetches the number of NUMA nodes on the platform. Returns 1 if the platform does not support NUMA.
+		u32 get_num_numa_nodes();
+
 		//! Reports an assertion failure information to the underlying OS or CRT.
 		//! This function works in all builds, and can be called even if the runtime is not initialized.
 		//! The behavior of this function depends on the OS/CRT implementation, but in general it will 
@@ -58,6 +89,13 @@ namespace Luna
 		//! Prints a message to the debug console attached to this process with `VarList` as arguments.
 		void debug_vprintf(const c8* fmt, VarList args);
 
+		//! Captures the call stack of the current thread.
+		//! @param[out] frames The array to receive the return addresses of the call stack, starting from the caller of
+		//! this function.
+		//! @param[in] max_frames The number of elements in `frames`.
+		//! @return Returns the number of frames captured. Returns 0 if the platform does not support capturing call stacks.
+		u32 capture_stack_trace(void** frames, u32 max_frames);
+
 		//! Reserves a region of pages in the virtual address space of the calling process.
 		//! @param[in] address The starting address of the region to reserve. If this parameter is NULL, the system 
 		//! determines where to reserve the region.
@@ -135,6 +173,19 @@ namespace Luna
 		//! @return Returns the size of bytes of the memory block. If `ptr` is `nullptr`, the returned value is 0.
 		usize memsize(void* ptr, usize alignment = 0);
 
+		//! Allocates memory pages from the specified NUMA node. Use this for memory that is mostly accessed by threads
+		//! running on processors of the same node.
+		//! @param[in] size The number of bytes to allocate. The size is rounded up to times of the page size.
+		//! @param[in] numa_node The NUMA node to allocate memory from. If the node does not have enough free memory, or the
+		//! platform does not support NUMA, the memory may be allocated from other nodes.
+		//! @return Returns a pointer to the allocated memory, or `nullptr` if failed.
+		void* numa_memalloc(usize size, u32 numa_node);
+
+		//! Frees memory allocated by `OS::numa_memalloc`.
+		//! @param[in] ptr The pointer returned by `OS::numa_memalloc`. If this is `nullptr`, this function does nothing.
+		//! @param[in] size The size specified when calling `OS::numa_memalloc`.
+		void numa_memfree(void* ptr, usize size);
+
 		//! Global object creation function.
 		template <typename _Ty, typename... _Args>
 		_Ty* memnew(_Args&&... args)
@@ -214,6 +265,14 @@ namespace Luna
 		//! Releases the semaphore acquired.
 		void release_semaphore(handle_t sema);
 
+		//! Suspends the current thread if the value at `address` equals to `compare_value`, until `futex_wake` is called
+		//! for the same address or the wait times out. This may return spuriously.
+		//! @return Returns `false` if the wait times out, returns `true` otherwise.
+		bool futex_wait(volatile u32* address, u32 compare_value, u32 timeout_milliseconds);
+
+		//! Resumes at most `count` threads that are suspended by `futex_wait` on the address.
+		void futex_wake(volatile u32* address, u32 count);
+
 		//! Queries the ticks of the high-performance counter of CPU.
 		//! @return Returns the current ticks of the CPU.
 		u64 get_ticks();
@@ -261,6 +320,17 @@ namespace Luna
 		//! @param[in] priority The priority to set.
 		RV set_thread_priority(handle_t thread, ThreadPriority priority);
 
+		//! Restricts the thread to run only on the specified logical processors.
+		//! @param[in] thread The thread handle returned by `new_thread`.
+		//! @param[in] processors The indices of logical processors the thread can run on, see `ProcessorInfo::processor`.
+		//! @param[in] num_processors The number of elements in `processors`. If this is 0, the thread can run on all
+		//! processors.
+		RV set_thread_affinity(handle_t thread, const u32* processors, u32 num_processors);
+
+		//! Restricts the current thread to run only on the specified logical processors. Unlike `set_thread_affinity`, this
+		//! can be called by threads that are not created by `new_thread`, like the main thread.
+		RV set_current_thread_affinity(const u32* processors, u32 num_processors);
+
 		//! Waits for the thread to finish.
 		void wait_thread(handle_t thread);
 
@@ -360,6 +430,11 @@ namespace Luna
 			read = 0x01,
 			//! Grants write access to the file so that `write` operations can be performed.
 			write = 0x02,
+			//! Reads and writes data directly from/to the device without going through the system file cache 
+			//! (`O_DIRECT` on Linux, `F_NOCACHE` on macOS, `FILE_FLAG_NO_BUFFERING` on Windows).
+			//! The buffer address, the file offset and the size of every read and write should be aligned to the sector
+			//! size of the device (4096 bytes is safe for most devices), or the operation may fail.
+			unbuffered = 0x08,
 		};
 
 		enum class FileCreationMode : u32
@@ -420,6 +495,19 @@ namespace Luna
 			end = 3
 		};
 
+		enum class FileMapHint : u32
+		{
+			//! No special access pattern.
+			normal = 0,
+			//! The mapped data will be accessed from low addresses to high addresses once. The system may read ahead aggressively
+			//! and free pages soon after they are accessed.
+			sequential = 1,
+			//! The mapped data will be accessed in random order. The system may disable read-ahead.
+			random = 2,
+			//! The mapped data will be accessed soon. The system may start reading the data into memory before this call returns.
+			will_need = 3,
+		};
+
 		//! Opens unbuffered file.
 		//! @param[in] path The path of the file.
 		//! @param[in] flags The file open flags.
@@ -499,6 +587,130 @@ namespace Luna
 		//! @param[in] file The file handle opened by `open_file`.
 		RV flush_file(handle_t file);
 
+		//! Maps one range of the file to the virtual address space of the process as read-only memory.
+		//! @param[in] file The file handle opened by `open_file` with `FileOpenFlag::read`.
+		//! @param[in] offset The offset of the first byte to map from the beginning of the file. This does not need to be 
+		//! aligned to the page size.
+		//! @param[in] size The number of bytes to map. This must not be 0, and `offset + size` must not exceed the file size.
+		//! @param[in] hint The expected access pattern of the mapped data.
+		//! @return Returns the address of the byte at `offset`, or one of the following error codes if failed:
+		//! * BasicError::bad_arguments
+		//! * BasicError::access_denied
+		//! * BasicError::bad_memory_alloc
+		//! * BasicError::bad_system_call for all errors that cannot be identified.
+		//! @remark The mapping stays valid after the file handle is closed, and must be released by `unmap_file`.
+		//! Modifying the mapped data causes a segmentation fault. If the file is truncated by another process while being 
+		//! mapped, accessing the truncated part also causes a segmentation fault.
+		R<void*> map_file(handle_t file, u64 offset, usize size, FileMapHint hint);
+
+		//! Releases one mapping created by `map_file`.
+		//! @param[in] data The address returned by `map_file`.
+		//! @param[in] size The size passed to `map_file`.
+		void unmap_file(void* data, usize size);
+
+		//! Reads data from the specified position of the file. This call does not use or change the cursor on POSIX platforms,
+		//! but moves the cursor on Windows, so do not mix this with cursor-based reads and writes on the same file.
+		//! This can be called from multiple threads on the same file at the same time.
+		//! @param[in] file The file handle opened by `open_file`.
+		//! @param[in] offset The position to read from, in bytes from the beginning of the file.
+		//! @param[in] buffer The buffer used to store the read data.
+		//! @param[in] size The size of the data to read in bytes.
+		//! @param[out] read_bytes If this is not `nullptr`, the system sets the actual size of bytes being read to this
+		//! parameter, which is smaller than `size` only when the end of the file is reached.
+		RV read_file_at(handle_t file, u64 offset, void* buffer, usize size, usize* read_bytes = nullptr);
+
+		//! Writes data to the specified position of the file. See `read_file_at` for details.
+		//! @param[in] file The file handle opened by `open_file`.
+		//! @param[in] offset The position to write to, in bytes from the beginning of the file.
+		//! @param[in] buffer The buffer that holds the data to be written.
+		//! @param[in] size The size of the data to write in bytes.
+		//! @param[out] write_bytes If not `nullptr`, the system sets the actual size of bytes being written to this parameter.
+		RV write_file_at(handle_t file, u64 offset, const void* buffer, usize size, usize* write_bytes = nullptr);
+
+		enum class AsyncIOOp : u32
+		{
+			//! Does nothing, but still posts one completion. Can be used to wake up the thread that waits for completions.
+			nop = 0,
+			//! Reads data from the file, like `read_file_at`.
+			read = 1,
+			//! Writes data to the file, like `write_file_at`.
+			write = 2,
+		};
+
+		//! Specifies that the buffer of one asynchronous I/O request is not registered by `register_async_io_buffers`.
+		constexpr u32 async_io_unregistered_buffer = u32_max;
+
+		struct AsyncIORequest
+		{
+			AsyncIOOp op;
+			//! The file handle opened by `open_file`.
+			handle_t file;
+			//! The position to read from or write to, in bytes from the beginning of the file.
+			u64 offset;
+			//! The buffer to read data to or write data from. The buffer must be valid until the request is completed.
+			void* buffer;
+			//! The number of bytes to read or write.
+			u32 size;
+			//! The index of the registered buffer that contains `buffer`, or `async_io_unregistered_buffer`.
+			u32 buffer_index;
+			//! The user data that is returned in the completion of this request, which identifies the request.
+			//! `u64_max` is reserved by the system and must not be used.
+			u64 user_data;
+		};
+
+		struct AsyncIOCompletion
+		{
+			//! The `AsyncIORequest::user_data` of the completed request.
+			u64 user_data;
+			//! 0 if the request succeeded, otherwise the error code. Requests canceled by `cancel_async_io` fail with
+			//! `BasicError::user_canceled`.
+			errcode_t result;
+			//! The number of bytes read or written.
+			usize transferred_bytes;
+		};
+
+		//! Creates one queue that performs file I/O requests asynchronously in the system kernel (`io_uring` on Linux).
+		//! @param[in] depth The maximum number of requests that can be submitted to the queue and not completed.
+		//! @return Returns the queue handle, or `BasicError::not_supported` if asynchronous I/O is not supported by the 
+		//! platform or the running system. Use a thread pool that calls `read_file_at`/`write_file_at` in such case.
+		//! @remark Submitting, canceling and registering buffers must be synchronized, and waiting for completions must 
+		//! be synchronized, but one thread can submit requests while another thread is waiting for completions.
+		R<handle_t> new_async_io_queue(u32 depth);
+
+		//! Closes one queue created by `new_async_io_queue`. All requests must be completed before the queue is closed.
+		void delete_async_io_queue(handle_t queue);
+
+		//! Registers buffers to the queue, so that the system does not need to map them for every request. This can be 
+		//! called only once for every queue.
+		//! @param[in] queue The queue handle.
+		//! @param[in] buffers The address of every buffer.
+		//! @param[in] sizes The size of every buffer.
+		//! @param[in] count The number of buffers.
+		RV register_async_io_buffers(handle_t queue, void* const* buffers, const usize* sizes, u32 count);
+
+		//! Submits requests to the queue.
+		//! @param[in] queue The queue handle.
+		//! @param[in] requests The requests to submit.
+		//! @param[in] count The number of requests to submit. The number of requests not completed should not exceed the
+		//! depth of the queue.
+		//! @return Returns the number of requests submitted, which may be smaller than `count` if the queue is full or the
+		//! system is busy. Requests that are not submitted are not recorded by the queue and should be submitted again later.
+		R<u32> submit_async_io(handle_t queue, const AsyncIORequest* requests, u32 count);
+
+		//! Requests the system to cancel one submitted request. The request still posts its completion, with
+		//! `BasicError::user_canceled` if it is canceled, or with its result if it completes before being canceled.
+		//! @param[in] queue The queue handle.
+		//! @param[in] user_data The user data of the request to cancel.
+		RV cancel_async_io(handle_t queue, u64 user_data);
+
+		//! Fetches completions of requests.
+		//! @param[in] queue The queue handle.
+		//! @param[out] completions The array to receive completions.
+		//! @param[in] max_completions The number of elements in `completions`.
+		//! @param[in] wait If `true`, blocks the calling thread until at least one completion is fetched.
+		//! @return Returns the number of completions fetched.
+		u32 wait_async_io(handle_t queue, AsyncIOCompletion* completions, u32 max_completions, bool wait);
+
 		//! Same as `open_file`, but opens the file with user-space buffering.
 		//! @param[in] path The path of the file.
 		//! @param[in] flags The file open flags.
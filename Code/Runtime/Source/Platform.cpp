@@ -17,6 +17,23 @@ namespace Luna
 		{
 			return OS::get_num_processors();
 		}
+		static_assert(sizeof(ProcessorInfo) == sizeof(OS::ProcessorInfo), "Platform::ProcessorInfo mismatch.");
+		LUNA_RUNTIME_API u32 get_processor_topology(ProcessorInfo* processors, u32 max_processors)
+		{
+			return OS::get_processor_topology((OS::ProcessorInfo*)processors, max_processors);
+		}
+		LUNA_RUNTIME_API u32 get_num_numa_nodes()
+		{
+			return OS::get_num_numa_nodes();
+		}
+		LUNA_RUNTIME_API void* numa_memalloc(usize size, u32 numa_node)
+		{
+			return OS::numa_memalloc(size, numa_node);
+		}
+		LUNA_RUNTIME_API void numa_memfree(void* ptr, usize size)
+		{
+			OS::numa_memfree(ptr, size);
+		}
 		LUNA_RUNTIME_API void debug_printf(const c8* fmt, ...)
 		{
 			VarList args;
@@ -104,6 +121,14 @@ namespace Luna
 		{
 			OS::release_semaphore(sema);
 		}
+		LUNA_RUNTIME_API bool futex_wait(volatile u32* address, u32 compare_value, u32 timeout_milliseconds)
+		{
+			return OS::futex_wait(address, compare_value, timeout_milliseconds);
+		}
+		LUNA_RUNTIME_API void futex_wake(volatile u32* address, u32 count)
+		{
+			OS::futex_wake(address, count);
+		}
 		LUNA_RUNTIME_API u64 get_ticks()
 		{
 			return OS::get_ticks();
@@ -140,6 +165,14 @@ namespace Luna
 		{
 			return OS::set_thread_priority(thread, (OS::ThreadPriority)priority);
 		}
+		LUNA_RUNTIME_API RV set_thread_affinity(handle_t thread, const u32* processors, u32 num_processors)
+		{
+			return OS::set_thread_affinity(thread, processors, num_processors);
+		}
+		LUNA_RUNTIME_API RV set_current_thread_affinity(const u32* processors, u32 num_processors)
+		{
+			return OS::set_current_thread_affinity(processors, num_processors);
+		}
 		LUNA_RUNTIME_API void wait_thread(handle_t thread)
 		{
 			OS::wait_thread(thread);
@@ -224,6 +257,48 @@ namespace Luna
 		{
 			return OS::flush_file(file);
 		}
+		LUNA_RUNTIME_API R<void*> map_file(handle_t file, u64 offset, usize size, FileMapHint hint)
+		{
+			return OS::map_file(file, offset, size, (OS::FileMapHint)hint);
+		}
+		LUNA_RUNTIME_API void unmap_file(void* data, usize size)
+		{
+			OS::unmap_file(data, size);
+		}
+		LUNA_RUNTIME_API RV read_file_at(handle_t file, u64 offset, void* buffer, usize size, usize* read_bytes)
+		{
+			return OS::read_file_at(file, offset, buffer, size, read_bytes);
+		}
+		LUNA_RUNTIME_API RV write_file_at(handle_t file, u64 offset, const void* buffer, usize size, usize* write_bytes)
+		{
+			return OS::write_file_at(file, offset, buffer, size, write_bytes);
+		}
+		static_assert(sizeof(AsyncIORequest) == sizeof(OS::AsyncIORequest), "Platform::AsyncIORequest mismatch.");
+		static_assert(sizeof(AsyncIOCompletion) == sizeof(OS::AsyncIOCompletion), "Platform::AsyncIOCompletion mismatch.");
+		LUNA_RUNTIME_API R<handle_t> new_async_io_queue(u32 depth)
+		{
+			return OS::new_async_io_queue(depth);
+		}
+		LUNA_RUNTIME_API void delete_async_io_queue(handle_t queue)
+		{
+			OS::delete_async_io_queue(queue);
+		}
+		LUNA_RUNTIME_API RV register_async_io_buffers(handle_t queue, void* const* buffers, const usize* sizes, u32 count)
+		{
+			return OS::register_async_io_buffers(queue, buffers, sizes, count);
+		}
+		LUNA_RUNTIME_API R<u32> submit_async_io(handle_t queue, const AsyncIORequest* requests, u32 count)
+		{
+			return OS::submit_async_io(queue, (const OS::AsyncIORequest*)requests, count);
+		}
+		LUNA_RUNTIME_API RV cancel_async_io(handle_t queue, u64 user_data)
+		{
+			return OS::cancel_async_io(queue, user_data);
+		}
+		LUNA_RUNTIME_API u32 wait_async_io(handle_t queue, AsyncIOCompletion* completions, u32 max_completions, bool wait)
+		{
+			return OS::wait_async_io(queue, (OS::AsyncIOCompletion*)completions, max_completions, wait);
+		}
 		LUNA_RUNTIME_API R<handle_t> open_buffered_file(const c8* path, FileOpenFlag flags, FileCreationMode creation)
 		{
 			return OS::open_buffered_file(path, (OS::FileOpenFlag)flags, (OS::FileCreationMode)creation);
@@ -0,0 +1,378 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AsyncIO.cpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#include <Runtime/PlatformDefines.hpp>
+#ifdef LUNA_PLATFORM_POSIX
+
+#include "../../OS.hpp"
+#include <Runtime/Memory.hpp>
+#include <Runtime/Atomic.hpp>
+#include <Runtime/Algorithm.hpp>
+
+#ifdef LUNA_PLATFORM_LINUX
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace Luna
+{
+	namespace OS
+	{
+#ifdef LUNA_PLATFORM_LINUX
+		//! The user data of requests submitted by the system (like cancel requests), whose completions are not returned
+		//! to the user.
+		constexpr u64 async_io_internal_user_data = u64_max;
+
+		struct AsyncIOQueue
+		{
+			int m_fd;
+			u32 m_sq_entries;
+
+			void* m_sq_ring;
+			usize m_sq_ring_size;
+			volatile u32* m_sq_head;
+			volatile u32* m_sq_tail;
+			u32 m_sq_mask;
+			u32* m_sq_array;
+			io_uring_sqe* m_sqes;
+			usize m_sqes_size;
+
+			void* m_cq_ring;
+			usize m_cq_ring_size;
+			volatile u32* m_cq_head;
+			volatile u32* m_cq_tail;
+			u32 m_cq_mask;
+			io_uring_cqe* m_cqes;
+
+			AsyncIOQueue() :
+				m_fd(-1),
+				m_sq_ring(MAP_FAILED),
+				m_sqes(nullptr),
+				m_cq_ring(MAP_FAILED) {}
+
+			~AsyncIOQueue()
+			{
+				if (m_sqes && (void*)m_sqes != MAP_FAILED)
+				{
+					munmap(m_sqes, m_sqes_size);
+				}
+				if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+				{
+					munmap(m_cq_ring, m_cq_ring_size);
+				}
+				if (m_sq_ring != MAP_FAILED)
+				{
+					munmap(m_sq_ring, m_sq_ring_size);
+				}
+				if (m_fd >= 0)
+				{
+					::close(m_fd);
+				}
+			}
+
+			//! Gets one free submission entry, or `nullptr` if the submission ring is full.
+			io_uring_sqe* get_sqe(u32 index_after_tail)
+			{
+				u32 tail = *m_sq_tail + index_after_tail;
+				u32 head = *m_sq_head;
+				atom_fence_acquire();
+				if (tail - head >= m_sq_entries)
+				{
+					return nullptr;
+				}
+				u32 index = tail & m_sq_mask;
+				m_sq_array[index] = index;
+				io_uring_sqe* sqe = &m_sqes[index];
+				memzero(sqe, sizeof(io_uring_sqe));
+				return sqe;
+			}
+
+			//! Publishes `count` entries written by `get_sqe` and submits them to the kernel.
+			//! @return Returns the number of entries consumed by the kernel, which is smaller than `count` only if the kernel
+			//! is busy. Entries that are not consumed are removed from the ring.
+			R<u32> submit(u32 count)
+			{
+				atom_fence_release();
+				*m_sq_tail = *m_sq_tail + count;
+				u32 submitted = 0;
+				while (submitted < count)
+				{
+					int r = (int)syscall(__NR_io_uring_enter, m_fd, count - submitted, 0, 0, nullptr, 0);
+					if (r < 0)
+					{
+						if (errno == EINTR)
+						{
+							continue;
+						}
+						// The kernel only reads the ring in `io_uring_enter` (the ring is not polled by the kernel),
+						// so entries that are not consumed can be taken back. Entries must not be left in the ring, since
+						// nothing submits them if no other request is submitted later.
+						int err = errno;
+						*m_sq_tail = *m_sq_tail - (count - submitted);
+						if (err == EAGAIN || err == EBUSY)
+						{
+							return R<u32>::success(submitted);
+						}
+						return BasicError::bad_system_call();
+					}
+					submitted += (u32)r;
+				}
+				return R<u32>::success(submitted);
+			}
+		};
+
+		R<handle_t> new_async_io_queue(u32 depth)
+		{
+			if (!depth)
+			{
+				return BasicError::bad_arguments();
+			}
+			io_uring_params params;
+			memzero(&params, sizeof(io_uring_params));
+			int fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+			if (fd < 0)
+			{
+				// ENOSYS if the kernel is older than 5.1, EPERM if io_uring is disabled by the system.
+				return errno == ENOMEM ? BasicError::bad_memory_alloc() : BasicError::not_supported();
+			}
+			AsyncIOQueue* q = memnew<AsyncIOQueue>();
+			q->m_fd = fd;
+			// `IORING_OP_READ` and `IORING_OP_WRITE` are added in Linux 5.6 along with `IORING_FEAT_RW_CUR_POS`.
+			if (!(params.features & IORING_FEAT_RW_CUR_POS))
+			{
+				memdelete(q);
+				return BasicError::not_supported();
+			}
+			q->m_sq_entries = params.sq_entries;
+			q->m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+			q->m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (single_mmap)
+			{
+				q->m_sq_ring_size = q->m_cq_ring_size = max(q->m_sq_ring_size, q->m_cq_ring_size);
+			}
+			q->m_sq_ring = mmap(nullptr, q->m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (q->m_sq_ring == MAP_FAILED)
+			{
+				memdelete(q);
+				return BasicError::bad_system_call();
+			}
+			q->m_cq_ring = single_mmap ? q->m_sq_ring :
+				mmap(nullptr, q->m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (q->m_cq_ring == MAP_FAILED)
+			{
+				memdelete(q);
+				return BasicError::bad_system_call();
+			}
+			q->m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+			q->m_sqes = (io_uring_sqe*)mmap(nullptr, q->m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+			if ((void*)q->m_sqes == MAP_FAILED)
+			{
+				memdelete(q);
+				return BasicError::bad_system_call();
+			}
+			u8* sq = (u8*)q->m_sq_ring;
+			q->m_sq_head = (volatile u32*)(sq + params.sq_off.head);
+			q->m_sq_tail = (volatile u32*)(sq + params.sq_off.tail);
+			q->m_sq_mask = *(u32*)(sq + params.sq_off.ring_mask);
+			q->m_sq_array = (u32*)(sq + params.sq_off.array);
+			u8* cq = (u8*)q->m_cq_ring;
+			q->m_cq_head = (volatile u32*)(cq + params.cq_off.head);
+			q->m_cq_tail = (volatile u32*)(cq + params.cq_off.tail);
+			q->m_cq_mask = *(u32*)(cq + params.cq_off.ring_mask);
+			q->m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+			return (handle_t)q;
+		}
+
+		void delete_async_io_queue(handle_t queue)
+		{
+			memdelete((AsyncIOQueue*)queue);
+		}
+
+		RV register_async_io_buffers(handle_t queue, void* const* buffers, const usize* sizes, u32 count)
+		{
+			AsyncIOQueue* q = (AsyncIOQueue*)queue;
+			iovec* vecs = (iovec*)memalloc(sizeof(iovec) * count);
+			for (u32 i = 0; i < count; ++i)
+			{
+				vecs[i].iov_base = buffers[i];
+				vecs[i].iov_len = sizes[i];
+			}
+			int r = (int)syscall(__NR_io_uring_register, q->m_fd, IORING_REGISTER_BUFFERS, vecs, count);
+			int err = errno;
+			memfree(vecs);
+			if (r < 0)
+			{
+				switch (err)
+				{
+				case EBUSY:
+					return BasicError::busy();
+				case ENOMEM:
+					// The registered memory is locked, and counts towards `RLIMIT_MEMLOCK`.
+					return BasicError::bad_memory_alloc();
+				case EINVAL:
+				case EFAULT:
+					return BasicError::bad_arguments();
+				default:
+					return BasicError::bad_system_call();
+				}
+			}
+			return RV();
+		}
+
+		R<u32> submit_async_io(handle_t queue, const AsyncIORequest* requests, u32 count)
+		{
+			AsyncIOQueue* q = (AsyncIOQueue*)queue;
+			u32 n = 0;
+			for (; n < count; ++n)
+			{
+				io_uring_sqe* sqe = q->get_sqe(n);
+				if (!sqe)
+				{
+					break;
+				}
+				const AsyncIORequest& req = requests[n];
+				luassert(req.user_data != async_io_internal_user_data);
+				bool fixed = req.buffer_index != async_io_unregistered_buffer;
+				switch (req.op)
+				{
+				case AsyncIOOp::nop:
+					sqe->opcode = IORING_OP_NOP;
+					sqe->fd = -1;
+					break;
+				case AsyncIOOp::read:
+					sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+					break;
+				case AsyncIOOp::write:
+					sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+					break;
+				default:
+					lupanic();
+				}
+				if (req.op != AsyncIOOp::nop)
+				{
+					sqe->fd = (int)(usize)req.file;
+					sqe->off = req.offset;
+					sqe->addr = (u64)(usize)req.buffer;
+					sqe->len = req.size;
+					if (fixed)
+					{
+						sqe->buf_index = (u16)req.buffer_index;
+					}
+				}
+				sqe->user_data = req.user_data;
+			}
+			if (!n)
+			{
+				return R<u32>::success(0);
+			}
+			return q->submit(n);
+		}
+
+		RV cancel_async_io(handle_t queue, u64 user_data)
+		{
+			AsyncIOQueue* q = (AsyncIOQueue*)queue;
+			io_uring_sqe* sqe = q->get_sqe(0);
+			if (!sqe)
+			{
+				return BasicError::busy();
+			}
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->fd = -1;
+			sqe->addr = user_data;
+			sqe->user_data = async_io_internal_user_data;
+			auto submitted = q->submit(1);
+			if (failed(submitted))
+			{
+				return submitted.errcode();
+			}
+			return submitted.get() ? RV() : BasicError::busy();
+		}
+
+		inline errcode_t translate_async_io_error(int err)
+		{
+			switch (err)
+			{
+			case ECANCELED:
+				return BasicError::user_canceled();
+			case EBADF:
+			case EINVAL:
+			case EFAULT:
+				return BasicError::bad_arguments();
+			case EACCES:
+			case EPERM:
+				return BasicError::access_denied();
+			case ENOMEM:
+				return BasicError::bad_memory_alloc();
+			default:
+				return BasicError::bad_system_call();
+			}
+		}
+
+		u32 wait_async_io(handle_t queue, AsyncIOCompletion* completions, u32 max_completions, bool wait)
+		{
+			AsyncIOQueue* q = (AsyncIOQueue*)queue;
+			u32 n = 0;
+			while (true)
+			{
+				u32 head = *q->m_cq_head;
+				u32 tail = *q->m_cq_tail;
+				atom_fence_acquire();
+				while (head != tail && n < max_completions)
+				{
+					const io_uring_cqe& cqe = q->m_cqes[head & q->m_cq_mask];
+					if (cqe.user_data != async_io_internal_user_data)
+					{
+						AsyncIOCompletion& c = completions[n];
+						c.user_data = cqe.user_data;
+						c.result = cqe.res < 0 ? translate_async_io_error(-cqe.res) : 0;
+						c.transferred_bytes = cqe.res < 0 ? 0 : (usize)cqe.res;
+						++n;
+					}
+					++head;
+				}
+				atom_fence_release();
+				*q->m_cq_head = head;
+				if (n || !wait)
+				{
+					return n;
+				}
+				// Blocks until at least one completion is posted. Fails with EINTR if interrupted, which is handled
+				// by checking the ring again.
+				syscall(__NR_io_uring_enter, q->m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+			}
+		}
+#else
+		R<handle_t> new_async_io_queue(u32 depth)
+		{
+			return BasicError::not_supported();
+		}
+		void delete_async_io_queue(handle_t queue) {}
+		RV register_async_io_buffers(handle_t queue, void* const* buffers, const usize* sizes, u32 count)
+		{
+			return BasicError::not_supported();
+		}
+		R<u32> submit_async_io(handle_t queue, const AsyncIORequest* requests, u32 count)
+		{
+			return BasicError::not_supported();
+		}
+		RV cancel_async_io(handle_t queue, u64 user_data)
+		{
+			return BasicError::not_supported();
+		}
+		u32 wait_async_io(handle_t queue, AsyncIOCompletion* completions, u32 max_completions, bool wait)
+		{
+			return 0;
+		}
+#endif
+	}
+}
+
+#endif
@@ -131,5 +131,17 @@ namespace Luna
 		return __sync_val_compare_and_swap(dest, comperand, exchange);
 	}
 
+	inline void atom_fence()
+	{
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	}
+	inline void atom_fence_acquire()
+	{
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}
+	inline void atom_fence_release()
+	{
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
 }
 #endif
@@ -10,6 +10,11 @@
 
 #include "../../OS.hpp"
 
+#if defined(__GLIBC__) || defined(LUNA_PLATFORM_MACOS)
+#include <execinfo.h>
+#define LUNA_POSIX_HAS_BACKTRACE
+#endif
+
 namespace Luna
 {
 	namespace OS
@@ -27,6 +32,19 @@ namespace Luna
 			vsnprintf(buf, 1024, fmt, args);
 			printf("%s\n", buf);
 		}
+		u32 capture_stack_trace(void** frames, u32 max_frames)
+		{
+#ifdef LUNA_POSIX_HAS_BACKTRACE
+			void* buf[64];
+			u32 n = (u32)backtrace(buf, (int)(max_frames + 1 > 64 ? 64 : max_frames + 1));
+			// Skips this function.
+			if (n <= 1) return 0;
+			memcpy(frames, buf + 1, sizeof(void*) * (n - 1));
+			return n - 1;
+#else
+			return 0;
+#endif
+		}
 	}
 }
 
@@ -0,0 +1,98 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FiberContext.cpp
+* @author JXMaster
+* @date 2021/6/18
+*/
+#include <Runtime/PlatformDefines.hpp>
+
+#ifdef LUNA_PLATFORM_POSIX
+
+#include "FiberContext.hpp"
+
+#ifdef LUNA_FIBER_ASM
+
+#if defined(LUNA_PLATFORM_MACOS)
+#define LUNA_FIBER_SYMBOL(_name) "_" #_name
+#define LUNA_FIBER_FUNC_BEGIN(_name) ".private_extern " LUNA_FIBER_SYMBOL(_name) "\n" ".globl " LUNA_FIBER_SYMBOL(_name) "\n" ".p2align 4\n" LUNA_FIBER_SYMBOL(_name) ":\n"
+#else
+#define LUNA_FIBER_SYMBOL(_name) #_name
+#define LUNA_FIBER_FUNC_BEGIN(_name) ".hidden " LUNA_FIBER_SYMBOL(_name) "\n" ".globl " LUNA_FIBER_SYMBOL(_name) "\n" ".type " LUNA_FIBER_SYMBOL(_name) ", %function\n" ".p2align 4\n" LUNA_FIBER_SYMBOL(_name) ":\n"
+#endif
+
+#if defined(LUNA_PLATFORM_X86_64)
+
+// System V AMD64: rbx, rbp, r12-r15, MXCSR control bits and x87 control word are callee-saved.
+asm(
+	".text\n"
+	LUNA_FIBER_FUNC_BEGIN(luna_fiber_switch)
+	"	pushq %rbp\n"
+	"	pushq %rbx\n"
+	"	pushq %r12\n"
+	"	pushq %r13\n"
+	"	pushq %r14\n"
+	"	pushq %r15\n"
+	"	subq $8, %rsp\n"
+	"	stmxcsr (%rsp)\n"
+	"	fnstcw 4(%rsp)\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	ldmxcsr (%rsp)\n"
+	"	fldcw 4(%rsp)\n"
+	"	addq $8, %rsp\n"
+	"	popq %r15\n"
+	"	popq %r14\n"
+	"	popq %r13\n"
+	"	popq %r12\n"
+	"	popq %rbx\n"
+	"	popq %rbp\n"
+	"	ret\n"
+	LUNA_FIBER_FUNC_BEGIN(luna_fiber_trampoline)
+	"	movq %r12, %rdi\n"
+	"	callq *%r13\n"
+	"	ud2\n"
+);
+
+#elif defined(LUNA_PLATFORM_ARM64)
+
+// AAPCS64: x19-x28, x29 (frame pointer), x30 (link register) and d8-d15 are callee-saved.
+asm(
+	".text\n"
+	LUNA_FIBER_FUNC_BEGIN(luna_fiber_switch)
+	"	sub sp, sp, #176\n"
+	"	stp x19, x20, [sp, #0]\n"
+	"	stp x21, x22, [sp, #16]\n"
+	"	stp x23, x24, [sp, #32]\n"
+	"	stp x25, x26, [sp, #48]\n"
+	"	stp x27, x28, [sp, #64]\n"
+	"	stp x29, x30, [sp, #80]\n"
+	"	stp d8, d9, [sp, #96]\n"
+	"	stp d10, d11, [sp, #112]\n"
+	"	stp d12, d13, [sp, #128]\n"
+	"	stp d14, d15, [sp, #144]\n"
+	"	mov x2, sp\n"
+	"	str x2, [x0]\n"
+	"	mov sp, x1\n"
+	"	ldp x19, x20, [sp, #0]\n"
+	"	ldp x21, x22, [sp, #16]\n"
+	"	ldp x23, x24, [sp, #32]\n"
+	"	ldp x25, x26, [sp, #48]\n"
+	"	ldp x27, x28, [sp, #64]\n"
+	"	ldp x29, x30, [sp, #80]\n"
+	"	ldp d8, d9, [sp, #96]\n"
+	"	ldp d10, d11, [sp, #112]\n"
+	"	ldp d12, d13, [sp, #128]\n"
+	"	ldp d14, d15, [sp, #144]\n"
+	"	add sp, sp, #176\n"
+	"	ret\n"
+	LUNA_FIBER_FUNC_BEGIN(luna_fiber_trampoline)
+	"	mov x0, x19\n"
+	"	blr x20\n"
+	"	brk #0\n"
+);
+
+#endif
+
+#endif
+
+#endif
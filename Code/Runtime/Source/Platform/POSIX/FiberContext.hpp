@@ -0,0 +1,72 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FiberContext.hpp
+* @author JXMaster
+* @date 2021/6/18
+* @brief Hand-written fiber context switch for POSIX platforms.
+*/
+#pragma once
+#include "../../../PlatformDefines.hpp"
+
+#if defined(LUNA_PLATFORM_X86_64) || defined(LUNA_PLATFORM_ARM64)
+//! Defined if the fiber context switch is implemented in assembly for the current architecture. Other architectures 
+//! fall back to `swapcontext`.
+#define LUNA_FIBER_ASM 1
+#endif
+
+#ifdef LUNA_FIBER_ASM
+#include "../../../Base.hpp"
+
+extern "C"
+{
+	//! Saves callee-saved registers of the current context on the current stack, stores the stack pointer to `from_sp`
+	//! and restores the context saved on `to_sp`.
+	//! @remark Unlike `swapcontext`, this does not save or restore the signal mask, so no system call is made.
+	void luna_fiber_switch(void** from_sp, void* to_sp);
+
+	//! The first return address of one new context. Calls the entry function with the argument saved in the initial
+	//! context.
+	void luna_fiber_trampoline();
+}
+
+namespace Luna
+{
+	namespace OS
+	{
+		using fiber_entry_func_t = void(void* arg);
+
+		//! Builds the initial context of one new fiber on the stack, so that the first `luna_fiber_switch` to the returned
+		//! stack pointer calls `entry(arg)` on the new stack. `entry` must not return.
+		//! @param[in] stack_top The highest address of the stack.
+		//! @return Returns the stack pointer to pass to `luna_fiber_switch`.
+		inline void* init_fiber_context(void* stack_top, fiber_entry_func_t* entry, void* arg)
+		{
+			// The stack pointer must be 16-byte aligned before the trampoline calls the entry function.
+			usize top = ((usize)stack_top & ~(usize)15) - 16;
+#if defined(LUNA_PLATFORM_X86_64)
+			// MXCSR and x87 control word, r15, r14, r13, r12, rbx, rbp, return address.
+			u64* frame = (u64*)(top - 64);
+			frame[0] = 0x1F80 | ((u64)0x037F << 32);
+			frame[1] = 0;
+			frame[2] = 0;
+			frame[3] = (u64)(usize)entry;	// r13
+			frame[4] = (u64)(usize)arg;		// r12
+			frame[5] = 0;
+			frame[6] = 0;
+			frame[7] = (u64)(usize)&luna_fiber_trampoline;
+#elif defined(LUNA_PLATFORM_ARM64)
+			// x19-x28, x29, x30, d8-d15, padding.
+			u64* frame = (u64*)(top - 176);
+			for (usize i = 0; i < 22; ++i)
+			{
+				frame[i] = 0;
+			}
+			frame[0] = (u64)(usize)arg;		// x19
+			frame[1] = (u64)(usize)entry;	// x20
+			frame[11] = (u64)(usize)&luna_fiber_trampoline;	// x30
+#endif
+			return frame;
+		}
+	}
+}
+#endif
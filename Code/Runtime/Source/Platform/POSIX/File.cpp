@@ -13,11 +13,19 @@
 
 #include <libgen.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #ifdef LUNA_PLATFORM_MACOS
 #include <libproc.h>
 #endif
 
+#ifdef LUNA_PLATFORM_LINUX
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+
 namespace Luna
 {
 	namespace OS
@@ -48,6 +56,12 @@ namespace Luna
 					return BasicError::bad_arguments();
 				}
 			}
+			if ((flags & FileOpenFlag::unbuffered) != FileOpenFlag::none)
+			{
+#ifdef O_DIRECT
+				f |= O_DIRECT;
+#endif
+			}
 			int fd;
 			switch (creation)
 			{
@@ -88,6 +102,12 @@ namespace Luna
 					return BasicError::bad_system_call();
 				}
 			}
+#ifdef LUNA_PLATFORM_MACOS
+			if ((flags & FileOpenFlag::unbuffered) != FileOpenFlag::none)
+			{
+				fcntl(fd, F_NOCACHE, 1);
+			}
+#endif
 			return R<handle_t>::success((handle_t)fd);
 		}
 		void close_file(handle_t file)
@@ -185,6 +205,120 @@ namespace Luna
 			int r = fsync(fd);
 			return r == 0 ? RV() : BasicError::bad_system_call();
 		}
+		RV read_file_at(handle_t file, u64 offset, void* buffer, usize size, usize* read_bytes)
+		{
+			int fd = (int)(usize)file;
+			usize total = 0;
+			// `pread` may return less bytes than requested before the end of the file if interrupted by one signal.
+			while (total < size)
+			{
+				ssize_t sz = ::pread(fd, (u8*)buffer + total, size - total, (off_t)(offset + total));
+				if (sz < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					if (read_bytes)
+					{
+						*read_bytes = total;
+					}
+					return BasicError::bad_system_call();
+				}
+				if (sz == 0)
+				{
+					break;
+				}
+				total += (usize)sz;
+			}
+			if (read_bytes)
+			{
+				*read_bytes = total;
+			}
+			return RV();
+		}
+		RV write_file_at(handle_t file, u64 offset, const void* buffer, usize size, usize* write_bytes)
+		{
+			int fd = (int)(usize)file;
+			usize total = 0;
+			while (total < size)
+			{
+				ssize_t sz = ::pwrite(fd, (const u8*)buffer + total, size - total, (off_t)(offset + total));
+				if (sz < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					if (write_bytes)
+					{
+						*write_bytes = total;
+					}
+					return BasicError::bad_system_call();
+				}
+				total += (usize)sz;
+			}
+			if (write_bytes)
+			{
+				*write_bytes = total;
+			}
+			return RV();
+		}
+		inline usize get_map_page_size()
+		{
+			static usize page_size = (usize)sysconf(_SC_PAGESIZE);
+			return page_size;
+		}
+		R<void*> map_file(handle_t file, u64 offset, usize size, FileMapHint hint)
+		{
+			if (!size)
+			{
+				return BasicError::bad_arguments();
+			}
+			int fd = (int)(usize)file;
+			// `mmap` requires the offset to be aligned to the page size.
+			usize page_size = get_map_page_size();
+			u64 map_offset = offset / page_size * page_size;
+			usize bias = (usize)(offset - map_offset);
+			usize map_size = size + bias;
+			void* p = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, (off_t)map_offset);
+			if (p == MAP_FAILED)
+			{
+				switch (errno)
+				{
+				case EACCES:
+				case EPERM:
+					return BasicError::access_denied();
+				case ENOMEM:
+					return BasicError::bad_memory_alloc();
+				case EINVAL:
+				case EBADF:
+					return BasicError::bad_arguments();
+				default:
+					return BasicError::bad_system_call();
+				}
+			}
+			int advice;
+			switch (hint)
+			{
+			case FileMapHint::sequential: advice = MADV_SEQUENTIAL; break;
+			case FileMapHint::random: advice = MADV_RANDOM; break;
+			case FileMapHint::will_need: advice = MADV_WILLNEED; break;
+			default: advice = MADV_NORMAL; break;
+			}
+			if (advice != MADV_NORMAL)
+			{
+				// The advice is only a hint, the mapping is still usable if this fails.
+				madvise(p, map_size, advice);
+			}
+			return (void*)((u8*)p + bias);
+		}
+		void unmap_file(void* data, usize size)
+		{
+			usize page_size = get_map_page_size();
+			usize bias = (usize)data % page_size;
+			munmap((u8*)data - bias, size + bias);
+		}
 		R<handle_t> open_buffered_file(const c8* path, FileOpenFlag flags, FileCreationMode creation)
 		{
 			// use buffered version.
@@ -459,11 +593,75 @@ namespace Luna
 			}
 			return attribute;
 		}
+		//! Copies the data of one file to one empty file in the kernel, so that the data is not copied to the user space.
+		//! @return Returns `BasicError::not_supported` if the data cannot be copied by the kernel, in such case nothing
+		//! is written to the destination file.
+		static RV copy_file_in_kernel(int from_fd, int to_fd, u64 size)
+		{
+#ifdef LUNA_PLATFORM_LINUX
+			// Reflink clones share the data extents between both files on file systems that support it (Btrfs, XFS, ...),
+			// so no data is copied at all.
+			if (!::ioctl(to_fd, FICLONE, from_fd))
+			{
+				return RV();
+			}
+			// `copy_file_range` may still use server-side copy or clone blocks partially. It fails between different
+			// file systems before Linux 5.3, in such case `sendfile` is used.
+			loff_t from_offset = 0;
+			loff_t to_offset = 0;
+			u64 copied = 0;
+			bool use_sendfile = false;
+			while (copied < size)
+			{
+				usize copy_size = (usize)min<u64>(size - copied, 1_gb);
+				ssize_t sz;
+				if (!use_sendfile)
+				{
+					sz = ::copy_file_range(from_fd, &from_offset, to_fd, &to_offset, copy_size, 0);
+					// Some file systems (procfs, sysfs, some FUSE and network file systems) copy nothing and report
+					// success instead of failing.
+					if (!copied && (sz == 0 || (sz < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))))
+					{
+						use_sendfile = true;
+						continue;
+					}
+				}
+				else
+				{
+					// Writes to the cursor of `to_fd`, which is at the beginning of the file.
+					off_t offset = (off_t)from_offset;
+					sz = ::sendfile(to_fd, from_fd, &offset, copy_size);
+					if (!copied && (sz == 0 || (sz < 0 && (errno == ENOSYS || errno == EINVAL))))
+					{
+						return BasicError::not_supported();
+					}
+					from_offset = (loff_t)offset;
+				}
+				if (sz < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					return BasicError::bad_system_call();
+				}
+				if (sz == 0)
+				{
+					// The source file is truncated while being copied, the destination file does not have all data.
+					return BasicError::end_of_file();
+				}
+				copied += (u64)sz;
+			}
+			return RV();
+#else
+			return BasicError::not_supported();
+#endif
+		}
 		RV copy_file(const c8* src_path, const c8* dest_path, bool fail_if_exists)
 		{
 			lucheck(src_path && dest_path);
 			constexpr u64 max_buffer_sz = 1_mb;
-			u8* buf = (u8*)memalloc(max_buffer_sz);
+			u8* buf = nullptr;
 			handle_t from_file = nullptr;
 			handle_t to_file = nullptr;
 			lutry
@@ -478,14 +676,23 @@ namespace Luna
 					luset(to_file, open_file(dest_path, FileOpenFlag::write, FileCreationMode::create_always));
 				}
 				lulet(copy_size, get_file_size(from_file));
-				u64 sz = copy_size;
-
-				while (sz)
+				RV r = copy_file_in_kernel((int)(usize)from_file, (int)(usize)to_file, copy_size);
+				if (succeeded(r) || r.errcode() != BasicError::not_supported())
+				{
+					luexp(r);
+				}
+				else
 				{
-					usize copy_size_onetime = min<usize>(sz, max_buffer_sz);
-					luexp(read_file(from_file, buf, copy_size_onetime, nullptr));
-					luexp(write_file(to_file, buf, copy_size_onetime, nullptr));
-					sz -= copy_size_onetime;
+					// Falls back to copying through one user buffer.
+					buf = (u8*)memalloc(max_buffer_sz);
+					u64 sz = copy_size;
+					while (sz)
+					{
+						usize copy_size_onetime = min<usize>(sz, max_buffer_sz);
+						luexp(read_file(from_file, buf, copy_size_onetime, nullptr));
+						luexp(write_file(to_file, buf, copy_size_onetime, nullptr));
+						sz -= copy_size_onetime;
+					}
 				}
 			}
 				lucatch
@@ -15,6 +15,10 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <Runtime/Algorithm.hpp>
+#ifdef LUNA_PLATFORM_LINUX
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 namespace Luna
 {
@@ -138,6 +142,7 @@ namespace Luna
             if (alignment <= max_align)
             {
                 free(ptr);
+                return;
             }
             isize offset = *(((isize*)ptr) - 1);
             void* origin_ptr = (void*)(((usize)ptr) - offset);
@@ -170,6 +175,37 @@ namespace Luna
 			void* origin_ptr = (void*)(((usize)ptr) - offset);
 			return malloc_usable_size(origin_ptr) - offset;
         }
+        void* numa_memalloc(usize size, u32 numa_node)
+        {
+            if (!size) return nullptr;
+            void* r = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (r == MAP_FAILED)
+            {
+                return nullptr;
+            }
+#ifdef LUNA_PLATFORM_LINUX
+            // Pages are not allocated until they are touched, so binding the range before returning places all pages
+            // on the node regardless of the thread that touches them. libnuma is not required for this.
+            constexpr unsigned long mpol_preferred = 1;
+            constexpr usize max_numa_nodes = 1024;
+            unsigned long node_mask[max_numa_nodes / (sizeof(unsigned long) * 8)];
+            if (numa_node < max_numa_nodes)
+            {
+                memzero(node_mask, sizeof(node_mask));
+                node_mask[numa_node / (sizeof(unsigned long) * 8)] = 1UL << (numa_node % (sizeof(unsigned long) * 8));
+                // Fails if the kernel is built without NUMA support, in which case the memory is still valid.
+                syscall(SYS_mbind, r, size, mpol_preferred, node_mask, (unsigned long)max_numa_nodes, 0);
+            }
+#else
+            (void)numa_node;
+#endif
+            return r;
+        }
+        void numa_memfree(void* ptr, usize size)
+        {
+            if (!ptr) return;
+            munmap(ptr, size);
+        }
     }
 }
 
@@ -11,6 +11,13 @@
 #include "../../OS.hpp"
 #include <sys/types.h>
 #include <sys/sysctl.h>
+#ifdef LUNA_PLATFORM_LINUX
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <stdlib.h>
+#endif
 
 namespace Luna
 {
@@ -18,14 +25,26 @@ namespace Luna
     {
 		void time_init();
 		void file_init();
+#ifndef LUNA_PLATFORM_LINUX
+		void sync_init();
+		void sync_close();
+#endif
 
 		void init()
 		{
 			time_init();
 			file_init();
+#ifndef LUNA_PLATFORM_LINUX
+			sync_init();
+#endif
 		}
 
-		void close() {}
+		void close()
+		{
+#ifndef LUNA_PLATFORM_LINUX
+			sync_close();
+#endif
+		}
 
 		u32 get_num_processors()
 		{
@@ -42,10 +61,160 @@ namespace Luna
 			}
 			return (u32)processor_count;
 #elif LUNA_PLATFORM_LINUX
-			int processor_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+			int processor_count = max((int)sysconf(_SC_NPROCESSORS_ONLN), 1);
 			return (u32)processor_count;
 #else
 #error "get_num_processors not implemented."
+#endif
+		}
+#ifdef LUNA_PLATFORM_LINUX
+		//! Reads one small file in sysfs to `buf` as one null-terminated string.
+		static bool read_sysfs_file(const c8* path, c8* buf, usize buf_size)
+		{
+			int fd = ::open(path, O_RDONLY);
+			if (fd < 0) return false;
+			isize r = ::read(fd, buf, buf_size - 1);
+			::close(fd);
+			if (r < 0) return false;
+			buf[r] = 0;
+			return true;
+		}
+		static bool read_sysfs_u32(const c8* path, u32& value)
+		{
+			c8 buf[32];
+			if (!read_sysfs_file(path, buf, sizeof(buf))) return false;
+			value = (u32)strtoul(buf, nullptr, 10);
+			return true;
+		}
+		//! Gets the NUMA node of one processor, which is represented by one `nodeN` link in the processor directory.
+		static u32 get_processor_numa_node(u32 processor)
+		{
+			c8 path[64];
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", processor);
+			DIR* dir = ::opendir(path);
+			if (!dir) return 0;
+			u32 node = 0;
+			while (dirent* entry = ::readdir(dir))
+			{
+				if (!strncmp(entry->d_name, "node", 4) && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+				{
+					node = (u32)strtoul(entry->d_name + 4, nullptr, 10);
+					break;
+				}
+			}
+			::closedir(dir);
+			return node;
+		}
+#endif
+		u32 get_processor_topology(ProcessorInfo* processors, u32 max_processors)
+		{
+#ifdef LUNA_PLATFORM_LINUX
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			if (sched_getaffinity(0, sizeof(cpu_set_t), &set) != 0)
+			{
+				u32 n = get_num_processors();
+				for (u32 i = 0; i < n && i < CPU_SETSIZE; ++i)
+				{
+					CPU_SET(i, &set);
+				}
+			}
+			// Core indices are assigned in the order that (package, core_id) pairs are found, since core_id is only
+			// unique in one package and may not be continuous.
+			u64 core_keys[CPU_SETSIZE];
+			u32 num_cores = 0;
+			u32 num_processors = 0;
+			c8 path[128];
+			c8 buf[64];
+			for (u32 i = 0; i < CPU_SETSIZE; ++i)
+			{
+				if (!CPU_ISSET(i, &set)) continue;
+				ProcessorInfo info;
+				info.processor = i;
+				info.package = 0;
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", i);
+				read_sysfs_u32(path, info.package);
+				u32 core_id = i;
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", i);
+				read_sysfs_u32(path, core_id);
+				u64 key = ((u64)info.package << 32) | core_id;
+				info.core = num_cores;
+				for (u32 j = 0; j < num_cores; ++j)
+				{
+					if (core_keys[j] == key)
+					{
+						info.core = j;
+						break;
+					}
+				}
+				if (info.core == num_cores)
+				{
+					core_keys[num_cores] = key;
+					++num_cores;
+				}
+				info.numa_node = get_processor_numa_node(i);
+				// The cache identifier is the first processor that shares the cache.
+				info.l2_cache = u32_max;
+				info.l3_cache = u32_max;
+				for (u32 index = 0;; ++index)
+				{
+					u32 level;
+					snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", i, index);
+					if (!read_sysfs_u32(path, level)) break;
+					snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", i, index);
+					if (!read_sysfs_file(path, buf, sizeof(buf)) || !strncmp(buf, "Instruction", 11)) continue;
+					snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", i, index);
+					u32 first_processor;
+					if (!read_sysfs_u32(path, first_processor)) continue;
+					if (level == 2) info.l2_cache = first_processor;
+					else if (level == 3) info.l3_cache = first_processor;
+				}
+				if (num_processors < max_processors)
+				{
+					processors[num_processors] = info;
+				}
+				++num_processors;
+			}
+			return num_processors;
+#else
+			// The topology is not reported, every processor is treated as one core.
+			u32 num_processors = get_num_processors();
+			for (u32 i = 0; i < num_processors && i < max_processors; ++i)
+			{
+				processors[i].processor = i;
+				processors[i].core = i;
+				processors[i].package = 0;
+				processors[i].numa_node = 0;
+				processors[i].l2_cache = u32_max;
+				processors[i].l3_cache = u32_max;
+			}
+			return num_processors;
+#endif
+		}
+		u32 get_num_numa_nodes()
+		{
+#ifdef LUNA_PLATFORM_LINUX
+			// The file contains one list like "0-3" or "0,2".
+			c8 buf[256];
+			if (!read_sysfs_file("/sys/devices/system/node/online", buf, sizeof(buf)))
+			{
+				return 1;
+			}
+			u32 max_node = 0;
+			for (c8* cur = buf; *cur;)
+			{
+				if (*cur >= '0' && *cur <= '9')
+				{
+					max_node = max(max_node, (u32)strtoul(cur, &cur, 10));
+				}
+				else
+				{
+					++cur;
+				}
+			}
+			return max_node + 1;
+#else
+			return 1;
 #endif
 		}
     }
@@ -9,110 +9,137 @@
 #ifdef LUNA_PLATFORM_POSIX
 
 #include "../../OS.hpp"
+#include "../../../Sync.hpp"
 #include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
+#include <errno.h>
 #include <Runtime/Assert.hpp>
 
+#ifdef LUNA_PLATFORM_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#endif
+
 namespace Luna
 {
 	namespace OS
 	{
-		struct Signal
+#ifdef LUNA_PLATFORM_LINUX
+		bool futex_wait(volatile u32* address, u32 compare_value, u32 timeout_milliseconds)
+		{
+			struct timespec timeout;
+			struct timespec* ptimeout = nullptr;
+			if (timeout_milliseconds != u32_max)
+			{
+				timeout.tv_sec = timeout_milliseconds / 1000;
+				timeout.tv_nsec = (long)(timeout_milliseconds % 1000) * 1000000;
+				ptimeout = &timeout;
+			}
+			long r = syscall(SYS_futex, (u32*)address, FUTEX_WAIT_PRIVATE, compare_value, ptimeout, nullptr, 0);
+			return !(r == -1 && errno == ETIMEDOUT);
+		}
+		void futex_wake(volatile u32* address, u32 count)
+		{
+			syscall(SYS_futex, (u32*)address, FUTEX_WAKE_PRIVATE, count > (u32)INT_MAX ? INT_MAX : (int)count, nullptr, nullptr, 0);
+		}
+#else
+		// Platforms without futex hash the address to one of several condition variables. `futex_wake` wakes all threads
+		// waiting on the same bucket, threads waiting for other addresses see spurious wakes.
+		struct FutexBucket
 		{
-			pthread_cond_t m_cond;
 			pthread_mutex_t m_mutex;
-			volatile bool m_signaled;
-			volatile bool m_manual_reset;
+			pthread_cond_t m_cond;
+		};
+		constexpr usize futex_bucket_count = 64;
+		FutexBucket g_futex_buckets[futex_bucket_count];
 
-			Signal()
+		void sync_init()
+		{
+			for (auto& i : g_futex_buckets)
 			{
-				m_signaled = false;
-				luna_eval_and_assert_equal(pthread_mutex_init(&m_mutex, NULL), 0);
-				luna_eval_and_assert_equal(pthread_cond_init(&m_cond, NULL), 0);
+				luna_eval_and_assert_equal(pthread_mutex_init(&i.m_mutex, NULL), 0);
+				luna_eval_and_assert_equal(pthread_cond_init(&i.m_cond, NULL), 0);
 			}
-			~Signal()
+		}
+		void sync_close()
+		{
+			for (auto& i : g_futex_buckets)
 			{
-				pthread_cond_destroy(&m_cond);
-				pthread_mutex_destroy(&m_mutex);
+				pthread_cond_destroy(&i.m_cond);
+				pthread_mutex_destroy(&i.m_mutex);
 			}
+		}
+		inline FutexBucket& get_futex_bucket(volatile u32* address)
+		{
+			return g_futex_buckets[(((usize)address) >> 2) % futex_bucket_count];
+		}
+		bool futex_wait(volatile u32* address, u32 compare_value, u32 timeout_milliseconds)
+		{
+			FutexBucket& b = get_futex_bucket(address);
+			int rc = 0;
+			luna_eval_and_assert_equal(pthread_mutex_lock(&b.m_mutex), 0);
+			if (*address == compare_value)
+			{
+				if (timeout_milliseconds == u32_max)
+				{
+					rc = pthread_cond_wait(&b.m_cond, &b.m_mutex);
+				}
+				else
+				{
+					struct timespec abstime;
+					struct timeval tv;
+					gettimeofday(&tv, NULL);
+					u64 nsec = (u64)tv.tv_usec * 1000 + (u64)(timeout_milliseconds % 1000) * 1000000;
+					abstime.tv_sec = tv.tv_sec + timeout_milliseconds / 1000 + (time_t)(nsec / 1000000000);
+					abstime.tv_nsec = (long)(nsec % 1000000000);
+					rc = pthread_cond_timedwait(&b.m_cond, &b.m_mutex, &abstime);
+				}
+			}
+			luna_eval_and_assert_equal(pthread_mutex_unlock(&b.m_mutex), 0);
+			return rc != ETIMEDOUT;
+		}
+		void futex_wake(volatile u32* address, u32 count)
+		{
+			FutexBucket& b = get_futex_bucket(address);
+			// Locking the bucket ensures that one thread that has checked the value is either waiting on the condition
+			// variable, or has not checked the value yet and will see the new value.
+			luna_eval_and_assert_equal(pthread_mutex_lock(&b.m_mutex), 0);
+			luna_eval_and_assert_equal(pthread_cond_broadcast(&b.m_cond), 0);
+			luna_eval_and_assert_equal(pthread_mutex_unlock(&b.m_mutex), 0);
+		}
+#endif
+		struct Signal
+		{
+			FutexEvent m_event;
+
+			Signal(bool manual_reset) :
+				m_event(manual_reset) {}
 		};
 		handle_t new_signal(bool manual_reset)
 		{
-			Signal* sig = memnew<Signal>();
-			sig->m_manual_reset = manual_reset;
-			return sig;
+			return memnew<Signal>(manual_reset);
 		}
 		void delete_signal(handle_t sig)
 		{
-			Signal* o = (Signal*)sig;
-			memdelete(o);
+			memdelete((Signal*)sig);
 		}
 		void wait_signal(handle_t sig)
 		{
-			Signal* o = (Signal*)sig;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			while (!o->m_signaled)
-			{
-				luna_eval_and_assert_equal(pthread_cond_wait(&o->m_cond, &o->m_mutex), 0);
-			}
-			if (!o->m_manual_reset)
-			{
-				o->m_signaled = false;
-			}
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
+			((Signal*)sig)->m_event.wait();
 		}
 		RV try_wait_signal(handle_t sig)
 		{
-			Signal* o = (Signal*)sig;
-			int rc = 0;
-			struct timespec abstime;
-			struct timeval tv;
-			gettimeofday(&tv, NULL);
-			abstime.tv_sec = tv.tv_sec;
-			abstime.tv_nsec = tv.tv_usec * 1000;
-			if (abstime.tv_nsec >= 1000000000)
-			{
-				abstime.tv_nsec -= 1000000000;
-				abstime.tv_sec++;
-			}
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			while (!o->m_signaled)
-			{
-				rc = pthread_cond_timedwait(&o->m_cond, &o->m_mutex, &abstime);
-				if (rc != 0)
-				{
-					break;
-				}
-			}
-			if (rc == 0 && !o->m_manual_reset)
-			{
-				o->m_signaled = false;
-			}
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
-			return rc == 0 ? RV() : BasicError::timeout();
+			return ((Signal*)sig)->m_event.try_wait() ? RV() : BasicError::timeout();
 		}
 		void trigger_signal(handle_t sig)
 		{
-			Signal* o = (Signal*)sig;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			o->m_signaled = true;
-			if (o->m_manual_reset)
-			{
-				luna_eval_and_assert_equal(pthread_cond_broadcast(&o->m_cond), 0);
-			}
-			else
-			{
-				luna_eval_and_assert_equal(pthread_cond_signal(&o->m_cond), 0);
-			}
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
+			((Signal*)sig)->m_event.trigger();
 		}
 		void reset_signal(handle_t sig)
 		{
-			Signal* o = (Signal*)sig;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			o->m_signaled = false;
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
+			((Signal*)sig)->m_event.reset();
 		}
 		handle_t new_mutex()
 		{
@@ -148,77 +175,31 @@ namespace Luna
 		}
 		struct Semaphore
 		{
-			pthread_mutex_t m_mutex;
-			pthread_cond_t m_cond;
-			i32 m_counter;
-			i32 m_max_count;
+			FutexSemaphore m_sema;
 
-			Semaphore(i32 initial_count, i32 max_count)
-			{
-				m_max_count = max_count;
-				m_counter = initial_count;
-				luna_eval_and_assert_equal(pthread_mutex_init(&m_mutex, NULL), 0);
-				luna_eval_and_assert_equal(pthread_cond_init(&m_cond, NULL), 0);
-			}
-			~Semaphore()
-			{
-				pthread_cond_destroy(&m_cond);
-				pthread_mutex_destroy(&m_mutex);
-			}
+			Semaphore(i32 initial_count, i32 max_count) :
+				m_sema((u32)initial_count, (u32)max_count) {}
 		};
 		handle_t new_semaphore(i32 initial_count, i32 max_count)
 		{
-			Semaphore* sema = memnew<Semaphore>(initial_count, max_count);
-			return h;
+			luassert(initial_count >= 0 && max_count > 0);
+			return memnew<Semaphore>(initial_count, max_count);
 		}
 		void delete_semaphore(handle_t sema)
 		{
-			Semaphore* o = (Semaphore*)sema;
-			memdelete(o);
+			memdelete((Semaphore*)sema);
 		}
 		void acquire_semaphore(handle_t sema)
 		{
-			Semaphore* o = (Semaphore*)sema;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			if (o->m_counter > 0)
-			{
-				atom_dec_i32(&o->m_counter);
-				luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
-			}
-			atom_dec_i32(&o->m_counter);
-			luna_eval_and_assert_equal(pthread_cond_wait(&o->m_cond, &o->m_mutex), 0);
-			atom_inc_i32(&o->m_counter);
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
+			((Semaphore*)sema)->m_sema.acquire();
 		}
 		RV try_acquire_semaphore(handle_t sema)
 		{
-			Semaphore* o = (Semaphore*)sema;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			if (o->m_counter > 0)
-			{
-				atom_dec_i32(&o->m_counter);
-				luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
-				return RV();
-			}
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
-			return BasicError::timeout();
+			return ((Semaphore*)sema)->m_sema.try_acquire() ? RV() : BasicError::timeout();
 		}
 		void release_semaphore(handle_t sema)
 		{
-			Semaphore* o = (Semaphore*)sema;
-			luna_eval_and_assert_equal(pthread_mutex_lock(&o->m_mutex), 0);
-			if (o->m_counter < o->m_max_count)
-			{
-				if (o->m_counter < 0)
-				{
-					luna_eval_and_assert_equal(pthread_cond_signal(&o->m_cond), 0);
-				}
-				else
-				{
-					atom_inc_i32(&o->m_counter);
-				}
-			}
-			luna_eval_and_assert_equal(pthread_mutex_unlock(&o->m_mutex), 0);
+			((Semaphore*)sema)->m_sema.release();
 		}
 	}
 }
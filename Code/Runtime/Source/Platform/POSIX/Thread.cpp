@@ -9,10 +9,20 @@
 #ifdef LUNA_PLATFORM_POSIX
 
 #include "../../OS.hpp"
+#include "FiberContext.hpp"
+#include "../../../Atomic.hpp"
 
 #include <unistd.h>
-#include <ucontext.h>
 #include <pthread.h>
+#include <errno.h>
+#ifdef LUNA_PLATFORM_LINUX
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <sched.h>
+#endif
+#ifndef LUNA_FIBER_ASM
+#include <ucontext.h>
+#endif
 
 namespace Luna
 {
@@ -20,8 +30,15 @@ namespace Luna
     {
         struct Fiber
         {
+#ifdef LUNA_FIBER_ASM
+			//! The saved stack pointer of the fiber when the fiber is not running.
+			void* m_sp;
+#else
 			ucontext_t m_context;
+#endif
+			//! The stack memory including the guard page, `nullptr` for fibers converted from threads.
 			void* m_stack;
+			usize m_stack_size;
 			thread_callback_func_t* m_func;
 			void* m_params;
         };
@@ -29,6 +46,7 @@ namespace Luna
 		struct Thread
 		{
 			pthread_t m_handle;        // Thread handle.
+			volatile u32 m_tid;        // The thread ID, set by the new thread when it starts.
 			int m_sched_policy;
 			sched_param m_sched_param;
 
@@ -36,18 +54,20 @@ namespace Luna
 			void* m_params;
 			handle_t m_finish_signal;
 
-            Fiber* m_native_fiber = nullptr;
-            Fiber* m_current_fiber = nullptr;
-
 			bool m_detached = false;
 		};
 
         thread_local Thread* tls_current_thread;
+		// Fibers are tracked per thread rather than per `Thread` object, so that threads not created by `new_thread`
+		// (like the main thread) can also be converted to fibers.
+		thread_local Fiber* tls_native_fiber;
+		thread_local Fiber* tls_current_fiber;
 
 		static void* posix_thread_main(void* cookie)
 		{
 			Thread* t = (Thread*)cookie;
             tls_current_thread = t;
+			atom_exchange_u32(&t->m_tid, get_current_thread_id());
 			t->m_func(t->m_params);
             trigger_signal(t->m_finish_signal);
             while (!t->m_detached)
@@ -58,15 +78,99 @@ namespace Luna
 			return 0;
 		}
 
+#ifdef LUNA_FIBER_ASM
+		static void posix_fiber_main(void* cookie)
+		{
+			Fiber* f = (Fiber*)cookie;
+			f->m_func(f->m_params);
+			lupanic_msg_always("The fiber callback function must not return.");
+		}
+#else
 		static void posix_uctx_main(u32 low, u32 high)
 		{
 			Fiber* f = (Fiber*)((usize)low | ((usize)high << 32));
 			f->m_func(f->m_params);
 		}
+#endif
+
+		//! Fiber stacks are reserved with one guard page below the stack, and released stacks are kept for reuse, since
+		//! mapping and unmapping memory is much slower than switching fibers.
+		constexpr usize max_pooled_fiber_stacks = 64;
+		struct FiberStack
+		{
+			void* m_memory;
+			usize m_size;
+		};
+		FiberStack g_fiber_stack_pool[max_pooled_fiber_stacks];
+		usize g_num_pooled_fiber_stacks = 0;
+		volatile u32 g_fiber_stack_pool_lock = 0;
+
+		inline usize get_page_size()
+		{
+			static usize page_size = (usize)sysconf(_SC_PAGESIZE);
+			return page_size;
+		}
+		inline void lock_fiber_stack_pool()
+		{
+			while (atom_exchange_u32(&g_fiber_stack_pool_lock, 1))
+			{
+				yield_current_thread();
+			}
+		}
+		inline void unlock_fiber_stack_pool()
+		{
+			atom_exchange_u32(&g_fiber_stack_pool_lock, 0);
+		}
+		//! Allocates one fiber stack.
+		//! @param[in] size The size of the mapping, including the guard page.
+		static void* alloc_fiber_stack(usize size)
+		{
+			lock_fiber_stack_pool();
+			for (usize i = 0; i < g_num_pooled_fiber_stacks; ++i)
+			{
+				if (g_fiber_stack_pool[i].m_size == size)
+				{
+					void* memory = g_fiber_stack_pool[i].m_memory;
+					g_fiber_stack_pool[i] = g_fiber_stack_pool[g_num_pooled_fiber_stacks - 1];
+					--g_num_pooled_fiber_stacks;
+					unlock_fiber_stack_pool();
+					return memory;
+				}
+			}
+			unlock_fiber_stack_pool();
+			auto r = virtual_reserve(nullptr, size);
+			if (failed(r))
+			{
+				return nullptr;
+			}
+			usize page_size = get_page_size();
+			// The lowest page is not committed and is used as the guard page.
+			if (failed(virtual_commit((u8*)r.get() + page_size, size - page_size, EPageProtection::read_write)))
+			{
+				auto _ = virtual_release(r.get(), size);
+				return nullptr;
+			}
+			return r.get();
+		}
+		static void free_fiber_stack(void* memory, usize size)
+		{
+			lock_fiber_stack_pool();
+			if (g_num_pooled_fiber_stacks < max_pooled_fiber_stacks)
+			{
+				g_fiber_stack_pool[g_num_pooled_fiber_stacks].m_memory = memory;
+				g_fiber_stack_pool[g_num_pooled_fiber_stacks].m_size = size;
+				++g_num_pooled_fiber_stacks;
+				unlock_fiber_stack_pool();
+				return;
+			}
+			unlock_fiber_stack_pool();
+			auto _ = virtual_release(memory, size);
+		}
 
         R<handle_t> new_thread(thread_callback_func_t* callback, void* params, usize stack_size)
         {
             Thread* t = memnew<Thread>();
+			t->m_tid = 0;
 			t->m_func = callback;
             t->m_params = params;
             t->m_finish_signal = new_signal(true);
@@ -94,26 +198,93 @@ namespace Luna
         RV set_thread_priority(handle_t thread, ThreadPriority priority)
         {
             Thread* t = (Thread*)thread;
+#ifdef LUNA_PLATFORM_LINUX
+			// Threads with the default `SCHED_OTHER` policy all have static priority 0, and are scheduled by their nice
+			// values, which can be set per thread by the thread ID.
+			u32 tid;
+			while (!(tid = t->m_tid))
+			{
+				yield_current_thread();
+			}
+			int nice_value = 0;
+            switch (priority)
+            {
+            case ThreadPriority::low: nice_value = 10; break;
+            case ThreadPriority::normal: nice_value = 0; break;
+            case ThreadPriority::high: nice_value = -5; break;
+            case ThreadPriority::critical: nice_value = -10; break;
+            }
+			if (setpriority(PRIO_PROCESS, (id_t)tid, nice_value) != 0)
+			{
+				// Lowering the nice value requires `CAP_SYS_NICE` or one `RLIMIT_NICE` limit.
+				return (errno == EPERM || errno == EACCES) ? BasicError::access_denied() : BasicError::bad_system_call();
+			}
+			return RV();
+#else
             sched_param param = t->m_sched_param;
             switch (priority)
             {
             case ThreadPriority::low:
                 param.sched_priority = (param.sched_priority + sched_get_priority_min(t->m_sched_policy)) >> 1;
-                pthread_setschedparam(t->m_handle, t->m_sched_policy, &param);
                 break;
             case ThreadPriority::normal:
-                pthread_setschedparam(t->m_handle, t->m_sched_policy, &param);
                 break;
             case ThreadPriority::high:
                 param.sched_priority = (param.sched_priority + sched_get_priority_max(t->m_sched_policy)) >> 1;
-                pthread_setschedparam(t->m_handle, t->m_sched_policy, &param);
                 break;
             case ThreadPriority::critical:
                 param.sched_priority = sched_get_priority_max(t->m_sched_policy);
-                pthread_setschedparam(t->m_handle, t->m_sched_policy, &param);
                 break;
             }
+            return pthread_setschedparam(t->m_handle, t->m_sched_policy, &param) == 0 ? RV() : BasicError::bad_system_call();
+#endif
         }
+#ifdef LUNA_PLATFORM_LINUX
+		static RV set_pthread_affinity(pthread_t thread, const u32* processors, u32 num_processors)
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			if (num_processors)
+			{
+				for (u32 i = 0; i < num_processors; ++i)
+				{
+					if (processors[i] >= CPU_SETSIZE)
+					{
+						return BasicError::bad_arguments();
+					}
+					CPU_SET(processors[i], &set);
+				}
+			}
+			else
+			{
+				// The kernel ignores processors that are not present.
+				for (u32 i = 0; i < CPU_SETSIZE; ++i)
+				{
+					CPU_SET(i, &set);
+				}
+			}
+			int r = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &set);
+			return r == 0 ? RV() : (r == EINVAL ? BasicError::bad_arguments() : BasicError::bad_system_call());
+		}
+#endif
+		RV set_thread_affinity(handle_t thread, const u32* processors, u32 num_processors)
+		{
+#ifdef LUNA_PLATFORM_LINUX
+			Thread* t = (Thread*)thread;
+			return set_pthread_affinity(t->m_handle, processors, num_processors);
+#else
+			// macOS only supports affinity tags as hints, which cannot pin threads.
+			return BasicError::not_supported();
+#endif
+		}
+		RV set_current_thread_affinity(const u32* processors, u32 num_processors)
+		{
+#ifdef LUNA_PLATFORM_LINUX
+			return set_pthread_affinity(pthread_self(), processors, num_processors);
+#else
+			return BasicError::not_supported();
+#endif
+		}
         void wait_thread(handle_t thread)
         {
             Thread* t = (Thread*)thread;
@@ -122,7 +293,7 @@ namespace Luna
         RV try_wait_thread(handle_t thread)
         {
             Thread* t = (Thread*)thread;
-            try_wait_signal(t->m_finish_signal);
+            return try_wait_signal(t->m_finish_signal);
         }
         void detach_thread(handle_t thread)
         {
@@ -134,9 +305,26 @@ namespace Luna
         {
             return tls_current_thread;
         }
+        //! The cached ID of the current thread, so that locking mutexes does not need one system call. 0 if not cached.
+        thread_local u32 tls_thread_id;
         u32 get_current_thread_id()
         {
-            return (u32)pthread_getthreadid_np();
+            u32 id = tls_thread_id;
+            if (id)
+            {
+                return id;
+            }
+#if defined(LUNA_PLATFORM_LINUX)
+            id = (u32)syscall(SYS_gettid);
+#elif defined(LUNA_PLATFORM_MACOS)
+            u64 tid;
+            pthread_threadid_np(nullptr, &tid);
+            id = (u32)tid;
+#else
+            id = (u32)(usize)pthread_self();
+#endif
+            tls_thread_id = id;
+            return id;
         }
         void sleep(u32 time_milliseconds)
         {
@@ -167,31 +355,34 @@ namespace Luna
         }
         R<handle_t> convert_thread_to_fiber()
         {
-			Thread* t = tls_current_thread;
-			if (t->m_native_fiber)
+			if (tls_native_fiber)
 			{
-                return R<handle_t>::success(t->m_native_fiber);
+                return R<handle_t>::success(tls_native_fiber);
 			}
 			Fiber* f = memnew<Fiber>();
+			f->m_stack = nullptr;
+			f->m_stack_size = 0;
+#ifndef LUNA_FIBER_ASM
 			int r = getcontext(&f->m_context);
 			if (r != 0)
 			{
                 memdelete(f);
 				return BasicError::bad_system_call();
 			}
-			t->m_native_fiber = f;
-			t->m_current_fiber = f;
+#endif
+			tls_native_fiber = f;
+			tls_current_fiber = f;
             return R<handle_t>::success(f);
         }
         RV convert_fiber_to_thread()
         {
-            Thread* t = tls_current_thread;
-			if (!t->m_native_fiber)
+			if (!tls_native_fiber)
 			{
 				return BasicError::bad_calling_time();
 			}
-            memdelete(t->m_native_fiber);
-            t->m_native_fiber = nullptr;
+            memdelete(tls_native_fiber);
+            tls_native_fiber = nullptr;
+			tls_current_fiber = nullptr;
             return RV();
         }
         R<handle_t> new_fiber(thread_callback_func_t* callback, void* params, usize stack_size)
@@ -201,33 +392,47 @@ namespace Luna
 			{
 				stack_size = (u32)1_mb;
 			}
-			// Allocate stack.
-			void* stack = memalloc(stack_size);
+			usize page_size = get_page_size();
+			usize mapping_size = align_upper(stack_size, page_size) + page_size;
+			void* stack = alloc_fiber_stack(mapping_size);
+			if (!stack)
+			{
+				return BasicError::bad_memory_alloc();
+			}
 			Fiber* f = memnew<Fiber>();
             f->m_stack = stack;
+			f->m_stack_size = mapping_size;
+			f->m_func = callback;
+            f->m_params = params;
+#ifdef LUNA_FIBER_ASM
+			f->m_sp = init_fiber_context((u8*)stack + mapping_size, posix_fiber_main, f);
+#else
             getcontext(&(f->m_context));
-            f->m_context.uc_stack.ss_sp = (char*)stack;
-            f->m_context.uc_stack.ss_size = stack_size;
+            f->m_context.uc_stack.ss_sp = (char*)stack + page_size;
+            f->m_context.uc_stack.ss_size = mapping_size - page_size;
             f->m_context.uc_stack.ss_flags = 0;
 			makecontext(&(f->m_context), (void(*)(void))(&posix_uctx_main), 2, (u32)(usize)f, (u32)((usize)(f) >> 32));
-			f->m_func = callback;
-            f->m_params = params;
+#endif
             return R<handle_t>::success(f);
         }
         void delete_fiber(handle_t fiber)
         {
             Fiber* f = (Fiber*)fiber;
-            memdelete(f->m_stack);
+			free_fiber_stack(f->m_stack, f->m_stack_size);
             memdelete(f);
         }
         void switch_to_fiber(handle_t fiber)
         {
-            Thread* t = tls_current_thread;
-            lucheck(t->m_native_fiber);
+            lucheck(tls_native_fiber);
             Fiber* new_f = (Fiber*)fiber;
-            Fiber* old_f = t->m_current_fiber;
-            t->m_current_fiber = new_f;
+            Fiber* old_f = tls_current_fiber;
+            tls_current_fiber = new_f;
+			// The fiber may be resumed by another thread, so thread-local variables must not be accessed after this.
+#ifdef LUNA_FIBER_ASM
+			luna_fiber_switch(&old_f->m_sp, new_f->m_sp);
+#else
             swapcontext(&(old_f->m_context), &(new_f->m_context));
+#endif
         }
         R<handle_t> tls_alloc(tls_destructor* destructor)
 		{
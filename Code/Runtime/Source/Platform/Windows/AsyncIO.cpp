@@ -0,0 +1,42 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AsyncIO.cpp
+* @author JXMaster
+* @date 2021/7/5
+*/
+#include <Runtime/PlatformDefines.hpp>
+#ifdef LUNA_PLATFORM_WINDOWS
+
+#include "../../OS.hpp"
+
+namespace Luna
+{
+	namespace OS
+	{
+		// Completion ports are not exposed as asynchronous I/O queues yet, the upper layer falls back to the thread pool
+		// that calls `read_file_at` and `write_file_at`.
+		R<handle_t> new_async_io_queue(u32 depth)
+		{
+			return BasicError::not_supported();
+		}
+		void delete_async_io_queue(handle_t queue) {}
+		RV register_async_io_buffers(handle_t queue, void* const* buffers, const usize* sizes, u32 count)
+		{
+			return BasicError::not_supported();
+		}
+		R<u32> submit_async_io(handle_t queue, const AsyncIORequest* requests, u32 count)
+		{
+			return BasicError::not_supported();
+		}
+		RV cancel_async_io(handle_t queue, u64 user_data)
+		{
+			return BasicError::not_supported();
+		}
+		u32 wait_async_io(handle_t queue, AsyncIOCompletion* completions, u32 max_completions, bool wait)
+		{
+			return 0;
+		}
+	}
+}
+
+#endif
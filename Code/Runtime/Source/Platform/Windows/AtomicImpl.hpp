@@ -157,5 +157,17 @@ namespace Luna
 	}
 #endif
 
+	inline void atom_fence()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+	inline void atom_fence_acquire()
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	inline void atom_fence_release()
+	{
+		std::atomic_thread_fence(std::memory_order_release);
+	}
 }
 #endif
\ No newline at end of file
@@ -28,6 +28,11 @@ namespace Luna
 			vsnprintf_s(buf, 1024, fmt, args);
 			::OutputDebugStringA(buf);
 		}
+		u32 capture_stack_trace(void** frames, u32 max_frames)
+		{
+			// Skips this function.
+			return (u32)::RtlCaptureStackBackTrace(1, max_frames, frames, nullptr);
+		}
 	}
 }
 
@@ -55,7 +55,12 @@ namespace Luna
 				lupanic();
 				break;
 			}
-			HANDLE fileHandle = ::CreateFileW(pathbuffer, dw_access, FILE_SHARE_READ, nullptr, dw_creation, FILE_ATTRIBUTE_NORMAL, nullptr);
+			DWORD dw_flags = FILE_ATTRIBUTE_NORMAL;
+			if ((flags & FileOpenFlag::unbuffered) != FileOpenFlag::none)
+			{
+				dw_flags |= FILE_FLAG_NO_BUFFERING;
+			}
+			HANDLE fileHandle = ::CreateFileW(pathbuffer, dw_access, FILE_SHARE_READ, nullptr, dw_creation, dw_flags, nullptr);
 			if (fileHandle == INVALID_HANDLE_VALUE)
 			{
 				DWORD dw = ::GetLastError();
@@ -190,6 +195,105 @@ namespace Luna
 			luassert(file);
 			return ::FlushFileBuffers(file) ? RV() : BasicError::bad_system_call();
 		}
+		RV read_file_at(handle_t file, u64 offset, void* buffer, usize size, usize* read_bytes)
+		{
+			luassert(file);
+			// `ReadFile` reads from the offset in `OVERLAPPED` even if the file is not opened for overlapped I/O.
+			OVERLAPPED overlapped;
+			memzero(&overlapped, sizeof(OVERLAPPED));
+			overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			DWORD actual = 0;
+			BOOL s = ::ReadFile(file, buffer, (DWORD)size, &actual, &overlapped);
+			if (read_bytes)
+			{
+				*read_bytes = actual;
+			}
+			if (s || ::GetLastError() == ERROR_HANDLE_EOF)
+			{
+				return RV();
+			}
+			return BasicError::bad_system_call();
+		}
+		RV write_file_at(handle_t file, u64 offset, const void* buffer, usize size, usize* write_bytes)
+		{
+			luassert(file);
+			OVERLAPPED overlapped;
+			memzero(&overlapped, sizeof(OVERLAPPED));
+			overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			DWORD actual = 0;
+			BOOL s = ::WriteFile(file, buffer, (DWORD)size, &actual, &overlapped);
+			if (write_bytes)
+			{
+				*write_bytes = actual;
+			}
+			return s ? RV() : BasicError::bad_system_call();
+		}
+		inline usize get_allocation_granularity()
+		{
+			static usize granularity = 0;
+			if (!granularity)
+			{
+				SYSTEM_INFO info;
+				::GetSystemInfo(&info);
+				granularity = info.dwAllocationGranularity;
+			}
+			return granularity;
+		}
+		R<void*> map_file(handle_t file, u64 offset, usize size, FileMapHint hint)
+		{
+			luassert(file);
+			if (!size)
+			{
+				return BasicError::bad_arguments();
+			}
+			// `MapViewOfFile` requires the offset to be aligned to the allocation granularity.
+			usize granularity = get_allocation_granularity();
+			u64 map_offset = offset / granularity * granularity;
+			usize bias = (usize)(offset - map_offset);
+			usize map_size = size + bias;
+			HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping)
+			{
+				DWORD err = ::GetLastError();
+				return err == ERROR_ACCESS_DENIED ? BasicError::access_denied() : BasicError::bad_system_call();
+			}
+			void* p = ::MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)(map_offset >> 32), (DWORD)(map_offset & 0xFFFFFFFF), map_size);
+			DWORD err = ::GetLastError();
+			// The view keeps a reference to the mapping object, so the mapping handle can be closed here.
+			::CloseHandle(mapping);
+			if (!p)
+			{
+				switch (err)
+				{
+				case ERROR_ACCESS_DENIED:
+					return BasicError::access_denied();
+				case ERROR_NOT_ENOUGH_MEMORY:
+					return BasicError::bad_memory_alloc();
+				case ERROR_INVALID_PARAMETER:
+					return BasicError::bad_arguments();
+				default:
+					return BasicError::bad_system_call();
+				}
+			}
+			// Windows does not accept access pattern hints for views. Pages that will be needed can still be 
+			// prefetched in one batch.
+			if (hint == FileMapHint::will_need || hint == FileMapHint::sequential)
+			{
+				WIN32_MEMORY_RANGE_ENTRY range;
+				range.VirtualAddress = p;
+				range.NumberOfBytes = map_size;
+				::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+			}
+			return (void*)((u8*)p + bias);
+		}
+		void unmap_file(void* data, usize size)
+		{
+			// Views are always mapped at addresses aligned to the allocation granularity.
+			usize bias = (usize)data % get_allocation_granularity();
+			::UnmapViewOfFile((u8*)data - bias);
+		}
 		R<handle_t> open_buffered_file(const c8* path, FileOpenFlag flags, FileCreationMode creation)
 		{
 			lucheck(path);
@@ -496,7 +600,7 @@ namespace Luna
 				{
 					res = BasicError::not_found();
 				}
-				else if (dw == ERROR_ALREADY_EXISTS)
+				else if (dw == ERROR_ALREADY_EXISTS || dw == ERROR_FILE_EXISTS)
 				{
 					res = BasicError::already_exists();
 				}
@@ -134,6 +134,16 @@ namespace Luna
 			if (!ptr) return 0;
 			return (alignment > max_align) ? _aligned_msize(ptr, alignment, 0) : _msize(ptr);
 		}
+		void* numa_memalloc(usize size, u32 numa_node)
+		{
+			if (!size) return nullptr;
+			return ::VirtualAllocExNuma(::GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, numa_node);
+		}
+		void numa_memfree(void* ptr, usize size)
+		{
+			if (!ptr) return;
+			::VirtualFree(ptr, 0, MEM_RELEASE);
+		}
 	}
 }
 
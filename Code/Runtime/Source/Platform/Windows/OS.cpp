@@ -38,6 +38,113 @@ namespace Luna
 			::GetSystemInfo(&si);
 			return si.dwNumberOfProcessors;
 		}
+		//! Calls `func(processor_index)` for every processor in the group affinity.
+		template <typename _Func>
+		inline void for_each_group_processor(const GROUP_AFFINITY& affinity, _Func&& func)
+		{
+			for (u32 i = 0; i < 64; ++i)
+			{
+				if (affinity.Mask & ((KAFFINITY)1 << i))
+				{
+					func((u32)affinity.Group * 64 + i);
+				}
+			}
+		}
+		u32 get_processor_topology(ProcessorInfo* processors, u32 max_processors)
+		{
+			DWORD size = 0;
+			::GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+			u8* buffer = (u8*)memalloc(size);
+			if (!buffer || !::GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buffer, &size))
+			{
+				memfree(buffer);
+				return 0;
+			}
+			// Processors are indexed by `group * 64 + processor number in group`, collects valid indices first.
+			constexpr u32 max_index = 64 * 64;
+			ProcessorInfo* infos = (ProcessorInfo*)memalloc(sizeof(ProcessorInfo) * max_index);
+			bool* valid = (bool*)memalloc(sizeof(bool) * max_index);
+			memzero(valid, sizeof(bool) * max_index);
+			u32 num_cores = 0;
+			u32 num_packages = 0;
+			u32 num_caches = 0;
+			for (DWORD offset = 0; offset < size;)
+			{
+				auto info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buffer + offset);
+				switch (info->Relationship)
+				{
+				case RelationProcessorCore:
+					for (WORD g = 0; g < info->Processor.GroupCount; ++g)
+					{
+						for_each_group_processor(info->Processor.GroupMask[g], [&](u32 i) {
+							valid[i] = true;
+							infos[i].processor = i;
+							infos[i].core = num_cores;
+							infos[i].package = 0;
+							infos[i].numa_node = 0;
+							infos[i].l2_cache = u32_max;
+							infos[i].l3_cache = u32_max;
+						});
+					}
+					++num_cores;
+					break;
+				default: break;
+				}
+				offset += info->Size;
+			}
+			for (DWORD offset = 0; offset < size;)
+			{
+				auto info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buffer + offset);
+				switch (info->Relationship)
+				{
+				case RelationProcessorPackage:
+					for (WORD g = 0; g < info->Processor.GroupCount; ++g)
+					{
+						for_each_group_processor(info->Processor.GroupMask[g], [&](u32 i) { infos[i].package = num_packages; });
+					}
+					++num_packages;
+					break;
+				case RelationNumaNode:
+					for_each_group_processor(info->NumaNode.GroupMask, [&](u32 i) { infos[i].numa_node = info->NumaNode.NodeNumber; });
+					break;
+				case RelationCache:
+					if (info->Cache.Type == CacheUnified || info->Cache.Type == CacheData)
+					{
+						for_each_group_processor(info->Cache.GroupMask, [&](u32 i) {
+							if (info->Cache.Level == 2) infos[i].l2_cache = num_caches;
+							else if (info->Cache.Level == 3) infos[i].l3_cache = num_caches;
+						});
+						++num_caches;
+					}
+					break;
+				default: break;
+				}
+				offset += info->Size;
+			}
+			u32 num_processors = 0;
+			for (u32 i = 0; i < max_index; ++i)
+			{
+				if (!valid[i]) continue;
+				if (num_processors < max_processors)
+				{
+					processors[num_processors] = infos[i];
+				}
+				++num_processors;
+			}
+			memfree(valid);
+			memfree(infos);
+			memfree(buffer);
+			return num_processors;
+		}
+		u32 get_num_numa_nodes()
+		{
+			ULONG highest_node;
+			if (!::GetNumaHighestNodeNumber(&highest_node))
+			{
+				return 1;
+			}
+			return (u32)highest_node + 1;
+		}
 	}
 }
 
@@ -189,6 +189,25 @@ namespace Luna
 			HANDLE h = (HANDLE)sema;
 			::ReleaseSemaphore(h, 1, NULL);
 		}
+		bool futex_wait(volatile u32* address, u32 compare_value, u32 timeout_milliseconds)
+		{
+			if (!::WaitOnAddress(address, &compare_value, sizeof(u32), timeout_milliseconds == u32_max ? INFINITE : timeout_milliseconds))
+			{
+				return ::GetLastError() != ERROR_TIMEOUT;
+			}
+			return true;
+		}
+		void futex_wake(volatile u32* address, u32 count)
+		{
+			if (count == 1)
+			{
+				::WakeByAddressSingle((PVOID)address);
+			}
+			else
+			{
+				::WakeByAddressAll((PVOID)address);
+			}
+		}
 	}
 }
 
@@ -128,6 +128,39 @@ namespace Luna
 			}
 			return r ? RV() : BasicError::bad_system_call();
 		}
+		RV set_thread_affinity(handle_t thread, const u32* processors, u32 num_processors)
+		{
+			// One thread can only run on processors of one processor group, processors are indexed by
+			// `group * 64 + processor number in group`, so all processors should be in the group of the first one.
+			GROUP_AFFINITY affinity;
+			memzero(&affinity, sizeof(GROUP_AFFINITY));
+			if (num_processors)
+			{
+				affinity.Group = (WORD)(processors[0] / 64);
+				for (u32 i = 0; i < num_processors; ++i)
+				{
+					if (processors[i] / 64 == affinity.Group)
+					{
+						affinity.Mask |= (KAFFINITY)1 << (processors[i] % 64);
+					}
+				}
+			}
+			else
+			{
+				// Restores the affinity to all processors of the current group.
+				if (!::GetThreadGroupAffinity(thread, &affinity))
+				{
+					return BasicError::bad_system_call();
+				}
+				u32 num_group_processors = ::GetActiveProcessorCount(affinity.Group);
+				affinity.Mask = num_group_processors >= 64 ? ~(KAFFINITY)0 : (((KAFFINITY)1 << num_group_processors) - 1);
+			}
+			return ::SetThreadGroupAffinity(thread, &affinity, nullptr) ? RV() : BasicError::bad_system_call();
+		}
+		RV set_current_thread_affinity(const u32* processors, u32 num_processors)
+		{
+			return set_thread_affinity(::GetCurrentThread(), processors, num_processors);
+		}
 		void wait_thread(handle_t thread)
 		{
 			if (::WaitForSingleObject(thread, INFINITE) != WAIT_OBJECT_0)
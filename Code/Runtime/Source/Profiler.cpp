@@ -0,0 +1,286 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Profiler.cpp
+* @author JXMaster
+* @date 2021/6/23
+*/
+#include "../PlatformDefines.hpp"
+#define LUNA_RUNTIME_API LUNA_EXPORT
+#include "../Profiler.hpp"
+#include "OS.hpp"
+#include "../Atomic.hpp"
+#include "../Sync.hpp"
+#include "../Vector.hpp"
+#include "../Time.hpp"
+#include "../Thread.hpp"
+
+// Every thread records its events to its own ring buffer. Only the owning thread writes the buffer and the head
+// counter, so recording never takes any lock. The exporting thread copies the buffer, then reads the head counter
+// again and discards events that may be overwritten during the copy.
+//
+// Thread records are never freed until the runtime is closed, so events of threads that have exited can still be
+// exported.
+
+namespace Luna
+{
+	enum class ProfilerEventType : u32
+	{
+		begin_scope = 0,
+		end_scope = 1,
+		frame = 2,
+	};
+
+	struct ProfilerEvent
+	{
+		u64 m_ticks;
+		const c8* m_name;
+		ProfilerEventType m_type;
+		u32 m_frame_index;
+	};
+
+	struct ProfilerThread
+	{
+		//! The event ring buffer, allocated when the thread records its first event.
+		ProfilerEvent* m_events;
+		//! The number of events written. This is only written by the owning thread.
+		volatile usize m_head;
+		u32 m_thread_id;
+		c8 m_name[64];
+		ProfilerThread* m_next;
+	};
+
+	SpinLock g_profiler_lock;
+	//! All thread records. Only modified when `g_profiler_lock` is held.
+	ProfilerThread* g_profiler_threads = nullptr;
+	volatile u32 g_profiler_capturing = 0;
+	u64 g_profiler_capture_begin_ticks = 0;
+	u64 g_profiler_capture_end_ticks = 0;
+	//! Increased when the profiler is closed, so that threads do not use records that are freed.
+	u32 g_profiler_generation = 0;
+
+	thread_local ProfilerThread* tls_profiler_thread = nullptr;
+	thread_local u32 tls_profiler_generation = 0;
+
+	static ProfilerThread* get_profiler_thread()
+	{
+		ProfilerThread* t = tls_profiler_thread;
+		if (t && tls_profiler_generation == g_profiler_generation)
+		{
+			return t;
+		}
+		t = (ProfilerThread*)OS::memalloc(sizeof(ProfilerThread), alignof(ProfilerThread));
+		if (!t) return nullptr;
+		t->m_events = nullptr;
+		t->m_head = 0;
+		t->m_thread_id = get_current_thread_id();
+		snprintf(t->m_name, sizeof(t->m_name), "Thread %u", t->m_thread_id);
+		g_profiler_lock.lock();
+		t->m_next = g_profiler_threads;
+		g_profiler_threads = t;
+		g_profiler_lock.unlock();
+		tls_profiler_thread = t;
+		tls_profiler_generation = g_profiler_generation;
+		return t;
+	}
+
+	inline void record_profiler_event(const c8* name, ProfilerEventType type, u32 frame_index)
+	{
+		ProfilerThread* t = get_profiler_thread();
+		if (!t) return;
+		if (!t->m_events)
+		{
+			ProfilerEvent* events = (ProfilerEvent*)OS::memalloc(sizeof(ProfilerEvent) * profiler_events_per_thread, alignof(ProfilerEvent));
+			if (!events) return;
+			atom_fence_release();
+			t->m_events = events;
+		}
+		usize head = t->m_head;
+		ProfilerEvent& e = t->m_events[head % profiler_events_per_thread];
+		e.m_ticks = get_ticks();
+		e.m_name = name;
+		e.m_type = type;
+		e.m_frame_index = frame_index;
+		// Publishes the event before the head.
+		atom_fence_release();
+		t->m_head = head + 1;
+	}
+
+	void profiler_close()
+	{
+		g_profiler_capturing = 0;
+		g_profiler_lock.lock();
+		ProfilerThread* t = g_profiler_threads;
+		g_profiler_threads = nullptr;
+		++g_profiler_generation;
+		g_profiler_lock.unlock();
+		while (t)
+		{
+			ProfilerThread* next = t->m_next;
+			OS::memfree(t->m_events, alignof(ProfilerEvent));
+			OS::memfree(t, alignof(ProfilerThread));
+			t = next;
+		}
+	}
+
+	LUNA_RUNTIME_API void begin_profiler_capture()
+	{
+		if (g_profiler_capturing) return;
+		g_profiler_capture_begin_ticks = get_ticks();
+		g_profiler_capture_end_ticks = u64_max;
+		atom_exchange_u32(&g_profiler_capturing, 1);
+	}
+	LUNA_RUNTIME_API void end_profiler_capture()
+	{
+		if (!g_profiler_capturing) return;
+		atom_exchange_u32(&g_profiler_capturing, 0);
+		g_profiler_capture_end_ticks = get_ticks();
+	}
+	LUNA_RUNTIME_API bool is_profiler_capturing()
+	{
+		return g_profiler_capturing != 0;
+	}
+	LUNA_RUNTIME_API void profiler_begin_scope(const c8* name)
+	{
+		if (g_profiler_capturing)
+		{
+			record_profiler_event(name, ProfilerEventType::begin_scope, 0);
+		}
+	}
+	LUNA_RUNTIME_API void profiler_end_scope(const c8* name)
+	{
+		if (g_profiler_capturing)
+		{
+			record_profiler_event(name, ProfilerEventType::end_scope, 0);
+		}
+	}
+	LUNA_RUNTIME_API void profiler_new_frame(u32 frame_index)
+	{
+		if (g_profiler_capturing)
+		{
+			record_profiler_event("Frame", ProfilerEventType::frame, frame_index);
+		}
+	}
+	LUNA_RUNTIME_API void set_profiler_thread_name(const c8* name)
+	{
+		ProfilerThread* t = get_profiler_thread();
+		if (!t) return;
+		snprintf(t->m_name, sizeof(t->m_name), "%s", name);
+	}
+
+	static void append_json_string(String& out, const c8* s)
+	{
+		out.push_back('"');
+		for (; *s; ++s)
+		{
+			c8 ch = *s;
+			if (ch == '"' || ch == '\\')
+			{
+				out.push_back('\\');
+				out.push_back(ch);
+			}
+			else if ((u8)ch < 0x20)
+			{
+				c8 buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", (u32)(u8)ch);
+				out.append(buf);
+			}
+			else
+			{
+				out.push_back(ch);
+			}
+		}
+		out.push_back('"');
+	}
+
+	struct ProfilerOpenScope
+	{
+		const c8* m_name;
+		u64 m_ticks;
+	};
+
+	LUNA_RUNTIME_API void export_profiler_capture(String& out)
+	{
+		u64 begin_ticks = g_profiler_capture_begin_ticks;
+		u64 end_ticks = g_profiler_capturing ? u64_max : g_profiler_capture_end_ticks;
+		f64 us_per_tick = 1000000.0 / get_ticks_per_second();
+		Vector<ProfilerEvent> events;
+		Vector<ProfilerOpenScope> stack;
+		c8 buf[256];
+		bool first = true;
+		auto begin_event = [&]() {
+			if (!first) out.push_back(',');
+			first = false;
+			out.append("\n");
+		};
+		out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		g_profiler_lock.lock();
+		ProfilerThread* threads = g_profiler_threads;
+		g_profiler_lock.unlock();
+		// Records are only prepended to the list, so the list can be iterated without the lock.
+		for (ProfilerThread* t = threads; t; t = t->m_next)
+		{
+			ProfilerEvent* src = t->m_events;
+			atom_fence_acquire();
+			if (!src) continue;
+			usize head = t->m_head;
+			atom_fence_acquire();
+			usize first_index = head > profiler_events_per_thread ? head - profiler_events_per_thread : 0;
+			events.clear();
+			for (usize i = first_index; i < head; ++i)
+			{
+				events.push_back(src[i % profiler_events_per_thread]);
+			}
+			atom_fence_acquire();
+			// Events before `valid_index` may be overwritten by the owning thread during the copy, including the event
+			// that is being written but not published yet.
+			usize new_head = t->m_head + 1;
+			usize valid_index = new_head > profiler_events_per_thread ? new_head - profiler_events_per_thread : 0;
+			usize skip = valid_index > first_index ? min(valid_index - first_index, events.size()) : 0;
+			begin_event();
+			out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,");
+			snprintf(buf, sizeof(buf), "\"tid\":%u,\"args\":{\"name\":", t->m_thread_id);
+			out.append(buf);
+			append_json_string(out, t->m_name);
+			out.append("}}");
+			stack.clear();
+			for (usize i = skip; i < events.size(); ++i)
+			{
+				const ProfilerEvent& e = events[i];
+				if (e.m_ticks < begin_ticks || e.m_ticks > end_ticks)
+				{
+					continue;
+				}
+				f64 ts = (f64)(e.m_ticks - begin_ticks) * us_per_tick;
+				switch (e.m_type)
+				{
+				case ProfilerEventType::begin_scope:
+					stack.push_back({ e.m_name, e.m_ticks });
+					break;
+				case ProfilerEventType::end_scope:
+					// Ends whose begins are not recorded are dropped. One scope may also begin and end on different
+					// threads if the job fiber is moved to another thread while waiting, such scopes are dropped as well.
+					if (!stack.empty() && stack.back().m_name == e.m_name)
+					{
+						ProfilerOpenScope scope = stack.back();
+						stack.pop_back();
+						f64 scope_ts = (f64)(scope.m_ticks - begin_ticks) * us_per_tick;
+						begin_event();
+						out.append("{\"name\":");
+						append_json_string(out, scope.m_name);
+						snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+							t->m_thread_id, scope_ts, ts - scope_ts);
+						out.append(buf);
+					}
+					break;
+				case ProfilerEventType::frame:
+					begin_event();
+					snprintf(buf, sizeof(buf), "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"index\":%u}}",
+						t->m_thread_id, ts, e.m_frame_index);
+					out.append(buf);
+					break;
+				}
+			}
+		}
+		out.append("\n]}\n");
+	}
+}
@@ -9,26 +9,37 @@
 #define LUNA_RUNTIME_API LUNA_EXPORT
 #include "../Runtime.hpp"
 #include "Name.hpp"
+#include "InternedPath.hpp"
 #include "Module.hpp"
 #include "OS.hpp"
 #include "Memory.hpp"
+#include "MemoryProfiler.hpp"
 namespace Luna
 {
 	void time_init();
 	void error_init();
 	void error_close();
+	void profiler_close();
 
 	LUNA_RUNTIME_API RV init()
 	{
 		OS::init();
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		memory_profiler_init();
+#endif
 		error_init();
 		name_init();
+		interned_path_init();
 		time_init();
 		auto r = module_init();
 		if (!r.valid())
 		{
+			interned_path_close();
 			name_close();
 			error_close();
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+			memory_profiler_close();
+#endif
 			return r;
 		}
 		return RV();
@@ -36,8 +47,13 @@ namespace Luna
 	LUNA_RUNTIME_API void close()
 	{
 		module_close();
+		profiler_close();
+		interned_path_close();
 		name_close();
 		error_close();
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		memory_profiler_close();
+#endif
 		OS::close();
 #ifdef LUNA_RUNTIME_CHECK_MEMORY_LEAK
 		check_memory_leak();
@@ -7,9 +7,235 @@
 #include <Runtime/PlatformDefines.hpp>
 #define LUNA_RUNTIME_API LUNA_EXPORT
 #include "../Unicode.hpp"
+#include "../Algorithm.hpp"
+
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#include <emmintrin.h>
+#define LUNA_UNICODE_SSE2 1
+#if defined(LUNA_PLATFORM_AVX2)
+#include <immintrin.h>
+#define LUNA_UNICODE_AVX2 1
+#endif
+#elif defined(LUNA_PLATFORM_ARM64)
+#include <arm_neon.h>
+#define LUNA_UNICODE_NEON 1
+#endif
 
 namespace Luna
 {
+	// The ASCII kernels below process one block of characters at one time, and stop at the first block that contains
+	// non-ASCII characters, the remaining characters of that block are then processed one by one.
+
+	//! Gets the length of the null-terminated string, but reads at most `max_chars` characters.
+	template <typename _Char>
+	inline usize bounded_strlen(const _Char* src, usize max_chars)
+	{
+		usize i = 0;
+		while (i < max_chars && src[i]) ++i;
+		return i;
+	}
+	template <>
+	inline usize bounded_strlen<c8>(const c8* src, usize max_chars)
+	{
+		if (max_chars == usize_max)
+		{
+			return strlen(src);
+		}
+		const void* end = memchr(src, 0, max_chars);
+		return end ? (usize)((const c8*)end - src) : max_chars;
+	}
+
+	//! Returns the number of leading ASCII characters in [src, src + len).
+	static usize scan_ascii(const u8* src, usize len)
+	{
+		usize i = 0;
+#if defined(LUNA_UNICODE_AVX2)
+		for (; i + 32 <= len; i += 32)
+		{
+			if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(src + i)))) break;
+		}
+#endif
+#if defined(LUNA_UNICODE_SSE2)
+		for (; i + 16 <= len; i += 16)
+		{
+			if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(src + i)))) break;
+		}
+#elif defined(LUNA_UNICODE_NEON)
+		for (; i + 16 <= len; i += 16)
+		{
+			if (vmaxvq_u8(vld1q_u8(src + i)) >= 0x80) break;
+		}
+#endif
+		for (; i < len; ++i)
+		{
+			if (src[i] & 0x80) break;
+		}
+		return i;
+	}
+
+	//! Checks whether the 16 characters starting from `src` are all ASCII characters.
+	inline bool is_ascii_block(const u8* src)
+	{
+#if defined(LUNA_UNICODE_SSE2)
+		return !_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)src));
+#elif defined(LUNA_UNICODE_NEON)
+		return vmaxvq_u8(vld1q_u8(src)) < 0x80;
+#else
+		u64 a;
+		u64 b;
+		memcpy(&a, src, sizeof(u64));
+		memcpy(&b, src + 8, sizeof(u64));
+		return !((a | b) & 0x8080808080808080ULL);
+#endif
+	}
+
+	//! Copies leading ASCII characters in [src, src + len) to UTF-32 buffer.
+	//! @return Returns the number of characters copied.
+	static usize widen_ascii(c32* dest, const u8* src, usize len)
+	{
+		usize i = 0;
+#if defined(LUNA_UNICODE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+			if (_mm_movemask_epi8(v)) break;
+			__m128i lo = _mm_unpacklo_epi8(v, zero);
+			__m128i hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_si128((__m128i*)(dest + i), _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128((__m128i*)(dest + i + 4), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128((__m128i*)(dest + i + 8), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128((__m128i*)(dest + i + 12), _mm_unpackhi_epi16(hi, zero));
+		}
+#elif defined(LUNA_UNICODE_NEON)
+		for (; i + 16 <= len; i += 16)
+		{
+			uint8x16_t v = vld1q_u8(src + i);
+			if (vmaxvq_u8(v) >= 0x80) break;
+			uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+			uint16x8_t hi = vmovl_high_u8(v);
+			vst1q_u32((u32*)(dest + i), vmovl_u16(vget_low_u16(lo)));
+			vst1q_u32((u32*)(dest + i + 4), vmovl_high_u16(lo));
+			vst1q_u32((u32*)(dest + i + 8), vmovl_u16(vget_low_u16(hi)));
+			vst1q_u32((u32*)(dest + i + 12), vmovl_high_u16(hi));
+		}
+#endif
+		for (; i < len; ++i)
+		{
+			u8 ch = src[i];
+			if (ch & 0x80) break;
+			dest[i] = (c32)ch;
+		}
+		return i;
+	}
+
+	//! Copies leading ASCII characters in [src, src + len) to UTF-16 buffer.
+	//! @return Returns the number of characters copied.
+	static usize widen_ascii(c16* dest, const u8* src, usize len)
+	{
+		usize i = 0;
+#if defined(LUNA_UNICODE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+			if (_mm_movemask_epi8(v)) break;
+			_mm_storeu_si128((__m128i*)(dest + i), _mm_unpacklo_epi8(v, zero));
+			_mm_storeu_si128((__m128i*)(dest + i + 8), _mm_unpackhi_epi8(v, zero));
+		}
+#elif defined(LUNA_UNICODE_NEON)
+		for (; i + 16 <= len; i += 16)
+		{
+			uint8x16_t v = vld1q_u8(src + i);
+			if (vmaxvq_u8(v) >= 0x80) break;
+			vst1q_u16((u16*)(dest + i), vmovl_u8(vget_low_u8(v)));
+			vst1q_u16((u16*)(dest + i + 8), vmovl_high_u8(v));
+		}
+#endif
+		for (; i < len; ++i)
+		{
+			u8 ch = src[i];
+			if (ch & 0x80) break;
+			dest[i] = (c16)ch;
+		}
+		return i;
+	}
+
+	//! Copies leading ASCII characters in [src, src + len) to UTF-8 buffer.
+	//! @return Returns the number of characters copied.
+	static usize narrow_ascii(c8* dest, const c16* src, usize len)
+	{
+		usize i = 0;
+#if defined(LUNA_UNICODE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask = _mm_set1_epi16((i16)0xFF80);
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+			__m128i high_bits = _mm_and_si128(_mm_or_si128(a, b), mask);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, zero)) != 0xFFFF) break;
+			_mm_storeu_si128((__m128i*)(dest + i), _mm_packus_epi16(a, b));
+		}
+#elif defined(LUNA_UNICODE_NEON)
+		for (; i + 16 <= len; i += 16)
+		{
+			uint16x8_t a = vld1q_u16((const u16*)(src + i));
+			uint16x8_t b = vld1q_u16((const u16*)(src + i + 8));
+			if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) break;
+			vst1q_u8((u8*)(dest + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+		}
+#endif
+		for (; i < len; ++i)
+		{
+			c16 ch = src[i];
+			if (ch >= 0x80) break;
+			dest[i] = (c8)ch;
+		}
+		return i;
+	}
+
+	//! Copies leading ASCII characters in [src, src + len) to UTF-8 buffer.
+	//! @return Returns the number of characters copied.
+	static usize narrow_ascii(c8* dest, const c32* src, usize len)
+	{
+		usize i = 0;
+#if defined(LUNA_UNICODE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i mask = _mm_set1_epi32((i32)0xFFFFFF80);
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+			__m128i c = _mm_loadu_si128((const __m128i*)(src + i + 8));
+			__m128i d = _mm_loadu_si128((const __m128i*)(src + i + 12));
+			__m128i high_bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), mask);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(high_bits, zero)) != 0xFFFF) break;
+			// All values are less than 0x80, so signed saturation does not change them.
+			_mm_storeu_si128((__m128i*)(dest + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+#elif defined(LUNA_UNICODE_NEON)
+		for (; i + 16 <= len; i += 16)
+		{
+			uint32x4_t a = vld1q_u32((const u32*)(src + i));
+			uint32x4_t b = vld1q_u32((const u32*)(src + i + 4));
+			uint32x4_t c = vld1q_u32((const u32*)(src + i + 8));
+			uint32x4_t d = vld1q_u32((const u32*)(src + i + 12));
+			if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80) break;
+			uint16x8_t lo = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+			uint16x8_t hi = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+			vst1q_u8((u8*)(dest + i), vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+		}
+#endif
+		for (; i < len; ++i)
+		{
+			c32 ch = src[i];
+			if (ch >= 0x80) break;
+			dest[i] = (c8)ch;
+		}
+		return i;
+	}
+
 	LUNA_RUNTIME_API usize utf8_encode_char(c8* dest, c32 ch)
 	{
 		if (ch <= impl::l_utf8_one_end)
@@ -88,17 +314,20 @@ namespace Luna
 
 	LUNA_RUNTIME_API usize utf16_encode_char(c16* dest, c32 ch, bool le)
 	{
-		if (ch >= 0xFFFF)
+		if (ch > 0xFFFF)
 		{
+			c32 v = ch - 0x10000;
+			c16 high = (c16)(0xD800 + ((v >> 10) & 0x03FF));
+			c16 low = (c16)(0xDC00 + (v & 0x03FF));
 			if (le)
 			{
-				dest[0] = 0xDC00 + (c16)ch & 0x03FF;
-				dest[1] = 0xD800 + (c16)(ch >> 10) & 0x03FF;
+				dest[0] = low;
+				dest[1] = high;
 			}
 			else
 			{
-				dest[0] = 0xD800 + (c16)(ch >> 10) & 0x03FF;
-				dest[1] = 0xDC00 + (c16)ch & 0x03FF;
+				dest[0] = high;
+				dest[1] = low;
 			}
 			return 2;
 		}
@@ -116,22 +345,140 @@ namespace Luna
 		if (fc >= 0xDC00 && fc <= 0xDFFF)
 		{
 			// LE
-			return (fc - 0xDC00) + (c32)((str[1] - 0xD800) << 10);
+			return (fc - 0xDC00) + (c32)((str[1] - 0xD800) << 10) + 0x10000;
 		}
 		if (fc >= 0xD800 && fc <= 0xDBFF)
 		{
 			// BE
-			return (str[1] - 0xDC00) + (c32)((fc - 0xD800) << 10);
+			return (str[1] - 0xDC00) + (c32)((fc - 0xD800) << 10) + 0x10000;
 		}
 		return (c32)fc;
 	}
 
+	LUNA_RUNTIME_API usize utf8_ascii_len(const c8* src, usize src_chars)
+	{
+		return scan_ascii((const u8*)src, src_chars);
+	}
+
+	LUNA_RUNTIME_API bool utf8_validate(const c8* src, usize src_chars)
+	{
+		const u8* s = (const u8*)src;
+		usize i = 0;
+		while (i < src_chars)
+		{
+			if (s[i] < 0x80)
+			{
+				i += scan_ascii(s + i, src_chars - i);
+				continue;
+			}
+			u8 c = s[i];
+			usize n;
+			// The valid range of the second byte, see RFC 3629 section 4.
+			u8 lo = 0x80;
+			u8 hi = 0xBF;
+			if (c >= 0xC2 && c <= 0xDF) n = 2;
+			else if (c == 0xE0) { n = 3; lo = 0xA0; }
+			else if (c == 0xED) { n = 3; hi = 0x9F; }
+			else if (c >= 0xE1 && c <= 0xEF) n = 3;
+			else if (c == 0xF0) { n = 4; lo = 0x90; }
+			else if (c == 0xF4) { n = 4; hi = 0x8F; }
+			else if (c >= 0xF1 && c <= 0xF3) n = 4;
+			else return false;
+			if (n > src_chars - i) return false;
+			if (s[i + 1] < lo || s[i + 1] > hi) return false;
+			for (usize j = 2; j < n; ++j)
+			{
+				if ((s[i + j] & 0xC0) != 0x80) return false;
+			}
+			i += n;
+		}
+		return true;
+	}
+
+	LUNA_RUNTIME_API usize utf8_decode_span(c32* dest, usize dest_max_chars, const c8* src, usize src_chars, usize* src_read)
+	{
+		const u8* s = (const u8*)src;
+		usize ri{ 0 };
+		usize wi{ 0 };
+		while (ri < src_chars && wi < dest_max_chars)
+		{
+			u8 c = s[ri];
+			if (c < 0x80)
+			{
+				// Only runs of at least one block take the vector path. Short runs like spaces and punctuation between
+				// non-ASCII words are copied directly.
+				if (src_chars - ri >= 16 && dest_max_chars - wi >= 16 && is_ascii_block(s + ri))
+				{
+					usize n = widen_ascii(dest + wi, s + ri, min(src_chars - ri, dest_max_chars - wi));
+					ri += n;
+					wi += n;
+				}
+				else
+				{
+					dest[wi] = (c32)c;
+					++ri;
+					++wi;
+				}
+				continue;
+			}
+			// 2-byte and 3-byte sequences cover all scripts of the Basic Multilingual Plane, so they are decoded inline.
+			if (c <= 0xDF)
+			{
+				if (src_chars - ri < 2)
+				{
+					break;
+				}
+				dest[wi] = ((c32)(c & 0x1F) << 6) + (s[ri + 1] & 0x3F);
+				ri += 2;
+				++wi;
+				continue;
+			}
+			if (c <= 0xEF)
+			{
+				if (src_chars - ri < 3)
+				{
+					break;
+				}
+				dest[wi] = ((c32)(c & 0x0F) << 12) + ((c32)(s[ri + 1] & 0x3F) << 6) + (s[ri + 2] & 0x3F);
+				ri += 3;
+				++wi;
+				continue;
+			}
+			usize len = utf8_charlen(src + ri);
+			if (len > src_chars - ri)
+			{
+				break;
+			}
+			dest[wi] = utf8_decode_char(src + ri);
+			ri += len;
+			++wi;
+		}
+		if (src_read)
+		{
+			*src_read = ri;
+		}
+		return wi;
+	}
+
 	LUNA_RUNTIME_API usize utf16_to_utf8(c8* dest, usize dest_max_chars, const c16* src, usize src_chars)
 	{
+		usize len = bounded_strlen(src, src_chars);
 		usize ri{ 0 };
 		usize wi{ 0 };
-		while ((src[ri]) && (ri < src_chars))
+		while (ri < len)
 		{
+			if (src[ri] < 0x80)
+			{
+				usize n = narrow_ascii(dest + wi, src + ri, min(len - ri, dest_max_chars - 1 - wi));
+				ri += n;
+				wi += n;
+				if (!n) break;
+				continue;
+			}
+			if (utf16_charlen(src + ri) > len - ri)
+			{
+				break;
+			}
 			c32 ch = utf16_decode_char(src + ri);
 			usize num_chars = utf8_charspan(ch);
 			if (wi + num_chars > dest_max_chars - 1)
@@ -147,10 +494,21 @@ namespace Luna
 
 	LUNA_RUNTIME_API usize utf16_to_utf8_len(const c16* src, usize src_chars)
 	{
+		usize len = bounded_strlen(src, src_chars);
 		usize ri{ 0 };
 		usize wi{ 0 };
-		while (src[ri] && (ri < src_chars))
+		while (ri < len)
 		{
+			if (src[ri] < 0x80)
+			{
+				++ri;
+				++wi;
+				continue;
+			}
+			if (utf16_charlen(src + ri) > len - ri)
+			{
+				break;
+			}
 			c32 ch = utf16_decode_char(src + ri);
 			ri += utf16_charspan(ch);
 			wi += utf8_charspan(ch);
@@ -160,17 +518,32 @@ namespace Luna
 
 	LUNA_RUNTIME_API usize utf8_to_utf16(c16* dest, usize dest_max_chars, const c8* src, bool le, usize src_chars)
 	{
+		usize len = bounded_strlen(src, src_chars);
+		const u8* s = (const u8*)src;
 		usize ri{ 0 };
 		usize wi{ 0 };
-		while ((src[ri]) && (ri < src_chars))
+		while (ri < len)
 		{
+			if (s[ri] < 0x80)
+			{
+				usize n = widen_ascii(dest + wi, s + ri, min(len - ri, dest_max_chars - 1 - wi));
+				ri += n;
+				wi += n;
+				if (!n) break;
+				continue;
+			}
+			usize char_len = utf8_charlen(src + ri);
+			if (char_len > len - ri)
+			{
+				break;
+			}
 			c32 ch = utf8_decode_char(src + ri);
 			usize num_chars = utf16_charspan(ch);
 			if (wi + num_chars >= dest_max_chars)
 			{
 				break;
 			}
-			ri += utf8_charspan(ch);
+			ri += char_len;
 			wi += utf16_encode_char(dest + wi, ch, le);
 		}
 		dest[wi] = '\0';
@@ -179,14 +552,74 @@ namespace Luna
 
 	LUNA_RUNTIME_API usize utf8_to_utf16_len(const c8* src, usize src_max_chars)
 	{
+		usize len = bounded_strlen(src, src_max_chars);
+		const u8* s = (const u8*)src;
 		usize ri{ 0 };
 		usize wi{ 0 };
-		while (src[ri] && (ri < src_max_chars))
+		while (ri < len)
 		{
+			if (s[ri] < 0x80)
+			{
+				usize n = scan_ascii(s + ri, len - ri);
+				ri += n;
+				wi += n;
+				continue;
+			}
+			usize char_len = utf8_charlen(src + ri);
+			if (char_len > len - ri)
+			{
+				break;
+			}
 			c32 ch = utf8_decode_char(src + ri);
-			ri += utf8_charspan(ch);
+			ri += char_len;
 			wi += utf16_charspan(ch);
 		}
 		return wi;
 	}
-}
\ No newline at end of file
+
+	LUNA_RUNTIME_API usize utf8_to_utf32(c32* dest, usize dest_max_chars, const c8* src, usize src_chars)
+	{
+		usize len = bounded_strlen(src, src_chars);
+		usize wi = utf8_decode_span(dest, dest_max_chars - 1, src, len);
+		dest[wi] = 0;
+		return wi;
+	}
+
+	LUNA_RUNTIME_API usize utf32_to_utf8(c8* dest, usize dest_max_chars, const c32* src, usize src_chars)
+	{
+		usize len = bounded_strlen(src, src_chars);
+		usize ri{ 0 };
+		usize wi{ 0 };
+		while (ri < len)
+		{
+			if (src[ri] < 0x80)
+			{
+				usize n = narrow_ascii(dest + wi, src + ri, min(len - ri, dest_max_chars - 1 - wi));
+				ri += n;
+				wi += n;
+				if (!n) break;
+				continue;
+			}
+			c32 ch = src[ri];
+			if (wi + utf8_charspan(ch) > dest_max_chars - 1)
+			{
+				break;
+			}
+			wi += utf8_encode_char(dest + wi, ch);
+			++ri;
+		}
+		dest[wi] = '\0';
+		return wi;
+	}
+
+	LUNA_RUNTIME_API usize utf32_to_utf8_len(const c32* src, usize src_chars)
+	{
+		usize len = bounded_strlen(src, src_chars);
+		usize wi{ 0 };
+		for (usize ri = 0; ri < len; ++ri)
+		{
+			wi += utf8_charspan(src[ri]);
+		}
+		return wi;
+	}
+}
@@ -8,6 +8,8 @@
 #include "Memory.hpp"
 #include "Algorithm.hpp"
 #include "Iterator.hpp"
+#include "Functional.hpp"
+#include "Allocator.hpp"
 
 namespace Luna
 {
@@ -39,26 +41,120 @@ namespace Luna
 	}
 
 	//! The string template used by String, String16 and String32.
-	template <typename _Char>
-	class BasicString
+	//! @remark The allocator is stored as the base class of the string, so the default allocator does not increase the size of the string.
+	//!
+	//! Short strings are stored in the string object directly without allocating memory. The string object is 3 pointers large,
+	//! which can store 22 `c8` characters, 10 `c16` characters or 4 `c32` characters in place on 64-bit platforms (10, 4 and 1 characters on
+	//! 32-bit platforms). The first byte of the string object tells whether the string is stored in place or in the heap, so the string does not
+	//! point to itself and can still be relocated by `memcpy`.
+	template <typename _Char, typename _Alloc = Allocator>
+	class BasicString : private _Alloc
 	{
 	private:
+		// The string data stored in the heap.
+		struct LongRep
+		{
+			usize m_cap;	// The capacity, with the long flag encoded.
+			usize m_size;
+			_Char* m_data;
+		};
+		static constexpr usize short_slots = (sizeof(LongRep) - (sizeof(_Char) > 1 ? sizeof(_Char) : 1)) / sizeof(_Char);
+		// The string data stored in place.
+		struct ShortRep
+		{
+			u8 m_size;		// The size, with the short flag encoded.
+			_Char m_data[short_slots];
+		};
+		static_assert(sizeof(ShortRep) == sizeof(LongRep), "Incorrect short string size.");
+
 		// -------------------- Begin of ABI compatible part --------------------
-		_Char* m_buffer;		// The memory buffer.
-		usize m_size;			// Number of elements in the vector.
-		usize m_capacity;		// Number of elements that can be included in the buffer before a reallocation is needed.
+		union
+		{
+			LongRep m_long;
+			ShortRep m_short;
+		};
 		// --------------------  End of ABI compatible part  --------------------
 
+		// The first byte of the string object is the first byte of `LongRep::m_cap` and `ShortRep::m_size`,
+		// we use one bit of this byte to identify the long mode.
+#ifdef LUNA_PLATFORM_BIG_ENDIAN
+		static constexpr u8 long_mask = 0x80;
+		static constexpr usize long_cap_flag = (usize)1 << (sizeof(usize) * 8 - 1);
+		void set_short_size(usize n) { m_short.m_size = (u8)n; }
+		usize get_short_size() const { return m_short.m_size; }
+		void set_long_cap(usize n) { m_long.m_cap = n | long_cap_flag; }
+		usize get_long_cap() const { return m_long.m_cap & ~long_cap_flag; }
+#else
+		static constexpr u8 long_mask = 0x01;
+		void set_short_size(usize n) { m_short.m_size = (u8)(n << 1); }
+		usize get_short_size() const { return m_short.m_size >> 1; }
+		void set_long_cap(usize n) { m_long.m_cap = (n << 1) | 1; }
+		usize get_long_cap() const { return m_long.m_cap >> 1; }
+#endif
+		bool is_long() const
+		{
+			return (m_short.m_size & long_mask) != 0;
+		}
+		_Char* get_pointer()
+		{
+			return is_long() ? m_long.m_data : m_short.m_data;
+		}
+		const _Char* get_pointer() const
+		{
+			return is_long() ? m_long.m_data : m_short.m_data;
+		}
+		usize get_size() const
+		{
+			return is_long() ? m_long.m_size : get_short_size();
+		}
+		// Sets the size and writes the null terminator.
+		void set_size(usize n)
+		{
+			if (is_long())
+			{
+				m_long.m_size = n;
+				m_long.m_data[n] = (_Char)0;
+			}
+			else
+			{
+				set_short_size(n);
+				m_short.m_data[n] = (_Char)0;
+			}
+		}
+		void init_short()
+		{
+			set_short_size(0);
+			m_short.m_data[0] = (_Char)0;
+		}
+		// Initializes the buffer to hold `count` characters, sets the size to `count` and writes the null terminator.
+		// This should only be called from constructors.
+		_Char* init_buffer(usize count)
+		{
+			_Char* buf;
+			if (count <= short_capacity)
+			{
+				set_short_size(count);
+				buf = m_short.m_data;
+			}
+			else
+			{
+				buf = (_Char*)_Alloc::allocate(sizeof(_Char) * (count + 1));
+				m_long.m_data = buf;
+				m_long.m_size = count;
+				set_long_cap(count);
+			}
+			buf[count] = (_Char)0;
+			return buf;
+		}
+
 		// Frees all dynamic memory.
 		void free_buffer()
 		{
-			if (m_buffer)
+			if (is_long())
 			{
-				memfree(m_buffer);
-				m_buffer = nullptr;
+				_Alloc::deallocate(m_long.m_data, sizeof(_Char) * (get_long_cap() + 1));
 			}
-			m_size = 0;
-			m_capacity = 0;
+			init_short();
 		}
 
 		usize strlength(const _Char* s)
@@ -70,6 +166,7 @@ namespace Luna
 
 	public:
 		using value_type = _Char;
+		using allocator_type = _Alloc;
 		using reference = value_type&;
 		using const_reference = const value_type&;
 		using pointer = value_type*;
@@ -81,233 +178,161 @@ namespace Luna
 
 		static constexpr usize npos = (usize)-1;
 
-		BasicString() :
-			m_size(0),
-			m_capacity(0),
-			m_buffer(nullptr) {}
-		BasicString(usize count, value_type ch) :
-			m_size(count),
-			m_capacity(count)
+		//! The maximum number of characters that can be stored without allocating memory.
+		static constexpr usize short_capacity = short_slots - 1;
+
+		BasicString()
 		{
-			if (count)
-			{
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (count + 1));
-				for (value_type* i = m_buffer; i < m_buffer + m_size; ++i)
-				{
-					*i = ch;
-				}
-				m_buffer[m_size] = (value_type)0;
-			}
-			else
-			{
-				m_buffer = nullptr;
-			}
+			init_short();
 		}
-		BasicString(const BasicString& rhs, usize pos, usize count = npos)
+		explicit BasicString(const allocator_type& alloc) :
+			_Alloc(alloc)
+		{
+			init_short();
+		}
+		BasicString(usize count, value_type ch, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc)
+		{
+			value_type* buf = init_buffer(count);
+			fill_construct_range(buf, buf + count, ch);
+		}
+		BasicString(const BasicString& rhs, usize pos, usize count = npos, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc)
 		{
 			count = (count == npos) ? rhs.size() - pos : count;
-			m_size = count;
-			m_capacity = count;
-			if (count)
-			{
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (count + 1));
-				memcpy(m_buffer, rhs.c_str() + pos, sizeof(value_type) * count);
-				m_buffer[count] = (value_type)0;
-			}
-			else
-			{
-				m_buffer = nullptr;
-			}
+			value_type* buf = init_buffer(count);
+			memcpy(buf, rhs.c_str() + pos, sizeof(value_type) * count);
 		}
-		BasicString(const value_type* s, usize count) :
-			m_size(count),
-			m_capacity(count)
+		BasicString(const value_type* s, usize count, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc)
 		{
-			if (count)
-			{
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (count + 1));
-				memcpy(m_buffer, s, sizeof(value_type) * count);
-				m_buffer[count] = (value_type)0;
-			}
-			else
-			{
-				m_buffer = nullptr;
-			}
+			value_type* buf = init_buffer(count);
+			memcpy(buf, s, sizeof(value_type) * count);
 		}
-		BasicString(const value_type* s)
+		BasicString(const value_type* s, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc)
 		{
 			usize count = strlength(s);
-			m_size = count;
-			m_capacity = count;
-			if (count)
-			{
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (count + 1));
-				memcpy(m_buffer, s, sizeof(value_type) * count);
-				m_buffer[count] = (value_type)0;
-			}
-			else
-			{
-				m_buffer = nullptr;
-			}
+			value_type* buf = init_buffer(count);
+			memcpy(buf, s, sizeof(value_type) * count);
 		}
-		BasicString(const BasicString& rhs)
+		BasicString(const BasicString& rhs) :
+			_Alloc(rhs.get_allocator())
 		{
-			if (!rhs.empty())
-			{
-				m_size = rhs.m_size;
-				m_capacity = rhs.m_size;
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (m_size + 1));
-				memcpy(m_buffer, rhs.m_buffer, sizeof(value_type) * (m_size + 1));
-			}
-			else
-			{
-				m_size = 0;
-				m_capacity = 0;
-				m_buffer = nullptr;
-			}
+			usize count = rhs.size();
+			value_type* buf = init_buffer(count);
+			memcpy(buf, rhs.data(), sizeof(value_type) * count);
 		}
 		BasicString(BasicString&& rhs) :
-			m_buffer(rhs.m_buffer),
-			m_size(rhs.m_size),
-			m_capacity(rhs.m_capacity)
+			_Alloc(rhs.get_allocator())
 		{
-			rhs.m_buffer = nullptr;
-			rhs.m_size = 0;
-			rhs.m_capacity = 0;
+			memcpy((void*)&m_long, (const void*)&rhs.m_long, sizeof(LongRep));
+			rhs.init_short();
 		}
-		BasicString(InitializerList<value_type> ilist) :
-			m_size(ilist.size()),
-			m_capacity(ilist.size())
+		BasicString(InitializerList<value_type> ilist, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc)
 		{
-			if (m_size)
-			{
-				m_buffer = (value_type*)memalloc(sizeof(value_type) * (ilist.size() + 1));
-				value_type* i = m_buffer;
-				for (auto iter = ilist.begin(); iter != ilist.end(); ++iter)
-				{
-					*i = *iter;
-					++i;
-				}
-				m_buffer[m_size] = 0;
-			}
-			else
+			value_type* i = init_buffer(ilist.size());
+			for (auto iter = ilist.begin(); iter != ilist.end(); ++iter)
 			{
-				m_buffer = nullptr;
+				*i = *iter;
+				++i;
 			}
-
 		}
 		BasicString& operator=(const BasicString& rhs)
 		{
-			free_buffer();
-			if (!rhs.empty())
+			if (this != &rhs)
 			{
-				reserve(rhs.m_size);
-				memcpy(m_buffer, rhs.c_str(), (rhs.size() + 1) * sizeof(value_type));
-				m_size = rhs.size();
+				assign(rhs.data(), rhs.size());
 			}
 			return *this;
 		}
 		BasicString& operator=(BasicString&& rhs)
 		{
-			free_buffer();
-			Luna::swap(m_buffer, rhs.m_buffer);
-			Luna::swap(m_size, rhs.m_size);
-			Luna::swap(m_capacity, rhs.m_capacity);
+			if (this != &rhs)
+			{
+				free_buffer();
+				Luna::swap(static_cast<_Alloc&>(*this), static_cast<_Alloc&>(rhs));
+				memcpy((void*)&m_long, (const void*)&rhs.m_long, sizeof(LongRep));
+				rhs.init_short();
+			}
 			return *this;
 		}
 		BasicString& operator=(const value_type* s)
 		{
-			clear();
-			usize count = strlen(s);
-			reserve(count);
-			if (count)
-			{
-				memcpy(m_buffer, s, sizeof(value_type) * count);
-				
-			}
-			m_size = count;
-			if (m_buffer)
-			{
-				m_buffer[m_size] = (value_type)0;
-			}
+			assign(s);
 			return *this;
 		}
 		BasicString& operator=(value_type ch)
 		{
 			clear();
-			reserve(1);
-			m_buffer[0] = ch;
-			m_size = 1;
-			m_buffer[m_size] = (value_type)0;
+			push_back(ch);
 			return *this;
 		}
 		BasicString& operator=(InitializerList<value_type> ilist)
 		{
 			clear();
 			reserve(ilist.size());
-			if (ilist.size())
-			{
-				value_type* i = m_buffer;
-				for (auto iter = ilist.begin(); iter != ilist.end(); ++iter)
-				{
-					*i = *iter;
-					++i;
-				}
-			}
-			m_size = ilist.size();
-			if (m_buffer)
+			value_type* i = data();
+			for (auto iter = ilist.begin(); iter != ilist.end(); ++iter)
 			{
-				m_buffer[m_size] = (value_type)0;
+				*i = *iter;
+				++i;
 			}
+			set_size(ilist.size());
 			return *this;
 		}
 		~BasicString()
 		{
 			free_buffer();
 		}
+		allocator_type get_allocator() const
+		{
+			return *static_cast<const _Alloc*>(this);
+		}
 
-		//! May returns `nullptr` if the string is empty.
+		//! Returns the pointer to the string buffer. The string buffer is always valid and null-terminated, even if the string is empty.
 		pointer data()
 		{
-			return m_buffer;
+			return get_pointer();
 		}
 
 		const_pointer data() const
 		{
-			return m_buffer;
+			return get_pointer();
 		}
 
-		//! Unlike `data`, this call always returns a valid string, not `nullptr`, even if the string is empty.
+		//! Returns the null-terminated string. This is the same as `data`.
 		const_pointer c_str() const
 		{
-			return m_buffer ? m_buffer : Impl::StringTraits<value_type>::null_string;
+			return get_pointer();
 		}
 
-		// Returns a pointer to the first element. Can only be `nullptr` if `size` and `capacity` is both 0.
+		// Returns a pointer to the first element.
 		iterator begin()
 		{
-			return m_buffer;
+			return get_pointer();
 		}
-		// Returns a pointer to the element next to the last element. Can only be `nullptr` if `size` and `capacity` is both 0.
+		// Returns a pointer to the element next to the last element.
 		iterator end()
 		{
-			return m_buffer + m_size;
+			return get_pointer() + get_size();
 		}
 		const_iterator begin() const
 		{
-			return m_buffer;
+			return get_pointer();
 		}
 		const_iterator end() const
 		{
-			return m_buffer + m_size;
+			return get_pointer() + get_size();
 		}
 		const_iterator cbegin() const
 		{
-			return m_buffer;
+			return begin();
 		}
 		const_iterator cend() const
 		{
-			return m_buffer + m_size;
+			return end();
 		}
 		reverse_iterator rbegin()
 		{
@@ -335,147 +360,148 @@ namespace Luna
 		}
 		usize size() const
 		{
-			return m_size;
+			return get_size();
 		}
 		usize length() const
 		{
-			return m_size;
+			return get_size();
 		}
+		//! Returns the number of characters that can be stored before a reallocation is needed.
+		//! This is never smaller than `short_capacity`.
 		usize capacity() const
 		{
-			return m_capacity;
+			return is_long() ? get_long_cap() : short_capacity;
 		}
 		bool empty() const
 		{
-			return (m_size == 0);
+			return get_size() == 0;
 		}
 		void reserve(usize new_cap)
 		{
-			if (new_cap > m_capacity)
+			if (new_cap > capacity())
 			{
-				value_type* new_buf = (value_type*)memalloc((new_cap + 1) * sizeof(value_type));
-				if (m_buffer)
+				value_type* new_buf = (value_type*)_Alloc::allocate((new_cap + 1) * sizeof(value_type));
+				usize sz = get_size();
+				memcpy(new_buf, get_pointer(), (sz + 1) * sizeof(value_type));
+				if (is_long())
 				{
-					copy_relocate_range(begin(), end() + 1, new_buf);
-
-					memfree(m_buffer);
+					_Alloc::deallocate(m_long.m_data, (get_long_cap() + 1) * sizeof(value_type));
 				}
-				m_buffer = new_buf;
-				m_capacity = new_cap;
+				m_long.m_data = new_buf;
+				m_long.m_size = sz;
+				set_long_cap(new_cap);
 			}
 		}
 	private:
 		void internal_expand_reserve(usize new_least_cap)
 		{
-			if (new_least_cap > m_capacity)
+			usize cap = capacity();
+			if (new_least_cap > cap)
 			{
-				reserve(max(max(new_least_cap, m_capacity * 2), (usize)4));	// Double the size by default.
+				reserve(max(max(new_least_cap, cap * 2), (usize)4));	// Double the size by default.
 			}
 		}
 	public:
 		void resize(usize n, value_type v)
 		{
 			reserve(n);
-			if (n > m_size)
+			usize sz = get_size();
+			if (n > sz)
 			{
-				fill_construct_range(m_buffer + m_size, m_buffer + n, v);
+				value_type* p = get_pointer();
+				fill_construct_range(p + sz, p + n, v);
 			}
-			m_size = n;
-			m_buffer[n] = (value_type)0;
+			set_size(n);
 		}
 		void shrink_to_fit()
 		{
-			if (m_capacity != m_size)
+			if (!is_long())
 			{
-				if (!m_size)
-				{
-					free_buffer();
-				}
-				else
-				{
-					value_type* new_buf = (value_type*)memalloc(sizeof(value_type) * (m_size + 1), alignof(value_type));
-					if (m_buffer)
-					{
-						memcpy(new_buf, m_buffer, sizeof(value_type) * (m_size + 1));
-						memfree(m_buffer);
-					}
-					m_buffer = new_buf;
-					m_capacity = m_size;
-				}
+				return;
+			}
+			usize sz = m_long.m_size;
+			usize cap = get_long_cap();
+			value_type* old_buf = m_long.m_data;
+			if (sz <= short_capacity)
+			{
+				// Moves the string back to the in-place buffer.
+				set_short_size(sz);
+				memcpy(m_short.m_data, old_buf, sizeof(value_type) * (sz + 1));
+				_Alloc::deallocate(old_buf, sizeof(value_type) * (cap + 1));
+			}
+			else if (cap != sz)
+			{
+				value_type* new_buf = (value_type*)_Alloc::allocate(sizeof(value_type) * (sz + 1));
+				memcpy(new_buf, old_buf, sizeof(value_type) * (sz + 1));
+				_Alloc::deallocate(old_buf, sizeof(value_type) * (cap + 1));
+				m_long.m_data = new_buf;
+				set_long_cap(sz);
 			}
 		}
 
 		reference operator[] (usize n)
 		{
-			luassert(n < m_size);
-			return m_buffer[n];
+			luassert(n < size());
+			return data()[n];
 		}
 		const_reference operator[] (usize n) const
 		{
-			luassert(n < m_size);
-			return m_buffer[n];
+			luassert(n < size());
+			return data()[n];
 		}
 		reference at(usize n)
 		{
-			luassert(n < m_size);
-			return m_buffer[n];
+			luassert(n < size());
+			return data()[n];
 		}
 		const_reference at(usize n) const
 		{
-			luassert(n < m_size);
-			return m_buffer[n];
+			luassert(n < size());
+			return data()[n];
 		}
 		reference front()
 		{
 			luassert(!empty());
-			return m_buffer[0];
+			return data()[0];
 		}
 		const_reference front() const
 		{
 			luassert(!empty());
-			return m_buffer[0];
+			return data()[0];
 		}
 		reference back()
 		{
 			luassert(!empty());
-			return m_buffer[m_size - 1];
+			return data()[size() - 1];
 		}
 		const_reference back() const
 		{
 			luassert(!empty());
-			return m_buffer[m_size - 1];
+			return data()[size() - 1];
 		}
 		void clear()
 		{
-			if (m_buffer)
-			{
-				m_buffer[0] = (value_type)0;
-			}
-			m_size = 0;
+			set_size(0);
 		}
 		void push_back(value_type ch)
 		{
-			internal_expand_reserve(size() + 1);
-			m_buffer[m_size] = ch;
-			++m_size;
-			m_buffer[m_size] = (value_type)0;
+			usize sz = get_size();
+			internal_expand_reserve(sz + 1);
+			get_pointer()[sz] = ch;
+			set_size(sz + 1);
 		}
 		void pop_back()
 		{
 			luassert(!empty());
-			--m_size;
-			m_buffer[m_size] = (value_type)0;
+			set_size(get_size() - 1);
 		}
 		void assign(usize count, value_type ch)
 		{
 			clear();
 			reserve(count);
-			if (count)
-			{
-				fill_construct_range(m_buffer, m_buffer + count, ch);
-				m_buffer[count] = (value_type)0;
-			}
-			m_size = count;
+			value_type* p = get_pointer();
+			fill_construct_range(p, p + count, ch);
+			set_size(count);
 		}
 		void assign(const BasicString& str)
 		{
@@ -483,48 +509,23 @@ namespace Luna
 		}
 		void assign(const BasicString& str, usize pos, usize count = npos)
 		{
-			clear();
 			count = (count == npos) ? str.size() - pos : count;
-			reserve(count);
-			if (count)
-			{
-				memcpy(m_buffer, str.c_str() + pos, count * sizeof(value_type));
-				m_buffer[count] = (value_type)0;
-			}
-			m_size = count;
+			assign(str.c_str() + pos, count);
 		}
 		void assign(BasicString&& str)
 		{
-			free_buffer();
-			m_buffer = str.m_buffer;
-			m_capacity = str.m_capacity;
-			m_size = str.m_size;
-			str.m_buffer = nullptr;
-			str.m_capacity = 0;
-			str.m_size = 0;
+			*this = move(str);
 		}
 		void assign(const value_type* s, usize count)
 		{
 			clear();
 			reserve(count);
-			if (count)
-			{
-				memcpy(m_buffer, s, count * sizeof(value_type));
-				m_buffer[count] = (value_type)0;
-				m_size = count;
-			}
+			memcpy(get_pointer(), s, count * sizeof(value_type));
+			set_size(count);
 		}
 		void assign(const value_type* s)
 		{
-			usize count = strlength(s);
-			clear();
-			reserve(count);
-			if (count)
-			{
-				memcpy(m_buffer, s, count * sizeof(value_type));
-				m_buffer[count] = (value_type)0;
-				m_size = count;
-			}
+			assign(s, strlength(s));
 		}
 		template <typename _InputIt>
 		void assign(_InputIt first, _InputIt last)
@@ -539,108 +540,77 @@ namespace Luna
 		{
 			assign(il.begin(), il.end());
 		}
-		void insert(usize index, usize count, value_type ch)
+	private:
+		// Opens a gap of `count` characters at `index` and returns the pointer to the gap. The size is updated.
+		value_type* internal_insert_gap(usize index, usize count)
 		{
-			luassert(index <= m_size);
-			internal_expand_reserve(m_size + count);
-			if (index != m_size)
+			usize sz = get_size();
+			luassert(index <= sz);
+			internal_expand_reserve(sz + count);
+			value_type* p = get_pointer();
+			if (index != sz)
 			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
+				memmove(p + index + count, p + index, sizeof(value_type) * (sz - index));
 			}
-			fill_construct_range(m_buffer + index, m_buffer + index + count, ch);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
+			set_size(sz + count);
+			return p + index;
+		}
+	public:
+		void insert(usize index, usize count, value_type ch)
+		{
+			value_type* dest = internal_insert_gap(index, count);
+			fill_construct_range(dest, dest + count, ch);
 		}
 		void insert(usize index, const value_type* s)
 		{
-			luassert(index <= m_size);
-			usize count = strlength(s);
-			internal_expand_reserve(m_size + count);
-			if (index != m_size)
-			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
-			}
-			memcpy(m_buffer + index, s, sizeof(value_type) * count);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
+			insert(index, s, strlength(s));
 		}
 		void insert(usize index, const value_type* s, usize count)
 		{
-			luassert(index <= m_size);
-			internal_expand_reserve(m_size + count);
-			if (index != m_size)
+			const value_type* p = get_pointer();
+			if (count && s >= p && s < p + get_size())
 			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
+				// `s` points into this string, which is moved by opening the gap.
+				BasicString tmp(s, count, get_allocator());
+				insert(index, tmp.c_str(), count);
+				return;
 			}
-			memcpy(m_buffer + index, s, sizeof(value_type) * count);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
+			value_type* dest = internal_insert_gap(index, count);
+			memcpy(dest, s, sizeof(value_type) * count);
 		}
 		void insert(usize index, const BasicString& str)
 		{
-			luassert(index <= m_size);
-			usize count = str.size();
-			internal_expand_reserve(m_size + count);
-			if (index != m_size)
-			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
-			}
-			memcpy(m_buffer + index, str.c_str(), sizeof(value_type) * count);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
+			insert(index, str.c_str(), str.size());
 		}
 		void insert(usize index, const BasicString& str, usize index_str, usize count)
 		{
-			luassert(index <= m_size);
 			luassert(count <= (str.size() - index_str));
-			internal_expand_reserve(m_size + count);
-			if (index != m_size)
-			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
-			}
-			memcpy(m_buffer + index, str.c_str() + index_str, sizeof(value_type) * count);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
+			insert(index, str.c_str() + index_str, count);
 		}
 		iterator insert(const_iterator pos, value_type ch)
 		{
-			luassert(((usize)pos >= (usize)m_buffer) && ((usize)pos <= (usize)(m_buffer + m_size)));
-			usize index = pos - cbegin();
-			internal_expand_reserve(m_size + 1);
-			auto mpos = begin() + index;
-			if (mpos != end())
-			{
-				memmove(m_buffer + index + 1, m_buffer + index, sizeof(value_type) * (m_size - index));
-			}
-			m_buffer[index] = ch;
-			++m_size;
-			m_buffer[m_size] = (value_type)0;
-			return mpos;
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* dest = internal_insert_gap(pos - cbegin(), 1);
+			*dest = ch;
+			return dest;
 		}
 		iterator insert(const_iterator pos, usize count, value_type ch)
 		{
-			luassert(((usize)pos >= (usize)m_buffer) && ((usize)pos <= (usize)(m_buffer + m_size)));
-			usize index = pos - cbegin();
-			internal_expand_reserve(m_size + count);
-			auto mpos = begin() + index;
-			if (mpos != end())
-			{
-				memmove(m_buffer + index + count, m_buffer + index, sizeof(value_type) * (m_size - index));
-			}
-			fill_construct_range(m_buffer + index, m_buffer + index + count, ch);
-			m_size += count;
-			m_buffer[m_size] = (value_type)0;
-			return mpos;
+			luassert((pos >= cbegin()) && (pos <= cend()));
+			value_type* dest = internal_insert_gap(pos - cbegin(), count);
+			fill_construct_range(dest, dest + count, ch);
+			return dest;
 		}
 		template <typename _InputIt>
 		iterator insert(const_iterator pos, _InputIt first, _InputIt last)
 		{
-			luassert(((usize)pos >= (usize)m_buffer) && ((usize)pos <= (usize)(m_buffer + m_size)));
+			luassert((pos >= cbegin()) && (pos <= cend()));
 			usize index = pos - cbegin();
+			usize i = index;
 			for (auto iter = first; iter != last; ++iter)
 			{
-				pos = insert(pos, *iter);
-				++pos;
+				*internal_insert_gap(i, 1) = *iter;
+				++i;
 			}
 			return begin() + index;
 		}
@@ -650,36 +620,35 @@ namespace Luna
 		}
 		void erase(usize index = 0, usize count = npos)
 		{
-			count = count == npos ? m_size - index : count;
-			luassert(index + count <= m_size);
-			if ((index + count) != m_size)
+			usize sz = get_size();
+			count = count == npos ? sz - index : count;
+			luassert(index + count <= sz);
+			value_type* p = get_pointer();
+			if ((index + count) != sz)
 			{
-				memmove(m_buffer + index, m_buffer + index + count, sizeof(value_type) * (m_size - index - count));
+				memmove(p + index, p + index + count, sizeof(value_type) * (sz - index - count));
 			}
-			m_size -= count;
-			m_buffer[m_size] = (value_type)0;
+			set_size(sz - count);
 		}
 		iterator erase(const_iterator pos)
 		{
-			luassert(((usize)pos >= (usize)m_buffer) && ((usize)pos < (usize)(m_buffer + m_size)));
+			luassert((pos >= cbegin()) && (pos < cend()));
 			if (pos != (end() - 1))
 			{
 				move_relocate_range((value_type*)pos + 1, (value_type*)end(), (value_type*)pos);
 			}
-			--m_size;
-			m_buffer[m_size] = (value_type)0;
+			set_size(get_size() - 1);
 			return const_cast<iterator>(pos);
 		}
 		iterator erase(const_iterator first, const_iterator last)
 		{
-			luassert(((usize)first >= (usize)m_buffer) && ((usize)first < (usize)(m_buffer + m_size)));
-			luassert(((usize)last >= (usize)m_buffer) && ((usize)last <= (usize)(m_buffer + m_size)));
+			luassert((first >= cbegin()) && (first < cend()));
+			luassert((last >= cbegin()) && (last <= cend()));
 			if (last != end())
 			{
 				move_relocate_range((value_type*)last, (value_type*)end(), (value_type*)first);
 			}
-			m_size -= (last - first);
-			m_buffer[m_size] = (value_type)0;
+			set_size(get_size() - (last - first));
 			return const_cast<iterator>(first);
 		}
 
@@ -694,53 +663,41 @@ namespace Luna
 		{
 			if (count)
 			{
-				internal_expand_reserve(m_size + count);
-				fill_construct_range(m_buffer + m_size, m_buffer + m_size + count, ch);
-				m_size += count;
-				m_buffer[m_size] = (value_type)0;
+				value_type* dest = internal_insert_gap(get_size(), count);
+				fill_construct_range(dest, dest + count, ch);
 			}
 		}
 		void append(const BasicString& str)
 		{
-			if (!str.empty())
-			{
-				internal_expand_reserve(m_size + str.size());
-				memcpy(m_buffer + m_size, str.c_str(), str.size() * sizeof(value_type));
-				m_size += str.size();
-				m_buffer[m_size] = (value_type)0;
-			}
+			append(str.c_str(), str.size());
 		}
 		void append(const BasicString& str, usize pos, usize count = npos)
 		{
 			count = count == npos ? str.size() : count;
-			if (count)
-			{
-				internal_expand_reserve(m_size + count);
-				memcpy(m_buffer + m_size, str.c_str() + pos, count * sizeof(value_type));
-				m_size += count;
-				m_buffer[m_size] = (value_type)0;
-			}
+			append(str.c_str() + pos, count);
 		}
 		void append(const value_type* s, usize count)
 		{
 			if (count)
 			{
-				internal_expand_reserve(m_size + count);
-				memcpy(m_buffer + m_size, s, count * sizeof(value_type));
-				m_size += count;
-				m_buffer[m_size] = (value_type)0;
+				// `s` may point into this string, which is invalidated if the buffer is reallocated.
+				const value_type* p = get_pointer();
+				usize sz = get_size();
+				if (s >= p && s < p + sz)
+				{
+					usize offset = s - p;
+					value_type* dest = internal_insert_gap(sz, count);
+					memcpy(dest, get_pointer() + offset, count * sizeof(value_type));
+				}
+				else
+				{
+					memcpy(internal_insert_gap(sz, count), s, count * sizeof(value_type));
+				}
 			}
 		}
 		void append(const value_type* s)
 		{
-			usize count = strlength(s);
-			if (count)
-			{
-				internal_expand_reserve(m_size + count);
-				memcpy(m_buffer + m_size, s, count * sizeof(value_type));
-				m_size += count;
-				m_buffer[m_size] = (value_type)0;
-			}
+			append(s, strlength(s));
 		}
 		template <typename _InputIt>
 		void append(_InputIt first, _InputIt last)
@@ -806,126 +763,218 @@ namespace Luna
 			return memcmp(c_str() + pos1, s, min(count1, count2) * sizeof(value_type));
 		}
 
-		void replace(usize pos, usize count, const BasicString& str)
+	private:
+		// Replaces `count` characters at `pos` with a gap of `count2` characters and returns the pointer to the gap.
+		value_type* internal_replace_gap(usize pos, usize count, usize count2)
 		{
-			isize delta = str.size() - count;
-			if (delta > 0)
+			usize sz = get_size();
+			luassert(pos + count <= sz);
+			if (count2 > count)
 			{
-				internal_expand_reserve(m_size + delta);
+				internal_expand_reserve(sz + count2 - count);
 			}
-			memmove(m_buffer + pos + str.size(), m_buffer + pos + count, sizeof(value_type) * (m_size - pos - count));
-			memcpy(m_buffer + pos, str.c_str(), sizeof(value_type) * str.size());
-			m_size += delta;
-			m_buffer[m_size] = (value_type)0;
+			value_type* p = get_pointer();
+			memmove(p + pos + count2, p + pos + count, sizeof(value_type) * (sz - pos - count));
+			set_size(sz + count2 - count);
+			return p + pos;
+		}
+	public:
+		void replace(usize pos, usize count, const BasicString& str)
+		{
+			memcpy(internal_replace_gap(pos, count, str.size()), str.c_str(), sizeof(value_type) * str.size());
 		}
 		void replace(const_iterator first, const_iterator last, const BasicString& str)
 		{
-			usize pos = first - m_buffer;
-			usize count = last - first;
-			replace(pos, count, str);
+			replace(first - cbegin(), last - first, str);
 		}
 		void replace(usize pos, usize count, const BasicString& str, usize pos2, usize count2 = npos)
 		{
-			count2 = (pos2 + count2 > str.size()) ? str.size() - pos2 : count2;
-			isize delta = count2 - count;
-			if (delta > 0)
-			{
-				internal_expand_reserve(m_size + delta);
-			}
-			memmove(m_buffer + pos + count2, m_buffer + pos + count, sizeof(value_type) * (m_size - pos - count));
-			memcpy(m_buffer + pos, str.c_str() + pos2, sizeof(value_type)* count2);
-			m_size += delta;
-			m_buffer[m_size] = (value_type)0;
+			count2 = (count2 == npos || pos2 + count2 > str.size()) ? str.size() - pos2 : count2;
+			memcpy(internal_replace_gap(pos, count, count2), str.c_str() + pos2, sizeof(value_type) * count2);
 		}
 		template <typename _InputIt>
 		void replace(const_iterator first, const_iterator last, _InputIt first2, _InputIt last2)
 		{
-			usize pos = first - m_buffer;
+			usize pos = first - cbegin();
 			erase(first, last);
 			insert(begin() + pos, first2, last2);
 		}
 		void replace(usize pos, usize count, const value_type* cstr, usize count2)
 		{
-			isize delta = count2 - count;
-			if (delta > 0)
-			{
-				internal_expand_reserve(m_size + delta);
-			}
-			memmove(m_buffer + pos + count2, m_buffer + pos + count, sizeof(value_type) * (m_size - pos - count));
-			memcpy(m_buffer + pos, cstr, sizeof(value_type) * count2);
-			m_size += delta;
-			m_buffer[m_size] = (value_type)0;
+			memcpy(internal_replace_gap(pos, count, count2), cstr, sizeof(value_type) * count2);
 		}
 		void replace(const_iterator first, const_iterator last, const value_type* cstr, usize count2)
 		{
-			usize pos = first - m_buffer;
-			usize count = last - first;
-			replace(pos, count, cstr, count2);
+			replace(first - cbegin(), last - first, cstr, count2);
 		}
 		void replace(usize pos, usize count, const value_type* cstr)
 		{
-			usize count2 = strlength(cstr);
-			replace(pos, count, cstr, count2);
+			replace(pos, count, cstr, strlength(cstr));
 		}
 		void replace(const_iterator first, const_iterator last, const value_type* cstr)
 		{
-			usize pos = first - m_buffer;
-			usize count = last - first;
-			replace(pos, count, cstr);
+			replace(first - cbegin(), last - first, cstr);
 		}
 		void replace(usize pos, usize count, usize count2, value_type ch)
 		{
-			isize delta = count2 - count;
-			if (delta > 0)
-			{
-				internal_expand_reserve(m_size + delta);
-			}
-			memmove(m_buffer + pos + count2, m_buffer + pos + count, sizeof(value_type) * (m_size - pos - count));
-			fill_construct_range(m_buffer + pos, m_buffer + pos + count2, ch);
-			m_size += delta;
-			m_buffer[m_size] = (value_type)0;
+			value_type* dest = internal_replace_gap(pos, count, count2);
+			fill_construct_range(dest, dest + count2, ch);
 		}
 		void replace(const_iterator first, const_iterator last, usize count2, value_type ch)
 		{
-			usize pos = first - m_buffer;
-			usize count = last - first;
-			replace(pos, count, count2, ch);
+			replace(first - cbegin(), last - first, count2, ch);
 		}
 		void replace(const_iterator first, const_iterator last, InitializerList<value_type> ilist)
 		{
-			usize pos = first - m_buffer;
-			usize count = last - first;
-			isize delta = ilist.size() - count;
-			if (delta > 0)
-			{
-				internal_expand_reserve(m_size + delta);
-			}
-			memmove(m_buffer + pos + ilist.size(), m_buffer + pos + count, sizeof(value_type) * (m_size - pos - count));
-			auto iter = const_cast<iterator>(first);
+			value_type* dest = internal_replace_gap(first - cbegin(), last - first, ilist.size());
 			for (auto& i : ilist)
 			{
-				*iter = i;
-				++iter;
+				*dest = i;
+				++dest;
 			}
-			m_size += delta;
-			m_buffer[m_size] = (value_type)0;
 		}
 		BasicString substr(usize pos = 0, usize count = npos) const
 		{
-			luassert(pos <= m_size);
-			count = min(count, m_size - pos);
-			return BasicString(m_buffer + pos, count, m_alloc);
+			usize sz = get_size();
+			luassert(pos <= sz);
+			count = min(count, sz - pos);
+			return BasicString(get_pointer() + pos, count, get_allocator());
 		}
 		usize copy(value_type* dest, usize count, usize pos = 0) const
 		{
-			luassert(pos <= m_size);
-			count = min(count, m_size - pos);
-			memcpy(dest, m_buffer + pos, sizeof(value_type) * count);
+			usize sz = get_size();
+			luassert(pos <= sz);
+			count = min(count, sz - pos);
+			memcpy(dest, get_pointer() + pos, sizeof(value_type) * count);
 			return count;
 		}
 	};
 
+	//! Two strings are equal if they have the same length and the same characters. The length is compared first,
+	//! so strings with different lengths are rejected without touching the string buffers.
+	template <typename _Char, typename _Alloc>
+	inline bool operator==(const BasicString<_Char, _Alloc>& lhs, const BasicString<_Char, _Alloc>& rhs)
+	{
+		usize sz = lhs.size();
+		return (sz == rhs.size()) && !memcmp(lhs.data(), rhs.data(), sz * sizeof(_Char));
+	}
+	template <typename _Char, typename _Alloc>
+	inline bool operator!=(const BasicString<_Char, _Alloc>& lhs, const BasicString<_Char, _Alloc>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+	template <typename _Char, typename _Alloc>
+	inline bool operator==(const BasicString<_Char, _Alloc>& lhs, const _Char* rhs)
+	{
+		const _Char* s = lhs.c_str();
+		const _Char* e = s + lhs.size();
+		while (s != e)
+		{
+			if (*s != *rhs) return false;
+			++s;
+			++rhs;
+		}
+		return *rhs == (_Char)0;
+	}
+	template <typename _Char, typename _Alloc>
+	inline bool operator!=(const BasicString<_Char, _Alloc>& lhs, const _Char* rhs)
+	{
+		return !(lhs == rhs);
+	}
+	template <typename _Char, typename _Alloc>
+	inline bool operator<(const BasicString<_Char, _Alloc>& lhs, const BasicString<_Char, _Alloc>& rhs)
+	{
+		usize lsz = lhs.size();
+		usize rsz = rhs.size();
+		const _Char* l = lhs.data();
+		const _Char* r = rhs.data();
+		usize sz = min(lsz, rsz);
+		for (usize i = 0; i < sz; ++i)
+		{
+			if (l[i] != r[i]) return l[i] < r[i];
+		}
+		return lsz < rsz;
+	}
+
 	using String = BasicString<c8>;
 	using String16 = BasicString<c16>;
 	using String32 = BasicString<c32>;
-}
\ No newline at end of file
+
+	template <typename _Char, typename _Alloc> struct hash<BasicString<_Char, _Alloc>>
+	{
+		usize operator()(const BasicString<_Char, _Alloc>& str) const
+		{
+			return (usize)wyhash(str.data(), sizeof(_Char) * str.size());
+		}
+	};
+
+	//! An immutable string that computes its hash code once when it is created.
+	//! @remark Use this as the key type of hash maps and sets whose keys are looked up or rehashed frequently, so that the
+	//! hash code is not computed again on every lookup. Two hashed strings are compared by their hash codes first, so
+	//! different strings are usually rejected without comparing the characters.
+	template <typename _Char, typename _Alloc = Allocator>
+	class BasicHashedString
+	{
+	public:
+		using string_type = BasicString<_Char, _Alloc>;
+		using value_type = _Char;
+
+		BasicHashedString() :
+			m_hash(hash<string_type>()(m_str)) {}
+		BasicHashedString(const value_type* s) :
+			m_str(s),
+			m_hash(hash<string_type>()(m_str)) {}
+		BasicHashedString(const value_type* s, usize count) :
+			m_str(s, count),
+			m_hash(hash<string_type>()(m_str)) {}
+		BasicHashedString(const string_type& str) :
+			m_str(str),
+			m_hash(hash<string_type>()(m_str)) {}
+		BasicHashedString(string_type&& str) :
+			m_str(move(str)),
+			m_hash(hash<string_type>()(m_str)) {}
+
+		const string_type& str() const
+		{
+			return m_str;
+		}
+		const value_type* c_str() const
+		{
+			return m_str.c_str();
+		}
+		usize size() const
+		{
+			return m_str.size();
+		}
+		bool empty() const
+		{
+			return m_str.empty();
+		}
+		//! Returns the hash code of the string, which is the same as `hash<BasicString<_Char, _Alloc>>` of the string.
+		usize hash_code() const
+		{
+			return m_hash;
+		}
+		bool operator==(const BasicHashedString& rhs) const
+		{
+			return (m_hash == rhs.m_hash) && (m_str == rhs.m_str);
+		}
+		bool operator!=(const BasicHashedString& rhs) const
+		{
+			return !(*this == rhs);
+		}
+	private:
+		string_type m_str;
+		usize m_hash;
+	};
+
+	using HashedString = BasicHashedString<c8>;
+
+	template <typename _Char, typename _Alloc> struct hash<BasicHashedString<_Char, _Alloc>>
+	{
+		usize operator()(const BasicHashedString<_Char, _Alloc>& str) const
+		{
+			return str.hash_code();
+		}
+	};
+}
@@ -0,0 +1,334 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file Sync.hpp
+* @author JXMaster
+* @date 2021/6/19
+* @brief Lightweight synchronization primitives that can be embedded into other objects.
+*/
+#pragma once
+#include "Atomic.hpp"
+#include "Algorithm.hpp"
+#include "Assert.hpp"
+#include "Platform.hpp"
+#include "Thread.hpp"
+
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#ifdef LUNA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+#endif
+
+namespace Luna
+{
+	//! Hints the processor that the current thread is spinning, so that the processor can reduce power consumption
+	//! and give execution resources to the other hardware thread of the same core.
+	inline void spin_pause()
+	{
+#if defined(LUNA_PLATFORM_X86) || defined(LUNA_PLATFORM_X86_64)
+#ifdef LUNA_COMPILER_MSVC
+		_mm_pause();
+#else
+		__builtin_ia32_pause();
+#endif
+#elif defined(LUNA_PLATFORM_ARM64) && !defined(LUNA_COMPILER_MSVC)
+		asm volatile("yield");
+#endif
+	}
+
+	//! The maximum number of times that one thread spins before parking itself when waiting for one synchronization
+	//! primitive.
+	constexpr u32 sync_max_spin_count = 100;
+
+	//! @class SpinLock
+	//! One lock that never suspends the waiting thread. The waiting thread spins for a short time, then yields its
+	//! time slice until the lock is released.
+	//! @remark Use this only for very short critical sections that never block, or the lock wastes processor time.
+	//! The lock is not recursive.
+	class SpinLock
+	{
+		volatile u32 m_locked;
+	public:
+		SpinLock() :
+			m_locked(0) {}
+		SpinLock(const SpinLock&) = delete;
+		SpinLock& operator=(const SpinLock&) = delete;
+
+		bool try_lock()
+		{
+			// Reads the value first so that the cache line is not written when the lock is held.
+			return !m_locked && !atom_exchange_u32(&m_locked, 1);
+		}
+		void lock()
+		{
+			u32 spins = 0;
+			while (!try_lock())
+			{
+				while (m_locked)
+				{
+					if (spins < sync_max_spin_count)
+					{
+						spin_pause();
+						++spins;
+					}
+					else
+					{
+						yield_current_thread();
+					}
+				}
+			}
+		}
+		void unlock()
+		{
+			atom_exchange_u32(&m_locked, 0);
+		}
+	};
+
+	//! @class FutexMutex
+	//! One non-recursive mutex that takes only 8 bytes and needs no system call when the mutex is not contended.
+	//!
+	//! The waiting thread spins for a short time before it is parked by `Platform::futex_wait`. The spin count adapts
+	//! to the time that the mutex is usually held: if the mutex is usually acquired by spinning, the thread spins longer,
+	//! otherwise the thread gives up spinning earlier.
+	class FutexMutex
+	{
+		//! 0 if the mutex is not locked, 1 if the mutex is locked and no thread is parked, 2 if the mutex is locked
+		//! and there may be threads parked.
+		volatile u32 m_state;
+		//! The average number of spins needed to acquire the mutex.
+		u32 m_spins;
+	public:
+		FutexMutex() :
+			m_state(0),
+			m_spins(0) {}
+		FutexMutex(const FutexMutex&) = delete;
+		FutexMutex& operator=(const FutexMutex&) = delete;
+
+		bool try_lock()
+		{
+			return !m_state && !atom_compare_exchange_u32(&m_state, 1, 0);
+		}
+		void lock()
+		{
+			if (!atom_compare_exchange_u32(&m_state, 1, 0))
+			{
+				return;
+			}
+			u32 max_spins = min(m_spins * 2 + 10, sync_max_spin_count);
+			for (u32 i = 0; i < max_spins; ++i)
+			{
+				spin_pause();
+				if (try_lock())
+				{
+					m_spins += ((i32)i - (i32)m_spins) / 8;
+					return;
+				}
+			}
+			m_spins += ((i32)max_spins - (i32)m_spins) / 8;
+			// Marks the mutex as contended, so that the owner wakes one parked thread when the mutex is unlocked.
+			while (atom_exchange_u32(&m_state, 2))
+			{
+				Platform::futex_wait(&m_state, 2);
+			}
+		}
+		void unlock()
+		{
+			if (atom_exchange_u32(&m_state, 0) == 2)
+			{
+				Platform::futex_wake(&m_state, 1);
+			}
+		}
+	};
+
+	//! @class FutexRecursiveMutex
+	//! One `FutexMutex` that can be locked recursively by the thread that owns the mutex.
+	class FutexRecursiveMutex
+	{
+		FutexMutex m_mtx;
+		volatile u32 m_owner;
+		u32 m_recursion;
+	public:
+		FutexRecursiveMutex() :
+			m_owner(0),
+			m_recursion(0) {}
+
+		bool try_lock()
+		{
+			u32 id = get_current_thread_id();
+			if (m_owner == id)
+			{
+				++m_recursion;
+				return true;
+			}
+			if (!m_mtx.try_lock())
+			{
+				return false;
+			}
+			m_owner = id;
+			m_recursion = 1;
+			return true;
+		}
+		void lock()
+		{
+			u32 id = get_current_thread_id();
+			// `m_owner` equals to `id` only if it is set by this thread, so this is safe without locking.
+			if (m_owner == id)
+			{
+				++m_recursion;
+				return;
+			}
+			m_mtx.lock();
+			m_owner = id;
+			m_recursion = 1;
+		}
+		void unlock()
+		{
+			if (!--m_recursion)
+			{
+				m_owner = 0;
+				m_mtx.unlock();
+			}
+		}
+	};
+
+	//! @class FutexEvent
+	//! One event that can be waited by multiple threads.
+	//!
+	//! When one event with manual reset is triggered, all waiting threads are resumed, and the event keeps triggered
+	//! until `reset` is called. When one event with automatic reset is triggered, only one waiting thread is resumed
+	//! and the event is reset to non-triggered state by that thread.
+	class FutexEvent
+	{
+		//! 1 if the event is triggered, 0 otherwise.
+		volatile u32 m_state;
+		//! The number of parked threads, so that `trigger` can skip the system call if no thread is parked.
+		volatile u32 m_waiters;
+		bool m_manual_reset;
+	public:
+		FutexEvent(bool manual_reset = false, bool initially_triggered = false) :
+			m_state(initially_triggered ? 1 : 0),
+			m_waiters(0),
+			m_manual_reset(manual_reset) {}
+		FutexEvent(const FutexEvent&) = delete;
+		FutexEvent& operator=(const FutexEvent&) = delete;
+
+		bool manual_reset() const
+		{
+			return m_manual_reset;
+		}
+		//! Checks whether the event is triggered, and resets the event if the event uses automatic reset.
+		bool try_wait()
+		{
+			if (m_manual_reset)
+			{
+				return m_state != 0;
+			}
+			return m_state && atom_compare_exchange_u32(&m_state, 0, 1) == 1;
+		}
+		void wait()
+		{
+			for (u32 i = 0; i < sync_max_spin_count; ++i)
+			{
+				if (try_wait())
+				{
+					return;
+				}
+				spin_pause();
+			}
+			while (!try_wait())
+			{
+				atom_inc_u32(&m_waiters);
+				Platform::futex_wait(&m_state, 0);
+				atom_dec_u32(&m_waiters);
+			}
+		}
+		void trigger()
+		{
+			atom_exchange_u32(&m_state, 1);
+			if (m_waiters)
+			{
+				Platform::futex_wake(&m_state, m_manual_reset ? u32_max : 1);
+			}
+		}
+		void reset()
+		{
+			atom_exchange_u32(&m_state, 0);
+		}
+	};
+
+	//! @class FutexSemaphore
+	//! One counting semaphore.
+	class FutexSemaphore
+	{
+		volatile u32 m_count;
+		volatile u32 m_waiters;
+		u32 m_max_count;
+	public:
+		FutexSemaphore(u32 initial_count, u32 max_count = u32_max) :
+			m_count(initial_count),
+			m_waiters(0),
+			m_max_count(max_count)
+		{
+			luassert(initial_count <= max_count);
+		}
+		FutexSemaphore(const FutexSemaphore&) = delete;
+		FutexSemaphore& operator=(const FutexSemaphore&) = delete;
+
+		u32 count() const
+		{
+			return m_count;
+		}
+		//! Decreases the count by one if the count is not 0.
+		//! @return Returns `true` if the count is decreased, `false` otherwise.
+		bool try_acquire()
+		{
+			u32 count = m_count;
+			while (count)
+			{
+				u32 prev = atom_compare_exchange_u32(&m_count, count - 1, count);
+				if (prev == count)
+				{
+					return true;
+				}
+				count = prev;
+			}
+			return false;
+		}
+		//! Decreases the count by one, and waits if the count is 0.
+		void acquire()
+		{
+			for (u32 i = 0; i < sync_max_spin_count; ++i)
+			{
+				if (try_acquire())
+				{
+					return;
+				}
+				spin_pause();
+			}
+			while (!try_acquire())
+			{
+				atom_inc_u32(&m_waiters);
+				Platform::futex_wait(&m_count, 0);
+				atom_dec_u32(&m_waiters);
+			}
+		}
+		//! Increases the count and resumes waiting threads. The count never exceeds the maximum count.
+		void release(u32 release_count = 1)
+		{
+			u32 count = m_count;
+			while (true)
+			{
+				u32 new_count = count + min(release_count, m_max_count - count);
+				u32 prev = atom_compare_exchange_u32(&m_count, new_count, count);
+				if (prev == count)
+				{
+					break;
+				}
+				count = prev;
+			}
+			if (m_waiters)
+			{
+				Platform::futex_wake(&m_count, release_count);
+			}
+		}
+	};
+}
@@ -131,6 +131,35 @@ namespace Luna
 	//! Returns the Unicode character in the UTF-8 string `str`.
 	LUNA_RUNTIME_API c32 utf8_decode_char(const c8* str);
 
+	//! Returns the number of leading ASCII characters (U+0000~U+007F) in the specified UTF-8 string.
+	//! @param[in] src The string to check.
+	//! @param[in] src_chars The number of `c8` characters to check. Null characters are treated as ASCII characters and
+	//! do not stop the scan.
+	//! @return Returns the index of the first non-ASCII character, or `src_chars` if all characters are ASCII characters.
+	LUNA_RUNTIME_API usize utf8_ascii_len(const c8* src, usize src_chars);
+
+	//! Checks whether the specified string is well-formed UTF-8 string defined by RFC 3629.
+	//! @param[in] src The string to check.
+	//! @param[in] src_chars The number of `c8` characters to check. Null characters are treated as ASCII characters and
+	//! do not stop the check.
+	//! @return Returns `true` if the string is well-formed. Returns `false` if the string contains truncated
+	//! sequences, overlong encodings, surrogate code points, or code points beyond U+10FFFF.
+	LUNA_RUNTIME_API bool utf8_validate(const c8* src, usize src_chars);
+
+	//! Decodes Unicode characters in one UTF-8 string in bulk.
+	//! @param[in] dest The buffer to hold decoded characters. No null-terminator is written.
+	//! @param[in] dest_max_chars The maximum characters the `dest` buffer can hold.
+	//! @param[in] src The string to decode.
+	//! @param[in] src_chars The number of `c8` characters to decode. Null characters are decoded as `0` and do not stop
+	//! the decoding.
+	//! @param[out] src_read If not `nullptr`, receives the number of `c8` characters consumed. This will be less than 
+	//! `src_chars` if the `dest` buffer is full, or if the string ends with one truncated character, in which case the 
+	//! caller may append more data to the truncated character and decode it again.
+	//! @return Returns the number of characters written to `dest`.
+	//! @remark This is equal to calling `utf8_decode_char` and `utf8_charlen` for every character, but ASCII characters are
+	//! decoded in blocks using SIMD instructions if available.
+	LUNA_RUNTIME_API usize utf8_decode_span(c32* dest, usize dest_max_chars, const c8* src, usize src_chars, usize* src_read = nullptr);
+
 	//! Returns the number of `Char16` characters needed to store the Unicode char `ch` in UTF-16 encoding.
 	inline constexpr usize utf16_charspan(c32 ch)
 	{
@@ -220,4 +249,30 @@ namespace Luna
 	//! @return Returns length of the `src` string in utf-16 format, not including the null-terminator. 
 	//! Returns (usize)-1 if the `src` string is not in utf-8 format.
 	LUNA_RUNTIME_API usize utf8_to_utf16_len(const c8* src, usize src_chars = usize_max);
+
+	//! Convert a utf-8 string to utf-32 string in destination buffer.
+	//! @param[in] dest The buffer to hold the output string.
+	//! @param[in] dest_max_chars The maximum characters the `dest` buffer can hold, 
+	//! including the null-terminator.
+	//! @param[in] src The null-terminated buffer holding the source string.
+	//! @param[in] src_chars The maximum characters to read. Specify `USize_max_v` to read till the end of the 
+	//! string.
+	//! @return Returns the number of characters outputted to the `dest` buffer, 
+	//! not including the null-terminator.
+	LUNA_RUNTIME_API usize utf8_to_utf32(c32* dest, usize dest_max_chars, const c8* src, usize src_chars = usize_max);
+
+	//! Convert a utf-32 string to utf-8 string in destination buffer.
+	//! @param[in] dest The buffer to hold the output string.
+	//! @param[in] dest_max_chars The maximum characters the `dest` buffer can hold, 
+	//! including the null-terminator.
+	//! @param[in] src The null-terminated buffer holding the source string.
+	//! @param[in] src_chars The maximum characters to read. Specify `USize_max_v` to read till the end of the 
+	//! string.
+	//! @return Returns the number of characters outputted to the `dest` buffer, 
+	//! not including the null-terminator.
+	LUNA_RUNTIME_API usize utf32_to_utf8(c8* dest, usize dest_max_chars, const c32* src, usize src_chars = usize_max);
+
+	//! Determines the length of the corresponding utf-8 string for a utf-32 input string,
+	//! not include the null-terminator.
+	LUNA_RUNTIME_API usize utf32_to_utf8_len(const c32* src, usize src_chars = usize_max);
 }
@@ -9,13 +9,15 @@
 #include "Algorithm.hpp"
 #include "Iterator.hpp"
 #include "Assert.hpp"
+#include "Allocator.hpp"
 
 namespace Luna
 {			
 	//! @class Vector
 	//! Vector represents a value type that stores a continuous array of elements.
-	template <typename _Ty>
-	class Vector
+	//! @remark The allocator is stored as the base class of the vector, so the default allocator does not increase the size of the vector.
+	template <typename _Ty, typename _Alloc = Allocator>
+	class Vector : private _Alloc
 	{
 	private:
 		// -------------------- Begin of ABI compatible part --------------------
@@ -30,7 +32,7 @@ namespace Luna
 			destruct_range(begin(), end());
 			if (m_buffer)
 			{
-				memfree(m_buffer, alignof(_Ty));
+				_Alloc::deallocate(m_buffer, sizeof(_Ty) * m_capacity, alignof(_Ty));
 				m_buffer = nullptr;
 			}
 			m_size = 0;
@@ -40,6 +42,7 @@ namespace Luna
 	public:
 
 		using value_type = _Ty;
+		using allocator_type = _Alloc;
 		using reference = value_type&;
 		using const_reference = const value_type&;
 		using pointer = value_type*;
@@ -54,7 +57,13 @@ namespace Luna
 			m_buffer(nullptr),
 			m_size(0),
 			m_capacity(0) {}
-		Vector(usize count, const value_type& value) :
+		explicit Vector(const allocator_type& alloc) :
+			_Alloc(alloc),
+			m_buffer(nullptr),
+			m_size(0),
+			m_capacity(0) {}
+		Vector(usize count, const value_type& value, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
 			m_buffer(nullptr),
 			m_size(0),
 			m_capacity(0)
@@ -66,7 +75,8 @@ namespace Luna
 				m_size = count;
 			}
 		}
-		Vector(usize count) :
+		Vector(usize count, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
 			m_buffer(nullptr),
 			m_size(0),
 			m_capacity(0)
@@ -79,6 +89,7 @@ namespace Luna
 			}
 		}
 		Vector(const Vector& rhs) :
+			_Alloc(rhs.get_allocator()),
 			m_buffer(nullptr),
 			m_size(0),
 			m_capacity(0)
@@ -92,6 +103,7 @@ namespace Luna
 			}
 		}
 		Vector(Vector&& rhs) :
+			_Alloc(rhs.get_allocator()),
 			m_buffer(rhs.m_buffer),
 			m_size(rhs.m_size),
 			m_capacity(rhs.m_capacity)
@@ -100,7 +112,8 @@ namespace Luna
 			rhs.m_size = 0;
 			rhs.m_capacity = 0;
 		}
-		Vector(InitializerList<value_type> init) :
+		Vector(InitializerList<value_type> init, const allocator_type& alloc = allocator_type()) :
+			_Alloc(alloc),
 			m_buffer(nullptr),
 			m_size(0),
 			m_capacity(0)
@@ -124,6 +137,7 @@ namespace Luna
 		Vector& operator=(Vector&& rhs)
 		{
 			free_buffer();
+			Luna::swap(static_cast<_Alloc&>(*this), static_cast<_Alloc&>(rhs));
 			Luna::swap(m_buffer, rhs.m_buffer);
 			Luna::swap(m_size, rhs.m_size);
 			Luna::swap(m_capacity, rhs.m_capacity);
@@ -141,6 +155,10 @@ namespace Luna
 		{
 			free_buffer();
 		}
+		allocator_type get_allocator() const
+		{
+			return *static_cast<const _Alloc*>(this);
+		}
 		// Returns a pointer to the first element. Can only be `nullptr` if `size` and `capacity` is both 0.
 		iterator begin()
 		{
@@ -207,11 +225,11 @@ namespace Luna
 		{
 			if (new_cap > m_capacity)
 			{
-				value_type* new_buf = (value_type*)memalloc(new_cap * sizeof(_Ty), alignof(_Ty));
+				value_type* new_buf = (value_type*)_Alloc::allocate(new_cap * sizeof(_Ty), alignof(_Ty));
 				if (m_buffer)
 				{
 					copy_relocate_range(begin(), end(), new_buf);
-					memfree(m_buffer, alignof(_Ty));
+					_Alloc::deallocate(m_buffer, m_capacity * sizeof(_Ty), alignof(_Ty));
 				}
 				m_buffer = new_buf;
 				m_capacity = new_cap;
@@ -254,6 +272,34 @@ namespace Luna
 			}
 			m_size = n;
 		}
+		//! Resizes the vector without value-initializing the new elements. New elements are default-initialized, so elements of
+		//! trivial types (like integers and vertices) are left uninitialized and should be overwritten by the user.
+		void resize_for_overwrite(usize n)
+		{
+			reserve(n);
+			if (n > m_size)
+			{
+				for (value_type* i = m_buffer + m_size; i < m_buffer + n; ++i)
+				{
+					new ((void*)i) value_type;
+				}
+			}
+			else if (n < m_size)
+			{
+				destruct_range(m_buffer + n, m_buffer + m_size);
+			}
+			m_size = n;
+		}
+		//! Appends `count` uninitialized elements to the end of the vector, and returns the iterator to the first appended element.
+		//! @remark The capacity is checked only once for all appended elements. The user must construct every appended element
+		//! (by placement new or by assigning elements of trivial types) before the vector is used again.
+		iterator append_uninitialized(usize count)
+		{
+			internal_expand_reserve(m_size + count);
+			iterator r = m_buffer + m_size;
+			m_size += count;
+			return r;
+		}
 		void shrink_to_fit()
 		{
 			if (m_capacity != m_size)
@@ -264,11 +310,11 @@ namespace Luna
 				}
 				else
 				{
-					value_type* new_buf = (value_type*)memalloc(m_size * sizeof(value_type), alignof(value_type));
+					value_type* new_buf = (value_type*)_Alloc::allocate(m_size * sizeof(value_type), alignof(value_type));
 					if (m_buffer)
 					{
 						copy_relocate_range(m_buffer, m_buffer + m_size, new_buf);
-						memfree(m_buffer, alignof(value_type));
+						_Alloc::deallocate(m_buffer, m_capacity * sizeof(value_type), alignof(value_type));
 					}
 					m_buffer = new_buf;
 					m_capacity = m_size;
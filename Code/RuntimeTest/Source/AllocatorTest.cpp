@@ -0,0 +1,168 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file AllocatorTest.cpp
+* @author JXMaster
+* @date 2021/6/10
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Allocator.hpp>
+#include <Runtime/Vector.hpp>
+#include <Runtime/String.hpp>
+#include <Runtime/HashMap.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	void allocator_test()
+	{
+		// Allocators without data members do not increase the container size.
+		static_assert(sizeof(Vector<usize>) == sizeof(usize) * 3, "Incorrect Vector size.");
+
+		{
+			// Containers that allocate from one linear arena.
+			LinearArena arena(256);
+			ArenaAllocator<LinearArena> alloc(arena);
+			usize mem = get_allocated_memory();
+
+			Vector<i32, ArenaAllocator<LinearArena>> v(alloc);
+			for (i32 i = 0; i < 1000; ++i)
+			{
+				v.push_back(i);
+			}
+			for (i32 i = 0; i < 1000; ++i)
+			{
+				lutest(v[i] == i);
+			}
+			Vector<i32, ArenaAllocator<LinearArena>> v2(v);
+			lutest(v2.size() == 1000);
+			lutest(v2.get_allocator() == alloc);
+			Vector<i32, ArenaAllocator<LinearArena>> v3(move(v2));
+			lutest(v3.size() == 1000);
+			lutest(v3[999] == 999);
+
+			BasicString<c8, ArenaAllocator<LinearArena>> s(alloc);
+			s.append("Hello, World!");
+			auto sub = s.substr(7, 5);
+			lutest(!strcmp(sub.c_str(), "World"));
+			lutest(sub.get_allocator() == alloc);
+
+			HashMap<i32, i32, hash<i32>, equal_to<i32>, ArenaAllocator<LinearArena>> m(alloc);
+			for (i32 i = 0; i < 500; ++i)
+			{
+				m.insert(make_pair(i, i * 2));
+			}
+			for (i32 i = 0; i < 500; i += 2)
+			{
+				m.erase(i);
+			}
+			lutest(m.size() == 250);
+			for (i32 i = 1; i < 500; i += 2)
+			{
+				auto iter = m.find(i);
+				lutest(iter != m.end() && iter->second == i * 2);
+			}
+
+			void* p = arena.allocate(10, 64);
+			lutest(((usize)p % 64) == 0);
+			lutest(arena.get_allocated_size() > 0);
+			// Memory allocated from the arena is not returned to the heap until the arena is reset.
+			lutest(get_allocated_memory() > mem);
+			arena.reset();
+			lutest(arena.get_allocated_size() == 0);
+		}
+
+		{
+			// Memory allocated from one frame is valid until the frame is recycled.
+			FrameArena<2> arena(1024);
+			u8* last_frame = nullptr;
+			for (u32 frame = 0; frame < 10; ++frame)
+			{
+				arena.new_frame();
+				lutest(arena.get_allocated_size() == 0);
+				if (last_frame)
+				{
+					for (u32 i = 0; i < 100; ++i)
+					{
+						lutest(last_frame[i] == (u8)(frame - 1));
+					}
+				}
+				u8* data = nullptr;
+				for (u32 i = 0; i < 100; ++i)
+				{
+					data = (u8*)arena.allocate(100);
+					memset(data, (u8)frame, 100);
+				}
+				last_frame = data;
+			}
+		}
+
+		{
+			// Objects allocated from one pool.
+			PoolAllocator<TestObject> pool(4);
+			TestObject* objs[100];
+			for (i32 i = 0; i < 100; ++i)
+			{
+				objs[i] = pool.new_object(i);
+			}
+			lutest(pool.get_num_allocated() == 100);
+			for (i32 i = 0; i < 100; ++i)
+			{
+				lutest(objs[i]->m_value == i);
+			}
+			for (i32 i = 0; i < 100; i += 2)
+			{
+				pool.delete_object(objs[i]);
+			}
+			for (i32 i = 0; i < 100; i += 2)
+			{
+				objs[i] = pool.new_object(-i);
+				lutest(objs[i]->m_value == -i);
+			}
+			for (i32 i = 0; i < 100; ++i)
+			{
+				pool.delete_object(objs[i]);
+			}
+			lutest(pool.get_num_allocated() == 0);
+		}
+		lutest(TestObject::is_clear());
+		TestObject::reset();
+
+		{
+			// Benchmark: builds many small temporary arrays per frame.
+			constexpr u32 num_frames = 100;
+			constexpr u32 num_arrays = 1000;
+			f64 freq = get_ticks_per_second();
+			u64 begin = get_ticks();
+			for (u32 frame = 0; frame < num_frames; ++frame)
+			{
+				for (u32 i = 0; i < num_arrays; ++i)
+				{
+					Vector<u32> v;
+					for (u32 j = 0; j < 32; ++j)
+					{
+						v.push_back(j);
+					}
+				}
+			}
+			u64 heap_ticks = get_ticks() - begin;
+			FrameArena<2> arena;
+			begin = get_ticks();
+			for (u32 frame = 0; frame < num_frames; ++frame)
+			{
+				arena.new_frame();
+				for (u32 i = 0; i < num_arrays; ++i)
+				{
+					Vector<u32, ArenaAllocator<FrameArena<2>>> v(arena);
+					for (u32 j = 0; j < 32; ++j)
+					{
+						v.push_back(j);
+					}
+				}
+			}
+			u64 arena_ticks = get_ticks() - begin;
+			debug_printf("[Allocator Benchmark]%u frames, %u arrays per frame: heap %.2f ms, frame arena %.2f ms\n",
+				num_frames, num_arrays, (f64)heap_ticks / freq * 1000.0, (f64)arena_ticks / freq * 1000.0);
+		}
+	}
+}
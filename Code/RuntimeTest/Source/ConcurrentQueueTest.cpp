@@ -0,0 +1,319 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file ConcurrentQueueTest.cpp
+* @author JXMaster
+* @date 2021/6/20
+*/
+#include "TestCommon.hpp"
+#include <Runtime/ConcurrentQueue.hpp>
+#include <Runtime/RingDeque.hpp>
+#include <Runtime/Platform.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <thread>
+
+namespace Luna
+{
+	//! The mutex+RingDeque pattern that the lock-free queues are compared with.
+	class LockedQueue
+	{
+		handle_t m_mtx;
+		RingDeque<u64> m_queue;
+	public:
+		LockedQueue()
+		{
+			m_mtx = Platform::new_mutex();
+		}
+		~LockedQueue()
+		{
+			Platform::delete_mutex(m_mtx);
+		}
+		bool push(u64 v)
+		{
+			Platform::lock_mutex(m_mtx);
+			m_queue.push_back(v);
+			Platform::unlock_mutex(m_mtx);
+			return true;
+		}
+		bool pop(u64& v)
+		{
+			Platform::lock_mutex(m_mtx);
+			bool r = !m_queue.empty();
+			if (r)
+			{
+				v = m_queue.front();
+				m_queue.pop_front();
+			}
+			Platform::unlock_mutex(m_mtx);
+			return r;
+		}
+	};
+
+	struct QueueTestNode : public MPSCQueueNode
+	{
+		u64 m_value;
+	};
+
+	//! Runs `num_producers` producer threads that push `num_items` values each, and `num_consumers` consumer threads that pop
+	//! all values. Checks that every value is popped exactly once.
+	//! @return Returns the elapsed ticks.
+	template <typename _Queue>
+	static u64 run_queue_throughput(_Queue& queue, u32 num_producers, u32 num_consumers, u64 num_items)
+	{
+		volatile u64 sum = 0;
+		volatile u64 popped = 0;
+		u64 total = num_items * num_producers;
+		u64 begin = get_ticks();
+		// The first `num_producers` threads are producers, the rest are consumers.
+		run_threads(num_producers + num_consumers, [&queue, &sum, &popped, num_producers, num_items, total](u32 t) {
+			if (t < num_producers)
+			{
+				for (u64 i = 0; i < num_items; ++i)
+				{
+					while (!queue.push(t * num_items + i + 1))
+					{
+						yield_current_thread();
+					}
+				}
+				return;
+			}
+			u64 local_sum = 0;
+			u64 local_popped = 0;
+			while (popped + local_popped < total)
+			{
+				u64 v;
+				if (queue.pop(v))
+				{
+					local_sum += v;
+					++local_popped;
+					// Publishes the progress in batches to reduce contention on the counter.
+					if (local_popped == 1024)
+					{
+						atom_add_u64(&sum, (i64)local_sum);
+						atom_add_u64(&popped, (i64)local_popped);
+						local_sum = 0;
+						local_popped = 0;
+					}
+				}
+				else
+				{
+					if (local_popped)
+					{
+						atom_add_u64(&sum, (i64)local_sum);
+						atom_add_u64(&popped, (i64)local_popped);
+						local_sum = 0;
+						local_popped = 0;
+					}
+					yield_current_thread();
+				}
+			}
+			atom_add_u64(&sum, (i64)local_sum);
+			atom_add_u64(&popped, (i64)local_popped);
+		});
+		u64 ticks = get_ticks() - begin;
+		lutest(popped == total);
+		lutest(sum == total * (total + 1) / 2);
+		return ticks;
+	}
+
+	//! Adapts `MPSCQueue` to the push/pop interface of other queues. Nodes are preallocated so that the benchmark does not
+	//! measure memory allocation.
+	class MPSCQueueAdapter
+	{
+		MPSCQueue<QueueTestNode> m_queue;
+		QueueTestNode* m_nodes;
+	public:
+		MPSCQueueAdapter(u64 num_nodes)
+		{
+			m_nodes = (QueueTestNode*)memalloc(sizeof(QueueTestNode) * num_nodes, alignof(QueueTestNode));
+		}
+		~MPSCQueueAdapter()
+		{
+			memfree(m_nodes, alignof(QueueTestNode));
+		}
+		bool push(u64 v)
+		{
+			// Values start from 1.
+			QueueTestNode* node = m_nodes + (v - 1);
+			node->m_value = v;
+			m_queue.push(node);
+			return true;
+		}
+		bool pop(u64& v)
+		{
+			QueueTestNode* node = m_queue.pop();
+			if (!node) return false;
+			v = node->m_value;
+			return true;
+		}
+	};
+
+	//! Measures the round-trip latency by passing one value back and forth between two threads.
+	//! @return Returns the average round-trip time in nanoseconds.
+	template <typename _Queue>
+	static f64 run_queue_latency(_Queue& ping, _Queue& pong, u64 num_round_trips)
+	{
+		std::thread t([&ping, &pong, num_round_trips]() {
+			for (u64 i = 0; i < num_round_trips; ++i)
+			{
+				u64 v;
+				while (!ping.pop(v)) {}
+				while (!pong.push(v + 1)) {}
+			}
+		});
+		u64 begin = get_ticks();
+		for (u64 i = 0; i < num_round_trips; ++i)
+		{
+			while (!ping.push(i)) {}
+			u64 v;
+			while (!pong.pop(v)) {}
+			lutest(v == i + 1);
+		}
+		u64 ticks = get_ticks() - begin;
+		t.join();
+		return (f64)ticks * 1000000000.0 / get_ticks_per_second() / num_round_trips;
+	}
+
+	static void concurrent_queue_benchmark()
+	{
+		constexpr u64 num_items = 500000;
+		f64 freq = get_ticks_per_second();
+		auto mops = [freq](u64 items, u64 ticks) { return (f64)items / ((f64)ticks / freq) / 1000000.0; };
+		{
+			LockedQueue locked;
+			u64 locked_ticks = run_queue_throughput(locked, 1, 1, num_items);
+			SPSCQueue<u64> spsc(1024);
+			u64 spsc_ticks = run_queue_throughput(spsc, 1, 1, num_items);
+			MPMCQueue<u64> mpmc(1024);
+			u64 mpmc_ticks = run_queue_throughput(mpmc, 1, 1, num_items);
+			debug_printf("[Queue Benchmark]1 producer, 1 consumer: mutex+RingDeque %.2f M/s, SPSCQueue %.2f M/s, MPMCQueue %.2f M/s\n",
+				mops(num_items, locked_ticks), mops(num_items, spsc_ticks), mops(num_items, mpmc_ticks));
+		}
+		{
+			constexpr u32 num_threads = 4;
+			LockedQueue locked;
+			u64 locked_ticks = run_queue_throughput(locked, num_threads, num_threads, num_items);
+			MPMCQueue<u64> mpmc(1024);
+			u64 mpmc_ticks = run_queue_throughput(mpmc, num_threads, num_threads, num_items);
+			LockedQueue locked2;
+			u64 locked_mpsc_ticks = run_queue_throughput(locked2, num_threads, 1, num_items);
+			MPSCQueueAdapter mpsc(num_items * num_threads);
+			u64 mpsc_ticks = run_queue_throughput(mpsc, num_threads, 1, num_items);
+			debug_printf("[Queue Benchmark]%u producers, %u consumers: mutex+RingDeque %.2f M/s, MPMCQueue %.2f M/s\n",
+				num_threads, num_threads, mops(num_items * num_threads, locked_ticks), mops(num_items * num_threads, mpmc_ticks));
+			debug_printf("[Queue Benchmark]%u producers, 1 consumer: mutex+RingDeque %.2f M/s, MPSCQueue %.2f M/s\n",
+				num_threads, mops(num_items * num_threads, locked_mpsc_ticks), mops(num_items * num_threads, mpsc_ticks));
+		}
+		// Latency is only meaningful if both threads can run at the same time.
+		if (std::thread::hardware_concurrency() >= 2)
+		{
+			constexpr u64 num_round_trips = 100000;
+			LockedQueue locked_ping, locked_pong;
+			f64 locked_ns = run_queue_latency(locked_ping, locked_pong, num_round_trips);
+			SPSCQueue<u64> spsc_ping(64), spsc_pong(64);
+			f64 spsc_ns = run_queue_latency(spsc_ping, spsc_pong, num_round_trips);
+			MPMCQueue<u64> mpmc_ping(64), mpmc_pong(64);
+			f64 mpmc_ns = run_queue_latency(mpmc_ping, mpmc_pong, num_round_trips);
+			debug_printf("[Queue Benchmark]Round trip latency: mutex+RingDeque %.0f ns, SPSCQueue %.0f ns, MPMCQueue %.0f ns\n",
+				locked_ns, spsc_ns, mpmc_ns);
+		}
+	}
+
+	void concurrent_queue_test()
+	{
+		{
+			// SPSC queue.
+			SPSCQueue<TestObject> q(4);
+			lutest(q.capacity() == 4);
+			lutest(q.empty());
+			for (i32 i = 0; i < 4; ++i)
+			{
+				lutest(q.push(TestObject(i)));
+			}
+			lutest(!q.push(TestObject(4)));
+			lutest(q.size() == 4);
+			TestObject v;
+			lutest(q.pop(v) && v.m_value == 0);
+			lutest(q.push(TestObject(4)));
+			TestObject buf[8];
+			lutest(q.pop_range(buf, 8) == 4);
+			for (i32 i = 0; i < 4; ++i)
+			{
+				lutest(buf[i].m_value == i + 1);
+			}
+			lutest(!q.pop(v));
+			// Batch push wraps around the buffer.
+			lutest(q.push_range(buf, 3) == 3);
+			lutest(q.push_range(buf, 3) == 1);
+			lutest(q.pop_range(buf + 4, 2) == 2);
+			lutest(buf[4].m_value == 1 && buf[5].m_value == 2);
+			// Remaining elements are destructed with the queue.
+		}
+		lutest(TestObject::is_clear());
+		TestObject::reset();
+
+		{
+			// MPMC queue.
+			MPMCQueue<TestObject> q(4);
+			for (i32 i = 0; i < 4; ++i)
+			{
+				lutest(q.push(TestObject(i)));
+			}
+			lutest(!q.push(TestObject(4)));
+			TestObject v;
+			lutest(q.pop(v) && v.m_value == 0);
+			TestObject buf[8];
+			for (i32 i = 0; i < 8; ++i) buf[i] = TestObject(10 + i);
+			lutest(q.push_range(buf, 8) == 1);
+			lutest(q.size() == 4);
+			lutest(q.pop_range(buf, 8) == 4);
+			lutest(buf[0].m_value == 1 && buf[1].m_value == 2 && buf[2].m_value == 3 && buf[3].m_value == 10);
+			lutest(!q.pop(v));
+			lutest(q.push_range(buf, 2) == 2);
+		}
+		lutest(TestObject::is_clear());
+		TestObject::reset();
+
+		{
+			// MPSC queue.
+			MPSCQueue<QueueTestNode> q;
+			lutest(q.empty());
+			lutest(!q.pop());
+			QueueTestNode nodes[8];
+			for (u32 i = 0; i < 8; ++i)
+			{
+				nodes[i].m_value = i;
+			}
+			q.push(&nodes[0]);
+			lutest(!q.empty());
+			QueueTestNode* list[3] = { &nodes[1], &nodes[2], &nodes[3] };
+			q.push_range(list, 3);
+			for (u32 i = 0; i < 4; ++i)
+			{
+				QueueTestNode* n = q.pop();
+				lutest(n && n->m_value == i);
+			}
+			lutest(!q.pop());
+			lutest(q.empty());
+			// Nodes can be pushed again after they are popped.
+			q.push(&nodes[0]);
+			q.push(&nodes[4]);
+			QueueTestNode* out[8];
+			lutest(q.pop_range(out, 8) == 2);
+			lutest(out[0] == &nodes[0] && out[1] == &nodes[4]);
+		}
+
+		{
+			// Concurrent correctness.
+			MPMCQueue<u64> mpmc(64);
+			run_queue_throughput(mpmc, 4, 4, 20000);
+			SPSCQueue<u64> spsc(64);
+			run_queue_throughput(spsc, 1, 1, 50000);
+			MPSCQueueAdapter mpsc(4 * 20000);
+			run_queue_throughput(mpsc, 4, 1, 20000);
+		}
+
+		concurrent_queue_benchmark();
+	}
+}
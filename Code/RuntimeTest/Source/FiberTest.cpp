@@ -0,0 +1,168 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FiberTest.cpp
+* @author JXMaster
+* @date 2021/6/18
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Platform.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+#ifdef LUNA_PLATFORM_POSIX
+#include <ucontext.h>
+#endif
+
+namespace Luna
+{
+	struct PingPongContext
+	{
+		handle_t m_main_fiber;
+		handle_t m_fiber;
+		u64 m_count;
+		u64 m_iterations;
+	};
+
+	static void ping_pong_main(void* params)
+	{
+		PingPongContext* ctx = (PingPongContext*)params;
+		for (u64 i = 0; i < ctx->m_iterations; ++i)
+		{
+			++ctx->m_count;
+			Platform::switch_to_fiber(ctx->m_main_fiber);
+		}
+		// Fibers must not return, so we keep switching back to the main fiber.
+		while (true)
+		{
+			Platform::switch_to_fiber(ctx->m_main_fiber);
+		}
+	}
+
+	//! Checks that callee-saved registers and floating-point values are preserved across switches.
+	static void nested_main(void* params)
+	{
+		PingPongContext* ctx = (PingPongContext*)params;
+		f64 v = 1.0;
+		for (u32 i = 0; i < 100; ++i)
+		{
+			v = v * 1.5 + 0.25;
+			ctx->m_count = (u64)v;
+			Platform::switch_to_fiber(ctx->m_main_fiber);
+		}
+		while (true)
+		{
+			Platform::switch_to_fiber(ctx->m_main_fiber);
+		}
+	}
+
+#ifdef LUNA_PLATFORM_POSIX
+	struct UContextPingPong
+	{
+		ucontext_t m_main;
+		ucontext_t m_fiber;
+		u64 m_iterations;
+	};
+	static UContextPingPong* g_uctx;
+	static void uctx_ping_pong_main()
+	{
+		while (true)
+		{
+			swapcontext(&g_uctx->m_fiber, &g_uctx->m_main);
+		}
+	}
+#endif
+
+	static void fiber_benchmark()
+	{
+		constexpr u64 num_switches = 1000000;
+		f64 freq = get_ticks_per_second();
+		PingPongContext ctx;
+		ctx.m_main_fiber = Platform::convert_thread_to_fiber().get();
+		ctx.m_count = 0;
+		ctx.m_iterations = num_switches;
+		ctx.m_fiber = Platform::new_fiber(ping_pong_main, &ctx, 64 * 1024).get();
+		u64 begin = get_ticks();
+		for (u64 i = 0; i < num_switches; ++i)
+		{
+			Platform::switch_to_fiber(ctx.m_fiber);
+		}
+		u64 fiber_ticks = get_ticks() - begin;
+		lutest(ctx.m_count == num_switches);
+		Platform::delete_fiber(ctx.m_fiber);
+		lutest(succeeded(Platform::convert_fiber_to_thread()));
+		// Two switches for every iteration.
+		f64 fiber_ns = (f64)fiber_ticks * 1000000000.0 / freq / (num_switches * 2);
+#ifdef LUNA_PLATFORM_POSIX
+		constexpr usize stack_size = 64 * 1024;
+		UContextPingPong uctx;
+		g_uctx = &uctx;
+		void* stack = memalloc(stack_size);
+		getcontext(&uctx.m_fiber);
+		uctx.m_fiber.uc_stack.ss_sp = stack;
+		uctx.m_fiber.uc_stack.ss_size = stack_size;
+		uctx.m_fiber.uc_link = nullptr;
+		makecontext(&uctx.m_fiber, uctx_ping_pong_main, 0);
+		begin = get_ticks();
+		for (u64 i = 0; i < num_switches; ++i)
+		{
+			swapcontext(&uctx.m_main, &uctx.m_fiber);
+		}
+		u64 uctx_ticks = get_ticks() - begin;
+		memfree(stack);
+		f64 uctx_ns = (f64)uctx_ticks * 1000000000.0 / freq / (num_switches * 2);
+		debug_printf("[Fiber Benchmark]switch_to_fiber %.1f ns/switch, swapcontext %.1f ns/switch\n", fiber_ns, uctx_ns);
+#else
+		debug_printf("[Fiber Benchmark]switch_to_fiber %.1f ns/switch\n", fiber_ns);
+#endif
+	}
+
+	void fiber_test()
+	{
+		{
+			// Ping-pong between the main fiber and one fiber.
+			PingPongContext ctx;
+			auto main_fiber = Platform::convert_thread_to_fiber();
+			lutest(succeeded(main_fiber));
+			ctx.m_main_fiber = main_fiber.get();
+			// Converting twice returns the same fiber.
+			lutest(Platform::convert_thread_to_fiber().get() == ctx.m_main_fiber);
+			ctx.m_count = 0;
+			ctx.m_iterations = 10;
+			auto fiber = Platform::new_fiber(ping_pong_main, &ctx, 0);
+			lutest(succeeded(fiber));
+			ctx.m_fiber = fiber.get();
+			for (u64 i = 0; i < 10; ++i)
+			{
+				Platform::switch_to_fiber(ctx.m_fiber);
+				lutest(ctx.m_count == i + 1);
+			}
+			Platform::delete_fiber(ctx.m_fiber);
+
+			// Values on the main fiber stack are preserved.
+			ctx.m_count = 0;
+			ctx.m_fiber = Platform::new_fiber(nested_main, &ctx, 16 * 1024).get();
+			f64 expected = 1.0;
+			for (u32 i = 0; i < 100; ++i)
+			{
+				expected = expected * 1.5 + 0.25;
+				Platform::switch_to_fiber(ctx.m_fiber);
+				lutest(ctx.m_count == (u64)expected);
+			}
+			Platform::delete_fiber(ctx.m_fiber);
+
+			// Fibers created and destroyed repeatedly reuse stacks.
+			for (u32 i = 0; i < 200; ++i)
+			{
+				ctx.m_count = 0;
+				ctx.m_iterations = 1;
+				ctx.m_fiber = Platform::new_fiber(ping_pong_main, &ctx, 16 * 1024).get();
+				Platform::switch_to_fiber(ctx.m_fiber);
+				lutest(ctx.m_count == 1);
+				Platform::delete_fiber(ctx.m_fiber);
+			}
+			lutest(succeeded(Platform::convert_fiber_to_thread()));
+		}
+
+		fiber_benchmark();
+	}
+}
@@ -0,0 +1,156 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file FlatHashTest.cpp
+* @author JXMaster
+* @date 2021/6/5
+*/
+#include "TestCommon.hpp"
+#include <Runtime/FlatHashMap.hpp>
+#include <Runtime/FlatHashSet.hpp>
+#include <Runtime/HashMap.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	template <typename _Map>
+	static void hash_map_benchmark(const c8* name, u64 num_elements)
+	{
+		// Scatters the keys so that the identity hash of integer keys does not produce a sequential pattern.
+		auto key = [](u64 i) { return i * 0x9E3779B97F4A7C15ULL; };
+		f64 freq = get_ticks_per_second();
+		_Map m;
+		u64 t0 = get_ticks();
+		for (u64 i = 0; i < num_elements; ++i)
+		{
+			m.insert(make_pair(key(i), i));
+		}
+		u64 t1 = get_ticks();
+		u64 sum = 0;
+		for (u64 i = 0; i < num_elements * 2; ++i)
+		{
+			// Half of the lookups hit, half of the lookups miss.
+			auto iter = m.find(key(i));
+			if (iter != m.end()) sum += iter->second;
+		}
+		u64 t2 = get_ticks();
+		for (auto& i : m)
+		{
+			sum += i.second;
+		}
+		u64 t3 = get_ticks();
+		for (u64 i = 0; i < num_elements; i += 2)
+		{
+			m.erase(key(i));
+		}
+		u64 t4 = get_ticks();
+		lutest(m.size() == num_elements / 2);
+		lutest(sum == num_elements * (num_elements - 1));
+		debug_printf("[Hash Map Benchmark]%s, %llu elements: insert %.2f ms, lookup %.2f ms, iterate %.2f ms, erase %.2f ms\n",
+			name, (unsigned long long)num_elements, (f64)(t1 - t0) / freq * 1000.0, (f64)(t2 - t1) / freq * 1000.0,
+			(f64)(t3 - t2) / freq * 1000.0, (f64)(t4 - t3) / freq * 1000.0);
+	}
+
+	void flat_hash_test()
+	{
+		TestObject::reset();
+
+		{
+			FlatHashSet<int> h;
+			lutest(h.empty());
+			lutest(h.size() == 0);
+			//! When the set is constructed, it does not allocate
+			//! any dynamic memory, thus does not have any bucket.
+			lutest(h.bucket_count() == 0);
+			lutest(h.begin() == h.end());
+			lutest(h.find(0) == h.end());
+			lutest(h.erase(0) == 0);
+
+			constexpr int count = 10000;
+			for (int i = 0; i < count; ++i)
+			{
+				lutest(h.insert(i).second);
+			}
+			lutest(!h.insert(0).second);
+			lutest(h.size() == count);
+			lutest(h.load_factor() <= h.max_load_factor());
+			for (int i = 0; i < count * 2; ++i)
+			{
+				lutest(h.contains(i) == (i < count));
+			}
+			int n_count = 0;
+			for (auto iter = h.begin(); iter != h.end(); ++iter, ++n_count)
+			{
+				lutest(*iter >= 0 && *iter < count);
+			}
+			lutest(n_count == count);
+
+			// Erases odd values while iterating.
+			for (auto iter = h.begin(); iter != h.end();)
+			{
+				if (*iter & 1) iter = h.erase(iter);
+				else ++iter;
+			}
+			lutest(h.size() == count / 2);
+			for (int i = 0; i < count; ++i)
+			{
+				lutest(h.contains(i) == !(i & 1));
+			}
+
+			// Reinserting into the slots marked as deleted.
+			for (int i = 1; i < count; i += 2)
+			{
+				lutest(h.insert(i).second);
+			}
+			lutest(h.size() == count);
+
+			h.clear();
+			lutest(h.empty());
+			//! When the set gets cleared, it frees all dynamic
+			//! memory, thus does not have any bucket.
+			lutest(h.bucket_count() == 0);
+		}
+
+		{
+			FlatHashMap<int, TestObject> h;
+			for (int i = 0; i < 1000; ++i)
+			{
+				h.insert(make_pair(i, TestObject(i)));
+			}
+			lutest(h.size() == 1000);
+			lutest(!h.insert_or_assign(5, TestObject(100)).second);
+			lutest(h.find(5)->second.m_value == 100);
+			lutest(h.insert_or_assign(1000, TestObject(1000)).second);
+			lutest(h.emplace(1001, TestObject(1001)).second);
+			lutest(!h.emplace(1001, TestObject(0)).second);
+
+			FlatHashMap<int, TestObject> h2(h);
+			lutest(h2.size() == h.size());
+			for (auto& i : h)
+			{
+				lutest(h2.find(i.first)->second == i.second);
+			}
+			FlatHashMap<int, TestObject> h3(move(h2));
+			lutest(h2.empty());
+			lutest(h3.size() == h.size());
+			for (int i = 0; i < 1002; ++i)
+			{
+				lutest(h3.erase(i) == 1);
+			}
+			lutest(h3.empty());
+
+			h.reserve(10000);
+			lutest(h.capacity() >= 10000);
+			lutest(h.find(1001)->second.m_value == 1001);
+		}
+		lutest(TestObject::is_clear());
+
+		// Compares with the node-based hash map.
+		constexpr u64 sizes[] = { 1000, 100000, 1000000 };
+		for (u64 size : sizes)
+		{
+			hash_map_benchmark<HashMap<u64, u64>>("HashMap", size);
+			hash_map_benchmark<FlatHashMap<u64, u64>>("FlatHashMap", size);
+		}
+	}
+}
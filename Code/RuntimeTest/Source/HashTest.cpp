@@ -9,6 +9,10 @@
 #include <Runtime/HashSet.hpp>
 #include <Runtime/HashMultiMap.hpp>
 #include <Runtime/HashMultiSet.hpp>
+#include <Runtime/Hash.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <Runtime/Memory.hpp>
 
 namespace Luna
 {
@@ -392,4 +396,51 @@ namespace Luna
 			lutest(h2.size() == 2);
 		}
 	}
-}
\ No newline at end of file
+
+	template <typename _Func>
+	static void hash_benchmark(const c8* name, const c8* data, usize size, usize num_rounds, _Func&& func)
+	{
+		u64 r = 0;
+		u64 begin = get_ticks();
+		for (usize i = 0; i < num_rounds; ++i)
+		{
+			// Mixes the previous result to prevent the compiler from hoisting the call out of the loop.
+			r += func(data + (r & 1), size);
+		}
+		f64 seconds = (f64)(get_ticks() - begin) / get_ticks_per_second();
+		debug_printf("[Hash Benchmark]%s, %u bytes: %.2f M hashes/s, %.2f MB/s (%llu)\n", name, (u32)size,
+			(f64)num_rounds / seconds / 1000000.0, (f64)num_rounds * size / seconds / 1048576.0, (unsigned long long)r);
+	}
+
+	void hash_algorithm_test()
+	{
+		// CRC32C check value.
+		lutest(crc32c("123456789", 9) == 0xE3069283);
+		lutest(crc32c(nullptr, 0) == 0);
+		// Chaining.
+		lutest(crc32c("6789", 4, crc32c("12345", 5)) == 0xE3069283);
+
+		// wyhash reference values.
+		lutest(wyhash("", 0) == 0x93228a4de0eec5a2ULL);
+		lutest(wyhash("a", 1, 1) == 0xc5bac3db178713c4ULL);
+		lutest(strwyhash("hello world") == wyhash("hello world", 11));
+		lutest(wyhash("hello world", 11, 1) != wyhash("hello world", 11, 2));
+
+		// Compares the hash algorithms on short identifiers and large blobs.
+		constexpr usize blob_size = 4096;
+		c8* data = (c8*)memalloc(blob_size + 1);
+		for (usize i = 0; i < blob_size + 1; ++i)
+		{
+			data[i] = (c8)('a' + (i * 7) % 26);
+		}
+		usize sizes[] = { 12, blob_size };
+		for (usize size : sizes)
+		{
+			usize num_rounds = size < 64 ? 10000000 : 100000;
+			hash_benchmark("memhash", data, size, num_rounds, [](const c8* d, usize s) { return (u64)memhash32(d, s); });
+			hash_benchmark("crc32c", data, size, num_rounds, [](const c8* d, usize s) { return (u64)crc32c(d, s); });
+			hash_benchmark("wyhash", data, size, num_rounds, [](const c8* d, usize s) { return wyhash(d, s); });
+		}
+		memfree(data);
+	}
+}
@@ -0,0 +1,168 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file InlineVectorTest.cpp
+* @author JXMaster
+* @date 2021/6/14
+*/
+#include "TestCommon.hpp"
+#include <Runtime/InlineVector.hpp>
+#include <Runtime/Vector.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	void inline_vector_test()
+	{
+		TestObject::reset();
+
+		{
+			// Elements are stored in place until the inline capacity is exceeded.
+			usize mem = get_allocated_memory();
+			InlineVector<TestObject, 4> vec1;
+			lutest(vec1.empty());
+			lutest(vec1.capacity() == 4);
+			for (i32 i = 0; i < 4; ++i)
+			{
+				vec1.push_back(TestObject(i));
+			}
+			lutest(get_allocated_memory() == mem);
+			lutest(vec1.capacity() == 4);
+			vec1.push_back(TestObject(4));
+			lutest(get_allocated_memory() > mem);
+			lutest(vec1.capacity() > 4);
+			for (i32 i = 0; i < 5; ++i)
+			{
+				lutest(vec1[i] == TestObject(i));
+			}
+
+			// Moves back in place.
+			vec1.pop_back();
+			vec1.shrink_to_fit();
+			lutest(get_allocated_memory() == mem);
+			lutest(vec1.capacity() == 4);
+			lutest(vec1.size() == 4);
+			lutest(vec1.back() == TestObject(3));
+
+			// Copy and move of inline elements.
+			InlineVector<TestObject, 4> vec2(vec1);
+			lutest(vec2.size() == 4);
+			lutest(vec2[3] == TestObject(3));
+			InlineVector<TestObject, 4> vec3(move(vec2));
+			lutest(vec2.empty());
+			lutest(vec3.size() == 4);
+			lutest(vec3[0] == TestObject(0));
+			vec2 = vec3;
+			lutest(vec2.size() == 4);
+			vec3 = move(vec2);
+			lutest(vec3.size() == 4 && vec2.empty());
+
+			// Copy and move of heap elements.
+			vec3.resize(10, TestObject(7));
+			lutest(vec3.size() == 10);
+			lutest(vec3[9] == TestObject(7));
+			InlineVector<TestObject, 4> vec4(vec3);
+			lutest(vec4.size() == 10);
+			lutest(vec4[2] == TestObject(2));
+			const TestObject* buf = vec4.data();
+			InlineVector<TestObject, 4> vec5(move(vec4));
+			lutest(vec5.data() == buf);
+			lutest(vec4.empty() && vec4.capacity() == 4);
+			vec4 = move(vec5);
+			lutest(vec4.data() == buf);
+			vec4.swap(vec1);
+			lutest(vec1.size() == 10 && vec4.size() == 4);
+		}
+		lutest(TestObject::is_clear());
+		TestObject::reset();
+
+		{
+			// Insert and erase.
+			InlineVector<i32, 3> vec = { 1, 2, 3 };
+			vec.insert(vec.begin() + 1, 5);
+			lutest(vec.size() == 4);
+			lutest(vec[0] == 1 && vec[1] == 5 && vec[2] == 2 && vec[3] == 3);
+			vec.insert(vec.end(), 2, 9);
+			lutest(vec.size() == 6 && vec[5] == 9);
+			vec.erase(vec.begin());
+			lutest(vec[0] == 5);
+			vec.erase(vec.begin() + 1, vec.begin() + 3);
+			lutest(vec.size() == 3);
+			lutest(vec[0] == 5 && vec[1] == 9 && vec[2] == 9);
+			vec.emplace(vec.begin(), 4);
+			lutest(vec[0] == 4);
+			vec.emplace_back(8);
+			lutest(vec.back() == 8);
+			vec.assign(2, 6);
+			lutest(vec.size() == 2 && vec[1] == 6);
+			vec.clear();
+			lutest(vec.empty());
+
+			// Bulk append.
+			vec.resize_for_overwrite(2);
+			vec[0] = 0;
+			vec[1] = 1;
+			i32* dest = vec.append_uninitialized(10);
+			for (i32 i = 0; i < 10; ++i)
+			{
+				dest[i] = i + 2;
+			}
+			lutest(vec.size() == 12);
+			for (i32 i = 0; i < 12; ++i)
+			{
+				lutest(vec[i] == i);
+			}
+		}
+
+		{
+			// Inline vectors of trivially relocatable types can be stored in vectors.
+			Vector<InlineVector<i32, 2>> vecs;
+			for (i32 i = 0; i < 100; ++i)
+			{
+				InlineVector<i32, 2> v;
+				for (i32 j = 0; j <= (i % 4); ++j)
+				{
+					v.push_back(i + j);
+				}
+				vecs.push_back(move(v));
+			}
+			for (i32 i = 0; i < 100; ++i)
+			{
+				lutest(vecs[i].size() == (usize)(i % 4) + 1);
+				lutest(vecs[i].back() == i + (i % 4));
+			}
+		}
+
+		{
+			// Benchmark: builds many small arrays.
+			constexpr u32 num_arrays = 100000;
+			f64 freq = get_ticks_per_second();
+			usize sum = 0;
+			u64 begin = get_ticks();
+			for (u32 i = 0; i < num_arrays; ++i)
+			{
+				Vector<u32> v;
+				for (u32 j = 0; j < (i & 3) + 1; ++j)
+				{
+					v.push_back(j);
+				}
+				sum += v.size();
+			}
+			u64 vector_ticks = get_ticks() - begin;
+			begin = get_ticks();
+			for (u32 i = 0; i < num_arrays; ++i)
+			{
+				InlineVector<u32, 4> v;
+				for (u32 j = 0; j < (i & 3) + 1; ++j)
+				{
+					v.push_back(j);
+				}
+				sum += v.size();
+			}
+			u64 inline_ticks = get_ticks() - begin;
+			lutest(sum == num_arrays * 5);
+			debug_printf("[Inline Vector Benchmark]%u arrays of 1-4 elements: Vector %.2f ms, InlineVector %.2f ms\n",
+				num_arrays, (f64)vector_ticks / freq * 1000.0, (f64)inline_ticks / freq * 1000.0);
+		}
+	}
+}
@@ -0,0 +1,129 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file MemoryTest.cpp
+* @author JXMaster
+* @date 2021/6/8
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Memory.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	void memory_test()
+	{
+		usize mem = get_allocated_memory();
+
+		// Sizes across all size classes and the system heap.
+		for (usize size = 1; size < 10000; size += 7)
+		{
+			u8* p = (u8*)memalloc(size);
+			lutest(p);
+			lutest(((usize)p % max_align) == 0);
+			lutest(memsize(p) >= size);
+			memset(p, 0xAB, size);
+			p = (u8*)memrealloc(p, size * 2 + 1);
+			for (usize i = 0; i < size; ++i)
+			{
+				lutest(p[i] == 0xAB);
+			}
+			p = (u8*)memrealloc(p, size / 2 + 1);
+			for (usize i = 0; i < size / 2 + 1; ++i)
+			{
+				lutest(p[i] == 0xAB);
+			}
+			memfree(p);
+		}
+
+		// Over-aligned allocations.
+		for (usize alignment = 32; alignment <= 4096; alignment *= 2)
+		{
+			void* p = memalloc(100, alignment);
+			lutest(((usize)p % alignment) == 0);
+			memfree(p, alignment);
+		}
+		lutest(get_allocated_memory() == mem);
+
+		// Memory allocated in one thread and freed in another thread.
+		constexpr u32 num_threads = 4;
+		constexpr u32 num_allocs = 100000;
+		void** blocks = (void**)memalloc(sizeof(void*) * num_threads * num_allocs);
+		usize base = get_allocated_memory();
+		u64 begin = get_ticks();
+		run_threads(num_threads, [blocks](u32 t)
+		{
+			void** b = blocks + t * num_allocs;
+			for (u32 i = 0; i < num_allocs; ++i)
+			{
+				b[i] = memalloc(16 + (i * 37) % 2000);
+			}
+			// Frees half of the blocks in the allocating thread.
+			for (u32 i = 0; i < num_allocs; i += 2)
+			{
+				memfree(b[i]);
+			}
+		});
+		u64 mid = get_ticks();
+		run_threads(num_threads, [blocks](u32 t)
+		{
+			// Frees the rest blocks allocated by other thread.
+			void** b = blocks + ((t + 1) % num_threads) * num_allocs;
+			for (u32 i = 1; i < num_allocs; i += 2)
+			{
+				memfree(b[i]);
+			}
+		});
+		u64 end = get_ticks();
+		lutest(get_allocated_memory() == base);
+		memfree(blocks);
+		lutest(get_allocated_memory() == mem);
+		f64 freq = get_ticks_per_second();
+		debug_printf("[Memory Benchmark]%u threads, %u allocations per thread: alloc & local free %.2f ms, remote free %.2f ms\n",
+			num_threads, num_allocs, (f64)(mid - begin) / freq * 1000.0, (f64)(end - mid) / freq * 1000.0);
+
+#ifdef LUNA_RUNTIME_PROFILE_MEMORY
+		// Memory profiler.
+		{
+			void* untagged = memalloc(64);
+			void* tagged[10];
+			{
+				lumemtag("MemoryTest");
+				lutest(!strcmp(get_memory_tag(), "MemoryTest"));
+				for (u32 i = 0; i < 10; ++i)
+				{
+					tagged[i] = memalloc(100);
+				}
+			}
+			lutest(get_memory_tag() == nullptr);
+			MemoryTagStats stats[64];
+			usize num_stats = min<usize>(get_memory_tag_stats(stats, 64), 64);
+			bool found = false;
+			for (usize i = 0; i < num_stats; ++i)
+			{
+				if (stats[i].tag && !strcmp(stats[i].tag, "MemoryTest"))
+				{
+					lutest(stats[i].live_blocks == 10);
+					lutest(stats[i].live_bytes == memsize(tagged[0]) * 10);
+					found = true;
+				}
+			}
+			lutest(found);
+			for (u32 i = 0; i < 10; ++i)
+			{
+				memfree(tagged[i]);
+			}
+			memfree(untagged);
+			num_stats = min<usize>(get_memory_tag_stats(stats, 64), 64);
+			for (usize i = 0; i < num_stats; ++i)
+			{
+				if (stats[i].tag && !strcmp(stats[i].tag, "MemoryTest"))
+				{
+					lutest(stats[i].live_blocks == 0);
+					lutest(stats[i].total_allocations == 10);
+				}
+			}
+		}
+#endif
+	}
+}
@@ -6,6 +6,9 @@
 */
 #include "TestCommon.hpp"
 #include <Runtime/Name.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <thread>
 
 namespace Luna
 {
@@ -45,4 +48,61 @@ namespace Luna
 			lutest(names[i] == names[50 + i]);
 		}
 	}
+
+	void name_concurrency_test()
+	{
+		// Every thread copies and destroys names from one shared name set, which is the access pattern of 
+		// copying `Path` and Variant tables across worker threads.
+		constexpr u32 num_names = 64;
+		constexpr u32 num_rounds = 20000;
+		Name names[num_names];
+		char str[32];
+		for (u32 i = 0; i < num_names; ++i)
+		{
+			sprintf(str, u8"ConcurrentName%u", i);
+			names[i] = str;
+		}
+		u32 max_threads = (u32)std::thread::hardware_concurrency();
+		if (!max_threads) max_threads = 1;
+		f64 base_seconds = 0.0;
+		for (u32 num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+		{
+			u64 begin = get_ticks();
+			run_threads(num_threads, [&names](u32 t) {
+				for (u32 r = 0; r < num_rounds; ++r)
+				{
+					Name copied[num_names];
+					for (u32 i = 0; i < num_names; ++i)
+					{
+						copied[i] = names[(i + t) % num_names];
+					}
+					for (u32 i = 0; i < num_names; ++i)
+					{
+						lutest(copied[i] == names[(i + t) % num_names]);
+					}
+				}
+				// Interns names concurrently.
+				char buf[32];
+				for (u32 i = 0; i < num_names; ++i)
+				{
+					sprintf(buf, u8"ConcurrentName%u", i);
+					Name n(buf);
+					lutest(n == names[i]);
+				}
+			});
+			f64 seconds = (f64)(get_ticks() - begin) / get_ticks_per_second();
+			if (num_threads == 1) base_seconds = seconds;
+			// Every thread performs the same amount of work, so perfect scaling keeps the time constant.
+			f64 copies = (f64)num_threads * num_rounds * num_names;
+			debug_printf("[Name Benchmark]%u thread(s): %.3f ms, %.2f M copies/s, scaling %.2fx\n", num_threads, seconds * 1000.0,
+				copies / seconds / 1000000.0, base_seconds * num_threads / seconds);
+		}
+		// All names are still valid after the test.
+		for (u32 i = 0; i < num_names; ++i)
+		{
+			sprintf(str, u8"ConcurrentName%u", i);
+			lutest(!strcmp(names[i].c_str(), str));
+			lutest(fetch_name(names[i].id()) == names[i].c_str());
+		}
+	}
 }
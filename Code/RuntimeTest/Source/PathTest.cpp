@@ -6,6 +6,7 @@
 */
 #include "TestCommon.hpp"
 #include <Runtime/Path.hpp>
+#include <Runtime/InternedPath.hpp>
 
 namespace Luna
 {
@@ -118,5 +119,49 @@ namespace Luna
 			lutest(!strcmp(rs2.c_str(), "C:Sample File.txt"));
 			lutest(!strcmp(rs3.c_str(), "C:Same Dir2/"));
 		}
+
+		{
+			// Interned path.
+			Path p1("/Assets/Textures/Sky.tex");
+			Path p2("/Assets/Textures/Grass.tex");
+			Path p3("/Assets/Textures");
+			InternedPath i1(p1);
+			InternedPath i2(p2);
+			InternedPath i3(p3);
+			lutest(i1.valid() && i2.valid() && i3.valid());
+			lutest(i1 != i2);
+			lutest(InternedPath(Path("/Assets/Textures/Sky.tex")) == i1);
+			lutest(InternedPath::find(p1) == i1);
+			lutest(!InternedPath::find(Path("/Assets/Textures/Water.tex")));
+			lutest(i1.size() == 3);
+			lutest(i1.back() == Name("Sky.tex"));
+			lutest(i1.flags() == EPathFlag::absolute);
+			// Paths with the same prefix share the same parent.
+			lutest(i1.parent() == i2.parent());
+			lutest(i1.parent() == i3);
+			lutest(i1.prefix(2) == i3);
+			lutest(i1.prefix(0).empty());
+			lutest(i1.is_subpath_of(i3));
+			lutest(i1.is_subpath_of(i1));
+			lutest(!i3.is_subpath_of(i1));
+			lutest(!i1.is_subpath_of(i2));
+			// Root names and flags are part of the interned path unless excluded.
+			InternedPath i4(Path("C:/Assets/Textures/Sky.tex"));
+			lutest(i4 != i1);
+			lutest(i4.root() == Name("C:"));
+			lutest(!i4.is_subpath_of(i3));
+			InternedPath i5(Path("C:/Assets/Textures/Sky.tex"), EPathComponent::nodes);
+			lutest(i5 == InternedPath(Path("Assets/Textures/Sky.tex"), EPathComponent::nodes));
+			lutest(!i5.root());
+			lutest(i5.is_subpath_of(InternedPath(p3, EPathComponent::nodes)));
+			// Longest interned prefix.
+			Path p4("/Assets/Textures/Water/Water.tex");
+			lutest(InternedPath::from_id(find_interned_path_prefix(p4)) == i3);
+			// Converts back.
+			lutest(i1.to_path() == p1);
+			lutest(i4.to_path() == Path("C:/Assets/Textures/Sky.tex"));
+			lutest(!strcmp(i1.encode().c_str(), "/Assets/Textures/Sky.tex"));
+			lutest(hash<InternedPath>()(i1) != hash<InternedPath>()(i2));
+		}
 	}
-}
\ No newline at end of file
+}
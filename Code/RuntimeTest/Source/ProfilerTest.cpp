@@ -0,0 +1,110 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file ProfilerTest.cpp
+* @author JXMaster
+* @date 2021/6/23
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Profiler.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	static usize count_substr(const String& str, const c8* substr)
+	{
+		usize count = 0;
+		usize len = strlen(substr);
+		for (const c8* p = strstr(str.c_str(), substr); p; p = strstr(p + len, substr))
+		{
+			++count;
+		}
+		return count;
+	}
+
+	static void profiler_benchmark()
+	{
+		constexpr u32 num_scopes = 1000000;
+		u64 begin = get_ticks();
+		for (u32 i = 0; i < num_scopes; ++i)
+		{
+			ProfilerScope scope("Benchmark");
+		}
+		u64 idle_ticks = get_ticks() - begin;
+		begin_profiler_capture();
+		begin = get_ticks();
+		for (u32 i = 0; i < num_scopes; ++i)
+		{
+			ProfilerScope scope("Benchmark");
+		}
+		u64 capture_ticks = get_ticks() - begin;
+		end_profiler_capture();
+		f64 ns_per_tick = 1000000000.0 / get_ticks_per_second();
+		debug_printf("[Profiler Benchmark]One scope costs %.2f ns when not capturing, %.2f ns when capturing\n",
+			idle_ticks * ns_per_tick / num_scopes, capture_ticks * ns_per_tick / num_scopes);
+	}
+
+	void profiler_test()
+	{
+		{
+			// Scopes out of captures are not recorded.
+			{
+				ProfilerScope scope("NotCaptured");
+			}
+			begin_profiler_capture();
+			lutest(is_profiler_capturing());
+			set_profiler_thread_name("Main \"Test\" Thread");
+			{
+				ProfilerScope outer("Outer");
+				{
+					ProfilerScope inner("Inner");
+				}
+				profiler_new_frame(1);
+			}
+			run_threads(1, [](u32) {
+				set_profiler_thread_name("Worker");
+				for (u32 i = 0; i < 10; ++i)
+				{
+					ProfilerScope scope("WorkerScope");
+				}
+			});
+			{
+				ProfilerScope scope("Open");
+				end_profiler_capture();
+			}
+			lutest(!is_profiler_capturing());
+			{
+				ProfilerScope scope("NotCaptured");
+			}
+			String json;
+			export_profiler_capture(json);
+			lutest(json.size() > 0 && json[0] == '{');
+			lutest(count_substr(json, "\"name\":\"Outer\"") == 1);
+			lutest(count_substr(json, "\"name\":\"Inner\"") == 1);
+			lutest(count_substr(json, "\"name\":\"WorkerScope\"") == 10);
+			lutest(count_substr(json, "\"name\":\"Frame\"") == 1);
+			lutest(count_substr(json, "\"name\":\"Worker\"") == 1);
+			lutest(count_substr(json, "\"name\":\"Main \\\"Test\\\" Thread\"") == 1);
+			// Scopes that are not ended in the capture are not exported.
+			lutest(count_substr(json, "Open") == 0);
+			lutest(count_substr(json, "NotCaptured") == 0);
+		}
+
+		{
+			// Only the most recent events are kept when the ring buffer is full.
+			begin_profiler_capture();
+			for (u32 i = 0; i < profiler_events_per_thread; ++i)
+			{
+				ProfilerScope scope("Overflow");
+			}
+			end_profiler_capture();
+			String json;
+			export_profiler_capture(json);
+			// The oldest event may be dropped since it may be overwritten during the export.
+			usize count = count_substr(json, "\"name\":\"Overflow\"");
+			lutest(count >= profiler_events_per_thread / 2 - 1 && count <= profiler_events_per_thread / 2);
+		}
+
+		profiler_benchmark();
+	}
+}
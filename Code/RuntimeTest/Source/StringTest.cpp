@@ -6,9 +6,144 @@
 */
 #include "TestCommon.hpp"
 #include <Runtime/String.hpp>
+#include <Runtime/HashMap.hpp>
+#include <Runtime/Vector.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
 
 namespace Luna
 {
+	// Generates identifiers with a length distribution similar to the names used in the engine: most names are short
+	// member, type and property names, while about one of eight names is a long asset path.
+	static void gen_identifiers(Vector<String>& out, usize count)
+	{
+		const c8* prefixes[] = { "", "", "m_", "get_", "set_", "is_", "Luna::" };
+		const c8* words[] = { "position", "rotation", "scale", "world", "matrix", "camera", "light", "mesh", "texture",
+			"shader", "buffer", "index", "count", "color", "normal", "entity", "component", "transform" };
+		u32 seed = 12345;
+		auto rand = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+		c8 num[16];
+		for (usize i = 0; i < count; ++i)
+		{
+			String s;
+			if ((rand() & 7) == 0)
+			{
+				s.append("/Assets/");
+				s.append(words[rand() % 18]);
+				s.push_back('/');
+				s.append(words[rand() % 18]);
+				s.append(".lasset");
+			}
+			else
+			{
+				s.append(prefixes[rand() % 7]);
+				s.append(words[rand() % 18]);
+				if (rand() & 1)
+				{
+					snprintf(num, 16, "_%u", (u32)(rand() % 100));
+					s.append(num);
+				}
+			}
+			out.push_back(move(s));
+		}
+	}
+
+	static void string_benchmark()
+	{
+		constexpr usize num_names = 10000;
+		constexpr usize num_rounds = 20;
+		f64 freq = get_ticks_per_second();
+		Vector<String> names;
+		gen_identifiers(names, num_names);
+		usize num_short = 0;
+		for (auto& i : names)
+		{
+			if (i.size() <= String::short_capacity) ++num_short;
+		}
+
+		// Construction, measures the memory allocated for the string data.
+		usize mem = get_allocated_memory();
+		Vector<String> strs;
+		strs.reserve(num_names);
+		usize vector_mem = get_allocated_memory() - mem;
+		u64 t0 = get_ticks();
+		for (usize r = 0; r < num_rounds; ++r)
+		{
+			strs.clear();
+			for (auto& i : names)
+			{
+				strs.push_back(String(i.c_str()));
+			}
+		}
+		u64 t1 = get_ticks();
+		usize string_mem = get_allocated_memory() - mem - vector_mem;
+
+		// Append, builds dotted names like "camera.transform.position".
+		usize total_size = 0;
+		for (usize r = 0; r < num_rounds; ++r)
+		{
+			for (usize i = 0; i + 2 < num_names; ++i)
+			{
+				String s(names[i]);
+				s.push_back('.');
+				s.append(names[i + 1]);
+				s.push_back('.');
+				s.append(names[i + 2]);
+				total_size += s.size();
+			}
+		}
+		u64 t2 = get_ticks();
+
+		// Compare, most compared pairs have different lengths.
+		usize num_equal = 0;
+		for (usize r = 0; r < num_rounds; ++r)
+		{
+			for (usize i = 0; i < num_names; ++i)
+			{
+				if (names[i] == strs[(i * 7) % num_names]) ++num_equal;
+			}
+		}
+		u64 t3 = get_ticks();
+
+		// Hashing, looks up every name from a hash map keyed by strings and by hashed strings.
+		HashMap<String, usize> map;
+		HashMap<HashedString, usize> hashed_map;
+		for (usize i = 0; i < num_names; ++i)
+		{
+			map.insert(make_pair(names[i], i));
+			hashed_map.insert(make_pair(HashedString(names[i]), i));
+		}
+		Vector<HashedString> hashed_names;
+		for (auto& i : names)
+		{
+			hashed_names.push_back(HashedString(i));
+		}
+		usize sum = 0;
+		u64 t4 = get_ticks();
+		for (usize r = 0; r < num_rounds; ++r)
+		{
+			for (auto& i : names)
+			{
+				sum += map.find(i)->second;
+			}
+		}
+		u64 t5 = get_ticks();
+		for (usize r = 0; r < num_rounds; ++r)
+		{
+			for (auto& i : hashed_names)
+			{
+				sum += hashed_map.find(i)->second;
+			}
+		}
+		u64 t6 = get_ticks();
+		lutest(total_size > 0 && num_equal > 0);
+		debug_printf("[String Benchmark]%u names, %u short (<= %u chars), %.1f heap bytes per string\n", (u32)num_names, (u32)num_short,
+			(u32)String::short_capacity, (f64)string_mem / num_names);
+		debug_printf("[String Benchmark]construct %.2f ms, append %.2f ms, compare %.2f ms, lookup %.2f ms, lookup (hashed) %.2f ms (%llu)\n",
+			(f64)(t1 - t0) / freq * 1000.0, (f64)(t2 - t1) / freq * 1000.0, (f64)(t3 - t2) / freq * 1000.0,
+			(f64)(t5 - t4) / freq * 1000.0, (f64)(t6 - t5) / freq * 1000.0, (unsigned long long)sum);
+	}
+
 	void string_test()
 	{
 		{
@@ -16,7 +151,7 @@ namespace Luna
 			String str1;
 			lutest(str1.empty());
 			lutest(str1.size() == 0);
-			lutest(str1.data() == nullptr);
+			lutest(str1.data() && str1.data()[0] == 0);
 			lutest(!strcmp(str1.c_str(), u8""));
 
 			// usize count, value_type ch, IAllocator* alloc
@@ -80,7 +215,7 @@ namespace Luna
 			// const_pointer	c_str() const
 			
 			String s;
-			lutest(s.data() == nullptr);
+			lutest(s.data() == s.c_str());
 			lutest(!strcmp(s.c_str(), u8""));
 		}
 
@@ -156,7 +291,7 @@ namespace Luna
 			lutest(!strcmp(s.c_str(), u8"ccccccccccccccc"));
 			s.shrink_to_fit();
 			lutest(!strcmp(s.c_str(), u8"ccccccccccccccc"));
-			lutest(s.capacity() == 15);
+			lutest(s.capacity() == max<usize>(15, String::short_capacity));
 		}
 
 		{
@@ -232,5 +367,89 @@ namespace Luna
 			lutest(!strcmp(s2.c_str(), u8"abc"));
 			lutest(s2.size() == 3);
 		}
+
+		{
+			// Short strings are stored in place.
+			usize mem = get_allocated_memory();
+			String s(String::short_capacity, 'a');
+			lutest(get_allocated_memory() == mem);
+			lutest(s.capacity() == String::short_capacity);
+			String s2(s);
+			String s3(move(s2));
+			lutest(get_allocated_memory() == mem);
+			lutest(s2.empty() && s3.size() == String::short_capacity);
+			// Grows to the heap.
+			s.push_back('b');
+			lutest(get_allocated_memory() > mem);
+			lutest(s.size() == String::short_capacity + 1);
+			lutest(s.back() == 'b' && s.front() == 'a');
+			s2 = move(s);
+			lutest(s.empty() && !strcmp(s.c_str(), u8""));
+			lutest(s2.size() == String::short_capacity + 1);
+			// Moves back in place.
+			s2.erase(0, 10);
+			s2.shrink_to_fit();
+			lutest(get_allocated_memory() == mem);
+			lutest(s2.size() == String::short_capacity - 9);
+			lutest(s2.back() == 'b');
+			s2.insert((usize)0, 20, 'c');
+			lutest(s2.size() == String::short_capacity + 11);
+			lutest(s2[0] == 'c' && s2[20] == 'a' && s2.back() == 'b');
+			String16 s16(u"abcdefg");
+			lutest(s16.size() == 7 && s16[6] == u'g');
+			String32 s32(U"abcdefgh");
+			lutest(s32.size() == 8 && s32[7] == U'h');
+		}
+
+		{
+			// Appends and inserts a string to itself, which may reallocate the buffer the source points to.
+			String s("abcdefghij");
+			s.append(s);
+			lutest(s == "abcdefghijabcdefghij");
+			s.append(s.c_str() + 1, 3);
+			lutest(s == "abcdefghijabcdefghijbcd");
+			lutest(s.size() > String::short_capacity);
+			s.append(s);
+			lutest(s == "abcdefghijabcdefghijbcdabcdefghijabcdefghijbcd");
+			s.append(s.c_str(), 10);
+			lutest(s == "abcdefghijabcdefghijbcdabcdefghijabcdefghijbcdabcdefghij");
+			String s2("0123456789");
+			s2.insert(2, s2.c_str() + 4, 6);
+			lutest(s2 == "0145678923456789");
+			s2.insert(0, s2);
+			lutest(s2 == "01456789234567890145678923456789");
+		}
+
+		{
+			// Comparison operators.
+			String s1("abc");
+			String s2("abcd");
+			lutest(s1 != s2);
+			s2.pop_back();
+			lutest(s1 == s2);
+			lutest(s1 == "abc");
+			lutest(s1 != "ab");
+			lutest(s1 != "abcd");
+			lutest(String("ab") < s1);
+			lutest(s1 < String("abd"));
+			lutest(!(s1 < s2));
+		}
+
+		{
+			// Hashed strings.
+			HashedString h1("position");
+			HashedString h2(String("position"));
+			lutest(h1 == h2);
+			lutest(h1.hash_code() == hash<String>()(String("position")));
+			lutest(h1 != HashedString("rotation"));
+			HashMap<HashedString, i32> m;
+			m.insert(make_pair(h1, 1));
+			m.insert(make_pair(HashedString("rotation"), 2));
+			lutest(m.find(HashedString("position"))->second == 1);
+			lutest(m.find(HashedString("rotation"))->second == 2);
+			lutest(m.find(HashedString("scale")) == m.end());
+		}
+
+		string_benchmark();
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,181 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file SyncTest.cpp
+* @author JXMaster
+* @date 2021/6/19
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Sync.hpp>
+#include <Runtime/Platform.hpp>
+#include <Runtime/Thread.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+#include <thread>
+
+namespace Luna
+{
+	static void sync_benchmark()
+	{
+		constexpr u32 num_iters = 200000;
+		u32 num_threads = (u32)std::thread::hardware_concurrency();
+		if (!num_threads) num_threads = 1;
+		f64 freq = get_ticks_per_second();
+
+		handle_t os_mtx = Platform::new_mutex();
+		u64 counter = 0;
+		u64 begin = get_ticks();
+		run_threads(num_threads, [&](u32) {
+			for (u32 i = 0; i < num_iters; ++i)
+			{
+				Platform::lock_mutex(os_mtx);
+				++counter;
+				Platform::unlock_mutex(os_mtx);
+			}
+		});
+		u64 os_ticks = get_ticks() - begin;
+		Platform::delete_mutex(os_mtx);
+		lutest(counter == (u64)num_threads * num_iters);
+
+		FutexMutex mtx;
+		counter = 0;
+		begin = get_ticks();
+		run_threads(num_threads, [&](u32) {
+			for (u32 i = 0; i < num_iters; ++i)
+			{
+				mtx.lock();
+				++counter;
+				mtx.unlock();
+			}
+		});
+		u64 futex_ticks = get_ticks() - begin;
+		lutest(counter == (u64)num_threads * num_iters);
+
+		SpinLock spin;
+		counter = 0;
+		begin = get_ticks();
+		run_threads(num_threads, [&](u32) {
+			for (u32 i = 0; i < num_iters; ++i)
+			{
+				spin.lock();
+				++counter;
+				spin.unlock();
+			}
+		});
+		u64 spin_ticks = get_ticks() - begin;
+		lutest(counter == (u64)num_threads * num_iters);
+
+		debug_printf("[Sync Benchmark]%u threads, %u locks per thread: OS mutex %.2f ms, FutexMutex %.2f ms, SpinLock %.2f ms\n",
+			num_threads, num_iters, os_ticks * 1000.0 / freq, futex_ticks * 1000.0 / freq, spin_ticks * 1000.0 / freq);
+	}
+
+	void sync_test()
+	{
+		{
+			// Mutexes.
+			FutexMutex mtx;
+			lutest(mtx.try_lock());
+			lutest(!mtx.try_lock());
+			mtx.unlock();
+			FutexRecursiveMutex rmtx;
+			rmtx.lock();
+			lutest(rmtx.try_lock());
+			rmtx.unlock();
+			rmtx.unlock();
+			volatile u32 counter = 0;
+			run_threads(4, [&](u32) {
+				for (u32 i = 0; i < 10000; ++i)
+				{
+					rmtx.lock();
+					rmtx.lock();
+					counter = counter + 1;
+					rmtx.unlock();
+					rmtx.unlock();
+				}
+			});
+			lutest(counter == 40000);
+		}
+
+		{
+			// Events.
+			FutexEvent auto_ev(false);
+			lutest(!auto_ev.try_wait());
+			auto_ev.trigger();
+			lutest(auto_ev.try_wait());
+			lutest(!auto_ev.try_wait());
+			FutexEvent manual_ev(true);
+			manual_ev.trigger();
+			lutest(manual_ev.try_wait());
+			lutest(manual_ev.try_wait());
+			manual_ev.reset();
+			lutest(!manual_ev.try_wait());
+
+			// All threads waiting for one manual reset event are resumed.
+			volatile u32 resumed = 0;
+			std::thread notifier([&]() {
+				sleep(10);
+				manual_ev.trigger();
+			});
+			run_threads(4, [&](u32) {
+				manual_ev.wait();
+				atom_inc_u32(&resumed);
+			});
+			notifier.join();
+			lutest(resumed == 4);
+
+			// Ping-pong between two threads with automatic reset events.
+			FutexEvent ping(false);
+			FutexEvent pong(false);
+			u32 count = 0;
+			std::thread t([&]() {
+				for (u32 i = 0; i < 1000; ++i)
+				{
+					ping.wait();
+					++count;
+					pong.trigger();
+				}
+			});
+			for (u32 i = 0; i < 1000; ++i)
+			{
+				ping.trigger();
+				pong.wait();
+				lutest(count == i + 1);
+			}
+			t.join();
+		}
+
+		{
+			// Semaphores.
+			FutexSemaphore sema(2, 3);
+			lutest(sema.try_acquire());
+			lutest(sema.try_acquire());
+			lutest(!sema.try_acquire());
+			sema.release(5);
+			lutest(sema.count() == 3);
+			sema.acquire();
+			sema.acquire();
+			sema.acquire();
+			lutest(sema.count() == 0);
+
+			FutexSemaphore items(0);
+			volatile u32 consumed = 0;
+			std::thread producer([&]() {
+				for (u32 i = 0; i < 10000; ++i)
+				{
+					items.release();
+				}
+			});
+			run_threads(4, [&](u32) {
+				for (u32 i = 0; i < 2500; ++i)
+				{
+					items.acquire();
+					atom_inc_u32(&consumed);
+				}
+			});
+			producer.join();
+			lutest(consumed == 10000);
+			lutest(items.count() == 0);
+		}
+
+		sync_benchmark();
+	}
+}
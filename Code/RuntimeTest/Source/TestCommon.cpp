@@ -5,6 +5,8 @@
 * @date 2020/2/16
 */
 #include "TestCommon.hpp"
+#include <Runtime/Memory.hpp>
+#include <thread>
 
 namespace Luna
 {
@@ -18,4 +20,19 @@ namespace Luna
 	i64 TestObject::g_copy_assign_count = 0;
 	i64 TestObject::g_move_assign_count = 0;
 	i32 TestObject::g_magic_error_count = 0;
+
+	void run_threads(u32 num_threads, void(*func)(void* userdata, u32 thread_index), void* userdata)
+	{
+		std::thread* threads = (std::thread*)memalloc(sizeof(std::thread) * num_threads);
+		for (u32 t = 0; t < num_threads; ++t)
+		{
+			new (threads + t) std::thread(func, userdata, t);
+		}
+		for (u32 t = 0; t < num_threads; ++t)
+		{
+			threads[t].join();
+			threads[t].~thread();
+		}
+		memfree(threads);
+	}
 }
\ No newline at end of file
@@ -11,15 +11,36 @@
 
 namespace Luna
 {
+	void memory_test();
 	void vector_test();
+	void inline_vector_test();
 	void hash_test();
+	void hash_algorithm_test();
+	void flat_hash_test();
+	void allocator_test();
 	void name_test();
+	void name_concurrency_test();
 	void ring_deque_test();
 	void string_test();
+	void unicode_test();
 	void path_test();
 	void time_test();
+	void fiber_test();
+	void sync_test();
+	void concurrent_queue_test();
+	void profiler_test();
 	void lexical_test();
 
+	//! Runs `func(userdata, thread_index)` on `num_threads` threads and waits for all of them.
+	void run_threads(u32 num_threads, void(*func)(void* userdata, u32 thread_index), void* userdata);
+
+	//! Runs `func(thread_index)` on `num_threads` threads and waits for all of them.
+	template <typename _Func>
+	inline void run_threads(u32 num_threads, const _Func& func)
+	{
+		run_threads(num_threads, [](void* userdata, u32 thread_index) { (*(const _Func*)userdata)(thread_index); }, (void*)&func);
+	}
+
 	// STL test framework modified from EASTL.
 
 	constexpr u32 magic_value_v = 0x01f1cbe8;
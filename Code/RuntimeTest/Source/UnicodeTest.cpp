@@ -0,0 +1,253 @@
+// Copyright 2018-2021 JXMaster. All rights reserved.
+/*
+* @file UnicodeTest.cpp
+* @author JXMaster
+* @date 2021/6/16
+*/
+#include "TestCommon.hpp"
+#include <Runtime/Unicode.hpp>
+#include <Runtime/String.hpp>
+#include <Runtime/Vector.hpp>
+#include <Runtime/Time.hpp>
+#include <Runtime/Debug.hpp>
+
+namespace Luna
+{
+	//! Generates one UTF-8 string whose characters are ASCII characters except every `stride`th character.
+	static String gen_text(usize num_chars, usize stride)
+	{
+		String r;
+		const c32 wide_chars[] = { 0xE9, 0x4E2D, 0x1F600 };
+		for (usize i = 0; i < num_chars; ++i)
+		{
+			if (stride && (i % stride) == stride - 1)
+			{
+				c8 buf[6];
+				usize len = utf8_encode_char(buf, wide_chars[i % 3]);
+				r.append(buf, len);
+			}
+			else
+			{
+				r.push_back((c8)('a' + i % 26));
+			}
+		}
+		return r;
+	}
+
+	//! Generates one UTF-8 string of words in different scripts separated by spaces and punctuation, like localized
+	//! UI text.
+	static String gen_mixed_script_text(usize num_chars)
+	{
+		String r;
+		// Latin, Cyrillic, Greek, CJK and Hiragana letters.
+		const c32 script_begins[] = { 'a', 0x430, 0x3B1, 0x4E00, 0x3041 };
+		const c8 separators[] = { ' ', ' ', ' ', ',', '.' };
+		usize i = 0;
+		usize word = 0;
+		while (i < num_chars)
+		{
+			c32 begin = script_begins[word % 5];
+			usize word_len = 2 + word % 7;
+			for (usize j = 0; j < word_len && i < num_chars; ++j, ++i)
+			{
+				c8 buf[6];
+				usize len = utf8_encode_char(buf, begin + (c32)((word * 7 + j) % 24));
+				r.append(buf, len);
+			}
+			if (i < num_chars)
+			{
+				r.push_back(separators[word % 5]);
+				++i;
+			}
+			++word;
+		}
+		return r;
+	}
+
+	static void unicode_benchmark()
+	{
+		constexpr usize num_chars = 1000000;
+		constexpr u32 num_iters = 10;
+		f64 freq = get_ticks_per_second();
+		Vector<c32> buf;
+		buf.resize_for_overwrite(num_chars);
+		usize strides[] = { 0, 64, 2 };
+		const c8* names[] = { "ASCII", "Mostly ASCII", "Mixed", "Mixed script" };
+		for (usize k = 0; k < 4; ++k)
+		{
+			String text = k < 3 ? gen_text(num_chars, strides[k]) : gen_mixed_script_text(num_chars);
+			usize sum = 0;
+			u64 begin = get_ticks();
+			for (u32 it = 0; it < num_iters; ++it)
+			{
+				const c8* cur = text.c_str();
+				usize n = 0;
+				while (*cur)
+				{
+					buf[n++] = utf8_decode_char(cur);
+					cur += utf8_charlen(cur);
+				}
+				sum += n;
+			}
+			u64 scalar_ticks = get_ticks() - begin;
+			begin = get_ticks();
+			for (u32 it = 0; it < num_iters; ++it)
+			{
+				sum += utf8_decode_span(buf.data(), buf.size(), text.c_str(), text.size());
+			}
+			u64 span_ticks = get_ticks() - begin;
+			begin = get_ticks();
+			bool valid = true;
+			for (u32 it = 0; it < num_iters; ++it)
+			{
+				valid &= utf8_validate(text.c_str(), text.size());
+			}
+			u64 validate_ticks = get_ticks() - begin;
+			lutest(valid);
+			lutest(sum == num_chars * num_iters * 2);
+			f64 mb = (f64)(text.size() * num_iters) / (1024.0 * 1024.0);
+			debug_printf("[Unicode Benchmark]%s: per-char decode %.1f MB/s, utf8_decode_span %.1f MB/s, utf8_validate %.1f MB/s\n",
+				names[k], mb / ((f64)scalar_ticks / freq), mb / ((f64)span_ticks / freq), mb / ((f64)validate_ticks / freq));
+		}
+	}
+
+	void unicode_test()
+	{
+		{
+			// ASCII scanning.
+			const c8* s = "abcdefghijklmnopqrstuvwxyz0123456789\xC3\xA9xyz";
+			lutest(utf8_ascii_len(s, strlen(s)) == 36);
+			lutest(utf8_ascii_len(s, 10) == 10);
+			lutest(utf8_ascii_len(s, 0) == 0);
+			c8 with_null[40] = {};
+			lutest(utf8_ascii_len(with_null, 40) == 40);
+		}
+
+		{
+			// Validation.
+			const c8* valid[] = {
+				"",
+				"hello",
+				"\xC3\xA9",							// U+00E9
+				"\xE4\xB8\xAD\xE6\x96\x87",			// U+4E2D U+6587
+				"\xF0\x9F\x98\x80",					// U+1F600
+				"\xF4\x8F\xBF\xBF",					// U+10FFFF
+				"\xEF\xBF\xBD",						// U+FFFD
+			};
+			for (auto s : valid)
+			{
+				lutest(utf8_validate(s, strlen(s)));
+			}
+			const c8* invalid[] = {
+				"\x80",								// Unexpected continuation byte.
+				"\xC3",								// Truncated.
+				"\xE4\xB8",							// Truncated.
+				"\xC0\xAF",							// Overlong '/'.
+				"\xE0\x80\xAF",						// Overlong '/'.
+				"\xED\xA0\x80",						// Surrogate U+D800.
+				"\xF4\x90\x80\x80",					// U+110000.
+				"\xF8\x88\x80\x80\x80",				// 5-byte sequence.
+				"\xC3\x28",							// Bad continuation byte.
+				"\xFF",
+			};
+			for (auto s : invalid)
+			{
+				lutest(!utf8_validate(s, strlen(s)));
+			}
+			// Errors after long ASCII blocks are found.
+			String s = gen_text(100, 0);
+			s.push_back('\xC3');
+			lutest(!utf8_validate(s.c_str(), s.size()));
+			s.push_back('\xA9');
+			lutest(utf8_validate(s.c_str(), s.size()));
+		}
+
+		{
+			// Bulk decoding matches per-char decoding.
+			usize strides[] = { 0, 1, 3, 17, 40 };
+			for (usize k = 0; k < 6; ++k)
+			{
+				String s = k < 5 ? gen_text(200, strides[k]) : gen_mixed_script_text(200);
+				Vector<c32> expected;
+				const c8* cur = s.c_str();
+				while (*cur)
+				{
+					expected.push_back(utf8_decode_char(cur));
+					cur += utf8_charlen(cur);
+				}
+				Vector<c32> decoded;
+				decoded.resize(s.size());
+				usize read;
+				usize n = utf8_decode_span(decoded.data(), decoded.size(), s.c_str(), s.size(), &read);
+				lutest(read == s.size());
+				lutest(n == expected.size());
+				for (usize i = 0; i < n; ++i)
+				{
+					lutest(decoded[i] == expected[i]);
+				}
+				// Destination buffer is full.
+				n = utf8_decode_span(decoded.data(), 20, s.c_str(), s.size(), &read);
+				lutest(n == 20);
+				lutest(read == utf8_index(s.c_str(), 20));
+			}
+			// Truncated characters are not consumed.
+			const c8* s = "abc\xE4\xB8\xAD\xE4\xB8";
+			c32 buf[8];
+			usize read;
+			usize n = utf8_decode_span(buf, 8, s, 8, &read);
+			lutest(n == 4);
+			lutest(read == 6);
+			lutest(buf[3] == 0x4E2D);
+		}
+
+		{
+			// Conversion between UTF-8, UTF-16 and UTF-32.
+			for (usize stride : { (usize)0, (usize)2, (usize)33 })
+			{
+				String s = gen_text(100, stride);
+				usize len16 = utf8_to_utf16_len(s.c_str());
+				Vector<c16> s16;
+				s16.resize(len16 + 1);
+				lutest(utf8_to_utf16(s16.data(), s16.size(), s.c_str()) == len16);
+				lutest(utf16_to_utf8_len(s16.data()) == s.size());
+				String back;
+				back.resize(s.size(), '\0');
+				lutest(utf16_to_utf8(back.data(), s.size() + 1, s16.data()) == s.size());
+				lutest(back == s);
+
+				usize len32 = utf8_strlen(s.c_str());
+				Vector<c32> s32;
+				s32.resize(len32 + 1);
+				lutest(utf8_to_utf32(s32.data(), s32.size(), s.c_str()) == len32);
+				lutest(s32[len32] == 0);
+				lutest(utf32_to_utf8_len(s32.data()) == s.size());
+				back.clear();
+				back.resize(s.size(), '\0');
+				lutest(utf32_to_utf8(back.data(), s.size() + 1, s32.data()) == s.size());
+				lutest(back == s);
+			}
+			// Surrogate pairs.
+			c16 pair[3];
+			lutest(utf8_to_utf16(pair, 3, "\xF0\x9F\x98\x80") == 2);
+			lutest(pair[0] == 0xDE00 && pair[1] == 0xD83D);
+			lutest(utf16_decode_char(pair) == 0x1F600);
+			lutest(utf8_to_utf16(pair, 3, "\xF0\x9F\x98\x80", false) == 2);
+			lutest(pair[0] == 0xD83D && pair[1] == 0xDE00);
+			lutest(utf16_decode_char(pair) == 0x1F600);
+			String s = gen_text(40, 0);
+			// Output is truncated by the destination buffer.
+			c16 small16[10];
+			lutest(utf8_to_utf16(small16, 10, s.c_str()) == 9);
+			lutest(small16[9] == 0);
+			c8 small8[10];
+			c32 s32[41];
+			utf8_to_utf32(s32, 41, s.c_str());
+			lutest(utf32_to_utf8(small8, 10, s32) == 9);
+			lutest(small8[9] == 0);
+			// `src_chars` limits the characters read.
+			lutest(utf8_to_utf16(small16, 10, s.c_str(), true, 5) == 5);
+		}
+
+		unicode_benchmark();
+	}
+}
@@ -415,5 +415,41 @@ namespace Luna
 			lutest(vec.empty());
 			lutest(vec.capacity() == 0);
 		}
+
+		{
+			// void resize_for_overwrite(usize n)
+			// iterator append_uninitialized(usize count)
+			Vector<u32> vec;
+			vec.resize_for_overwrite(10);
+			lutest(vec.size() == 10);
+			for (u32 i = 0; i < 10; ++i)
+			{
+				vec[i] = i;
+			}
+			u32* dest = vec.append_uninitialized(20);
+			lutest(vec.size() == 30);
+			lutest(dest == vec.data() + 10);
+			for (u32 i = 0; i < 20; ++i)
+			{
+				dest[i] = i + 10;
+			}
+			for (u32 i = 0; i < 30; ++i)
+			{
+				lutest(vec[i] == i);
+			}
+			vec.resize_for_overwrite(5);
+			lutest(vec.size() == 5 && vec.back() == 4);
+
+			Vector<TestObject> vec2;
+			TestObject* objs = vec2.append_uninitialized(3);
+			for (i32 i = 0; i < 3; ++i)
+			{
+				new (objs + i) TestObject(i);
+			}
+			lutest(vec2.size() == 3);
+			lutest(vec2[2] == TestObject(2));
+		}
+		lutest(TestObject::is_clear());
+		TestObject::reset();
 	}
-}
\ No newline at end of file
+}
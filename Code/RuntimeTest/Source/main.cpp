@@ -15,15 +15,35 @@ int main()
 
 	usize mem = get_allocated_memory();
 
+	memory_test();
+
+	lutest(mem == get_allocated_memory());
+
 	vector_test();
 
 	//! Ensure there is not any memory leak in container.
 	lutest(mem == get_allocated_memory());
 
+	inline_vector_test();
+
+	lutest(mem == get_allocated_memory());
+
 	hash_test();
 
 	lutest(mem == get_allocated_memory());
 
+	hash_algorithm_test();
+
+	lutest(mem == get_allocated_memory());
+
+	flat_hash_test();
+
+	lutest(mem == get_allocated_memory());
+
+	allocator_test();
+
+	lutest(mem == get_allocated_memory());
+
 	ring_deque_test();
 
 	lutest(mem == get_allocated_memory());
@@ -32,14 +52,39 @@ int main()
 
 	lutest(mem == get_allocated_memory());
 
+	unicode_test();
+
+	lutest(mem == get_allocated_memory());
+
 	name_test();
 
+	name_concurrency_test();
+
 	path_test();
 	//vfs_test();
 	//data_test();
 
 	time_test();
 
+	// Names are interned and kept alive, so the memory is measured again from here.
+	mem = get_allocated_memory();
+
+	fiber_test();
+
+	lutest(mem == get_allocated_memory());
+
+	sync_test();
+
+	lutest(mem == get_allocated_memory());
+
+	concurrent_queue_test();
+
+	lutest(mem == get_allocated_memory());
+
+	profiler_test();
+
+	lutest(mem == get_allocated_memory());
+
 	lexical_test();
 
 	close();
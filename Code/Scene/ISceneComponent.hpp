@@ -6,6 +6,7 @@
 */
 #pragma once
 #include <Core/Core.hpp>
+#include <Runtime/InlineVector.hpp>
 
 namespace Luna
 {
@@ -25,7 +26,7 @@ namespace Luna
 			virtual P<IScene> belonging_scene() = 0;
 
 			//! Gets a list of assets this component refers to.
-			virtual Vector<Guid> referred_assets() = 0;
+			virtual InlineVector<Guid, 2> referred_assets() = 0;
 		};
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #pragma once
 #include "SceneHeader.hpp"
 #include <Runtime/TSAssert.hpp>
+#include <Runtime/InlineVector.hpp>
 #include <Core/Interface.hpp>
 
 namespace Luna
@@ -22,7 +23,7 @@ namespace Luna
 
 			WP<IScene> m_belonging_scene;
 			Name m_name;
-			Vector<P<IComponent>> m_components;
+			InlineVector<P<IComponent>, 4> m_components;
 
 			Entity() {}
 
@@ -6,6 +6,7 @@
 */
 #include "ObjImporter.hpp"
 #include <Runtime/HashMap.hpp>
+#include <Core/Parallel.hpp>
 
 namespace Luna
 {
@@ -19,9 +20,11 @@ namespace Luna
 
 			// Convert indices to vertices.
 			Vector<E3D::Vertex> vertices;
-			for (auto& i : m.indices)
+			vertices.resize_for_overwrite(m.indices.size());
+			for (usize vi = 0; vi < m.indices.size(); ++vi)
 			{
-				E3D::Vertex v;
+				auto& i = m.indices[vi];
+				E3D::Vertex& v = vertices[vi];
 				v.position = attrib.vertices[i.vertex_index];
 				auto& color3 = attrib.colors[i.vertex_index];
 				v.color = Float4U(color3.r, color3.g, color3.b, 1.0f);
@@ -42,7 +45,6 @@ namespace Luna
 					v.texcoord = Float2U(0.0f, 0.0f);
 				}
 				// Tangent is left to be computed later.
-				vertices.push_back(v);
 			}
 
 			// Build index list.
@@ -59,11 +61,13 @@ namespace Luna
 				}
 
 				// If this is not a triangle face, convert this to triangles.
-				for (u32 j = 0; j < (u32)(faces[i] - 2); ++j)
+				u32 num_tris = (u32)(faces[i] - 2);
+				u32* dest = iter->second.append_uninitialized(num_tris * 3);
+				for (u32 j = 0; j < num_tris; ++j)
 				{
-					iter->second.push_back(vert_offset);
-					iter->second.push_back(vert_offset + j + 1);
-					iter->second.push_back(vert_offset + j + 2);
+					dest[j * 3] = vert_offset;
+					dest[j * 3 + 1] = vert_offset + j + 1;
+					dest[j * 3 + 2] = vert_offset + j + 2;
 				}
 				vert_offset += faces[i];
 			}
@@ -112,7 +116,8 @@ namespace Luna
 				idx_offset += (u32)i.second.size();
 			}
 
-			for (usize i = 0; i < vertices.size(); ++i)
+			// Vertices are independent, so they are processed in parallel.
+			parallel_for(0, vertices.size(), [&](usize i)
 			{
 				Float3 n = vertices[i].normal;
 				Float3 t = tangents[i];
@@ -127,7 +132,7 @@ namespace Luna
 					tang = -tang;
 				}
 				vertices[i].tangent = tang;
-			}
+			});
 
 			// Fill vertex data.
 			auto vb_blob = Blob(vertices.size() * sizeof(E3D::Vertex));
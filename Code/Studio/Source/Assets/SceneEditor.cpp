@@ -443,8 +443,10 @@ namespace Luna
 				}
 
 				// Fetch meshes to draw.
-				Vector<P<E3D::ITransform>> ts;
-				Vector<P<E3D::IModelRenderer>> rs;
+				m_frame_arena.reset();
+				ArenaAllocator<LinearArena> frame_alloc(m_frame_arena);
+				Vector<P<E3D::ITransform>, ArenaAllocator<LinearArena>> ts(frame_alloc);
+				Vector<P<E3D::IModelRenderer>, ArenaAllocator<LinearArena>> rs(frame_alloc);
 				for (auto& i : entities)
 				{
 					auto t = i->get_component(Name("Transform"));
@@ -489,8 +491,8 @@ namespace Luna
 				}
 
 				// Fetches lights to draw.
-				Vector<P<E3D::ITransform>> light_ts;
-				Vector<P<E3D::ILight>> light_rs;
+				Vector<P<E3D::ITransform>, ArenaAllocator<LinearArena>> light_ts(frame_alloc);
+				Vector<P<E3D::ILight>, ArenaAllocator<LinearArena>> light_rs(frame_alloc);
 				for (auto& i : entities)
 				{
 					auto t = i->get_component(Name("Transform"));
@@ -11,6 +11,7 @@
 #include "../IComponentEditorType.hpp"
 #include "../ISceneComponentEditorType.hpp"
 #include <Runtime/HashMap.hpp>
+#include <Runtime/Allocator.hpp>
 
 namespace Luna
 {
@@ -106,6 +107,9 @@ namespace Luna
 
 			bool m_open = true;
 
+			// Temporary memory used when drawing the scene, which is reset every frame.
+			LinearArena m_frame_arena;
+
 			SceneEditor() {}
 
 			void init();